@@ -26,16 +26,143 @@
 
 #include "BinaryDataSet.h"
 
+// Standard C Includes
+#include <string.h>
+
 // Standard C++11 Includes
 #include <algorithm>
+#include <iterator>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 using namespace libcomp;
 using namespace libhack;
 
+/// Number of bytes read at a time when streaming XML records.
+static const std::streamsize XML_CHUNK_SIZE = 64 * 1024;
+
+namespace {
+
+/**
+ * XML printer that indents one extra level so a single object prints the
+ * same as it would inside the root objects element.
+ */
+class RecordPrinter : public tinyxml2::XMLPrinter {
+ protected:
+  virtual void PrintSpace(int depth) {
+    tinyxml2::XMLPrinter::PrintSpace(depth + 1);
+  }
+};
+
+}  // namespace
+
+/**
+ * Print a single object as XML.
+ * @param obj Object to print
+ * @param xml Set to the XML for the object
+ * @returns true if the object was saved
+ */
+static bool PrintObject(const std::shared_ptr<libcomp::Object>& obj,
+                        std::string& xml) {
+  tinyxml2::XMLDocument doc;
+
+  tinyxml2::XMLElement* pRoot = doc.NewElement("objects");
+  doc.InsertEndChild(pRoot);
+
+  if (!obj->Save(doc, *pRoot)) {
+    return false;
+  }
+
+  RecordPrinter printer;
+
+  for (auto pElement = pRoot->FirstChildElement(); nullptr != pElement;
+       pElement = pElement->NextSiblingElement()) {
+    pElement->Accept(&printer);
+  }
+
+  xml = printer.CStr();
+
+  return true;
+}
+
+/**
+ * Check if a character ends the name of an XML tag.
+ * @param c Character after the tag name
+ * @returns true if the tag name ends before the character
+ */
+static bool IsTagNameEnd(char c) {
+  return ' ' == c || '\t' == c || '\r' == c || '\n' == c || '>' == c ||
+         '/' == c;
+}
+
+/**
+ * Find the first complete object or remove element that is a direct child
+ * of the root element in a buffer of XML.
+ * @param buffer XML read so far
+ * @param offset Offset in the buffer to start looking from
+ * @param start Set to the offset of the element or npos if none has started
+ * @param end Set to the offset just past the element
+ * @returns true if a complete element was found
+ */
+static bool FindXmlRecord(const std::string& buffer, size_t offset,
+                          size_t& start, size_t& end) {
+  int depth = 0;
+
+  start = std::string::npos;
+
+  for (size_t idx = buffer.find('<', offset); std::string::npos != idx;
+       idx = buffer.find('<', idx + 1)) {
+    if (0 == buffer.compare(idx, 9, "</object>")) {
+      if (0 < depth && 0 == --depth) {
+        end = idx + 9;
+
+        return true;
+      }
+    } else if (0 == depth && (idx + 7) < buffer.size() &&
+               0 == buffer.compare(idx, 7, "<remove") &&
+               IsTagNameEnd(buffer[idx + 7])) {
+      // Removed records are always written as an empty element.
+      start = idx;
+
+      size_t close = buffer.find('>', idx);
+
+      if (std::string::npos == close) {
+        break;
+      }
+
+      end = close + 1;
+
+      return true;
+    } else if ((idx + 7) < buffer.size() &&
+               0 == buffer.compare(idx, 7, "<object") &&
+               IsTagNameEnd(buffer[idx + 7])) {
+      size_t close = buffer.find('>', idx);
+
+      if (std::string::npos == close) {
+        break;
+      }
+
+      if (0 == depth) {
+        start = idx;
+      }
+
+      if ('/' != buffer[close - 1]) {
+        depth++;
+      } else if (0 == depth) {
+        end = close + 1;
+
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 BinaryDataSet::BinaryDataSet(
     std::function<std::shared_ptr<libcomp::Object>()> allocator,
     std::function<uint32_t(const std::shared_ptr<libcomp::Object>&)> mapper)
@@ -105,6 +232,140 @@ bool BinaryDataSet::LoadXml(tinyxml2::XMLDocument& doc, bool loadMore) {
   return !mObjects.empty();
 }
 
+bool BinaryDataSet::LoadXml(std::istream& file, bool loadMore) {
+  std::list<std::shared_ptr<libcomp::Object>> objs;
+
+  if (!ReadXmlRecords(file,
+                      [&objs](const std::shared_ptr<libcomp::Object>& obj) {
+                        objs.push_back(obj);
+
+                        return true;
+                      })) {
+    return false;
+  }
+
+  if (loadMore) {
+    for (auto obj : objs) {
+      mObjects.push_back(obj);
+    }
+  } else {
+    mObjects = objs;
+    mObjectMap.clear();
+  }
+
+  for (auto obj : objs) {
+    mObjectMap[mObjectMapper(obj)] = obj;
+  }
+
+  return !mObjects.empty();
+}
+
+bool BinaryDataSet::ApplyXml(std::istream& file, size_t& replaced,
+                             size_t& added, size_t& removed) {
+  replaced = 0;
+  added = 0;
+  removed = 0;
+
+  // Position of each record in the list so a replaced record can be
+  // swapped in place and a removed record erased. This is only built once
+  // a record is replaced or removed.
+  std::unordered_map<libcomp::Object*,
+                     std::list<std::shared_ptr<libcomp::Object>>::iterator>
+      positions;
+
+  auto findPosition = [&](const std::shared_ptr<libcomp::Object>& obj) {
+    if (positions.empty()) {
+      for (auto pos = mObjects.begin(); pos != mObjects.end(); ++pos) {
+        positions[pos->get()] = pos;
+      }
+    }
+
+    return positions.find(obj.get());
+  };
+
+  return ReadXmlRecords(
+      file,
+      [&](const std::shared_ptr<libcomp::Object>& obj) {
+        uint32_t id = mObjectMapper(obj);
+
+        auto it = mObjectMap.find(id);
+
+        if (mObjectMap.end() != it) {
+          // Keep the record in the same place in the file.
+          auto pos = findPosition(it->second);
+
+          if (positions.end() != pos) {
+            auto listPos = pos->second;
+            *listPos = obj;
+
+            positions.erase(pos);
+            positions[obj.get()] = listPos;
+          }
+
+          it->second = obj;
+          replaced++;
+        } else {
+          mObjects.push_back(obj);
+          mObjectMap[id] = obj;
+          added++;
+
+          if (!positions.empty()) {
+            positions[obj.get()] = std::prev(mObjects.end());
+          }
+        }
+
+        return true;
+      },
+      [&](uint32_t id) {
+        auto it = mObjectMap.find(id);
+
+        // Removing a record that is already gone is not an error so the
+        // same patch can be applied twice.
+        if (mObjectMap.end() != it) {
+          auto pos = findPosition(it->second);
+
+          if (positions.end() != pos) {
+            mObjects.erase(pos->second);
+            positions.erase(pos);
+          }
+
+          mObjectMap.erase(it);
+          removed++;
+        }
+
+        return true;
+      });
+}
+
+bool BinaryDataSet::SaveXml(std::ostream& file) const {
+  return SaveXml(file, mObjects);
+}
+
+bool BinaryDataSet::SaveXml(
+    std::ostream& file,
+    const std::list<std::shared_ptr<libcomp::Object>>& objs,
+    const std::list<uint32_t>& removedIDs) {
+  file << "<objects>" << std::endl;
+
+  std::string xml;
+
+  for (auto obj : objs) {
+    if (!PrintObject(obj, xml)) {
+      return false;
+    }
+
+    file << xml;
+  }
+
+  for (auto id : removedIDs) {
+    file << "    <remove id=\"" << id << "\"/>" << std::endl;
+  }
+
+  file << "</objects>" << std::endl;
+
+  return file.good();
+}
+
 std::string BinaryDataSet::GetXml() const {
   tinyxml2::XMLDocument doc;
 
@@ -178,6 +439,98 @@ std::shared_ptr<libcomp::Object> BinaryDataSet::GetObjectByID(
   return {};
 }
 
+std::list<std::shared_ptr<libcomp::Object>> BinaryDataSet::GetChangedObjects(
+    const BinaryDataSet& base) const {
+  std::list<std::shared_ptr<libcomp::Object>> changed;
+
+  std::string xml, baseXml;
+
+  for (auto pair : mObjectMap) {
+    auto baseObj = base.GetObjectByID(pair.first);
+
+    if (!baseObj || !PrintObject(pair.second, xml) ||
+        !PrintObject(baseObj, baseXml) || xml != baseXml) {
+      changed.push_back(pair.second);
+    }
+  }
+
+  return changed;
+}
+
+std::list<uint32_t> BinaryDataSet::GetRemovedIDs(
+    const BinaryDataSet& base) const {
+  std::list<uint32_t> removed;
+
+  for (auto pair : base.mObjectMap) {
+    if (mObjectMap.end() == mObjectMap.find(pair.first)) {
+      removed.push_back(pair.first);
+    }
+  }
+
+  return removed;
+}
+
+bool BinaryDataSet::ReadXmlRecords(
+    std::istream& file,
+    const std::function<bool(const std::shared_ptr<libcomp::Object>&)>&
+        handler,
+    const std::function<bool(uint32_t)>& removeHandler) const {
+  std::string buffer;
+  std::vector<char> chunk((size_t)XML_CHUNK_SIZE);
+
+  size_t start, end;
+
+  while (true) {
+    // Handle every complete record before reading more. The records
+    // handled are only removed from the buffer once per chunk.
+    size_t offset = 0;
+
+    while (FindXmlRecord(buffer, offset, start, end)) {
+      tinyxml2::XMLDocument doc;
+
+      if (tinyxml2::XML_SUCCESS != doc.Parse(buffer.c_str() + start,
+                                             end - start) ||
+          nullptr == doc.RootElement()) {
+        return false;
+      }
+
+      auto pElement = doc.RootElement();
+
+      if (0 == strcmp("remove", pElement->Name())) {
+        // Only a patch can remove records.
+        unsigned int id = 0;
+
+        if (!removeHandler ||
+            tinyxml2::XML_SUCCESS != pElement->QueryUnsignedAttribute("id",
+                                                                     &id) ||
+            !removeHandler((uint32_t)id)) {
+          return false;
+        }
+      } else {
+        auto obj = mObjectAllocator();
+
+        if (!obj->Load(doc, *pElement) || !handler(obj)) {
+          return false;
+        }
+      }
+
+      offset = end;
+    }
+
+    buffer.erase(0, offset);
+
+    if (!file.good()) {
+      break;
+    }
+
+    file.read(&chunk[0], XML_CHUNK_SIZE);
+    buffer.append(&chunk[0], (size_t)file.gcount());
+  }
+
+  // Anything left over should be the end of the root element.
+  return file.eof() && std::string::npos == start;
+}
+
 std::list<std::string> BinaryDataSet::ReadNodes(tinyxml2::XMLElement* node,
                                                 int16_t dataMode) const {
   std::list<std::string> data;
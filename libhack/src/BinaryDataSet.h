@@ -28,6 +28,8 @@
 #define LIBHACK_SRC_BINARYDATASET_H
 
 // Standard C++11 Includes
+#include <functional>
+#include <list>
 #include <map>
 #include <memory>
 
@@ -57,12 +59,23 @@ class BinaryDataSet {
   bool Save(std::ostream& file) const;
 
   bool LoadXml(tinyxml2::XMLDocument& doc, bool loadMore = false);
+  bool LoadXml(std::istream& file, bool loadMore = false);
+  bool ApplyXml(std::istream& file, size_t& replaced, size_t& added,
+                size_t& removed);
+
+  bool SaveXml(std::ostream& file) const;
+  static bool SaveXml(std::ostream& file,
+                      const std::list<std::shared_ptr<libcomp::Object>>& objs,
+                      const std::list<uint32_t>& removedIDs = {});
 
   std::string GetXml() const;
   std::string GetTabular() const;
 
   std::list<std::shared_ptr<libcomp::Object>> GetObjects() const;
   std::shared_ptr<libcomp::Object> GetObjectByID(uint32_t id) const;
+  std::list<std::shared_ptr<libcomp::Object>> GetChangedObjects(
+      const BinaryDataSet& base) const;
+  std::list<uint32_t> GetRemovedIDs(const BinaryDataSet& base) const;
 
  protected:
   std::function<std::shared_ptr<libcomp::Object>()> mObjectAllocator;
@@ -73,6 +86,12 @@ class BinaryDataSet {
   std::list<std::string> ReadNodes(tinyxml2::XMLElement* node,
                                    int16_t dataMode) const;
 
+  bool ReadXmlRecords(
+      std::istream& file,
+      const std::function<bool(const std::shared_ptr<libcomp::Object>&)>&
+          handler,
+      const std::function<bool(uint32_t)>& removeHandler = {}) const;
+
  protected:
   std::list<std::shared_ptr<libcomp::Object>> mObjects;
   std::map<uint32_t, std::shared_ptr<libcomp::Object>> mObjectMap;
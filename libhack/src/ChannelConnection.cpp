@@ -35,15 +35,17 @@ using namespace libcomp;
 using namespace libhack;
 
 ChannelConnection::ChannelConnection(asio::io_service& io_service)
-    : libcomp::EncryptedConnection(io_service) {}
+    : libcomp::EncryptedConnection(io_service), mWriteCount(0) {}
 
 ChannelConnection::ChannelConnection(
     asio::ip::tcp::socket& socket,
     const std::shared_ptr<Crypto::DiffieHellman>& diffieHellman)
-    : libcomp::EncryptedConnection(socket, diffieHellman) {}
+    : libcomp::EncryptedConnection(socket, diffieHellman), mWriteCount(0) {}
 
 ChannelConnection::~ChannelConnection() {}
 
+uint64_t ChannelConnection::TakeWriteCount() { return mWriteCount.exchange(0); }
+
 void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets) {
   static const uint32_t headerSize = GetHeaderSize();
 
@@ -168,6 +170,7 @@ void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets) {
       mEncryptionKey.EncryptPacket(finalPacket);
 
       mOutgoing = finalPacket;
+      mWriteCount++;
     } else {
       // We should never get here.
       SocketError();
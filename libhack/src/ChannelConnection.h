@@ -30,6 +30,9 @@
 // libcomp Includes
 #include "EncryptedConnection.h"
 
+// Standard C++11 Includes
+#include <atomic>
+
 namespace libhack {
 
 /**
@@ -58,6 +61,13 @@ class ChannelConnection : public libcomp::EncryptedConnection {
    */
   virtual ~ChannelConnection();
 
+  /**
+   * Get the number of socket writes prepared since the last call and reset
+   * the count. Each write carries every packet flushed together.
+   * @return Number of socket writes
+   */
+  uint64_t TakeWriteCount();
+
  protected:
   virtual void PreparePackets(std::list<libcomp::ReadOnlyPacket>& packets);
 
@@ -65,6 +75,10 @@ class ChannelConnection : public libcomp::EncryptedConnection {
                                 uint32_t& realSize, uint32_t& dataStart);
 
   virtual uint32_t GetHeaderSize();
+
+ private:
+  /// Number of socket writes prepared since the count was last taken
+  std::atomic<uint64_t> mWriteCount;
 };
 
 }  // namespace libhack
@@ -0,0 +1,190 @@
+/**
+ * @file libhack/src/CoalescingSyncManager.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief DataSyncManager that coalesces outgoing records within a flush
+ * window before sending them to each connection.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CoalescingSyncManager.h"
+
+// libcomp Includes
+#include <Object.h>
+#include <Packet.h>
+
+using namespace libhack;
+
+namespace libcomp {
+template <>
+BaseScriptEngine& BaseScriptEngine::Using<CoalescingSyncManager>() {
+  if (!BindingExists("CoalescingSyncManager", true)) {
+    Using<DataSyncManager>();
+
+    // Scripts only see the base binding otherwise and the sync functions
+    // are not virtual so the flush window would be skipped.
+    Sqrat::DerivedClass<CoalescingSyncManager, DataSyncManager,
+                        Sqrat::NoConstructor<CoalescingSyncManager>>
+        binding(mVM, "CoalescingSyncManager");
+    binding.Func("UpdateRecord", &CoalescingSyncManager::UpdateRecord)
+        .Func("RemoveRecord", &CoalescingSyncManager::RemoveRecord)
+        .Func("SyncOutgoing", &CoalescingSyncManager::SyncOutgoing);
+
+    Bind<CoalescingSyncManager>("CoalescingSyncManager", binding);
+  }
+
+  return *this;
+}
+}  // namespace libcomp
+
+CoalescingSyncManager::CoalescingSyncManager(uint16_t syncPacketCode)
+    : libcomp::DataSyncManager(syncPacketCode),
+      mFlushWindow(0),
+      mFlushPending(false),
+      mRecordsCoalesced(0),
+      mBytesSaved(0),
+      mRecordsCoalescedTaken(0),
+      mBytesSavedTaken(0) {}
+
+CoalescingSyncManager::~CoalescingSyncManager() {}
+
+bool CoalescingSyncManager::UpdateRecord(
+    const std::shared_ptr<libcomp::Object>& record,
+    const libcomp::String& type) {
+  if (DataSyncManager::UpdateRecord(record, type)) {
+    TrackPending(record, type);
+    return true;
+  }
+
+  return false;
+}
+
+bool CoalescingSyncManager::RemoveRecord(
+    const std::shared_ptr<libcomp::Object>& record,
+    const libcomp::String& type) {
+  if (DataSyncManager::RemoveRecord(record, type)) {
+    TrackPending(record, type);
+    return true;
+  }
+
+  return false;
+}
+
+void CoalescingSyncManager::SyncOutgoing() {
+  {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    if (mFlushWindow) {
+      // Hold everything until the window closes
+      mFlushPending = true;
+      return;
+    }
+  }
+
+  SendOutgoing();
+}
+
+void CoalescingSyncManager::FlushOutgoing() {
+  {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    if (!mFlushPending) {
+      // Still drop the window's records in case something synced them
+      // through the base class without going through the window.
+      mPendingRecords.clear();
+      return;
+    }
+  }
+
+  SendOutgoing();
+}
+
+uint32_t CoalescingSyncManager::GetFlushWindow() const {
+  return mFlushWindow;
+}
+
+void CoalescingSyncManager::SetFlushWindow(uint32_t flushWindow) {
+  bool flush = false;
+  {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    mFlushWindow = flushWindow;
+    flush = !flushWindow && mFlushPending;
+  }
+
+  if (flush) {
+    // Nothing will flush the pending records anymore
+    SendOutgoing();
+  }
+}
+
+uint64_t CoalescingSyncManager::GetRecordsCoalesced() const {
+  return mRecordsCoalesced;
+}
+
+uint64_t CoalescingSyncManager::GetBytesSaved() const {
+  return mBytesSaved;
+}
+
+void CoalescingSyncManager::TakeStats(uint64_t& recordsCoalesced,
+                                      uint64_t& bytesSaved) {
+  std::lock_guard<std::mutex> lock(mPendingLock);
+
+  uint64_t totalCoalesced = mRecordsCoalesced;
+  uint64_t totalSaved = mBytesSaved;
+
+  recordsCoalesced = totalCoalesced - mRecordsCoalescedTaken;
+  bytesSaved = totalSaved - mBytesSavedTaken;
+
+  mRecordsCoalescedTaken = totalCoalesced;
+  mBytesSavedTaken = totalSaved;
+}
+
+void CoalescingSyncManager::SendOutgoing() {
+  {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    mPendingRecords.clear();
+    mFlushPending = false;
+  }
+
+  DataSyncManager::SyncOutgoing();
+}
+
+void CoalescingSyncManager::TrackPending(
+    const std::shared_ptr<libcomp::Object>& record,
+    const libcomp::String& type) {
+  {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    if (!mFlushWindow) {
+      // Nothing is held so nothing can be coalesced
+      return;
+    }
+
+    if (mPendingRecords[type.C()].insert(record).second) {
+      return;
+    }
+  }
+
+  // The record is already pending so this update rides along with the
+  // existing one. Estimate what it would have cost to send separately.
+  libcomp::Packet p;
+  record->SavePacket(p);
+
+  mRecordsCoalesced++;
+  mBytesSaved += (uint64_t)p.Size();
+}
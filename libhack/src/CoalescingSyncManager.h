@@ -0,0 +1,190 @@
+/**
+ * @file libhack/src/CoalescingSyncManager.h
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief DataSyncManager that coalesces outgoing records within a flush
+ * window before sending them to each connection.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_COALESCINGSYNCMANAGER_H
+#define LIBHACK_SRC_COALESCINGSYNCMANAGER_H
+
+// libcomp Includes
+#include <DataSyncManager.h>
+#include <ScriptEngine.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <set>
+
+namespace libhack {
+
+/**
+ * Server side DataSyncManager that can hold outgoing records for a
+ * configurable flush window instead of sending them as soon as they are
+ * queued. Records updated multiple times within the same window are only
+ * sent once with their latest state and every connection receives a single
+ * DataSync packet per window containing all queued records.
+ */
+class CoalescingSyncManager : public libcomp::DataSyncManager {
+ public:
+  /**
+   * Create a new CoalescingSyncManager
+   * @param syncPacketCode Packet code used for DataSync packets
+   */
+  CoalescingSyncManager(uint16_t syncPacketCode);
+
+  /**
+   * Clean up the CoalescingSyncManager
+   */
+  virtual ~CoalescingSyncManager();
+
+  /**
+   * Queue a record to be updated on the connections registered for its
+   * type. If the record is already queued within the current flush window
+   * it will be coalesced with the pending update.
+   * @param record Pointer to the record to update
+   * @param type Type name of the record
+   * @return true if the record was queued, false if it was not
+   */
+  virtual bool UpdateRecord(const std::shared_ptr<libcomp::Object>& record,
+                            const libcomp::String& type);
+
+  /**
+   * Queue a record to be removed from the connections registered for its
+   * type. If the record is already queued within the current flush window
+   * it will be coalesced with the pending update.
+   * @param record Pointer to the record to remove
+   * @param type Type name of the record
+   * @return true if the record was queued, false if it was not
+   */
+  virtual bool RemoveRecord(const std::shared_ptr<libcomp::Object>& record,
+                            const libcomp::String& type);
+
+  /**
+   * Send all queued records to each registered connection. If a flush
+   * window is set, the send is deferred until the next call to
+   * @ref FlushOutgoing. This hides the non-virtual base implementation so
+   * the script binding for this class rebinds it as well.
+   */
+  void SyncOutgoing();
+
+  /**
+   * Send any records that have been deferred by the flush window. This
+   * should be called once per window by the owning server.
+   */
+  void FlushOutgoing();
+
+  /**
+   * Get the flush window outgoing records are held for
+   * @return Flush window in milliseconds, 0 if records are sent as soon
+   *  as they are synced
+   */
+  uint32_t GetFlushWindow() const;
+
+  /**
+   * Set the flush window outgoing records are held for
+   * @param flushWindow Flush window in milliseconds, 0 to send records
+   *  as soon as they are synced
+   */
+  void SetFlushWindow(uint32_t flushWindow);
+
+  /**
+   * Get the number of record updates that have been coalesced into an
+   * already pending update since the server started
+   * @return Number of coalesced record updates
+   */
+  uint64_t GetRecordsCoalesced() const;
+
+  /**
+   * Get the estimated number of bytes that did not need to be sent due to
+   * record updates being coalesced since the server started
+   * @return Number of bytes saved by coalescing
+   */
+  uint64_t GetBytesSaved() const;
+
+  /**
+   * Get the record updates coalesced and bytes saved since the last call
+   * and reset both counts to zero. This is used for periodic reporting
+   * while @ref GetRecordsCoalesced and @ref GetBytesSaved keep the totals.
+   * @param recordsCoalesced Output number of coalesced record updates
+   * @param bytesSaved Output number of bytes saved by coalescing
+   */
+  void TakeStats(uint64_t& recordsCoalesced, uint64_t& bytesSaved);
+
+ private:
+  /**
+   * Clear the records pending for the current flush window and send all
+   * queued records to each registered connection right away.
+   */
+  void SendOutgoing();
+
+  /**
+   * Track a record queued for the current flush window and update the
+   * coalescing counters if it was already pending.
+   * @param record Pointer to the record being queued
+   * @param type Type name of the record
+   */
+  void TrackPending(const std::shared_ptr<libcomp::Object>& record,
+                    const libcomp::String& type);
+
+  /// Records queued within the current flush window by type name. The
+  /// base DataSyncManager queues records by reference so each distinct
+  /// record is only sent once with its state at the time of the flush.
+  std::unordered_map<std::string, std::set<std::shared_ptr<libcomp::Object>>>
+      mPendingRecords;
+
+  /// Server lock for the pending records and flush state
+  std::mutex mPendingLock;
+
+  /// Flush window in milliseconds, 0 if disabled
+  uint32_t mFlushWindow;
+
+  /// Indicates that a sync was requested within the current flush window
+  bool mFlushPending;
+
+  /// Number of record updates coalesced into a pending update
+  std::atomic<uint64_t> mRecordsCoalesced;
+
+  /// Estimated bytes not sent due to coalesced record updates
+  std::atomic<uint64_t> mBytesSaved;
+
+  /// Value of @ref mRecordsCoalesced at the last call to @ref TakeStats
+  uint64_t mRecordsCoalescedTaken;
+
+  /// Value of @ref mBytesSaved at the last call to @ref TakeStats
+  uint64_t mBytesSavedTaken;
+};
+
+}  // namespace libhack
+
+namespace libcomp {
+/**
+ * Bind the CoalescingSyncManager so scripts call the coalescing versions of
+ * the record and sync functions instead of the DataSyncManager ones.
+ * @returns Script engine the binding was added to.
+ */
+template <>
+BaseScriptEngine& BaseScriptEngine::Using<libhack::CoalescingSyncManager>();
+}  // namespace libcomp
+
+#endif  // LIBHACK_SRC_COALESCINGSYNCMANAGER_H
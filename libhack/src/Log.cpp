@@ -26,6 +26,14 @@
 
 #include "Log.h"
 
+// Standard C++11 Includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 using namespace libcomp;
 using namespace libhack;
 
@@ -47,6 +55,7 @@ static EnumMap<LogComponent_t, String> gLogComponentMapping = {
     {LogComponent_t::Item, "Item"},
     {LogComponent_t::MatchManager, "MatchManager"},
     {LogComponent_t::Party, "Party"},
+    {LogComponent_t::Performance, "Performance"},
     {LogComponent_t::ServerConstants, "ServerConstants"},
     {LogComponent_t::ServerDataManager, "ServerDataManager"},
     {LogComponent_t::SkillManager, "SkillManager"},
@@ -77,9 +86,249 @@ String libhack::LogComponentToString(GenericLogComponent_t comp) {
   return "Unknown";
 }
 
+namespace {
+
+/**
+ * Bounded lock-free queue of log messages with any number of producers and a
+ * single consumer. Each slot has a sequence number that tells producers when
+ * the slot is free and the consumer when the message in it is ready so no
+ * lock is taken on either side.
+ */
+class AsyncLogQueue {
+ public:
+  /**
+   * Create the queue.
+   * @param capacity Number of messages the queue can hold. This is rounded
+   *   up to a power of two of at least 2. A single slot would look free to
+   *   the producers again as soon as it was filled.
+   */
+  explicit AsyncLogQueue(size_t capacity)
+      : mCapacity(2), mEnqueuePos(0), mDequeuePos(0) {
+    while (mCapacity < capacity) {
+      mCapacity <<= 1;
+    }
+
+    mSlots.reset(new Slot[mCapacity]);
+
+    for (size_t i = 0; i < mCapacity; i++) {
+      mSlots[i].sequence.store(i, std::memory_order_relaxed);
+      mSlots[i].pMessage = nullptr;
+    }
+  }
+
+  /**
+   * Add a message to the queue. This may be called from any thread.
+   * @param pMessage Message to add.
+   * @returns false if the queue is full.
+   */
+  bool Push(LogMessage* pMessage) {
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    Slot* pSlot;
+
+    for (;;) {
+      pSlot = &mSlots[pos & (mCapacity - 1)];
+
+      size_t seq = pSlot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+      if (0 == diff) {
+        if (mEnqueuePos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (0 > diff) {
+        // The consumer has not freed this slot yet so the queue is full.
+        return false;
+      } else {
+        pos = mEnqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    pSlot->pMessage = pMessage;
+    pSlot->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * Remove the oldest message from the queue. This may only be called from
+   * the writer thread.
+   * @returns The message or null if the queue is empty.
+   */
+  LogMessage* Pop() {
+    Slot* pSlot = &mSlots[mDequeuePos & (mCapacity - 1)];
+
+    size_t seq = pSlot->sequence.load(std::memory_order_acquire);
+
+    if ((intptr_t)seq - (intptr_t)(mDequeuePos + 1) < 0) {
+      return nullptr;
+    }
+
+    LogMessage* pMessage = pSlot->pMessage;
+    pSlot->pMessage = nullptr;
+    pSlot->sequence.store(mDequeuePos + mCapacity, std::memory_order_release);
+    mDequeuePos++;
+
+    return pMessage;
+  }
+
+ private:
+  /// Entry in the ring buffer
+  struct Slot {
+    /// Position the slot is ready for
+    std::atomic<size_t> sequence;
+
+    /// Message stored in the slot
+    LogMessage* pMessage;
+  };
+
+  /// Ring buffer of messages
+  std::unique_ptr<Slot[]> mSlots;
+
+  /// Number of slots in the ring buffer (a power of two)
+  size_t mCapacity;
+
+  /// Position the next message will be added at
+  std::atomic<size_t> mEnqueuePos;
+
+  /// Position of the next message to write (writer thread only)
+  size_t mDequeuePos;
+};
+
+/**
+ * Writer thread and queue for async logging.
+ */
+class AsyncLogWriter {
+ public:
+  /**
+   * Create the queue and start the writer thread.
+   * @param pLog Log the writer thread writes messages to.
+   * @param capacity Number of messages the queue can hold.
+   */
+  AsyncLogWriter(BaseLog* pLog, size_t capacity)
+      : mQueue(capacity), mRunning(true), mIdle(false), mReported(0) {
+    mThread = std::thread([this, pLog]() { Run(pLog); });
+  }
+
+  /**
+   * Stop the writer thread once every queued message has been written.
+   */
+  ~AsyncLogWriter() {
+    mRunning.store(false);
+    mWake.notify_one();
+    mThread.join();
+  }
+
+  /**
+   * Queue a message for the writer thread.
+   * @param pMessage Message to queue.
+   * @returns false if the queue is full.
+   */
+  bool Push(LogMessage* pMessage) {
+    if (!mQueue.Push(pMessage)) {
+      return false;
+    }
+
+    // Only pay for the wake up if the writer is waiting for work.
+    if (mIdle.load(std::memory_order_relaxed)) {
+      mWake.notify_one();
+    }
+
+    return true;
+  }
+
+ private:
+  /**
+   * Write queued messages until the writer is stopped.
+   * @param pLog Log to write the messages to.
+   */
+  void Run(BaseLog* pLog);
+
+  /**
+   * Log a warning if messages were dropped since the last warning.
+   * @param pLog Log to write the warning to.
+   */
+  void ReportDropped(BaseLog* pLog);
+
+  /// Queued messages
+  AsyncLogQueue mQueue;
+
+  /// Writer thread
+  std::thread mThread;
+
+  /// Indicates the writer thread should keep running
+  std::atomic<bool> mRunning;
+
+  /// Indicates the writer thread is waiting for messages
+  std::atomic<bool> mIdle;
+
+  /// Lock for @ref mWake
+  std::mutex mWakeLock;
+
+  /// Signaled when a message is queued for an idle writer
+  std::condition_variable mWake;
+
+  /// Number of dropped messages the writer has already warned about
+  uint64_t mReported;
+};
+
+}  // namespace
+
+/// Writer for async logging or null if messages are written right away
+static std::atomic<AsyncLogWriter*> gAsyncWriter(nullptr);
+
+/// Number of threads currently inside @ref Log::Submit
+static std::atomic<uint32_t> gAsyncSubmitters(0);
+
+/// Number of messages dropped because the async queue was full
+static std::atomic<uint64_t> gAsyncDropped(0);
+
+/// Serializes enabling and disabling async logging
+static std::mutex gAsyncLock;
+
+void AsyncLogWriter::Run(BaseLog* pLog) {
+  for (;;) {
+    // Read this first so every message queued before the stop is written.
+    bool running = mRunning.load();
+    bool wrote = false;
+
+    while (LogMessage* pMessage = mQueue.Pop()) {
+      pLog->LogMessage(pMessage);
+      wrote = true;
+    }
+
+    ReportDropped(pLog);
+
+    if (!running) {
+      break;
+    }
+
+    if (!wrote) {
+      // The timeout covers a wake up missed between the check and the wait.
+      std::unique_lock<std::mutex> lock(mWakeLock);
+      mIdle.store(true);
+      mWake.wait_for(lock, std::chrono::milliseconds(10));
+      mIdle.store(false);
+    }
+  }
+}
+
+void AsyncLogWriter::ReportDropped(BaseLog* pLog) {
+  uint64_t dropped = gAsyncDropped.load(std::memory_order_relaxed);
+
+  if (dropped != mReported) {
+    pLog->LogMessage(new LogMessageFixed(
+        to_underlying(BaseLogComponent_t::General), BaseLog::LOG_LEVEL_WARNING,
+        String("Async log queue is full. %1 message(s) were dropped.\n")
+            .Arg(dropped - mReported)));
+
+    mReported = dropped;
+  }
+}
+
 Log::Log() : BaseLog() {}
 
-Log::~Log() {}
+Log::~Log() { DisableAsync(); }
 
 BaseLog* Log::GetSingletonPtr() {
   auto pBase = BaseLog::GetBaseSingletonPtr();
@@ -108,3 +357,64 @@ String Log::LogComponentToString(GenericLogComponent_t comp) const {
     return libcomp::BaseLogComponentToString(comp);
   }
 }
+
+bool Log::EnableAsync(size_t capacity) {
+  std::lock_guard<std::mutex> lock(gAsyncLock);
+
+  if (gAsyncWriter.load()) {
+    return false;
+  }
+
+  gAsyncWriter.store(new AsyncLogWriter(GetSingletonPtr(), capacity));
+
+  return true;
+}
+
+void Log::DisableAsync() {
+  std::lock_guard<std::mutex> lock(gAsyncLock);
+
+  AsyncLogWriter* pWriter = gAsyncWriter.exchange(nullptr);
+
+  if (!pWriter) {
+    return;
+  }
+
+  // Wait for any thread that already picked up the writer to queue its
+  // message so it is written before the writer stops.
+  while (gAsyncSubmitters.load()) {
+    std::this_thread::yield();
+  }
+
+  delete pWriter;
+}
+
+uint64_t Log::GetDroppedCount() { return gAsyncDropped.load(); }
+
+void Log::Submit(BaseLog* pLog, libcomp::LogMessage* pMessage) {
+  // Skip the shared submitter count entirely when async logging is off.
+  if (!gAsyncWriter.load()) {
+    pLog->LogMessage(pMessage);
+
+    return;
+  }
+
+  gAsyncSubmitters.fetch_add(1);
+
+  // Check again now that DisableAsync will wait for this thread.
+  AsyncLogWriter* pWriter = gAsyncWriter.load();
+
+  if (pWriter) {
+    if (!pWriter->Push(pMessage)) {
+      gAsyncDropped.fetch_add(1, std::memory_order_relaxed);
+      delete pMessage;
+    }
+
+    gAsyncSubmitters.fetch_sub(1);
+
+    return;
+  }
+
+  gAsyncSubmitters.fetch_sub(1);
+
+  pLog->LogMessage(pMessage);
+}
@@ -29,6 +29,9 @@
 
 #include "BaseLog.h"
 
+// Standard C++11 Includes
+#include <type_traits>
+
 namespace libhack {
 
 /**
@@ -51,6 +54,7 @@ enum class LogComponent_t : libcomp::GenericLogComponent_t {
   Item,
   MatchManager,
   Party,
+  Performance,
   ServerConstants,
   ServerDataManager,
   SkillManager,
@@ -133,6 +137,42 @@ class Log : public libcomp::BaseLog {
   libcomp::String LogComponentToString(
       libcomp::GenericLogComponent_t comp) const override;
 
+  /**
+   * Start writing log messages on a dedicated writer thread. Messages
+   * submitted with @ref Submit are queued in a fixed size lock-free ring
+   * buffer and the writer thread passes them to the log. When the ring
+   * buffer is full the message is dropped and counted instead of blocking
+   * the thread that logged it. Messages created with the Delayed log
+   * functions are also formatted on the writer thread.
+   * @param capacity Number of messages the ring buffer can hold. This is
+   *   rounded up to a power of two of at least 2.
+   * @returns true if async logging was started, false if it was already
+   *   enabled.
+   */
+  static bool EnableAsync(size_t capacity);
+
+  /**
+   * Stop the writer thread after it has written every queued message.
+   * Messages are written on the thread that logs them afterwards.
+   */
+  static void DisableAsync();
+
+  /**
+   * Get the number of messages dropped because the ring buffer was full.
+   * @returns Number of messages dropped since the process started.
+   */
+  static uint64_t GetDroppedCount();
+
+  /**
+   * Log a message. The message is queued for the writer thread when async
+   * logging is enabled and logged right away otherwise. Only the libhack
+   * log functions submit here so messages logged with the libcomp
+   * component functions (such as LogGeneralDebug) are never queued.
+   * @param pLog Log to write the message to.
+   * @param pMessage Message to log. Ownership is taken by this function.
+   */
+  static void Submit(libcomp::BaseLog* pLog, libcomp::LogMessage* pMessage);
+
  protected:
   /**
    * @internal
@@ -160,7 +200,7 @@ class Log : public libcomp::BaseLog {
     if (log->ShouldLog(to_underlying(libhack::LogComponent_t::comp), level)) { \
       auto msg = new libcomp::LogMessageFixed(                                 \
           to_underlying(libhack::LogComponent_t::comp), level, fun());         \
-      log->LogMessage(msg);                                                    \
+      libhack::Log::Submit(log, msg);                                          \
     }                                                                          \
   }                                                                            \
                                                                                \
@@ -169,10 +209,11 @@ class Log : public libcomp::BaseLog {
     auto log = libhack::Log::GetSingletonPtr();                                \
                                                                                \
     if (log->ShouldLog(to_underlying(libhack::LogComponent_t::comp), level)) { \
-      auto msg = new libcomp::LogMessageImpl<Args...>(                         \
-          to_underlying(libhack::LogComponent_t::comp), level,                 \
-          std::forward<Function>(f), std::forward<Args>(args)...);             \
-      log->LogMessage(msg);                                                    \
+      auto msg =                                                               \
+          new libcomp::LogMessageImpl<typename std::decay<Args>::type...>(     \
+              to_underlying(libhack::LogComponent_t::comp), level,             \
+              std::forward<Function>(f), std::forward<Args>(args)...);         \
+      libhack::Log::Submit(log, msg);                                          \
     }                                                                          \
   }                                                                            \
                                                                                \
@@ -182,7 +223,7 @@ class Log : public libcomp::BaseLog {
     if (log->ShouldLog(to_underlying(libhack::LogComponent_t::comp), level)) { \
       auto msg = new libcomp::LogMessageFixed(                                 \
           to_underlying(libhack::LogComponent_t::comp), level, _msg);          \
-      log->LogMessage(msg);                                                    \
+      libhack::Log::Submit(log, msg);                                          \
     }                                                                          \
   }
 
@@ -214,6 +255,7 @@ LOG_FUNCTIONS(FusionManager)
 LOG_FUNCTIONS(Item)
 LOG_FUNCTIONS(MatchManager)
 LOG_FUNCTIONS(Party)
+LOG_FUNCTIONS(Performance)
 LOG_FUNCTIONS(ServerConstants)
 LOG_FUNCTIONS(ServerDataManager)
 LOG_FUNCTIONS(SkillManager)
@@ -0,0 +1,82 @@
+/**
+ * @file libhack/src/PacketPool.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Per-thread pool of reusable packets for outbound traffic.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PacketPool.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <vector>
+
+using namespace libhack;
+
+namespace {
+/// Maximum number of idle packets kept by each thread
+const size_t MAX_IDLE_PACKETS = 64;
+
+/// Idle packets owned by the current thread
+thread_local std::vector<std::unique_ptr<libcomp::Packet>> tIdlePackets;
+
+/// Number of packets reused from a pool since the stats were last taken
+std::atomic<uint64_t> sReused(0);
+
+/// Number of packets created since the stats were last taken
+std::atomic<uint64_t> sAllocated(0);
+}  // namespace
+
+std::unique_ptr<libcomp::Packet> PacketPool::Acquire() {
+  if (!tIdlePackets.empty()) {
+    auto packet = std::move(tIdlePackets.back());
+    tIdlePackets.pop_back();
+
+    sReused++;
+
+    return packet;
+  }
+
+  sAllocated++;
+
+  return std::unique_ptr<libcomp::Packet>(new libcomp::Packet);
+}
+
+void PacketPool::Release(std::unique_ptr<libcomp::Packet>&& packet) {
+  if (packet && tIdlePackets.size() < MAX_IDLE_PACKETS) {
+    packet->Clear();
+    tIdlePackets.push_back(std::move(packet));
+  }
+}
+
+void PacketPool::TakeStats(uint64_t& reused, uint64_t& allocated) {
+  reused = sReused.exchange(0);
+  allocated = sAllocated.exchange(0);
+}
+
+PooledPacket::PooledPacket() : mPacket(PacketPool::Acquire()) {}
+
+PooledPacket::~PooledPacket() { PacketPool::Release(std::move(mPacket)); }
+
+libcomp::Packet& PooledPacket::operator*() { return *mPacket; }
+
+libcomp::Packet* PooledPacket::operator->() { return mPacket.get(); }
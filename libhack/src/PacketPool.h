@@ -0,0 +1,109 @@
+/**
+ * @file libhack/src/PacketPool.h
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Per-thread pool of reusable packets for outbound traffic.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_PACKETPOOL_H
+#define LIBHACK_SRC_PACKETPOOL_H
+
+// libcomp Includes
+#include <Packet.h>
+
+// Standard C++11 Includes
+#include <memory>
+
+namespace libhack {
+
+/**
+ * Pool of cleared packets kept per thread so packets built and broadcast
+ * on hot paths reuse an existing buffer instead of allocating a new one
+ * for every message. Packets should be acquired through @ref PooledPacket
+ * rather than using this class directly.
+ */
+class PacketPool {
+ public:
+  /**
+   * Get a cleared packet from the calling thread's pool, creating one if
+   * the pool is empty
+   * @return Pointer to an empty packet
+   */
+  static std::unique_ptr<libcomp::Packet> Acquire();
+
+  /**
+   * Clear a packet and return it to the calling thread's pool
+   * @param packet Packet to return
+   */
+  static void Release(std::unique_ptr<libcomp::Packet>&& packet);
+
+  /**
+   * Get the number of packets reused and created since the last call and
+   * reset both counts
+   * @param reused Output parameter for the number of packets reused from
+   *  a pool
+   * @param allocated Output parameter for the number of packets created
+   *  because a pool was empty
+   */
+  static void TakeStats(uint64_t& reused, uint64_t& allocated);
+};
+
+/**
+ * Packet borrowed from the calling thread's @ref PacketPool and returned
+ * to it when this goes out of scope. The packet must not be used after
+ * the PooledPacket is destroyed.
+ */
+class PooledPacket {
+ public:
+  /**
+   * Borrow a packet from the pool
+   */
+  PooledPacket();
+
+  /**
+   * Return the packet to the pool
+   */
+  ~PooledPacket();
+
+  PooledPacket(const PooledPacket&) = delete;
+  PooledPacket& operator=(const PooledPacket&) = delete;
+
+  /**
+   * Get the borrowed packet
+   * @return Reference to the packet
+   */
+  libcomp::Packet& operator*();
+
+  /**
+   * Get the borrowed packet
+   * @return Pointer to the packet
+   */
+  libcomp::Packet* operator->();
+
+ private:
+  /// Borrowed packet
+  std::unique_ptr<libcomp::Packet> mPacket;
+};
+
+}  // namespace libhack
+
+#endif  // LIBHACK_SRC_PACKETPOOL_H
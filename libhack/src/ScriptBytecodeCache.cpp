@@ -0,0 +1,305 @@
+/**
+ * @file libhack/src/ScriptBytecodeCache.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief On disk cache of compiled Squirrel script bytecode.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScriptBytecodeCache.h"
+
+#ifndef EXOTIC_PLATFORM
+
+// libcomp Includes
+#include <Crypto.h>
+
+// libhack Includes
+#include "Constants.h"
+#include "Log.h"
+#include "ScriptEngine.h"
+
+// Standard C Includes
+#include <cstdio>
+#include <ctime>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif  // _WIN32
+
+// Standard C++11 Includes
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <thread>
+
+using namespace libhack;
+
+/// Age in seconds a temporary cache file must reach before it is treated
+/// as left behind by a crashed write instead of one still in progress
+static const time_t STALE_TEMP_FILE_AGE = 60 * 60;
+
+/**
+ * List the names of every file in a directory.
+ * @param directory Directory to list, ending with a path separator
+ * @returns Names of the files in the directory
+ */
+static std::list<std::string> ListFiles(const libcomp::String& directory) {
+  std::list<std::string> files;
+
+#ifdef _WIN32
+  WIN32_FIND_DATAA data;
+  HANDLE find = FindFirstFileA((directory + "*").C(), &data);
+  if (INVALID_HANDLE_VALUE == find) {
+    return files;
+  }
+
+  do {
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      files.push_back(data.cFileName);
+    }
+  } while (FindNextFileA(find, &data));
+
+  FindClose(find);
+#else
+  DIR* dir = opendir(directory.C());
+  if (!dir) {
+    return files;
+  }
+
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    if (name != "." && name != "..") {
+      files.push_back(name);
+    }
+  }
+
+  closedir(dir);
+#endif  // _WIN32
+
+  return files;
+}
+
+/**
+ * Check if a string ends with another.
+ * @param value String to check
+ * @param suffix Suffix to look for
+ * @returns true if value ends with suffix
+ */
+static bool EndsWith(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         0 == value.compare(value.size() - suffix.size(), suffix.size(),
+                            suffix);
+}
+
+ScriptBytecodeCache::ScriptBytecodeCache(const libcomp::String& directory,
+                                         bool validate)
+    : mDirectory(directory),
+      mTag(GetTag()),
+      mValidate(validate),
+      mHits(0),
+      mMisses(0),
+      mMismatches(0) {
+  if (!mDirectory.IsEmpty() && mDirectory.Right(1) != "/") {
+    mDirectory += "/";
+  }
+}
+
+ScriptBytecodeCache::~ScriptBytecodeCache() {}
+
+bool ScriptBytecodeCache::GetBytecode(const libcomp::String& path,
+                                      const libcomp::String& source,
+                                      std::vector<char>& bytecode) {
+  auto cacheName = GetCacheName(path, source);
+  auto cachePath = mDirectory + cacheName;
+
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    mCurrentFiles[GetFlatName(path).ToUtf8()] = cacheName.ToUtf8();
+  }
+
+  std::vector<char> cached = libcomp::Crypto::LoadFile(cachePath.ToUtf8());
+  if (!cached.empty() && !mValidate) {
+    mHits++;
+    bytecode = std::move(cached);
+
+    return true;
+  }
+
+  ScriptEngine compiler;
+  if (!compiler.Compile(source, path, bytecode)) {
+    return false;
+  }
+
+  if (!cached.empty()) {
+    mHits++;
+
+    if (cached == bytecode) {
+      return true;
+    }
+
+    mMismatches++;
+
+    LogServerDataManagerWarning([&]() {
+      return libcomp::String(
+                 "Cached bytecode for script %1 does not match the compiled "
+                 "script and will be replaced\n")
+          .Arg(path);
+    });
+  } else {
+    mMisses++;
+  }
+
+  if (!Store(cachePath, bytecode)) {
+    // Not fatal, the script just gets compiled again next time
+    LogServerDataManagerWarning([&]() {
+      return libcomp::String("Failed to write script bytecode cache file: %1\n")
+          .Arg(cachePath);
+    });
+  }
+
+  return true;
+}
+
+size_t ScriptBytecodeCache::Prune() {
+  if (mDirectory.IsEmpty()) {
+    return 0;
+  }
+
+  std::string current = libcomp::String(".%1.cnut").Arg(mTag).ToUtf8();
+  time_t now = time(nullptr);
+
+  std::lock_guard<std::mutex> lock(mLock);
+
+  size_t removed = 0;
+  for (auto& name : ListFiles(mDirectory)) {
+    std::string path = (mDirectory + libcomp::String(name)).ToUtf8();
+
+    bool stale = false;
+    if (EndsWith(name, ".cnut")) {
+      stale = !EndsWith(name, current);
+
+      // Names are <script>.<sha1>.<tag>.cnut so an entry for a script
+      // loaded here is stale if the hash is not for its current source
+      auto hashEnd = name.size() - current.size();
+      auto hashStart = hashEnd > 0 ? name.rfind('.', hashEnd - 1)
+                                   : std::string::npos;
+      if (!stale && hashStart != std::string::npos) {
+        auto it = mCurrentFiles.find(name.substr(0, hashStart));
+        stale = it != mCurrentFiles.end() && it->second != name;
+      }
+    } else if (EndsWith(name, ".tmp")) {
+      // Another process may still be writing this one
+      struct stat info;
+      stale = 0 == stat(path.c_str(), &info) &&
+              (now - info.st_mtime) > STALE_TEMP_FILE_AGE;
+    }
+
+    if (stale && 0 == std::remove(path.c_str())) {
+      removed++;
+    }
+  }
+
+  if (removed) {
+    LogServerDataManagerDebug([&]() {
+      return libcomp::String("Removed %1 stale script bytecode cache file(s)\n")
+          .Arg(removed);
+    });
+  }
+
+  return removed;
+}
+
+libcomp::String ScriptBytecodeCache::GetTag() {
+  // Bytecode depends on the Squirrel version and the size of its integer
+  // and float types. The server version covers any change to the bindings
+  // the scripts are compiled against.
+  return libcomp::String("sq%1-i%2-f%3-%4.%5.%6")
+      .Arg((int)SQUIRREL_VERSION_NUMBER)
+      .Arg((int)(sizeof(SQInteger) * 8))
+      .Arg((int)(sizeof(SQFloat) * 8))
+      .Arg(VERSION_MAJOR)
+      .Arg(VERSION_MINOR)
+      .Arg(VERSION_PATCH);
+}
+
+uint64_t ScriptBytecodeCache::GetHits() const { return mHits; }
+
+uint64_t ScriptBytecodeCache::GetMisses() const { return mMisses; }
+
+uint64_t ScriptBytecodeCache::GetMismatches() const { return mMismatches; }
+
+libcomp::String ScriptBytecodeCache::GetCacheName(
+    const libcomp::String& path, const libcomp::String& source) const {
+  std::string src = source.ToUtf8();
+  std::vector<char> data(src.begin(), src.end());
+
+  return libcomp::String("%1.%2.%3.cnut")
+      .Arg(GetFlatName(path))
+      .Arg(libcomp::Crypto::SHA1(data))
+      .Arg(mTag);
+}
+
+libcomp::String ScriptBytecodeCache::GetFlatName(const libcomp::String& path) {
+  // Flatten the script path so every entry lives in the cache directory
+  return path.Replace("/", "_").Replace("\\", "_");
+}
+
+bool ScriptBytecodeCache::Store(const libcomp::String& cachePath,
+                                const std::vector<char>& bytecode) const {
+  auto tempPath = libcomp::String("%1.%2-%3.tmp")
+                      .Arg(cachePath)
+                      .Arg((uint64_t)std::hash<std::thread::id>()(
+                          std::this_thread::get_id()))
+                      .Arg((uint64_t)std::chrono::steady_clock::now()
+                               .time_since_epoch()
+                               .count());
+
+  {
+    std::ofstream out(tempPath.C(), std::ios::out | std::ios::binary);
+    out.write(bytecode.data(), (std::streamsize)bytecode.size());
+
+    if (!out.good()) {
+      out.close();
+      (void)std::remove(tempPath.C());
+
+      return false;
+    }
+  }
+
+#ifdef _WIN32
+  // rename does not replace an existing file on Windows
+  if (!MoveFileExA(tempPath.C(), cachePath.C(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+  if (0 != std::rename(tempPath.C(), cachePath.C())) {
+#endif  // _WIN32
+    (void)std::remove(tempPath.C());
+
+    return false;
+  }
+
+  return true;
+}
+
+#endif  // !EXOTIC_PLATFORM
@@ -0,0 +1,175 @@
+/**
+ * @file libhack/src/ScriptBytecodeCache.h
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief On disk cache of compiled Squirrel script bytecode.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_SCRIPTBYTECODECACHE_H
+#define LIBHACK_SRC_SCRIPTBYTECODECACHE_H
+
+#ifndef EXOTIC_PLATFORM
+
+// libcomp Includes
+#include <CString.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libhack {
+
+/**
+ * Cache of compiled script bytecode stored in a directory on disk. Entries
+ * are keyed by the script path, a hash of its source and a tag for the
+ * Squirrel version and build so a changed script or a new build is simply
+ * a cache miss. The directory can be shared by every server
+ * process on the same host so a warm restart does not need to compile any
+ * script. In validation mode every cache hit is recompiled and compared to
+ * the cached bytecode to catch stale or corrupt entries.
+ */
+class ScriptBytecodeCache {
+ public:
+  /**
+   * Create a new cache
+   * @param directory Directory to store compiled scripts in
+   * @param validate true if every cache hit should be recompiled and
+   *  compared against the cached bytecode
+   */
+  ScriptBytecodeCache(const libcomp::String& directory, bool validate);
+
+  /**
+   * Clean up the cache
+   */
+  ~ScriptBytecodeCache();
+
+  /**
+   * Get the compiled bytecode for a script, compiling and storing it in
+   * the cache if it has not been compiled before.
+   * @param path Path of the script used as the cache key and source name
+   * @param source Source code of the script
+   * @param bytecode Output parameter to store the compiled bytecode in
+   * @returns true if the bytecode was loaded or compiled, false if the
+   *  script failed to compile
+   */
+  bool GetBytecode(const libcomp::String& path, const libcomp::String& source,
+                   std::vector<char>& bytecode);
+
+  /**
+   * Remove every cache file written for a different Squirrel version or
+   * build along with temporary files left behind by a crashed write. Files
+   * for a script loaded through this cache are also removed if they were
+   * written for a different version of its source. Call this once on
+   * startup after the scripts are loaded.
+   * @returns Number of files removed
+   */
+  size_t Prune();
+
+  /**
+   * Get the tag stored in every cache file name that identifies the
+   * Squirrel version and build the bytecode was compiled by
+   * @returns Cache tag for this build
+   */
+  static libcomp::String GetTag();
+
+  /**
+   * Get the number of scripts loaded from the cache
+   * @returns Number of cache hits
+   */
+  uint64_t GetHits() const;
+
+  /**
+   * Get the number of scripts that had to be compiled
+   * @returns Number of cache misses
+   */
+  uint64_t GetMisses() const;
+
+  /**
+   * Get the number of cache entries that did not match a fresh compile
+   * while in validation mode
+   * @returns Number of mismatched cache entries
+   */
+  uint64_t GetMismatches() const;
+
+ private:
+  /**
+   * Get the file name for a cached script
+   * @param path Path of the script
+   * @param source Source code of the script
+   * @returns Name of the cache file in the cache directory
+   */
+  libcomp::String GetCacheName(const libcomp::String& path,
+                               const libcomp::String& source) const;
+
+  /**
+   * Get the script path part of a cache file name flattened into one
+   * directory
+   * @param path Path of the script
+   * @returns Flattened script path
+   */
+  static libcomp::String GetFlatName(const libcomp::String& path);
+
+  /**
+   * Write compiled bytecode to the cache. The file is written to a
+   * temporary path first and renamed so other processes sharing the cache
+   * never read a partial file.
+   * @param cachePath Path of the cache file
+   * @param bytecode Compiled bytecode to write
+   * @returns true if the file was written, false otherwise
+   */
+  bool Store(const libcomp::String& cachePath,
+             const std::vector<char>& bytecode) const;
+
+  /// Directory compiled scripts are stored in
+  libcomp::String mDirectory;
+
+  /// Tag for the Squirrel version and build added to each cache file
+  libcomp::String mTag;
+
+  /// Indicates that cache hits are recompiled and compared
+  bool mValidate;
+
+  /// Number of scripts loaded from the cache
+  std::atomic<uint64_t> mHits;
+
+  /// Number of scripts compiled
+  std::atomic<uint64_t> mMisses;
+
+  /// Number of cache entries that did not match a fresh compile
+  std::atomic<uint64_t> mMismatches;
+
+  /// Cache file name for the current source of each script loaded, keyed
+  /// by the flattened script path
+  std::unordered_map<std::string, std::string> mCurrentFiles;
+
+  /// Server lock for the current cache file names
+  std::mutex mLock;
+};
+
+}  // namespace libhack
+
+#endif  // !EXOTIC_PLATFORM
+
+#endif  // LIBHACK_SRC_SCRIPTBYTECODECACHE_H
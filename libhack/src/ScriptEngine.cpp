@@ -30,8 +30,15 @@
 
 // libcomp Includes
 #include "DefinitionManager.h"
+#include "Log.h"
 #include "ServerDataManager.h"
 
+// Standard C Includes
+#include <cstring>
+
+// Standard C++11 Includes
+#include <list>
+
 // objects Includes
 #include <Account.h>
 #include <AccountWorldData.h>
@@ -66,6 +73,40 @@ static std::shared_ptr<objects::Demon> ToDemon(
   return std::dynamic_pointer_cast<objects::Demon>(obj);
 }
 
+/**
+ * Read state used while loading bytecode from a memory buffer.
+ */
+struct BytecodeReader {
+  const std::vector<char>* Data;
+  size_t Offset;
+};
+
+static SQInteger WriteBytecode(SQUserPointer pUser, SQUserPointer pData,
+                               SQInteger size) {
+  auto pBytecode = static_cast<std::vector<char>*>(pUser);
+  auto pBytes = static_cast<const char*>(pData);
+
+  pBytecode->insert(pBytecode->end(), pBytes, pBytes + size);
+
+  return size;
+}
+
+static SQInteger ReadBytecode(SQUserPointer pUser, SQUserPointer pData,
+                              SQInteger size) {
+  auto pReader = static_cast<BytecodeReader*>(pUser);
+
+  size_t left = pReader->Data->size() - pReader->Offset;
+  if ((size_t)size > left) {
+    // Squirrel treats a short read as an error
+    return -1;
+  }
+
+  memcpy(pData, pReader->Data->data() + pReader->Offset, (size_t)size);
+  pReader->Offset += (size_t)size;
+
+  return size;
+}
+
 ScriptEngine::ScriptEngine(bool useRawPrint)
     : libcomp::BaseScriptEngine(useRawPrint) {
   // Bind some root level object conversions
@@ -77,6 +118,108 @@ ScriptEngine::ScriptEngine(bool useRawPrint)
 
 ScriptEngine::~ScriptEngine() {}
 
+bool ScriptEngine::Compile(const libcomp::String& source,
+                           const libcomp::String& name,
+                           std::vector<char>& bytecode) {
+  std::string src = source.ToUtf8();
+  std::string srcName = name.ToUtf8();
+
+  SQInteger top = sq_gettop(mVM);
+
+  bool result = SQ_SUCCEEDED(sq_compilebuffer(mVM, src.c_str(),
+                                              (SQInteger)src.size(),
+                                              srcName.c_str(), SQTrue));
+  if (result) {
+    bytecode.clear();
+    result = SQ_SUCCEEDED(sq_writeclosure(mVM, WriteBytecode, &bytecode));
+  }
+
+  sq_settop(mVM, top);
+
+  return result;
+}
+
+bool ScriptEngine::EvalBytecode(const std::vector<char>& bytecode,
+                                const libcomp::String& name) {
+  BytecodeReader reader;
+  reader.Data = &bytecode;
+  reader.Offset = 0;
+
+  SQInteger top = sq_gettop(mVM);
+
+  bool result = SQ_SUCCEEDED(sq_readclosure(mVM, ReadBytecode, &reader));
+  if (result) {
+    sq_pushroottable(mVM);
+    result = SQ_SUCCEEDED(sq_call(mVM, 1, SQFalse, SQTrue));
+  }
+
+  sq_settop(mVM, top);
+
+  if (!result) {
+    LogGeneralError([&]() {
+      return libcomp::String("Failed to run compiled script: %1\n").Arg(name);
+    });
+  }
+
+  return result;
+}
+
+bool ScriptEngine::EvalServerScript(const ServerScript& script) {
+  if (script.Bytecode.empty()) {
+    return Eval(script.Source, script.Path);
+  }
+
+  return EvalBytecode(script.Bytecode, script.Path);
+}
+
+void ScriptEngine::SnapshotGlobals() {
+  mGlobalNames.clear();
+
+  SQInteger top = sq_gettop(mVM);
+
+  sq_pushroottable(mVM);
+  sq_pushnull(mVM);
+  while (SQ_SUCCEEDED(sq_next(mVM, -2))) {
+    const SQChar* key = nullptr;
+    if (SQ_SUCCEEDED(sq_getstring(mVM, -2, &key))) {
+      mGlobalNames.insert(key);
+    }
+
+    sq_pop(mVM, 2);
+  }
+
+  sq_settop(mVM, top);
+}
+
+void ScriptEngine::ResetGlobals() {
+  std::list<std::string> added;
+
+  SQInteger top = sq_gettop(mVM);
+
+  sq_pushroottable(mVM);
+  sq_pushnull(mVM);
+  while (SQ_SUCCEEDED(sq_next(mVM, -2))) {
+    const SQChar* key = nullptr;
+    if (SQ_SUCCEEDED(sq_getstring(mVM, -2, &key)) &&
+        mGlobalNames.find(key) == mGlobalNames.end()) {
+      added.push_back(key);
+    }
+
+    sq_pop(mVM, 2);
+  }
+
+  // Slots cannot be removed while iterating the table
+  sq_settop(mVM, top);
+  sq_pushroottable(mVM);
+
+  for (auto& name : added) {
+    sq_pushstring(mVM, name.c_str(), (SQInteger)name.size());
+    sq_deleteslot(mVM, -2, SQFalse);
+  }
+
+  sq_settop(mVM, top);
+}
+
 void ScriptEngine::InitializeServerBuiltins() {
   // Now register the common objects you might want to access
   // from the server.
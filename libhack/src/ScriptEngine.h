@@ -30,10 +30,16 @@
 // libcomp Includes
 #include <BaseScriptEngine.h>
 
+// Standard C++11 Includes
+#include <set>
+#include <vector>
+
 #ifndef EXOTIC_PLATFORM
 
 namespace libhack {
 
+struct ServerScript;
+
 /**
  * Represents a Sqrat based Squirrel virtual machine handler to facilitate
  * script execution and bind @ref Object instances to the VM.
@@ -51,6 +57,47 @@ class ScriptEngine : public libcomp::BaseScriptEngine {
    */
   virtual ~ScriptEngine();
 
+  /**
+   * Compile a script into Squirrel bytecode without running it. Compile
+   * errors are reported through this VM's error handler.
+   * @param source Source code of the script
+   * @param name Name of the script used when reporting errors
+   * @param bytecode Output buffer to write the compiled bytecode to
+   * @returns true if the script compiled, false if it did not
+   */
+  bool Compile(const libcomp::String& source, const libcomp::String& name,
+               std::vector<char>& bytecode);
+
+  /**
+   * Load bytecode built by @ref Compile into the VM and run it with the
+   * root table as the environment, just like evaluating the source would.
+   * @param bytecode Compiled bytecode to run
+   * @param name Name of the script used when reporting errors
+   * @returns true if the bytecode was loaded and run, false otherwise
+   */
+  bool EvalBytecode(const std::vector<char>& bytecode,
+                    const libcomp::String& name);
+
+  /**
+   * Run a script loaded by the ServerDataManager, using its compiled
+   * bytecode when available instead of compiling the source again.
+   * @param script Script definition to run
+   * @returns true if the script was loaded and run, false otherwise
+   */
+  bool EvalServerScript(const ServerScript& script);
+
+  /**
+   * Record the names of every slot currently in the root table so that
+   * @ref ResetGlobals can later remove anything added after this point.
+   */
+  void SnapshotGlobals();
+
+  /**
+   * Remove every root table slot added since @ref SnapshotGlobals was
+   * called. Slots that existed at that time are left as they are.
+   */
+  void ResetGlobals();
+
  private:
   /**
    * Initialize the server specific database built-in script modules.
@@ -61,6 +108,9 @@ class ScriptEngine : public libcomp::BaseScriptEngine {
    * Initialize the server specific server built-in script modules.
    */
   void InitializeServerBuiltins() override;
+
+  /// Names of the root table slots recorded by @ref SnapshotGlobals
+  std::set<std::string> mGlobalNames;
 };
 
 }  // namespace libhack
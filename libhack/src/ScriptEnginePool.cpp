@@ -0,0 +1,234 @@
+/**
+ * @file libhack/src/ScriptEnginePool.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Pool of pre-warmed script engines for a single script.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScriptEnginePool.h"
+
+#ifndef EXOTIC_PLATFORM
+
+// libhack Includes
+#include "Log.h"
+
+using namespace libhack;
+
+ScriptEnginePool::ScriptEnginePool(const libcomp::String& name,
+                                   const Binder_t& binder, bool resetOnRelease,
+                                   size_t maxIdle)
+    : mName(name),
+      mBinder(binder),
+      mResetOnRelease(resetOnRelease),
+      mMaxIdle(maxIdle),
+      mWarmCount(0),
+      mRefilling(false),
+      mHits(0),
+      mMisses(0),
+      mExecutions(0),
+      mTotalExecutionTime(0),
+      mMaxExecutionTime(0) {}
+
+ScriptEnginePool::~ScriptEnginePool() {}
+
+bool ScriptEnginePool::Initialize(const libcomp::String& source,
+                                  size_t warmCount) {
+  std::vector<char> bytecode;
+
+  ScriptEngine compiler;
+  if (!compiler.Compile(source, mName, bytecode)) {
+    LogGeneralError([&]() {
+      return libcomp::String("Failed to compile pooled script: %1\n")
+          .Arg(mName);
+    });
+
+    return false;
+  }
+
+  return Initialize(bytecode, warmCount);
+}
+
+bool ScriptEnginePool::Initialize(const std::vector<char>& bytecode,
+                                  size_t warmCount) {
+  mBytecode = bytecode;
+  mWarmCount = warmCount;
+
+  std::list<std::shared_ptr<ScriptEngine>> engines;
+  for (size_t i = 0; i < warmCount; i++) {
+    auto engine = Create();
+    if (!engine) {
+      return false;
+    }
+
+    engines.push_back(engine);
+  }
+
+  std::lock_guard<std::mutex> lock(mLock);
+  mIdle.splice(mIdle.end(), engines);
+
+  return true;
+}
+
+std::shared_ptr<ScriptEngine> ScriptEnginePool::Acquire() {
+  std::shared_ptr<ScriptEngine> engine;
+  while (true) {
+    bool dirty = false;
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      if (mIdle.size() > 0) {
+        engine = mIdle.front();
+        mIdle.pop_front();
+      } else if (mDirty.size() > 0) {
+        engine = mDirty.front();
+        mDirty.pop_front();
+        dirty = true;
+      } else {
+        break;
+      }
+    }
+
+    // Nothing was ready so reset a returned engine here instead of
+    // building a new one. A broken engine is dropped.
+    if (!dirty || Reset(engine)) {
+      mHits++;
+      return engine;
+    }
+  }
+
+  mMisses++;
+
+  return Create();
+}
+
+void ScriptEnginePool::Release(const std::shared_ptr<ScriptEngine>& engine) {
+  if (!engine) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mLock);
+  if (mIdle.size() + mDirty.size() < mMaxIdle) {
+    if (mResetOnRelease) {
+      mDirty.push_back(engine);
+    } else {
+      mIdle.push_back(engine);
+    }
+  }
+}
+
+bool ScriptEnginePool::ClaimRefill() {
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mDirty.size() == 0 && mIdle.size() >= mWarmCount) {
+      return false;
+    }
+  }
+
+  return !mRefilling.exchange(true);
+}
+
+void ScriptEnginePool::Refill() {
+  while (true) {
+    std::shared_ptr<ScriptEngine> engine;
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      if (mDirty.size() > 0) {
+        engine = mDirty.front();
+        mDirty.pop_front();
+      } else if (mIdle.size() >= mWarmCount) {
+        break;
+      }
+    }
+
+    if (engine) {
+      if (!Reset(engine)) {
+        continue;
+      }
+    } else {
+      engine = Create();
+      if (!engine) {
+        break;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mIdle.size() + mDirty.size() >= mMaxIdle) {
+      break;
+    }
+
+    mIdle.push_back(engine);
+  }
+
+  mRefilling = false;
+}
+
+void ScriptEnginePool::RecordExecution(uint64_t microseconds) {
+  mExecutions++;
+  mTotalExecutionTime += microseconds;
+
+  uint64_t currentMax = mMaxExecutionTime;
+  while (microseconds > currentMax &&
+         !mMaxExecutionTime.compare_exchange_weak(currentMax, microseconds)) {
+  }
+}
+
+libcomp::String ScriptEnginePool::GetName() const { return mName; }
+
+uint64_t ScriptEnginePool::GetHits() const { return mHits; }
+
+uint64_t ScriptEnginePool::GetMisses() const { return mMisses; }
+
+uint64_t ScriptEnginePool::GetExecutions() const { return mExecutions; }
+
+uint64_t ScriptEnginePool::GetTotalExecutionTime() const {
+  return mTotalExecutionTime;
+}
+
+uint64_t ScriptEnginePool::GetMaxExecutionTime() const {
+  return mMaxExecutionTime;
+}
+
+std::shared_ptr<ScriptEngine> ScriptEnginePool::Create() {
+  auto engine = std::make_shared<ScriptEngine>();
+  if (mBinder) {
+    mBinder(*engine);
+  }
+
+  if (mResetOnRelease) {
+    engine->SnapshotGlobals();
+  }
+
+  if (!engine->EvalBytecode(mBytecode, mName)) {
+    return nullptr;
+  }
+
+  return engine;
+}
+
+bool ScriptEnginePool::Reset(const std::shared_ptr<ScriptEngine>& engine) {
+  // Remove anything the script or the request added to the root table
+  // then run the script again to restore its own globals
+  engine->ResetGlobals();
+
+  return engine->EvalBytecode(mBytecode, mName);
+}
+
+#endif  // !EXOTIC_PLATFORM
@@ -0,0 +1,233 @@
+/**
+ * @file libhack/src/ScriptEnginePool.h
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Pool of pre-warmed script engines for a single script.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_SCRIPTENGINEPOOL_H
+#define LIBHACK_SRC_SCRIPTENGINEPOOL_H
+
+#ifndef EXOTIC_PLATFORM
+
+// libhack Includes
+#include "ScriptEngine.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+
+namespace libhack {
+
+/**
+ * Pool of script engines that all run the same script. The script is
+ * compiled to bytecode once and each engine in the pool is created by
+ * binding the required types and loading that bytecode, so no request
+ * ever pays the compile cost. Idle engines are kept for reuse and can
+ * optionally be reset before they are used again by removing every global
+ * the script added and running the script bytecode again. Resets and new
+ * engines are left to @ref Refill so they can be run off the request
+ * thread, with @ref Acquire only doing the work itself when nothing ready
+ * is left.
+ */
+class ScriptEnginePool {
+ public:
+  /// Function used to bind any types or functions the script needs on a
+  /// newly created engine before the script is loaded
+  typedef std::function<void(ScriptEngine&)> Binder_t;
+
+  /**
+   * Create a new pool for a script
+   * @param name Name of the script, used for reporting
+   * @param binder Function to bind types on each new engine
+   * @param resetOnRelease true if each returned engine should have the
+   *  globals added by the script removed and the script run again before
+   *  it is used again so no root table state carries over between requests
+   * @param maxIdle Maximum number of idle engines to keep
+   */
+  ScriptEnginePool(const libcomp::String& name, const Binder_t& binder,
+                   bool resetOnRelease, size_t maxIdle = 16);
+
+  /**
+   * Clean up the pool and all idle engines
+   */
+  ~ScriptEnginePool();
+
+  /**
+   * Compile the script and create the requested number of ready engines.
+   * @param source Source code of the script
+   * @param warmCount Number of engines to create up front
+   * @returns true if the script compiled and loaded, false otherwise
+   */
+  bool Initialize(const libcomp::String& source, size_t warmCount);
+
+  /**
+   * Create the requested number of ready engines from already compiled
+   * script bytecode.
+   * @param bytecode Compiled bytecode of the script
+   * @param warmCount Number of engines to create up front
+   * @returns true if the script loaded, false otherwise
+   */
+  bool Initialize(const std::vector<char>& bytecode, size_t warmCount);
+
+  /**
+   * Get an engine with the script loaded from the pool. If no engine is
+   * ready a returned engine is reset or, failing that, a new one is created
+   * from the compiled bytecode.
+   * @returns Pointer to a ready engine or null if one could not be created
+   */
+  std::shared_ptr<ScriptEngine> Acquire();
+
+  /**
+   * Return an engine to the pool once a request is done with it. Engines
+   * that need a reset are held until @ref Refill or @ref Acquire resets
+   * them.
+   * @param engine Pointer to the engine to return
+   */
+  void Release(const std::shared_ptr<ScriptEngine>& engine);
+
+  /**
+   * Check if the pool has returned engines to reset or has fewer ready
+   * engines than it was warmed with and, if so, claim the refill. Only
+   * one refill can be claimed at a time.
+   * @returns true if the caller should run @ref Refill
+   */
+  bool ClaimRefill();
+
+  /**
+   * Reset any returned engines then create new engines until the pool is
+   * back to its warm count. Meant to be queued on a worker after
+   * @ref ClaimRefill returns true.
+   */
+  void Refill();
+
+  /**
+   * Record how long one execution of the script took.
+   * @param microseconds Execution time in microseconds
+   */
+  void RecordExecution(uint64_t microseconds);
+
+  /**
+   * Get the name of the script the pool runs
+   * @returns Name of the script
+   */
+  libcomp::String GetName() const;
+
+  /**
+   * Get the number of times an idle engine was reused
+   * @returns Number of pool hits
+   */
+  uint64_t GetHits() const;
+
+  /**
+   * Get the number of times a new engine had to be created for a request
+   * @returns Number of pool misses
+   */
+  uint64_t GetMisses() const;
+
+  /**
+   * Get the number of recorded script executions
+   * @returns Number of executions
+   */
+  uint64_t GetExecutions() const;
+
+  /**
+   * Get the total time of all recorded script executions
+   * @returns Total execution time in microseconds
+   */
+  uint64_t GetTotalExecutionTime() const;
+
+  /**
+   * Get the longest recorded script execution
+   * @returns Longest execution time in microseconds
+   */
+  uint64_t GetMaxExecutionTime() const;
+
+ private:
+  /**
+   * Create a new engine and load the compiled script into it.
+   * @returns Pointer to the new engine or null on failure
+   */
+  std::shared_ptr<ScriptEngine> Create();
+
+  /**
+   * Remove the globals added since the engine was created and run the
+   * script again.
+   * @param engine Engine to reset
+   * @returns true if the script loaded again, false if the engine should
+   *  be dropped
+   */
+  bool Reset(const std::shared_ptr<ScriptEngine>& engine);
+
+  /// Name of the script
+  libcomp::String mName;
+
+  /// Function to bind types on each new engine
+  Binder_t mBinder;
+
+  /// Compiled bytecode of the script
+  std::vector<char> mBytecode;
+
+  /// Engines not currently in use that are ready to run
+  std::list<std::shared_ptr<ScriptEngine>> mIdle;
+
+  /// Returned engines waiting to be reset
+  std::list<std::shared_ptr<ScriptEngine>> mDirty;
+
+  /// Indicates that returned engines are reset before being used again
+  bool mResetOnRelease;
+
+  /// Maximum number of idle engines to keep, ready or waiting on a reset
+  size_t mMaxIdle;
+
+  /// Number of ready engines a refill creates up to
+  size_t mWarmCount;
+
+  /// Indicates a refill has been claimed and has not finished
+  std::atomic<bool> mRefilling;
+
+  /// Number of idle engines reused
+  std::atomic<uint64_t> mHits;
+
+  /// Number of engines created on demand
+  std::atomic<uint64_t> mMisses;
+
+  /// Number of recorded executions
+  std::atomic<uint64_t> mExecutions;
+
+  /// Total recorded execution time in microseconds
+  std::atomic<uint64_t> mTotalExecutionTime;
+
+  /// Longest recorded execution time in microseconds
+  std::atomic<uint64_t> mMaxExecutionTime;
+
+  /// Server lock for the idle engines
+  std::mutex mLock;
+};
+
+}  // namespace libhack
+
+#endif  // !EXOTIC_PLATFORM
+
+#endif  // LIBHACK_SRC_SCRIPTENGINEPOOL_H
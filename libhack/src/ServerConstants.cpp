@@ -1790,6 +1790,16 @@ bool ServerConstants::Initialize(const String& filePath) {
   success &= LoadInteger(constants["API_ADMIN_LVL_UPDATE_ACCOUNT"],
                          sConstants.API_ADMIN_LVL_UPDATE_ACCOUNT);
 
+  // Optional so older constants files still load, falling back to the level
+  // required to list accounts
+  auto apiStatsLevel = constants.find("API_ADMIN_LVL_API_STATS");
+  if (apiStatsLevel != constants.end()) {
+    success &=
+        LoadInteger(apiStatsLevel->second, sConstants.API_ADMIN_LVL_API_STATS);
+  } else {
+    sConstants.API_ADMIN_LVL_API_STATS = sConstants.API_ADMIN_LVL_GET_ACCOUNTS;
+  }
+
   //
   // GM Command Levels
   //
@@ -670,6 +670,9 @@ class ServerConstants {
     /// Required user level for checking the online count or status of a player
     /// via the API.
     uint32_t API_ADMIN_LVL_ONLINE;
+    /// Required user level for getting the API route statistics via the API.
+    /// Defaults to API_ADMIN_LVL_GET_ACCOUNTS when not specified.
+    uint32_t API_ADMIN_LVL_API_STATS;
     /// Required user level for adding items to an account's post via the API.
     uint32_t API_ADMIN_LVL_POST_ITEMS;
     /// Required user level for updating an account via the API.
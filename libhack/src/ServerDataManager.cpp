@@ -29,6 +29,7 @@
 #ifndef EXOTIC_PLATFORM
 
 // libhack Includes
+#include "ScriptBytecodeCache.h"
 #include "ScriptEngine.h"
 
 // libcomp Includes
@@ -90,6 +91,16 @@ ServerDataManager::ServerDataManager() {}
 
 ServerDataManager::~ServerDataManager() {}
 
+void ServerDataManager::SetBytecodeCache(
+    const std::shared_ptr<ScriptBytecodeCache>& cache) {
+  mBytecodeCache = cache;
+}
+
+std::shared_ptr<ScriptBytecodeCache> ServerDataManager::GetBytecodeCache()
+    const {
+  return mBytecodeCache;
+}
+
 const std::shared_ptr<objects::ServerZone> ServerDataManager::GetZoneData(
     uint32_t id, uint32_t dynamicMapID, bool applyPartials,
     std::set<uint32_t> extraPartialIDs) {
@@ -2239,9 +2250,16 @@ bool ServerDataManager::LoadObject<objects::Tokusei>(
 
 bool ServerDataManager::LoadScript(const libcomp::String& path,
                                    const libcomp::String& source) {
+  // Compile (or load the cached compile of) the script once so anything
+  // else that builds an engine for it can skip straight to the bytecode
+  std::vector<char> bytecode;
+  bool compiled = mBytecodeCache
+                      ? mBytecodeCache->GetBytecode(path, source, bytecode)
+                      : ScriptEngine().Compile(source, path, bytecode);
+
   ScriptEngine engine;
   engine.Using<ServerScript>();
-  if (!engine.Eval(source)) {
+  if (!compiled || !engine.EvalBytecode(bytecode, path)) {
     LogServerDataManagerError([&]() {
       return String("Improperly formatted script encountered: %1\n").Arg(path);
     });
@@ -2271,6 +2289,7 @@ bool ServerDataManager::LoadScript(const libcomp::String& path,
 
   script->Path = path;
   script->Source = source;
+  script->Bytecode = std::move(bytecode);
 
   if (script->Type.ToLower() == "ai") {
     if (mAIScripts.find(script->Name.C()) != mAIScripts.end()) {
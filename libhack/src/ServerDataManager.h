@@ -53,8 +53,10 @@
 #include "PopIgnore.h"
 
 // Standard C++11 Includes
+#include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace objects {
 class Action;
@@ -77,6 +79,7 @@ class ServerZoneTrigger;
 namespace libhack {
 
 class DefinitionManager;
+class ScriptBytecodeCache;
 
 /**
  * Container for script information.
@@ -87,6 +90,10 @@ struct ServerScript {
   libcomp::String Source;
   libcomp::String Type;
   bool Instantiated = false;
+
+  /// Compiled bytecode of the source, used to create script engines
+  /// without compiling the source again
+  std::vector<char> Bytecode;
 };
 
 /**
@@ -278,6 +285,20 @@ class ServerDataManager {
    */
   const std::shared_ptr<ServerScript> GetAIScript(const libcomp::String& name);
 
+  /**
+   * Set the cache used to store compiled script bytecode. This must be
+   * set before any scripts are loaded to take effect.
+   * @param cache Pointer to the bytecode cache or null to always compile
+   *  scripts from source
+   */
+  void SetBytecodeCache(const std::shared_ptr<ScriptBytecodeCache>& cache);
+
+  /**
+   * Get the cache used to store compiled script bytecode
+   * @return Pointer to the bytecode cache, null if none is set
+   */
+  std::shared_ptr<ScriptBytecodeCache> GetBytecodeCache() const;
+
   /**
    * Load all server data defintions in the data store
    * @param pDataStore Pointer to the datastore to load binary files from
@@ -663,6 +684,9 @@ class ServerDataManager {
 
   /// Map of AI scripts by name
   std::unordered_map<std::string, std::shared_ptr<ServerScript>> mAIScripts;
+
+  /// Optional cache of compiled script bytecode
+  std::shared_ptr<ScriptBytecodeCache> mBytecodeCache;
 };
 
 }  // namespace libhack
@@ -0,0 +1,372 @@
+/**
+ * @file libhack/tests/AsyncLog.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Test the async log queue and writer thread.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libhack Includes
+#include <Log.h>
+
+// Standard C Includes
+#include <stdio.h>
+#include <string.h>
+
+// Standard C++11 Includes
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace libhack;
+
+/// Component the test messages are logged to
+static const libcomp::GenericLogComponent_t TEST_COMPONENT =
+    to_underlying(LogComponent_t::Performance);
+
+/// Producer ID of the message that blocks the writer thread
+static const int BLOCK_PRODUCER = -1;
+
+/**
+ * Messages written by the writer thread. The log hook records every test
+ * message and can hold the writer thread inside the hook so the queue fills
+ * up without being drained.
+ */
+class Received {
+ public:
+  /**
+   * Forget every message and stop blocking the writer.
+   */
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mLock);
+    mMessages.clear();
+    mBlock = false;
+    mBlocked = false;
+  }
+
+  /**
+   * Block the writer thread on the next blocking message.
+   */
+  void Block() {
+    std::lock_guard<std::mutex> lock(mLock);
+    mBlock = true;
+  }
+
+  /**
+   * Wait for the writer thread to be held inside the hook.
+   */
+  void WaitBlocked() {
+    std::unique_lock<std::mutex> lock(mLock);
+    mCondition.wait(lock, [this]() { return mBlocked; });
+  }
+
+  /**
+   * Let the writer thread continue.
+   */
+  void Release() {
+    std::lock_guard<std::mutex> lock(mLock);
+    mBlock = false;
+    mCondition.notify_all();
+  }
+
+  /**
+   * Record a message from the log hook.
+   * @param producer Producer that submitted the message.
+   * @param sequence Number of the message for that producer.
+   */
+  void Add(int producer, int sequence) {
+    std::unique_lock<std::mutex> lock(mLock);
+
+    if (BLOCK_PRODUCER == producer) {
+      mBlocked = true;
+      mCondition.notify_all();
+      mCondition.wait(lock, [this]() { return !mBlock; });
+
+      return;
+    }
+
+    mMessages.push_back(std::make_pair(producer, sequence));
+  }
+
+  /**
+   * Get the messages recorded so far in the order they were written.
+   * @returns Pairs of producer and sequence number.
+   */
+  std::vector<std::pair<int, int>> Messages() {
+    std::lock_guard<std::mutex> lock(mLock);
+
+    return mMessages;
+  }
+
+ private:
+  std::mutex mLock;
+  std::condition_variable mCondition;
+  std::vector<std::pair<int, int>> mMessages;
+  bool mBlock = false;
+  bool mBlocked = false;
+};
+
+static Received gReceived;
+
+/**
+ * Submit a test message through the async path.
+ * @param producer Producer submitting the message.
+ * @param sequence Number of the message for that producer.
+ */
+static void SubmitTest(int producer, int sequence) {
+  auto log = Log::GetSingletonPtr();
+
+  Log::Submit(log, new libcomp::LogMessageFixed(
+                       TEST_COMPONENT, libcomp::BaseLog::LOG_LEVEL_INFO,
+                       libcomp::String("AsyncLogTest %1 %2\n")
+                           .Arg(producer)
+                           .Arg(sequence)));
+}
+
+/**
+ * Submit the message that holds the writer thread and wait for the writer
+ * to pick it up so the queue is empty.
+ */
+static void BlockWriter() {
+  gReceived.Block();
+  SubmitTest(BLOCK_PRODUCER, 0);
+  gReceived.WaitBlocked();
+}
+
+/**
+ * Check that the messages of each producer were written in order.
+ * @param messages Messages written by the writer thread.
+ * @param producers Number of producers.
+ * @param perProducer Number of messages each producer submitted.
+ * @param count Set to the number of messages written for each producer.
+ */
+static void CheckOrder(const std::vector<std::pair<int, int>>& messages,
+                       int producers, int perProducer,
+                       std::vector<int>& count) {
+  std::vector<int> last((size_t)producers, -1);
+  count.assign((size_t)producers, 0);
+
+  for (auto& msg : messages) {
+    ASSERT_LE(0, msg.first);
+    ASSERT_GT(producers, msg.first);
+    ASSERT_GT(perProducer, msg.second);
+    ASSERT_LT(last[(size_t)msg.first], msg.second);
+
+    last[(size_t)msg.first] = msg.second;
+    count[(size_t)msg.first]++;
+  }
+}
+
+/**
+ * Submit messages from several threads at once.
+ * @param producers Number of producer threads.
+ * @param perProducer Number of messages each thread submits.
+ */
+static void RunProducers(int producers, int perProducer) {
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p < producers; p++) {
+    threads.push_back(std::thread([p, perProducer]() {
+      for (int i = 0; i < perProducer; i++) {
+        SubmitTest(p, i);
+      }
+    }));
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST(AsyncLog, NoLossUnderCapacity) {
+  const int producers = 8;
+  const int perProducer = 4000;
+
+  gReceived.Reset();
+
+  uint64_t dropped = Log::GetDroppedCount();
+
+  ASSERT_TRUE(Log::EnableAsync(65536));
+  ASSERT_FALSE(Log::EnableAsync(65536));
+
+  RunProducers(producers, perProducer);
+
+  Log::DisableAsync();
+
+  EXPECT_EQ(dropped, Log::GetDroppedCount());
+
+  auto messages = gReceived.Messages();
+  ASSERT_EQ((size_t)(producers * perProducer), messages.size());
+
+  std::vector<int> count;
+  CheckOrder(messages, producers, perProducer, count);
+
+  for (int c : count) {
+    EXPECT_EQ(perProducer, c);
+  }
+}
+
+TEST(AsyncLog, DropWhenFull) {
+  gReceived.Reset();
+
+  uint64_t dropped = Log::GetDroppedCount();
+
+  ASSERT_TRUE(Log::EnableAsync(8));
+
+  BlockWriter();
+
+  // The writer holds the first message so 8 fit and the rest are dropped.
+  for (int i = 0; i < 13; i++) {
+    SubmitTest(0, i);
+  }
+
+  EXPECT_EQ(dropped + 5, Log::GetDroppedCount());
+
+  gReceived.Release();
+  Log::DisableAsync();
+
+  auto messages = gReceived.Messages();
+  ASSERT_EQ(8u, messages.size());
+
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(0, messages[(size_t)i].first);
+    EXPECT_EQ(i, messages[(size_t)i].second);
+  }
+}
+
+TEST(AsyncLog, MinimumCapacity) {
+  gReceived.Reset();
+
+  uint64_t dropped = Log::GetDroppedCount();
+
+  // A capacity of 1 is raised to 2 so a full queue is still detected.
+  ASSERT_TRUE(Log::EnableAsync(1));
+
+  BlockWriter();
+
+  for (int i = 0; i < 4; i++) {
+    SubmitTest(0, i);
+  }
+
+  EXPECT_EQ(dropped + 2, Log::GetDroppedCount());
+
+  gReceived.Release();
+  Log::DisableAsync();
+
+  auto messages = gReceived.Messages();
+  ASSERT_EQ(2u, messages.size());
+  EXPECT_EQ(0, messages[0].second);
+  EXPECT_EQ(1, messages[1].second);
+}
+
+TEST(AsyncLog, DropCountWithProducers) {
+  const int producers = 8;
+  const int perProducer = 4000;
+
+  gReceived.Reset();
+
+  uint64_t dropped = Log::GetDroppedCount();
+
+  ASSERT_TRUE(Log::EnableAsync(64));
+
+  RunProducers(producers, perProducer);
+
+  Log::DisableAsync();
+
+  // Every message is either written or counted as dropped.
+  auto messages = gReceived.Messages();
+  EXPECT_EQ((uint64_t)(producers * perProducer),
+            (uint64_t)messages.size() + (Log::GetDroppedCount() - dropped));
+
+  std::vector<int> count;
+  CheckOrder(messages, producers, perProducer, count);
+}
+
+TEST(AsyncLog, DrainOnDisable) {
+  const int producers = 4;
+  const int perProducer = 16;
+
+  gReceived.Reset();
+
+  uint64_t dropped = Log::GetDroppedCount();
+
+  ASSERT_TRUE(Log::EnableAsync(256));
+
+  BlockWriter();
+  RunProducers(producers, perProducer);
+
+  // Nothing has been written yet so every message must come from the drain.
+  EXPECT_TRUE(gReceived.Messages().empty());
+
+  gReceived.Release();
+  Log::DisableAsync();
+
+  EXPECT_EQ(dropped, Log::GetDroppedCount());
+
+  auto messages = gReceived.Messages();
+  ASSERT_EQ((size_t)(producers * perProducer), messages.size());
+
+  std::vector<int> count;
+  CheckOrder(messages, producers, perProducer, count);
+
+  // Messages are written right away once async logging is off.
+  SubmitTest(0, perProducer - 1);
+  EXPECT_EQ((size_t)(producers * perProducer) + 1, gReceived.Messages().size());
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    auto log = Log::GetSingletonPtr();
+    log->SetLogLevel(TEST_COMPONENT, libcomp::BaseLog::LOG_LEVEL_DEBUG);
+    log->AddLogHook([](libcomp::GenericLogComponent_t comp,
+                       libcomp::BaseLog::Level_t level,
+                       const libcomp::String& msg) {
+      (void)level;
+
+      int producer, sequence;
+      const char* pTag = strstr(msg.C(), "AsyncLogTest ");
+
+      if (TEST_COMPONENT == comp && pTag &&
+          2 == sscanf(pTag, "AsyncLogTest %d %d", &producer, &sequence)) {
+        gReceived.Add(producer, sequence);
+      }
+    });
+
+    ::testing::InitGoogleTest(&argc, argv);
+
+    int result = RUN_ALL_TESTS();
+
+    delete Log::GetSingletonPtr();
+
+    return result;
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,279 @@
+/**
+ * @file libhack/tests/BinaryDataSet.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Test the streaming XML and patch paths of BinaryDataSet.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libhack Includes
+#include <BinaryDataSet.h>
+
+// object Includes
+#include <MiCBlockNameData.h>
+
+// Standard C++11 Includes
+#include <sstream>
+
+using namespace libhack;
+
+/// Enough records for the XML to span several 64 KiB stream reads
+static const uint32_t RECORD_COUNT = 2000;
+
+/**
+ * Create an empty set of MiCBlockNameData records.
+ * @returns New data set
+ */
+static std::shared_ptr<BinaryDataSet> CreateSet() {
+  return std::make_shared<BinaryDataSet>(
+      []() { return std::make_shared<objects::MiCBlockNameData>(); },
+      [](const std::shared_ptr<libcomp::Object>& obj) -> uint32_t {
+        return std::dynamic_pointer_cast<objects::MiCBlockNameData>(obj)
+            ->GetID();
+      });
+}
+
+/**
+ * Create a record.
+ * @param id ID of the record
+ * @param name Name of the record
+ * @returns New record
+ */
+static std::shared_ptr<libcomp::Object> CreateRecord(
+    uint32_t id, const libcomp::String& name) {
+  auto obj = std::make_shared<objects::MiCBlockNameData>();
+  obj->SetID(id);
+  obj->SetName(name);
+
+  return obj;
+}
+
+/**
+ * Create a set with RECORD_COUNT records loaded from XML.
+ * @returns New data set
+ */
+static std::shared_ptr<BinaryDataSet> CreateFilledSet() {
+  std::list<std::shared_ptr<libcomp::Object>> objs;
+
+  for (uint32_t i = 0; i < RECORD_COUNT; i++) {
+    objs.push_back(CreateRecord(i, libcomp::String("Block %1").Arg(i)));
+  }
+
+  std::stringstream ss;
+  BinaryDataSet::SaveXml(ss, objs);
+
+  auto set = CreateSet();
+  set->LoadXml(ss);
+
+  return set;
+}
+
+TEST(BinaryDataSet, SaveXmlMatchesGetXml) {
+  auto set = CreateFilledSet();
+
+  ASSERT_EQ((size_t)RECORD_COUNT, set->GetObjects().size());
+
+  std::stringstream ss;
+  ASSERT_TRUE(set->SaveXml(ss));
+
+  EXPECT_EQ(set->GetXml(), ss.str());
+}
+
+TEST(BinaryDataSet, LoadXmlRoundTrip) {
+  auto set = CreateFilledSet();
+
+  std::stringstream ss;
+  ASSERT_TRUE(set->SaveXml(ss));
+
+  auto loaded = CreateSet();
+  ASSERT_TRUE(loaded->LoadXml(ss));
+
+  EXPECT_EQ(set->GetObjects().size(), loaded->GetObjects().size());
+  EXPECT_EQ(set->GetXml(), loaded->GetXml());
+
+  auto obj = std::dynamic_pointer_cast<objects::MiCBlockNameData>(
+      loaded->GetObjectByID(RECORD_COUNT - 1));
+  ASSERT_NE(nullptr, obj);
+  EXPECT_EQ(libcomp::String("Block %1").Arg(RECORD_COUNT - 1),
+            obj->GetName());
+
+  // Loading more keeps the records already loaded.
+  std::stringstream more;
+  ASSERT_TRUE(BinaryDataSet::SaveXml(
+      more, {CreateRecord(RECORD_COUNT, "More")}));
+  ASSERT_TRUE(loaded->LoadXml(more, true));
+
+  EXPECT_EQ((size_t)RECORD_COUNT + 1, loaded->GetObjects().size());
+  EXPECT_NE(nullptr, loaded->GetObjectByID(0));
+  EXPECT_NE(nullptr, loaded->GetObjectByID(RECORD_COUNT));
+}
+
+TEST(BinaryDataSet, LoadXmlTruncated) {
+  auto set = CreateFilledSet();
+
+  std::stringstream ss;
+  ASSERT_TRUE(set->SaveXml(ss));
+
+  std::string xml = ss.str();
+  std::stringstream truncated(xml.substr(0, xml.size() / 2));
+
+  EXPECT_FALSE(CreateSet()->LoadXml(truncated));
+}
+
+TEST(BinaryDataSet, DiffAndPatch) {
+  auto base = CreateFilledSet();
+  auto updated = CreateFilledSet();
+
+  // Change every 10th record and add a few new ones.
+  std::stringstream changes;
+  std::list<std::shared_ptr<libcomp::Object>> changed;
+
+  for (uint32_t i = 0; i < RECORD_COUNT; i += 10) {
+    changed.push_back(CreateRecord(i, libcomp::String("Changed %1").Arg(i)));
+  }
+
+  for (uint32_t i = RECORD_COUNT; i < RECORD_COUNT + 5; i++) {
+    changed.push_back(CreateRecord(i, libcomp::String("Added %1").Arg(i)));
+  }
+
+  ASSERT_TRUE(BinaryDataSet::SaveXml(changes, changed));
+
+  size_t replaced = 0, added = 0, removed = 0;
+  ASSERT_TRUE(updated->ApplyXml(changes, replaced, added, removed));
+
+  EXPECT_EQ((size_t)RECORD_COUNT / 10, replaced);
+  EXPECT_EQ(5u, added);
+  EXPECT_EQ(0u, removed);
+  EXPECT_EQ((size_t)RECORD_COUNT + 5, updated->GetObjects().size());
+
+  // The diff only holds the records that were changed or added.
+  auto diff = updated->GetChangedObjects(*base);
+
+  EXPECT_EQ(changed.size(), diff.size());
+  EXPECT_TRUE(updated->GetRemovedIDs(*base).empty());
+
+  std::stringstream patch;
+  ASSERT_TRUE(BinaryDataSet::SaveXml(patch, diff));
+
+  // Applying the diff to the base gives the updated set with the replaced
+  // records kept in place and the new records at the end.
+  ASSERT_TRUE(base->ApplyXml(patch, replaced, added, removed));
+
+  EXPECT_EQ((size_t)RECORD_COUNT / 10, replaced);
+  EXPECT_EQ(5u, added);
+  EXPECT_EQ(0u, removed);
+  EXPECT_EQ(updated->GetXml(), base->GetXml());
+
+  auto obj = std::dynamic_pointer_cast<objects::MiCBlockNameData>(
+      base->GetObjects().front());
+  ASSERT_NE(nullptr, obj);
+  EXPECT_EQ(0u, obj->GetID());
+  EXPECT_EQ(libcomp::String("Changed 0"), obj->GetName());
+
+  EXPECT_TRUE(base->GetChangedObjects(*updated).empty());
+}
+
+TEST(BinaryDataSet, DiffAndPatchRemoved) {
+  auto base = CreateFilledSet();
+  auto updated = CreateFilledSet();
+
+  // Remove every 7th record, change one and re-add a removed ID.
+  std::stringstream changes;
+  std::list<uint32_t> removedIDs;
+
+  for (uint32_t i = 0; i < RECORD_COUNT; i += 7) {
+    removedIDs.push_back(i);
+  }
+
+  ASSERT_TRUE(BinaryDataSet::SaveXml(
+      changes, {CreateRecord(1, "Changed 1")}, removedIDs));
+
+  size_t replaced = 0, added = 0, removed = 0;
+  ASSERT_TRUE(updated->ApplyXml(changes, replaced, added, removed));
+
+  EXPECT_EQ(1u, replaced);
+  EXPECT_EQ(0u, added);
+  EXPECT_EQ(removedIDs.size(), removed);
+  EXPECT_EQ((size_t)RECORD_COUNT - removedIDs.size(),
+            updated->GetObjects().size());
+  EXPECT_EQ(nullptr, updated->GetObjectByID(0));
+  EXPECT_EQ(nullptr, updated->GetObjectByID(7));
+  EXPECT_NE(nullptr, updated->GetObjectByID(1));
+
+  std::stringstream readd;
+  ASSERT_TRUE(BinaryDataSet::SaveXml(readd, {CreateRecord(7, "Back")}));
+  ASSERT_TRUE(updated->ApplyXml(readd, replaced, added, removed));
+  EXPECT_EQ(1u, added);
+
+  // The diff writes the removed records after the changed ones.
+  auto diff = updated->GetChangedObjects(*base);
+  auto diffRemoved = updated->GetRemovedIDs(*base);
+
+  EXPECT_EQ(2u, diff.size());
+  EXPECT_EQ(removedIDs.size() - 1, diffRemoved.size());
+  EXPECT_EQ(0u, diffRemoved.front());
+
+  std::stringstream patch;
+  ASSERT_TRUE(BinaryDataSet::SaveXml(patch, diff, diffRemoved));
+
+  std::string patchXml = patch.str();
+  EXPECT_NE(std::string::npos, patchXml.find("<remove id=\"14\"/>"));
+
+  // Applying the diff to the base gives the updated set. The re-added
+  // record is still in the base so it is replaced.
+  ASSERT_TRUE(base->ApplyXml(patch, replaced, added, removed));
+
+  EXPECT_EQ(2u, replaced);
+  EXPECT_EQ(0u, added);
+  EXPECT_EQ(diffRemoved.size(), removed);
+  EXPECT_EQ(updated->GetObjects().size(), base->GetObjects().size());
+  EXPECT_TRUE(base->GetChangedObjects(*updated).empty());
+  EXPECT_TRUE(base->GetRemovedIDs(*updated).empty());
+  EXPECT_TRUE(updated->GetRemovedIDs(*base).empty());
+
+  // Applying the same patch again removes nothing more.
+  std::stringstream again(patchXml);
+  ASSERT_TRUE(base->ApplyXml(again, replaced, added, removed));
+  EXPECT_EQ(0u, removed);
+  EXPECT_EQ(updated->GetObjects().size(), base->GetObjects().size());
+
+  // A full data file can not remove records.
+  std::stringstream full(patchXml);
+  EXPECT_FALSE(CreateSet()->LoadXml(full));
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
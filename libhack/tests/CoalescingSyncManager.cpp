@@ -0,0 +1,161 @@
+/**
+ * @file libhack/tests/CoalescingSyncManager.cpp
+ * @ingroup libhack
+ *
+ * @author HACKfrost
+ *
+ * @brief Test the coalescing of outgoing data sync records.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libhack Includes
+#include <CoalescingSyncManager.h>
+
+// object Includes
+#include <SearchEntry.h>
+
+using namespace libhack;
+
+/**
+ * Sync manager with a single registered type and no connections.
+ */
+class TestSyncManager : public CoalescingSyncManager {
+ public:
+  TestSyncManager() : CoalescingSyncManager(0x1234) {
+    mRegisteredTypes["SearchEntry"] =
+        std::make_shared<ObjectConfig>("SearchEntry", false);
+  }
+
+  bool Initialize() { return true; }
+};
+
+TEST(CoalescingSyncManager, NoWindow) {
+  TestSyncManager syncManager;
+
+  auto entry = std::make_shared<objects::SearchEntry>();
+
+  // Without a window every sync is sent right away so nothing coalesces
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  syncManager.SyncOutgoing();
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  syncManager.SyncOutgoing();
+
+  EXPECT_EQ(0u, syncManager.GetRecordsCoalesced());
+  EXPECT_EQ(0u, syncManager.GetBytesSaved());
+}
+
+TEST(CoalescingSyncManager, UnknownType) {
+  TestSyncManager syncManager;
+  syncManager.SetFlushWindow(100);
+
+  auto entry = std::make_shared<objects::SearchEntry>();
+
+  EXPECT_FALSE(syncManager.UpdateRecord(entry, "Unknown"));
+  EXPECT_FALSE(syncManager.UpdateRecord(entry, "Unknown"));
+
+  EXPECT_EQ(0u, syncManager.GetRecordsCoalesced());
+}
+
+TEST(CoalescingSyncManager, CoalesceWithinWindow) {
+  TestSyncManager syncManager;
+  syncManager.SetFlushWindow(100);
+
+  auto entry = std::make_shared<objects::SearchEntry>();
+  auto other = std::make_shared<objects::SearchEntry>();
+
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  syncManager.SyncOutgoing();
+  ASSERT_TRUE(syncManager.UpdateRecord(other, "SearchEntry"));
+  syncManager.SyncOutgoing();
+
+  // Distinct records do not coalesce
+  EXPECT_EQ(0u, syncManager.GetRecordsCoalesced());
+
+  entry->SetEntryID(2);
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  ASSERT_TRUE(syncManager.RemoveRecord(entry, "SearchEntry"));
+
+  EXPECT_EQ(2u, syncManager.GetRecordsCoalesced());
+  EXPECT_LT(0u, syncManager.GetBytesSaved());
+
+  // A new window starts after the flush
+  syncManager.FlushOutgoing();
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+
+  EXPECT_EQ(2u, syncManager.GetRecordsCoalesced());
+}
+
+TEST(CoalescingSyncManager, ClosingWindowFlushes) {
+  TestSyncManager syncManager;
+  syncManager.SetFlushWindow(100);
+
+  auto entry = std::make_shared<objects::SearchEntry>();
+
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  syncManager.SyncOutgoing();
+
+  // Turning the window off sends what was held
+  syncManager.SetFlushWindow(0);
+  syncManager.SetFlushWindow(100);
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+
+  EXPECT_EQ(0u, syncManager.GetRecordsCoalesced());
+}
+
+TEST(CoalescingSyncManager, TakeStats) {
+  TestSyncManager syncManager;
+  syncManager.SetFlushWindow(100);
+
+  auto entry = std::make_shared<objects::SearchEntry>();
+
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+  ASSERT_TRUE(syncManager.UpdateRecord(entry, "SearchEntry"));
+
+  uint64_t coalesced = 0, bytesSaved = 0;
+  syncManager.TakeStats(coalesced, bytesSaved);
+
+  EXPECT_EQ(2u, coalesced);
+  EXPECT_EQ(bytesSaved, syncManager.GetBytesSaved());
+
+  // The counts reset but the totals are kept
+  syncManager.TakeStats(coalesced, bytesSaved);
+
+  EXPECT_EQ(0u, coalesced);
+  EXPECT_EQ(0u, bytesSaved);
+  EXPECT_EQ(2u, syncManager.GetRecordsCoalesced());
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
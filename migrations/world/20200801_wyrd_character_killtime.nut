@@ -0,0 +1,20 @@
+import("server");
+
+function up(db, server)
+{
+    print("Adding the character kill time index.");
+
+    if(!db.Execute("CREATE INDEX IF NOT EXISTS " +
+        "`idx_Character_KillTime` ON `Character` (`KillTime`);"))
+    {
+        print("ERROR: Failed to create the character kill time index");
+        return false;
+    }
+
+    return true;
+}
+
+function down(db)
+{
+    return true;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file server/channel/src/AIHookTable.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Script functions resolved for the hooks an AI script overrides.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AIHookTable.h"
+
+using namespace channel;
+
+AIHookTable::AIHookTable() : mMask(0) {}
+
+void AIHookTable::SetScript(
+    const std::shared_ptr<libhack::ScriptEngine>& script) {
+  // Drop the old functions before the script they belong to
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    mFunctions[i] = Sqrat::Function();
+  }
+
+  mScript = script;
+
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    Resolve((AIHook_t)i);
+  }
+}
+
+void AIHookTable::SetOverride(const libcomp::String& key,
+                              const libcomp::String& function) {
+  auto hook = GetHook(key);
+  if (hook == AI_HOOK_COUNT) {
+    return;
+  }
+
+  mMask = (uint16_t)(mMask | (1 << hook));
+  mOverrides[hook] = function;
+
+  Resolve(hook);
+}
+
+void AIHookTable::RemoveOverride(const libcomp::String& key) {
+  auto hook = GetHook(key);
+  if (hook == AI_HOOK_COUNT) {
+    return;
+  }
+
+  mMask = (uint16_t)(mMask & ~(1 << hook));
+  mOverrides[hook] = libcomp::String();
+
+  Resolve(hook);
+}
+
+void AIHookTable::ClearOverrides() {
+  mMask = 0;
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    mFunctions[i] = Sqrat::Function();
+    mOverrides[i] = libcomp::String();
+  }
+}
+
+bool AIHookTable::Has(AIHook_t hook) const {
+  return (mMask & (1 << hook)) != 0;
+}
+
+const libcomp::String& AIHookTable::GetOverride(AIHook_t hook) const {
+  return mOverrides[hook];
+}
+
+Sqrat::Function AIHookTable::GetFunction(AIHook_t hook) const {
+  return mFunctions[hook];
+}
+
+const char* AIHookTable::GetName(AIHook_t hook) {
+  static const char* names[AI_HOOK_COUNT] = {
+      "idle",    "wander", "follow",       "aggro",          "combat",
+      "enraged", "target", "prepareSkill", "combatSkillHit",
+      "combatSkillComplete"};
+
+  return hook < AI_HOOK_COUNT ? names[hook] : "";
+}
+
+AIHook_t AIHookTable::GetHook(const libcomp::String& key) {
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    if (key == GetName((AIHook_t)i)) {
+      return (AIHook_t)i;
+    }
+  }
+
+  return AI_HOOK_COUNT;
+}
+
+void AIHookTable::Resolve(AIHook_t hook) {
+  mFunctions[hook] = Sqrat::Function();
+
+  if (mScript && Has(hook)) {
+    libcomp::String name(GetName(hook));
+
+    mFunctions[hook] = Sqrat::Function(
+        Sqrat::RootTable(mScript->GetVM()),
+        mOverrides[hook].IsEmpty() ? name.C() : mOverrides[hook].C());
+  }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file server/channel/src/AIHookTable.h
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Script functions resolved for the hooks an AI script overrides.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_AIHOOKTABLE_H
+#define SERVER_CHANNEL_SRC_AIHOOKTABLE_H
+
+// libhack Includes
+#include <ScriptEngine.h>
+
+namespace channel {
+
+/**
+ * Script hooks an AI script can register through its action overrides,
+ * resolved once per AI state instead of being looked up by name.
+ */
+enum AIHook_t : uint8_t {
+  AI_HOOK_IDLE = 0,               //!< "idle" status action override
+  AI_HOOK_WANDER,                 //!< "wander" status action override
+  AI_HOOK_FOLLOW,                 //!< "follow" status action override
+  AI_HOOK_AGGRO,                  //!< "aggro" status action override
+  AI_HOOK_COMBAT,                 //!< "combat" status action override
+  AI_HOOK_ENRAGED,                //!< "enraged" status action override
+  AI_HOOK_TARGET,                 //!< "target" selection override
+  AI_HOOK_PREPARE_SKILL,          //!< "prepareSkill" override
+  AI_HOOK_COMBAT_SKILL_HIT,       //!< "combatSkillHit" override
+  AI_HOOK_COMBAT_SKILL_COMPLETE,  //!< "combatSkillComplete" override
+  AI_HOOK_COUNT,                  //!< Number of hooks, not a valid hook
+};
+
+/**
+ * Table of the hooks an AI script overrides and the script function each
+ * one resolves to. A hook is resolved again whenever its override or the
+ * script changes so the table never points at a stale function.
+ */
+class AIHookTable {
+ public:
+  /**
+   * Create a new empty hook table
+   */
+  AIHookTable();
+
+  /**
+   * Set the script hooks are resolved against and resolve every hook
+   * again
+   * @param script Pointer to the AI script, null to unbind every hook
+   */
+  void SetScript(const std::shared_ptr<libhack::ScriptEngine>& script);
+
+  /**
+   * Override a hook and resolve it against the current script. Keys that
+   * are not the name of a hook are ignored.
+   * @param key Name of the hook to override
+   * @param function Name of the script function to call for the hook, empty
+   *  if the hook's default function name should be used
+   */
+  void SetOverride(const libcomp::String& key,
+                   const libcomp::String& function);
+
+  /**
+   * Remove the override of a hook
+   * @param key Name of the hook to remove the override of
+   */
+  void RemoveOverride(const libcomp::String& key);
+
+  /**
+   * Remove the override of every hook
+   */
+  void ClearOverrides();
+
+  /**
+   * Check if an override is registered for a hook
+   * @param hook Hook to check
+   * @return true if the hook is overridden
+   */
+  bool Has(AIHook_t hook) const;
+
+  /**
+   * Get the function name an overridden hook was registered with
+   * @param hook Hook to get the override of
+   * @return Registered function name, empty if the hook's default function
+   *  name should be used
+   */
+  const libcomp::String& GetOverride(AIHook_t hook) const;
+
+  /**
+   * Get the script function resolved for an overridden hook
+   * @param hook Hook to get the function of
+   * @return Resolved script function, null if the hook is not overridden
+   *  or the function does not exist
+   */
+  Sqrat::Function GetFunction(AIHook_t hook) const;
+
+  /**
+   * Get the default script function name of a hook, which is also the key
+   * it is registered with in the action overrides
+   * @param hook Hook to get the name of
+   * @return Default name of the hook
+   */
+  static const char* GetName(AIHook_t hook);
+
+  /**
+   * Get the hook registered with an action override key
+   * @param key Action override key
+   * @return Hook for the key or AI_HOOK_COUNT if the key is not a hook
+   */
+  static AIHook_t GetHook(const libcomp::String& key);
+
+ private:
+  /**
+   * Resolve the function of one hook against the current script
+   * @param hook Hook to resolve
+   */
+  void Resolve(AIHook_t hook);
+
+  /// Pointer to the AI script hooks are resolved against
+  std::shared_ptr<libhack::ScriptEngine> mScript;
+
+  /// Script functions resolved for each overridden hook, indexed by
+  /// AIHook_t. Declared after the script so they are released first.
+  Sqrat::Function mFunctions[AI_HOOK_COUNT];
+
+  /// Function names registered for each overridden hook, indexed by
+  /// AIHook_t
+  libcomp::String mOverrides[AI_HOOK_COUNT];
+
+  /// Bitmask of overridden hooks, indexed by AIHook_t
+  uint16_t mMask;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_AIHOOKTABLE_H
@@ -31,6 +31,7 @@
 #include <ErrorCodes.h>
 #include <Log.h>
 #include <PacketCodes.h>
+#include <PacketPool.h>
 #include <Randomizer.h>
 #include <ScriptEngine.h>
 #include <ServerConstants.h>
@@ -76,9 +77,6 @@
 
 using namespace channel;
 
-std::unordered_map<std::string, std::shared_ptr<libhack::ScriptEngine>>
-    AIManager::sPreparedScripts;
-
 namespace libcomp {
 template <>
 BaseScriptEngine& BaseScriptEngine::Using<AIManager>() {
@@ -109,6 +107,10 @@ BaseScriptEngine& BaseScriptEngine::Using<AIManager>() {
 }
 }  // namespace libcomp
 
+AIScriptEngines AIManager::sScriptEngines([](libhack::ScriptEngine& engine) {
+  engine.Using<AIManager>();
+});
+
 AIManager::AIManager() {}
 
 AIManager::AIManager(const std::weak_ptr<ChannelServer>& server)
@@ -210,35 +212,9 @@ bool AIManager::Prepare(const std::shared_ptr<ActiveEntityState>& eState,
 
   std::shared_ptr<libhack::ScriptEngine> aiEngine;
   if (!finalAIType.IsEmpty()) {
-    auto it = sPreparedScripts.find(finalAIType.C());
-    if (it == sPreparedScripts.end()) {
-      auto script = serverDataManager->GetAIScript(finalAIType);
-      if (!script) {
-        LogAIManagerError([finalAIType]() {
-          return libcomp::String("AI type '%1' does not exist\n")
-              .Arg(finalAIType);
-        });
-
-        return false;
-      }
-
-      aiEngine = std::make_shared<libhack::ScriptEngine>();
-      aiEngine->Using<AIManager>();
-
-      if (!aiEngine->Eval(script->Source)) {
-        LogAIManagerError([finalAIType]() {
-          return libcomp::String("AI type '%1' is not a valid AI script\n")
-              .Arg(finalAIType);
-        });
-
-        return false;
-      }
-
-      if (!script->Instantiated) {
-        sPreparedScripts[finalAIType.C()] = aiEngine;
-      }
-    } else {
-      aiEngine = it->second;
+    aiEngine = GetAIScriptEngine(eState, finalAIType);
+    if (!aiEngine) {
+      return false;
     }
 
     Sqrat::Function f(Sqrat::RootTable(aiEngine->GetVM()), "prepare");
@@ -267,26 +243,84 @@ bool AIManager::Prepare(const std::shared_ptr<ActiveEntityState>& eState,
   return true;
 }
 
+void AIManager::ReleaseZoneScripts(uint32_t zoneID) {
+  sScriptEngines.ReleaseZone(zoneID);
+}
+
 void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
                                    uint64_t now, bool isNight) {
+  auto zConnections = zone->GetConnectionList();
+
+  // Gather player positions once for the level of detail checks
+  std::list<Point> players;
+  bool lodEnabled = LODEnabled();
+  if (lodEnabled) {
+    for (auto client : zConnections) {
+      auto cState = client->GetClientState()->GetCharacterState();
+      if (cState->Ready()) {
+        players.push_back(Point(cState->GetCurrentX(), cState->GetCurrentY()));
+      }
+    }
+  }
+
+  uint32_t tierCounts[3] = {0, 0, 0};
+
+  // Entities are still updated one at a time on the zone tick thread. Zone
+  // script isolation keeps the VMs apart but the managers an update calls
+  // into are not safe to run from more than one zone at once.
   std::list<std::shared_ptr<ActiveEntityState>> updated;
   for (auto eState : zone->GetEnemiesAndAllies()) {
+    auto aiState = eState->GetAIState();
+    if (lodEnabled && aiState) {
+      auto tier = UpdateLODTier(eState, players);
+      tierCounts[(size_t)tier]++;
+
+      if (tier == AILODTier_t::DORMANT) {
+        // Nothing is simulated while dormant but despawning still
+        // happens on time. Anything else catches up once woken since
+        // positions and status times are all relative to the server time.
+        uint64_t despawnTimeout = aiState->GetDespawnTimeout();
+        if (despawnTimeout && despawnTimeout <= now) {
+          UpdateState(eState, now, isNight);
+        }
+
+        continue;
+      } else if (tier == AILODTier_t::REDUCED &&
+                 now < aiState->GetLastLODUpdate() + ReducedLODInterval()) {
+        continue;
+      }
+
+      aiState->SetLastLODUpdate(now);
+    } else {
+      tierCounts[(size_t)AILODTier_t::FULL]++;
+    }
+
     if (UpdateState(eState, now, isNight)) {
       updated.push_back(eState);
     }
   }
 
+  zone->SetAILODCounts(tierCounts[(size_t)AILODTier_t::FULL],
+                       tierCounts[(size_t)AILODTier_t::REDUCED],
+                       tierCounts[(size_t)AILODTier_t::DORMANT]);
+
   // Update enemy states first
   if (updated.size() > 0) {
-    auto zConnections = zone->GetConnectionList();
     RelativeTimeMap timeMap;
+
+    // Every packet is copied per connection so one pooled packet can be
+    // rebuilt for each entity
+    libhack::PooledPacket pooled;
+    libcomp::Packet& p = *pooled;
+
     for (auto entity : updated) {
       // Update the clients with what the entity is doing
 
       // Check if the entity's position or rotation has updated
       if (now == entity->GetOriginTicks()) {
+        p.Clear();
+
         if (entity->IsMoving()) {
-          libcomp::Packet p;
           p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_MOVE);
           p.WriteS32Little(entity->GetEntityID());
           p.WriteFloat(entity->GetDestinationX());
@@ -300,7 +334,6 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
           ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
                                                           timeMap, true);
         } else if (entity->IsRotating()) {
-          libcomp::Packet p;
           p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_ROTATE);
           p.WriteS32Little(entity->GetEntityID());
           p.WriteFloat(entity->GetDestinationRotation());
@@ -312,7 +345,6 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
         } else {
           // The movement was actually a stop
 
-          libcomp::Packet p;
           p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_STOP_MOVEMENT);
           p.WriteS32Little(entity->GetEntityID());
           p.WriteFloat(entity->GetDestinationX());
@@ -337,6 +369,9 @@ void AIManager::CombatSkillHit(
     auto aiState = eState->GetAIState();
     if (!aiState) continue;
 
+    // Always react to being hit, even if nobody is nearby
+    aiState->Wake();
+
     // If the current command is a skill command and it was cancelled
     // by the hit, remove it now so they can react faster later
     auto skillCmd = std::dynamic_pointer_cast<AIUseSkillCommand>(
@@ -349,8 +384,9 @@ void AIManager::CombatSkillHit(
     // If currently not acting, cancel now
     eState->RemoveStatusTimes(STATUS_RESTING);
 
-    if (aiState->ActionOverridesKeyExists("combatSkillHit")) {
-      libcomp::String fOverride = aiState->GetActionOverrides("combatSkillHit");
+    if (aiState->HasHook(AI_HOOK_COMBAT_SKILL_HIT)) {
+      libcomp::String fOverride =
+          aiState->GetHookOverride(AI_HOOK_COMBAT_SKILL_HIT);
 
       LogAIManagerDebug([eState, fOverride]() {
         return libcomp::String("Executing combatSkillHit override for %1: %2\n")
@@ -358,8 +394,7 @@ void AIManager::CombatSkillHit(
             .Arg(fOverride);
       });
 
-      Sqrat::Function f(Sqrat::RootTable(aiState->GetScript()->GetVM()),
-                        fOverride.IsEmpty() ? "combatSkillHit" : fOverride.C());
+      auto f = aiState->GetHookFunction(AI_HOOK_COMBAT_SKILL_HIT);
 
       auto scriptResult =
           !f.IsNull() ? f.Evaluate<int32_t>(eState, this, source, skillData)
@@ -404,9 +439,9 @@ void AIManager::CombatSkillComplete(
   bool wait = true;
 
   bool normalProcesing = true;
-  if (aiState->ActionOverridesKeyExists("combatSkillComplete")) {
+  if (aiState->HasHook(AI_HOOK_COMBAT_SKILL_COMPLETE)) {
     libcomp::String fOverride =
-        aiState->GetActionOverrides("combatSkillComplete");
+        aiState->GetHookOverride(AI_HOOK_COMBAT_SKILL_COMPLETE);
 
     LogAIManagerDebug([eState, fOverride]() {
       return libcomp::String(
@@ -415,9 +450,7 @@ void AIManager::CombatSkillComplete(
           .Arg(fOverride);
     });
 
-    Sqrat::Function f(
-        Sqrat::RootTable(aiState->GetScript()->GetVM()),
-        fOverride.IsEmpty() ? "combatSkillComplete" : fOverride.C());
+    auto f = aiState->GetHookFunction(AI_HOOK_COMBAT_SKILL_COMPLETE);
 
     auto scriptResult =
         !f.IsNull() ? f.Evaluate<int32_t>(eState, this, activated, target, hit)
@@ -942,7 +975,7 @@ bool AIManager::UpdateState(const std::shared_ptr<ActiveEntityState>& eState,
     return false;
   }
 
-  if (aiState->IsIdle() && !aiState->ActionOverridesKeyExists("idle") &&
+  if (aiState->IsIdle() && !aiState->HasHook(AI_HOOK_IDLE) &&
       !aiState->HasFollowTarget() && !aiState->GetCurrentCommand()) {
     // Nothing to do
     return false;
@@ -1066,43 +1099,44 @@ bool AIManager::UpdateState(const std::shared_ptr<ActiveEntityState>& eState,
 
   if (!aiState->GetCurrentCommand()) {
     // Check for overrides first
-    libcomp::String actionName;
+    AIHook_t hook = AI_HOOK_COUNT;
     switch (aiState->GetStatus()) {
       case AIStatus_t::IDLE:
-        actionName = "idle";
+        hook = AI_HOOK_IDLE;
         break;
       case AIStatus_t::WANDERING:
-        actionName = "wander";
+        hook = AI_HOOK_WANDER;
         break;
       case AIStatus_t::FOLLOWING:
-        actionName = "follow";
+        hook = AI_HOOK_FOLLOW;
         break;
       case AIStatus_t::AGGRO:
-        actionName = "aggro";
+        hook = AI_HOOK_AGGRO;
         break;
       case AIStatus_t::COMBAT:
-        actionName = "combat";
+        hook = AI_HOOK_COMBAT;
         break;
       case AIStatus_t::ENRAGED:
-        actionName = "enraged";
+        hook = AI_HOOK_ENRAGED;
         break;
       default:
         break;
     }
 
-    if (aiState->ActionOverridesKeyExists(actionName)) {
-      libcomp::String fOverride = aiState->GetActionOverrides(actionName);
+    if (hook != AI_HOOK_COUNT && aiState->HasHook(hook)) {
+      libcomp::String fOverride = aiState->GetHookOverride(hook);
       if (!fOverride.IsEmpty()) {
         // Queue the overridden function
         QueueScriptCommand(aiState, fOverride);
       } else {
         // Run the function with the action name
-        int32_t result = 0;
-        if (ExecuteScriptFunction(eState, actionName.C(), now, result)) {
-          if (result == -1) {
+        auto f = aiState->GetHookFunction(hook);
+        auto result = !f.IsNull() ? f.Evaluate<int32_t>(eState, this, now) : 0;
+        if (result) {
+          if (*result == -1) {
             // Erroring or skipping the action
             return false;
-          } else if (result == 1) {
+          } else if (*result == 1) {
             // Direct entity update, communicate the results
             return true;
           }
@@ -2048,9 +2082,8 @@ std::shared_ptr<ActiveEntityState> AIManager::Retarget(
 
   int32_t newTarget = currentTarget;
   if (possibleTargets.size() > 0) {
-    if (aiState->ActionOverridesKeyExists("target") && aiState->GetScript()) {
-      Sqrat::Function f(Sqrat::RootTable(aiState->GetScript()->GetVM()),
-                        aiState->GetActionOverrides("target").C());
+    if (aiState->HasHook(AI_HOOK_TARGET) && aiState->GetScript()) {
+      auto f = aiState->GetHookFunction(AI_HOOK_TARGET);
 
       auto scriptResult =
           !f.IsNull() ? f.Evaluate<int32_t>(eState, possibleTargets, this, now)
@@ -2302,11 +2335,8 @@ bool AIManager::PrepareSkillUsage(
   int32_t targetID = aiState->GetTargetEntityID();
   auto target = targetID > 0 ? zone->GetActiveEntity(targetID) : nullptr;
 
-  if (aiState->ActionOverridesKeyExists("prepareSkill")) {
-    libcomp::String fOverride = aiState->GetActionOverrides("prepareSkill");
-
-    Sqrat::Function f(Sqrat::RootTable(aiState->GetScript()->GetVM()),
-                      fOverride.IsEmpty() ? "prepareSkill" : fOverride.C());
+  if (aiState->HasHook(AI_HOOK_PREPARE_SKILL)) {
+    auto f = aiState->GetHookFunction(AI_HOOK_PREPARE_SKILL);
 
     auto scriptResult =
         !f.IsNull() ? f.Evaluate<int32_t>(eState, this, target) : 0;
@@ -2708,6 +2738,111 @@ std::shared_ptr<ActiveEntityState> AIManager::GetSharedAggroEntity(
   return nullptr;
 }
 
+AILODTier_t AIManager::UpdateLODTier(
+    const std::shared_ptr<ActiveEntityState>& eState,
+    const std::list<Point>& players) {
+  auto aiState = eState->GetAIState();
+
+  AILODTier_t tier = AILODTier_t::FULL;
+  if (aiState->PopWoken() || (!aiState->IsIdle() && !aiState->IsWandering()) ||
+      aiState->GetTargetEntityID() > 0 || aiState->HasFollowTarget() ||
+      eState->GetOpponentIDs().size() > 0) {
+    // Entities doing anything beyond idling or wandering on their own
+    // always run at full detail
+    tier = AILODTier_t::FULL;
+  } else {
+    const static float nearDist =
+        mServer.lock()->GetWorldSharedConfig()->GetAILODNearDistance();
+    const static float dormantDist =
+        mServer.lock()->GetWorldSharedConfig()->GetAILODDormantDistance();
+
+    // Compare squared distances to the closest player, negative if there
+    // are no players in the zone
+    float closest = -1.f;
+    for (auto& p : players) {
+      float dist = eState->GetDistance(p.x, p.y, true);
+      if (closest < 0.f || dist < closest) {
+        closest = dist;
+      }
+    }
+
+    if (dormantDist > 0.f &&
+        (closest < 0.f || closest > dormantDist * dormantDist)) {
+      tier = AILODTier_t::DORMANT;
+    } else if (nearDist > 0.f &&
+               (closest < 0.f || closest > nearDist * nearDist)) {
+      tier = AILODTier_t::REDUCED;
+    }
+  }
+
+  if (tier != aiState->GetLODTier()) {
+    if (aiState->GetLODTier() == AILODTier_t::DORMANT) {
+      // Coming out of dormancy (a player came close or the entity was
+      // woken), update immediately
+      aiState->SetLastLODUpdate(0);
+    }
+
+    LogAIManagerDebug([eState, tier]() {
+      return libcomp::String("%1 moves to AI LOD tier %2.\n")
+          .Arg(eState->GetEntityLabel())
+          .Arg((uint8_t)tier);
+    });
+
+    aiState->SetLODTier(tier);
+  }
+
+  return tier;
+}
+
+std::shared_ptr<libhack::ScriptEngine> AIManager::GetAIScriptEngine(
+    const std::shared_ptr<ActiveEntityState>& eState,
+    const libcomp::String& aiType) {
+  auto script = mServer.lock()->GetServerDataManager()->GetAIScript(aiType);
+  if (!script) {
+    LogAIManagerError([aiType]() {
+      return libcomp::String("AI type '%1' does not exist\n").Arg(aiType);
+    });
+
+    return nullptr;
+  }
+
+  auto zone = eState->GetZone();
+  auto aiEngine = zone && ZoneScriptIsolationEnabled()
+                      ? sScriptEngines.GetForZone(*script, zone->GetID())
+                      : sScriptEngines.GetShared(*script);
+  if (!aiEngine) {
+    LogAIManagerError([aiType]() {
+      return libcomp::String("AI type '%1' is not a valid AI script\n")
+          .Arg(aiType);
+    });
+
+    return nullptr;
+  }
+
+  return aiEngine;
+}
+
+bool AIManager::ZoneScriptIsolationEnabled() {
+  const static bool enabled =
+      mServer.lock()->GetWorldSharedConfig()->GetAIZoneScriptIsolation();
+  return enabled;
+}
+
+bool AIManager::LODEnabled() {
+  const static bool enabled =
+      mServer.lock()->GetWorldSharedConfig()->GetAILODNearDistance() > 0.f ||
+      mServer.lock()->GetWorldSharedConfig()->GetAILODDormantDistance() > 0.f;
+  return enabled;
+}
+
+uint64_t AIManager::ReducedLODInterval() {
+  // Configured in milliseconds, server time is in microseconds
+  const static uint64_t interval =
+      (uint64_t)mServer.lock()->GetWorldSharedConfig()
+          ->GetAILODReducedInterval() * 1000ULL;
+  return interval;
+}
+
 bool AIManager::CombatStaggerEnabled() {
   const static bool enabled =
       mServer.lock()->GetWorldSharedConfig()->GetAICombatStagger();
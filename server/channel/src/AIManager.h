@@ -28,6 +28,7 @@
 #define SERVER_CHANNEL_SRC_AIMANAGER_H
 
 // channel Includes
+#include "AIScriptEngines.h"
 #include "AIState.h"
 #include "ActiveEntityState.h"
 #include "ClientState.h"
@@ -84,6 +85,13 @@ class AIManager {
   bool Prepare(const std::shared_ptr<ActiveEntityState>& eState,
                const libcomp::String& aiType, uint16_t baseAIType = 0);
 
+  /**
+   * Release the AI script engines owned by a zone when AI scripts are
+   * isolated per zone. This should be called when the zone is removed.
+   * @param zoneID Unique ID of the zone being removed
+   */
+  void ReleaseZoneScripts(uint32_t zoneID);
+
   /**
    * Update the AI state of all active AI controlled entities in the
    * specified zone
@@ -481,6 +489,30 @@ class AIManager {
    */
   bool CombatStaggerEnabled();
 
+  /**
+   * Determine the level of detail tier an AI controlled entity should be
+   * updated at based upon its current state and distance to the closest
+   * player in the zone.
+   * @param eState Pointer to the AI controlled entity
+   * @param players Positions of all players in the zone
+   * @return Level of detail tier the entity should be updated at
+   */
+  AILODTier_t UpdateLODTier(const std::shared_ptr<ActiveEntityState>& eState,
+                            const std::list<Point>& players);
+
+  /**
+   * Determine if AI level of detail tiers are enabled, meaning a near or
+   * dormant distance has been configured
+   * @return true if level of detail tiers are enabled
+   */
+  bool LODEnabled();
+
+  /**
+   * Get the interval reduced level of detail entities are updated at
+   * @return Reduced update interval in server time (microseconds)
+   */
+  uint64_t ReducedLODInterval();
+
   /**
    * Determine if the AI does not bother to navigate to a target that is
    * not in direct line of sight. Only affects specific movement types.
@@ -488,10 +520,30 @@ class AIManager {
    */
   bool LazyPathingEnabled();
 
-  /// Static map of scripts that have been loaded and compiled
-  /// by AI type name
-  static std::unordered_map<std::string, std::shared_ptr<libhack::ScriptEngine>>
-      sPreparedScripts;
+  /**
+   * Get the script engine to bind to an entity for an AI type. Depending
+   * on the AIZoneScriptIsolation setting, engines are either shared by
+   * every entity of the AI type on the channel or only by entities of the
+   * AI type within the same zone. Instantiated scripts always get a new
+   * engine.
+   * @param eState Pointer to the entity the AI is being prepared for
+   * @param aiType AI script type to load
+   * @return Pointer to the script engine or null if the AI type does not
+   *  exist or could not be loaded
+   */
+  std::shared_ptr<libhack::ScriptEngine> GetAIScriptEngine(
+      const std::shared_ptr<ActiveEntityState>& eState,
+      const libcomp::String& aiType);
+
+  /**
+   * Determine if AI script engines are isolated per zone rather than
+   * shared across the channel
+   * @return true if AI script engines are isolated per zone
+   */
+  bool ZoneScriptIsolationEnabled();
+
+  /// AI script engines shared by the channel or owned by each zone
+  static AIScriptEngines sScriptEngines;
 
   /// Pointer to the channel server.
   std::weak_ptr<ChannelServer> mServer;
@@ -0,0 +1,97 @@
+/**
+ * @file server/channel/src/AIScriptEngines.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Shared or per zone AI script engines built from compiled scripts.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AIScriptEngines.h"
+
+// libhack Includes
+#include <ScriptEngine.h>
+#include <ServerDataManager.h>
+
+using namespace channel;
+
+AIScriptEngines::AIScriptEngines(const Binder_t& binder) : mBinder(binder) {}
+
+std::shared_ptr<libhack::ScriptEngine> AIScriptEngines::GetShared(
+    const libhack::ServerScript& script) {
+  return Get(script, false, 0);
+}
+
+std::shared_ptr<libhack::ScriptEngine> AIScriptEngines::GetForZone(
+    const libhack::ServerScript& script, uint32_t zoneID) {
+  return Get(script, true, zoneID);
+}
+
+void AIScriptEngines::ReleaseZone(uint32_t zoneID) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mZones.erase(zoneID);
+}
+
+size_t AIScriptEngines::GetZoneCount() {
+  std::lock_guard<std::mutex> lock(mLock);
+  return mZones.size();
+}
+
+std::shared_ptr<libhack::ScriptEngine> AIScriptEngines::Get(
+    const libhack::ServerScript& script, bool isolated, uint32_t zoneID) {
+  std::string name(script.Name.C());
+
+  if (!script.Instantiated) {
+    std::lock_guard<std::mutex> lock(mLock);
+    auto& engines = isolated ? mZones[zoneID] : mShared;
+
+    auto it = engines.find(name);
+    if (it != engines.end()) {
+      return it->second;
+    }
+  }
+
+  // Each engine is built from the bytecode compiled when the script was
+  // loaded so creating one per zone does not compile the script again
+  auto engine = std::make_shared<libhack::ScriptEngine>();
+  if (mBinder) {
+    mBinder(*engine);
+  }
+
+  if (!engine->EvalServerScript(script)) {
+    return nullptr;
+  }
+
+  if (!script.Instantiated) {
+    std::lock_guard<std::mutex> lock(mLock);
+    auto& engines = isolated ? mZones[zoneID] : mShared;
+
+    // Another thread may have prepared the same script first, use theirs
+    // so every entity in scope shares one engine
+    auto it = engines.find(name);
+    if (it != engines.end()) {
+      return it->second;
+    }
+
+    engines[name] = engine;
+  }
+
+  return engine;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file server/channel/src/AIScriptEngines.h
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Shared or per zone AI script engines built from compiled scripts.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_AISCRIPTENGINES_H
+#define SERVER_CHANNEL_SRC_AISCRIPTENGINES_H
+
+// libcomp Includes
+#include <CString.h>
+
+// Standard C++11 Includes
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace libhack {
+class ScriptEngine;
+struct ServerScript;
+}  // namespace libhack
+
+namespace channel {
+
+/**
+ * Cache of the script engines AI controlled entities are bound to. Each
+ * engine is built from the bytecode compiled when the script was loaded.
+ * An engine is either shared by every entity using the AI type on the
+ * channel or only by entities using it in the same zone, so AI for
+ * different zones never touches the same VM. Instantiated scripts always
+ * get a new engine.
+ */
+class AIScriptEngines {
+ public:
+  /// Function used to bind any types the AI scripts need on a newly
+  /// created engine before the script is loaded
+  typedef std::function<void(libhack::ScriptEngine&)> Binder_t;
+
+  /**
+   * Create a new engine cache
+   * @param binder Function to bind types on each new engine
+   */
+  AIScriptEngines(const Binder_t& binder);
+
+  /**
+   * Get the engine shared by every entity on the channel using a script,
+   * creating it if it does not exist yet
+   * @param script AI script to load
+   * @return Pointer to the script engine or null if the script could not
+   *  be loaded
+   */
+  std::shared_ptr<libhack::ScriptEngine> GetShared(
+      const libhack::ServerScript& script);
+
+  /**
+   * Get the engine shared by every entity in one zone using a script,
+   * creating it if it does not exist yet
+   * @param script AI script to load
+   * @param zoneID Unique ID of the zone the engine belongs to
+   * @return Pointer to the script engine or null if the script could not
+   *  be loaded
+   */
+  std::shared_ptr<libhack::ScriptEngine> GetForZone(
+      const libhack::ServerScript& script, uint32_t zoneID);
+
+  /**
+   * Release every engine owned by a zone
+   * @param zoneID Unique ID of the zone being removed
+   */
+  void ReleaseZone(uint32_t zoneID);
+
+  /**
+   * Get the number of zones that currently own at least one engine
+   * @return Number of zones with engines
+   */
+  size_t GetZoneCount();
+
+ private:
+  /// Map of AI script names to their engines
+  typedef std::unordered_map<std::string,
+                             std::shared_ptr<libhack::ScriptEngine>>
+      EngineMap_t;
+
+  /**
+   * Get an engine for a script from one of the engine maps, creating and
+   * storing it if it does not exist yet
+   * @param script AI script to load
+   * @param isolated true if the engine belongs to a zone
+   * @param zoneID Unique ID of the zone the engine belongs to
+   * @return Pointer to the script engine or null if the script could not
+   *  be loaded
+   */
+  std::shared_ptr<libhack::ScriptEngine> Get(
+      const libhack::ServerScript& script, bool isolated, uint32_t zoneID);
+
+  /// Function to bind types on each new engine
+  Binder_t mBinder;
+
+  /// Engines shared by every entity on the channel by AI script name
+  EngineMap_t mShared;
+
+  /// Map of zone unique IDs to the engines owned by that zone
+  std::unordered_map<uint32_t, EngineMap_t> mZones;
+
+  /// Server lock for the engine maps
+  std::mutex mLock;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_AISCRIPTENGINES_H
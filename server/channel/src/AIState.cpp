@@ -45,7 +45,11 @@ BaseScriptEngine& BaseScriptEngine::Using<AIState>() {
                         Sqrat::NoConstructor<AIState>>
         binding(mVM, "AIState");
     binding.Func("GetStatus", &AIState::GetStatus)
-        .Func("SetStatus", &AIState::SetStatus);
+        .Func("SetStatus", &AIState::SetStatus)
+        .Func("ResolveHooks", &AIState::ResolveHooks)
+        .Func("SetActionOverrides", &AIState::SetActionOverrides)
+        .Func("RemoveActionOverrides", &AIState::RemoveActionOverrides)
+        .Func("ClearActionOverrides", &AIState::ClearActionOverrides);
 
     Bind<AIState>("AIState", binding);
 
@@ -80,7 +84,10 @@ AIState::AIState()
     : mStatus(AIStatus_t::IDLE),
       mPreviousStatus(AIStatus_t::IDLE),
       mDefaultStatus(AIStatus_t::IDLE),
-      mStatusChanged(false) {}
+      mStatusChanged(false),
+      mLODTier(AILODTier_t::FULL),
+      mLastLODUpdate(0),
+      mWoken(false) {}
 
 AIStatus_t AIState::GetStatus() const { return mStatus; }
 
@@ -165,6 +172,8 @@ std::shared_ptr<libhack::ScriptEngine> AIState::GetScript() const {
 void AIState::SetScript(
     const std::shared_ptr<libhack::ScriptEngine>& aiScript) {
   mAIScript = aiScript;
+
+  ResolveHooks();
 }
 
 float AIState::GetAggroValue(uint8_t mode, bool fov, float defaultVal) {
@@ -261,3 +270,80 @@ void AIState::SetSkillMap(const AISkillMap_t& skillMap) {
   std::lock_guard<std::mutex> lock(mFieldLock);
   mSkillMap = skillMap;
 }
+
+void AIState::ResolveHooks() {
+  mHooks.ClearOverrides();
+  mHooks.SetScript(mAIScript);
+
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    libcomp::String name(GetHookName((AIHook_t)i));
+    if (ActionOverridesKeyExists(name)) {
+      mHooks.SetOverride(name, GetActionOverrides(name));
+    }
+  }
+}
+
+bool AIState::SetActionOverrides(const libcomp::String& key,
+                                 const libcomp::String& val) {
+  objects::AIStateObject::SetActionOverrides(key, val);
+
+  return UpdateHook(key);
+}
+
+bool AIState::RemoveActionOverrides(const libcomp::String& key) {
+  objects::AIStateObject::RemoveActionOverrides(key);
+
+  return !UpdateHook(key);
+}
+
+void AIState::ClearActionOverrides() {
+  objects::AIStateObject::ClearActionOverrides();
+  mHooks.ClearOverrides();
+}
+
+bool AIState::UpdateHook(const libcomp::String& key) {
+  if (ActionOverridesKeyExists(key)) {
+    mHooks.SetOverride(key, GetActionOverrides(key));
+
+    return true;
+  }
+
+  mHooks.RemoveOverride(key);
+
+  return false;
+}
+
+bool AIState::HasHook(AIHook_t hook) const { return mHooks.Has(hook); }
+
+const libcomp::String& AIState::GetHookOverride(AIHook_t hook) const {
+  return mHooks.GetOverride(hook);
+}
+
+Sqrat::Function AIState::GetHookFunction(AIHook_t hook) const {
+  return mHooks.GetFunction(hook);
+}
+
+const char* AIState::GetHookName(AIHook_t hook) {
+  return AIHookTable::GetName(hook);
+}
+
+AILODTier_t AIState::GetLODTier() const { return mLODTier; }
+
+void AIState::SetLODTier(AILODTier_t tier) { mLODTier = tier; }
+
+uint64_t AIState::GetLastLODUpdate() const { return mLastLODUpdate; }
+
+void AIState::SetLastLODUpdate(uint64_t time) { mLastLODUpdate = time; }
+
+void AIState::Wake() {
+  std::lock_guard<std::mutex> lock(mFieldLock);
+  mWoken = true;
+}
+
+bool AIState::PopWoken() {
+  std::lock_guard<std::mutex> lock(mFieldLock);
+  bool woken = mWoken;
+  mWoken = false;
+
+  return woken;
+}
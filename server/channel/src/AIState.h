@@ -36,6 +36,7 @@
 
 // channel Includes
 #include "AICommand.h"
+#include "AIHookTable.h"
 
 namespace objects {
 class MiSkillData;
@@ -72,6 +73,16 @@ enum AIStatus_t : uint8_t {
               //!< Liberama or Mass Taunt
 };
 
+/**
+ * Level of detail tiers used to limit how often an AI controlled entity is
+ * updated based upon its distance to the nearest player.
+ */
+enum class AILODTier_t : uint8_t {
+  FULL = 0,  //!< Entity is near a player and updated every tick
+  REDUCED,   //!< Entity is at mid range and updated at a reduced rate
+  DORMANT,   //!< Entity is far from every player and not updated at all
+};
+
 /**
  * Contains the state of an entity's AI information when controlled
  * by the channel.
@@ -251,7 +262,111 @@ class AIState : public objects::AIStateObject {
    */
   void SetSkillMap(const AISkillMap_t& skillMap);
 
+  /**
+   * Resolve every action override registered on the state into the hook
+   * table against the bound AI script. Setting the script or changing an
+   * override through the functions below already does this.
+   */
+  void ResolveHooks();
+
+  /**
+   * Set an action override and resolve its hook again
+   * @param key Action override key
+   * @param val Name of the script function to call, empty to use the
+   *  default function name of the hook
+   * @return true if the override was set
+   */
+  bool SetActionOverrides(const libcomp::String& key,
+                          const libcomp::String& val);
+
+  /**
+   * Remove an action override and its hook
+   * @param key Action override key
+   * @return true if the override was removed
+   */
+  bool RemoveActionOverrides(const libcomp::String& key);
+
+  /**
+   * Remove every action override and hook
+   */
+  void ClearActionOverrides();
+
+  /**
+   * Check if an action override is registered for a hook
+   * @param hook Hook to check
+   * @return true if the hook is overridden
+   */
+  bool HasHook(AIHook_t hook) const;
+
+  /**
+   * Get the function name an overridden hook was registered with
+   * @param hook Hook to get the override of
+   * @return Registered function name, empty if the hook's default function
+   *  name should be used
+   */
+  const libcomp::String& GetHookOverride(AIHook_t hook) const;
+
+  /**
+   * Get the script function resolved for an overridden hook
+   * @param hook Hook to get the function of
+   * @return Resolved script function, null if the hook is not overridden
+   *  or the function does not exist
+   */
+  Sqrat::Function GetHookFunction(AIHook_t hook) const;
+
+  /**
+   * Get the default script function name of a hook, which is also the key
+   * it is registered with in the action overrides
+   * @param hook Hook to get the name of
+   * @return Default name of the hook
+   */
+  static const char* GetHookName(AIHook_t hook);
+
+  /**
+   * Get the level of detail tier the entity was last updated at
+   * @return Level of detail tier of the entity
+   */
+  AILODTier_t GetLODTier() const;
+
+  /**
+   * Set the level of detail tier the entity is being updated at
+   * @param tier Level of detail tier of the entity
+   */
+  void SetLODTier(AILODTier_t tier);
+
+  /**
+   * Get the server time the entity was last updated at, used to space out
+   * updates for reduced level of detail entities
+   * @return Server time of the last update
+   */
+  uint64_t GetLastLODUpdate() const;
+
+  /**
+   * Set the server time the entity was last updated at
+   * @param time Server time of the last update
+   */
+  void SetLastLODUpdate(uint64_t time);
+
+  /**
+   * Wake the entity so it is updated at full detail on the next tick
+   * regardless of its distance to any player, such as when it is hit
+   */
+  void Wake();
+
+  /**
+   * Check and clear the flag set by @ref Wake
+   * @return true if the entity was woken since the last check
+   */
+  bool PopWoken();
+
  private:
+  /**
+   * Update the hook for an action override key to match the overrides
+   * @param key Action override key
+   * @return true if the key is overridden
+   */
+  bool UpdateHook(const libcomp::String& key);
+
   /// List of all AI commands to be processed, starting with the current
   /// command and ending with the last to be processed
   std::list<std::shared_ptr<AICommand>> mCommandQueue;
@@ -267,6 +382,10 @@ class AIState : public objects::AIStateObject {
   /// Pointer to the AI script to use for the AI controlled entity
   std::shared_ptr<libhack::ScriptEngine> mAIScript;
 
+  /// Script functions resolved for each action override. Declared after
+  /// the script so they are released first.
+  AIHookTable mHooks;
+
   /// Current AI status of the entity
   AIStatus_t mStatus;
 
@@ -278,6 +397,15 @@ class AIState : public objects::AIStateObject {
 
   /// Specifies that the status has changed and hasn't been checked yet
   bool mStatusChanged;
+
+  /// Level of detail tier the entity was last updated at
+  AILODTier_t mLODTier;
+
+  /// Server time the entity was last updated at
+  uint64_t mLastLODUpdate;
+
+  /// Specifies that the entity was woken and must be updated next tick
+  bool mWoken;
 };
 
 }  // namespace channel
@@ -912,8 +912,8 @@ bool ActionManager::AddRemoveItems(ActionContext& ctx) {
       auto dropSet = serverDataManager->GetDropSetData(pair.first);
       if (dropSet) {
         // Value of 0 does not require or limit the number of drops
-        auto drops = characterManager->DetermineDrops(dropSet->GetDrops(), 0,
-                                                      pair.second != 0);
+        auto drops =
+            characterManager->DetermineDrops(dropSet, 0, pair.second != 0);
         auto loot = characterManager->CreateLootFromDrops(drops);
 
         // Limit drop count
@@ -3102,7 +3102,7 @@ bool ActionManager::RunScript(ActionContext& ctx) {
       Sqrat::ConstTable(engine->GetVM()).Enum("Result_t", e);
     }
 
-    if (!engine->Eval(script->Source)) {
+    if (!engine->EvalServerScript(*script)) {
       return false;
     }
 
@@ -30,11 +30,15 @@
 
 using namespace channel;
 
+std::atomic<bool> ChannelClientConnection::sOutboundBatching(false);
+std::atomic<uint32_t> ChannelClientConnection::sOutboundFlushSize(0);
+
 ChannelClientConnection::ChannelClientConnection(
     asio::ip::tcp::socket& socket,
     const std::shared_ptr<libcomp::Crypto::DiffieHellman>& diffieHellman)
     : libhack::ChannelConnection(socket, diffieHellman),
       mClientState(std::shared_ptr<ClientState>(new ClientState)),
+      mBatchedSize(0),
       mTimeout(0) {}
 
 ChannelClientConnection::~ChannelClientConnection() {}
@@ -55,6 +59,36 @@ void ChannelClientConnection::Kill() {
   Close();
 }
 
+void ChannelClientConnection::SendPacket(libcomp::Packet& packet,
+                                         bool closeConnection) {
+  if (!sOutboundBatching || closeConnection) {
+    libhack::ChannelConnection::SendPacket(packet, closeConnection);
+    return;
+  }
+
+  uint32_t size = packet.Size();
+  QueuePacket(packet);
+  BatchQueued(size);
+}
+
+void ChannelClientConnection::FlushBatched() {
+  if (mBatchedSize.exchange(0) > 0) {
+    FlushOutgoing();
+  }
+}
+
+void ChannelClientConnection::SetOutboundBatching(bool enabled,
+                                                  uint32_t flushSize) {
+  sOutboundFlushSize = flushSize;
+  sOutboundBatching = enabled;
+}
+
+void ChannelClientConnection::BatchQueued(uint32_t size) {
+  if ((mBatchedSize += size) >= sOutboundFlushSize) {
+    FlushBatched();
+  }
+}
+
 void ChannelClientConnection::BroadcastPacket(
     const std::list<std::shared_ptr<ChannelClientConnection>>& clients,
     libcomp::Packet& packet, bool queue) {
@@ -62,6 +96,12 @@ void ChannelClientConnection::BroadcastPacket(
     for (auto client : clients) {
       client->QueuePacketCopy(packet);
     }
+  } else if (sOutboundBatching) {
+    uint32_t size = packet.Size();
+    for (auto client : clients) {
+      client->QueuePacketCopy(packet);
+      client->BatchQueued(size);
+    }
   } else {
     std::list<std::shared_ptr<libcomp::TcpConnection>> connections;
     for (auto client : clients) {
@@ -33,6 +33,9 @@
 // libcomp Includes
 #include <ChannelConnection.h>
 
+// Standard C++11 Includes
+#include <atomic>
+
 namespace channel {
 
 typedef std::unordered_map<uint32_t, uint64_t> RelativeTimeMap;
@@ -83,6 +86,33 @@ class ChannelClientConnection : public libhack::ChannelConnection {
    */
   void Kill();
 
+  using libhack::ChannelConnection::SendPacket;
+
+  /**
+   * Send a packet to the client. If outbound batching is enabled, the
+   * packet is queued instead and written together with everything else
+   * queued for the client when the tick ends or the queued size passes
+   * the flush threshold.
+   * @param packet Packet to send
+   * @param closeConnection true if the connection should be closed after
+   *  the packet is sent, which always sends immediately
+   */
+  void SendPacket(libcomp::Packet& packet, bool closeConnection = false);
+
+  /**
+   * Write any packets queued by outbound batching since the last flush.
+   */
+  void FlushBatched();
+
+  /**
+   * Configure outbound batching for all client connections.
+   * @param enabled true if sends and broadcasts should be queued until
+   *  the end of the tick
+   * @param flushSize Queued size in bytes that causes a connection to
+   *  flush before the end of the tick
+   */
+  static void SetOutboundBatching(bool enabled, uint32_t flushSize);
+
   /**
    * Broadcast the supplied packet to each client connection in the list.
    * @param clients List of client connections to send the packet to
@@ -125,9 +155,26 @@ class ChannelClientConnection : public libhack::ChannelConnection {
       libcomp::Packet& p, const RelativeTimeMap& timeMap, bool queue = false);
 
  private:
+  /**
+   * Track the size of a packet queued by outbound batching and flush the
+   * connection if the flush threshold has been reached.
+   * @param size Size of the queued packet
+   */
+  void BatchQueued(uint32_t size);
+
+  /// Indicates that sends and broadcasts are queued until the tick ends
+  static std::atomic<bool> sOutboundBatching;
+
+  /// Queued size in bytes that causes a batched connection to flush early
+  static std::atomic<uint32_t> sOutboundFlushSize;
+
   /// State of the client
   std::shared_ptr<ClientState> mClientState;
 
+  /// Size in bytes of the packets queued by outbound batching since the
+  /// connection was last flushed
+  std::atomic<uint32_t> mBatchedSize;
+
   /// Server timestamp used to disconnect the client should it pass
   /// without refreshing beforehand.
   uint64_t mTimeout;
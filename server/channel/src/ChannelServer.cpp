@@ -33,6 +33,8 @@
 #include <ManagerSystem.h>
 #include <MessageTick.h>
 #include <PacketCodes.h>
+#include <PacketPool.h>
+#include <ScriptBytecodeCache.h>
 #include <ScriptEngine.h>
 #include <ServerDataManager.h>
 
@@ -62,6 +64,9 @@
 
 using namespace channel;
 
+/// Milliseconds between each queued server tick
+static const int TICK_DELTA = 100;
+
 namespace libcomp {
 template <>
 BaseScriptEngine& BaseScriptEngine::Using<ChannelServer>() {
@@ -120,6 +125,8 @@ ChannelServer::ChannelServer(
       mMaxEntityID(0),
       mMaxObjectID(0),
       mTicksPending(0),
+      mLastWriteReport(0),
+      mTickOverruns(0),
       mTickRunning(true) {}
 
 bool ChannelServer::Initialize() {
@@ -148,10 +155,37 @@ bool ChannelServer::Initialize() {
   }
 
   mServerDataManager = new libhack::ServerDataManager();
+
+  ChannelClientConnection::SetOutboundBatching(
+      conf->GetOutboundBatching(), conf->GetOutboundBatchFlushSize());
+
+  if (conf->GetAsyncLogging()) {
+    libhack::Log::EnableAsync(conf->GetAsyncLogQueueSize());
+  }
+
+  if (!conf->GetScriptCacheDirectory().IsEmpty()) {
+    auto cache = std::make_shared<libhack::ScriptBytecodeCache>(
+        conf->GetScriptCacheDirectory(), conf->GetScriptCacheValidate());
+    mServerDataManager->SetBytecodeCache(cache);
+  }
+
   if (!mServerDataManager->LoadData(GetDataStore(), mDefinitionManager)) {
     return false;
   }
 
+  if (auto cache = mServerDataManager->GetBytecodeCache()) {
+    cache->Prune();
+
+    LogGeneralDebug([cache]() {
+      return libcomp::String(
+                 "Script bytecode cache: %1 hit(s), %2 miss(es), %3 "
+                 "mismatch(es)\n")
+          .Arg(cache->GetHits())
+          .Arg(cache->GetMisses())
+          .Arg(cache->GetMismatches());
+    });
+  }
+
   if (conf->GetVerifyServerData()) {
     LogGeneralDebugMsg("Verifying server data integrity...\n");
     if (!mServerDataManager->VerifyDataIntegrity(mDefinitionManager)) {
@@ -1113,6 +1147,52 @@ void ChannelServer::Tick() {
   }
   perf.Stop("ScheduleWork");
 
+  // Write everything batched for each client during the tick
+  perf.Start();
+  auto connections = mManagerConnection->GetAllConnections();
+  for (auto client : connections) {
+    client->FlushBatched();
+  }
+  perf.Stop("FlushBatchedOutgoing");
+
+  // Report the average socket writes per connection about once a second
+  if (tickTime >= mLastWriteReport + 1000000ULL) {
+    uint64_t writes = 0;
+    for (auto client : connections) {
+      writes += client->TakeWriteCount();
+    }
+
+    if (mLastWriteReport && connections.size() > 0) {
+      uint64_t elapsed = (uint64_t)(tickTime - mLastWriteReport);
+      perf.Count("WritesPerConnectionPerSecond",
+                 writes * 1000000ULL / elapsed / connections.size());
+    }
+
+    if (mLastWriteReport) {
+      perf.Count("TickOverruns", mTickOverruns);
+    }
+
+    mLastWriteReport = tickTime;
+    mTickOverruns = 0;
+  }
+
+  // Report how many outbound packets reused a pooled buffer
+  uint64_t packetsReused = 0, packetsAllocated = 0;
+  libhack::PacketPool::TakeStats(packetsReused, packetsAllocated);
+  perf.Count("PacketPoolReused", packetsReused);
+  perf.Count("PacketPoolAllocated", packetsAllocated);
+
+  // Report how many outgoing sync records were coalesced
+  uint64_t syncCoalesced = 0, syncBytesSaved = 0;
+  mSyncManager->TakeStats(syncCoalesced, syncBytesSaved);
+  perf.Count("SyncRecordsCoalesced", syncCoalesced);
+  perf.Count("SyncBytesSaved", syncBytesSaved);
+
+  // Count ticks that did not finish before the next one was due
+  if (GetServerTime() - tickTime > TICK_DELTA * 1000ULL) {
+    mTickOverruns++;
+  }
+
   tickPerf.Stop("Tick");
 }
 
@@ -1125,7 +1205,6 @@ void ChannelServer::StartGameTick() {
         pthread_setname_np(pthread_self(), "tick");
 #endif  // !defined(_WIN32) && !defined(__APPLE__)
 
-        const static int TICK_DELTA = 100;
         auto tickDelta = std::chrono::milliseconds(TICK_DELTA);
 
         int32_t ticksMissed = 0;
@@ -563,6 +563,13 @@ class ChannelServer : public libhack::Server {
   /// Incremented by StartTick and decremented by Tick.
   uint8_t mTicksPending;
 
+  /// Server time the outbound write rate was last reported
+  ServerTime mLastWriteReport;
+
+  /// Number of ticks since the last report that took longer than the
+  /// tick interval
+  uint64_t mTickOverruns;
+
   /// Thread that queues up tick messages after a delay.
   std::thread mTickThread;
 
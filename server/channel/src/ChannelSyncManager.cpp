@@ -35,6 +35,7 @@
 
 // object Includes
 #include <Account.h>
+#include <ChannelConfig.h>
 #include <CharacterLogin.h>
 #include <EventCounter.h>
 #include <InstanceAccess.h>
@@ -61,7 +62,7 @@ namespace libcomp {
 template <>
 BaseScriptEngine& BaseScriptEngine::Using<ChannelSyncManager>() {
   if (!BindingExists("ChannelSyncManager", true)) {
-    Using<DataSyncManager>();
+    Using<libhack::CoalescingSyncManager>();
     Using<objects::Account>();
     Using<objects::EventCounter>();
     Using<objects::Match>();
@@ -73,7 +74,7 @@ BaseScriptEngine& BaseScriptEngine::Using<ChannelSyncManager>() {
     Using<objects::UBResult>();
     Using<objects::UBTournament>();
 
-    Sqrat::DerivedClass<ChannelSyncManager, DataSyncManager,
+    Sqrat::DerivedClass<ChannelSyncManager, libhack::CoalescingSyncManager,
                         Sqrat::NoConstructor<ChannelSyncManager>>
         binding(mVM, "ChannelSyncManager");
     binding.Func("GetWorldEventCounter",
@@ -88,7 +89,7 @@ BaseScriptEngine& BaseScriptEngine::Using<ChannelSyncManager>() {
 
 ChannelSyncManager::ChannelSyncManager(
     const std::weak_ptr<ChannelServer>& server)
-    : libcomp::DataSyncManager(
+    : libhack::CoalescingSyncManager(
           to_underlying(InternalPacketCode_t::PACKET_DATA_SYNC)),
       mServer(server) {}
 
@@ -197,6 +198,20 @@ bool ChannelSyncManager::Initialize() {
     mEventCounters[c->GetType()] = c;
   }
 
+  // Coalesce outgoing records if a flush window is configured
+  auto conf =
+      std::dynamic_pointer_cast<objects::ChannelConfig>(server->GetConfig());
+  if (conf->GetDataSyncFlushWindow()) {
+    SetFlushWindow(conf->GetDataSyncFlushWindow());
+
+    server->GetTimerManager()->SchedulePeriodicEvent(
+        std::chrono::milliseconds(GetFlushWindow()),
+        [](ChannelSyncManager* pSyncManager) {
+          pSyncManager->FlushOutgoing();
+        },
+        this);
+  }
+
   // Add the world connection
   const std::set<std::string> worldTypes = {
       "Account",        "CharacterLogin", "CharacterProgress", "EventCounter",
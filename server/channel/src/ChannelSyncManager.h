@@ -28,8 +28,10 @@
 #ifndef SERVER_CHANNEL_SRC_CHANNELSYNCMANAGER_H
 #define SERVER_CHANNEL_SRC_CHANNELSYNCMANAGER_H
 
+// libhack Includes
+#include <CoalescingSyncManager.h>
+
 // libcomp Includes
-#include <DataSyncManager.h>
 #include <EnumMap.h>
 
 // object Includes
@@ -47,7 +49,7 @@ class ChannelServer;
  * Channel specific implementation of the DataSyncManager in charge of
  * performing server side update operations.
  */
-class ChannelSyncManager : public libcomp::DataSyncManager {
+class ChannelSyncManager : public libhack::CoalescingSyncManager {
  public:
   /**
    * Create a new ChannelSyncManager
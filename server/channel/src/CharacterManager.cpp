@@ -31,6 +31,7 @@
 #include <DefinitionManager.h>
 #include <Log.h>
 #include <PacketCodes.h>
+#include <PacketPool.h>
 #include <Randomizer.h>
 #include <ServerConstants.h>
 #include <ServerDataManager.h>
@@ -117,8 +118,10 @@
 #include "ChannelServer.h"
 #include "ChannelSyncManager.h"
 #include "CultureMachineState.h"
+#include "DropTable.h"
 #include "EventManager.h"
 #include "FusionManager.h"
+#include "InventoryIndex.h"
 #include "ManagerConnection.h"
 #include "MatchManager.h"
 #include "SkillManager.h"
@@ -808,7 +811,8 @@ void CharacterManager::SendEntityStats(
     return;
   }
 
-  libcomp::Packet p;
+  libhack::PooledPacket pooled;
+  libcomp::Packet& p = *pooled;
   p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_ENTITY_STATS);
   p.WriteS32Little(eState->GetEntityID());
 
@@ -1901,6 +1905,10 @@ bool CharacterManager::AddRemoveItems(
     }
   }
 
+  // Index the inventory once and keep it up to date as slots change
+  // rather than scanning every slot for each item type
+  InventoryIndex index(itemBox);
+
   // Loop until we're done
   std::list<uint16_t> updatedSlots;
   while (itemCounts.size() > 0) {
@@ -1916,8 +1924,11 @@ bool CharacterManager::AddRemoveItems(
       return false;
     }
 
-    auto existing = GetExistingItems(character, itemType);
     uint32_t maxStack = (uint32_t)def->GetPossession()->GetStackSize();
+
+    // Only partial stacks can be added to
+    auto existing = add ? index.GetPartialStacks(itemType, (uint16_t)maxStack)
+                        : index.GetItems(itemType);
     if (add) {
       bool compressible = false;
       auto compressibleIter = SVR_CONST.ITEM_COMPRESSIONS.begin();
@@ -1945,12 +1956,7 @@ bool CharacterManager::AddRemoveItems(
         }
       }
 
-      std::list<size_t> freeSlots;
-      for (size_t i = 0; i < 50; i++) {
-        if (itemBox->GetItems(i).IsNull()) {
-          freeSlots.push_back(i);
-        }
-      }
+      std::list<size_t> freeSlots = index.GetFreeSlots();
 
       if (quantityLeft <= (freeSlots.size() * maxStack)) {
         uint32_t added = 0;
@@ -1969,6 +1975,7 @@ bool CharacterManager::AddRemoveItems(
                 // Remove the current item and add the compressed item
                 // to the set
                 itemBox->SetItems((size_t)item->GetBoxSlot(), NULLUUID);
+                index.SlotUpdated((size_t)item->GetBoxSlot());
                 updatedSlots.push_back((uint16_t)item->GetBoxSlot());
                 dbChanges->Delete(item);
 
@@ -2023,6 +2030,7 @@ bool CharacterManager::AddRemoveItems(
               return false;
             }
 
+            index.SlotUpdated(freeSlot);
             updatedSlots.push_back((uint16_t)freeSlot);
             dbChanges->Insert(item);
 
@@ -2115,6 +2123,7 @@ bool CharacterManager::AddRemoveItems(
             return false;
           }
 
+          index.SlotUpdated((size_t)slot);
           dbChanges->Delete(item);
         } else {
           item->SetStackSize(
@@ -2167,15 +2176,10 @@ uint64_t CharacterManager::GetTotalInInventory(
 
   uint64_t totalBaseItem = 0;
   if (isCompressible) {
-    auto baseItems = GetExistingItems(character, itemType, inventory);
-    auto compressedItems =
-        GetExistingItems(character, compressedItemType, inventory);
-
-    for (auto baseItem : baseItems) {
-      totalBaseItem += baseItem->GetStackSize();
-    }
+    InventoryIndex index(inventory);
+    totalBaseItem = index.GetCount(itemType);
 
-    for (auto compressedItem : compressedItems) {
+    for (auto compressedItem : index.GetItems(compressedItemType)) {
       totalBaseItem +=
           (uint64_t)(compressedItem->GetStackSize() * compressorValue);
     }
@@ -2216,6 +2220,9 @@ bool CharacterManager::CalculateCompressibleItemPayment(
   auto character = cState->GetEntity();
   auto inventory = character->GetItemBoxes(0).Get();
 
+  // Nothing is moved while calculating so one index covers every currency
+  InventoryIndex index(inventory);
+
   for (auto& compressibleItemCost : compressibleItemCosts) {
     auto baseItemType = compressibleItemCost.first;
     auto baseItemCost = compressibleItemCost.second;
@@ -2232,9 +2239,8 @@ bool CharacterManager::CalculateCompressibleItemPayment(
       }
     }
 
-    auto baseItems = GetExistingItems(character, baseItemType, inventory);
-    auto compressedItems =
-        GetExistingItems(character, compressedItemType, inventory);
+    auto baseItems = index.GetItems(baseItemType);
+    auto compressedItems = index.GetItems(compressedItemType);
 
     uint64_t totalBaseItem = 0;
     for (auto baseItem : baseItems) {
@@ -2694,30 +2700,10 @@ std::list<std::shared_ptr<objects::ItemDrop>> CharacterManager::DetermineDrops(
 
   for (auto drop : drops) {
     double baseRate = (double)drop->GetRate();
-    uint32_t dropRate = (uint32_t)(baseRate * 100.0);
-    if (luck > 0 && scalingCap != 0.f) {
-      // Scale drop rates based on luck, more for high drop rates and higher
-      // luck. Estimates roughly to: 75% base -> 76.47% at 10 luck, 87.26% at 30
-      // luck, 100+% at 44+ luck 50% base -> 51.83% at 20 luck, 57.05% at 40
-      // luck, 100+% at 114+ luck 10% base -> 10.57% at 40 luck, 22.7% at 200
-      // luck, 100+% at 600+ luck 1% base -> 3.33% at 300 luck, 6.83% at 500
-      // luck, 12.78% at 750 luck 0.1% base -> 0.89% at 600 luck, 1.39% at 800
-      // luck, 1.95% at 999 luck
-      double deltaDiff = (double)(100.0 - baseRate);
-      dropRate = (uint32_t)(
-          baseRate *
-          (100.f +
-           100.f * (float)(((double)luck / 30.0) * 10.0 * (double)luck) /
-               (1000.0 + 7.0 * (double)luck + (deltaDiff * deltaDiff))));
-
-      // Limit luck scaling based on cap
-      if (scalingCap > 0.f &&
-          (float)((double)dropRate / (baseRate * 100.0)) > (1.f + scalingCap)) {
-        dropRate = (uint32_t)(baseRate * 100.0 * (1.0 + (double)scalingCap));
-      }
-    }
-
-    dropRate = (uint32_t)((double)dropRate * (double)(1.f + globalDropBonus));
+    double deltaDiff = (double)(100.0 - baseRate);
+    uint32_t dropRate =
+        DropTable::GetDropRate(baseRate, deltaDiff * deltaDiff, luck,
+                               scalingCap, globalDropBonus);
 
     if (dropRate >= 10000 || RNG(uint16_t, 1, 10000) <= dropRate ||
         (minLast && results.size() == 0 && drops.back() == drop)) {
@@ -2728,13 +2714,76 @@ std::list<std::shared_ptr<objects::ItemDrop>> CharacterManager::DetermineDrops(
   return results;
 }
 
+std::list<std::shared_ptr<objects::ItemDrop>> CharacterManager::DetermineDrops(
+    const std::shared_ptr<objects::DropSet>& dropSet, int16_t luck,
+    bool minLast) {
+  auto table = GetDropTable(dropSet);
+  if (table->Size() == 0) {
+    return {};
+  }
+
+  auto sharedConfig = mServer.lock()->GetWorldSharedConfig();
+  return table->Roll(luck, sharedConfig->GetDropLuckScalingCap(),
+                     sharedConfig->GetDropRateBonus(), minLast);
+}
+
+std::list<std::shared_ptr<objects::ItemDrop>> CharacterManager::DetermineDrops(
+    const std::list<std::shared_ptr<DropTable>>& tables, int16_t luck,
+    bool minLast, const DropTable::Filter_t& filter) {
+  std::list<std::shared_ptr<objects::ItemDrop>> results;
+  if (tables.size() == 0) {
+    return results;
+  }
+
+  auto sharedConfig = mServer.lock()->GetWorldSharedConfig();
+  float globalDropBonus = sharedConfig->GetDropRateBonus();
+  float scalingCap = sharedConfig->GetDropLuckScalingCap();
+
+  std::shared_ptr<objects::ItemDrop> last;
+  for (auto& table : tables) {
+    auto tableLast =
+        table->Roll(luck, scalingCap, globalDropBonus, results, filter);
+    if (tableLast) {
+      last = tableLast;
+    }
+  }
+
+  if (minLast && results.size() == 0 && last) {
+    results.push_back(last);
+  }
+
+  return results;
+}
+
+const std::shared_ptr<DropTable> CharacterManager::GetDropTable(
+    const std::shared_ptr<objects::DropSet>& dropSet) {
+  std::lock_guard<std::mutex> lock(mDropTableLock);
+
+  auto it = mDropTables.find(dropSet->GetID());
+  if (it != mDropTables.end()) {
+    return it->second;
+  }
+
+  // Drop sets do not change once the server data is loaded so the
+  // compiled table can be kept for the life of the server
+  auto table = std::make_shared<DropTable>(dropSet->GetDrops());
+  mDropTables[dropSet->GetID()] = table;
+
+  return table;
+}
+
 bool CharacterManager::CreateLootFromDrops(
     const std::shared_ptr<objects::LootBox>& box,
     const std::list<std::shared_ptr<objects::ItemDrop>>& drops, int16_t luck,
     bool minLast, float maccaRate, float magRate) {
   auto dSet = DetermineDrops(drops, luck, minLast);
-  auto lootItems = CreateLootFromDrops(dSet, maccaRate, magRate);
 
+  return FillLootBox(box, CreateLootFromDrops(dSet, maccaRate, magRate));
+}
+
+bool CharacterManager::FillLootBox(
+    const std::shared_ptr<objects::LootBox>& box,
+    std::list<std::shared_ptr<objects::Loot>> lootItems) {
   bool added = false;
   if (lootItems.size() > 0) {
     for (size_t i = 0; i < box->LootCount(); i++) {
@@ -2758,12 +2807,37 @@ std::list<std::shared_ptr<objects::Loot>> CharacterManager::CreateLootFromDrops(
   auto server = mServer.lock();
   auto definitionManager = server->GetDefinitionManager();
 
-  // Loop through the drops and sum up stacks
-  // Drops can be restricted by active cooldown so make sure not to combine
-  // two stacks with differing cooldown restrictions
-  std::unordered_map<uint32_t, std::unordered_map<int32_t, uint32_t>>
-      itemStacks;
+  // Loop through the drops and sum up stacks in the order each item is
+  // first seen. Drops can be restricted by active cooldown so make sure not
+  // to combine two stacks with differing cooldown restrictions. Drop lists
+  // are short so a flat list is cheaper than a map here.
+  struct ItemStack {
+    uint32_t ItemType;
+    int32_t CooldownRestrict;
+    uint32_t StackSize;
+    bool Valid;
+  };
+
+  std::vector<ItemStack> itemStacks;
+  itemStacks.reserve(drops.size());
   for (auto drop : drops) {
+    uint32_t itemType = drop->GetItemType();
+    int32_t rGroup = drop->GetCooldownRestrict();
+
+    ItemStack* itemStack = nullptr;
+    for (auto& existing : itemStacks) {
+      if (existing.ItemType == itemType &&
+          existing.CooldownRestrict == rGroup) {
+        itemStack = &existing;
+        break;
+      }
+    }
+
+    if (!itemStack) {
+      itemStacks.push_back(ItemStack{itemType, rGroup, 0, false});
+      itemStack = &itemStacks.back();
+    }
+
     uint16_t minStack = drop->GetMinStack();
     uint16_t maxStack = drop->GetMaxStack();
 
@@ -2780,38 +2854,25 @@ std::list<std::shared_ptr<objects::Loot>> CharacterManager::CreateLootFromDrops(
       continue;
     }
 
-    int32_t rGroup = drop->GetCooldownRestrict();
-
-    auto& subset = itemStacks[drop->GetItemType()];
-    auto it = subset.find(rGroup);
-    if (it != subset.end()) {
-      it->second = it->second + (uint32_t)stackSize;
-    } else {
-      subset[rGroup] = (uint32_t)stackSize;
-    }
+    itemStack->StackSize = itemStack->StackSize + (uint32_t)stackSize;
+    itemStack->Valid = true;
   }
 
   // Loop back through and create the items with the combined stacks
   std::list<std::shared_ptr<objects::Loot>> lootItems;
-  for (auto drop : drops) {
-    int32_t rGroup = drop->GetCooldownRestrict();
-
-    auto& subset = itemStacks[drop->GetItemType()];
-
-    auto it = subset.find(rGroup);
-    if (it != subset.end()) {
-      uint32_t stackSize = it->second;
-
-      // Remove it from the set so its not generated twice
-      subset.erase(it);
+  for (auto& itemStack : itemStacks) {
+    if (itemStack.Valid) {
+      uint32_t stackSize = itemStack.StackSize;
+      uint32_t itemType = itemStack.ItemType;
+      int32_t rGroup = itemStack.CooldownRestrict;
 
-      auto itemDef = definitionManager->GetItemData(drop->GetItemType());
+      auto itemDef = definitionManager->GetItemData(itemType);
       if (!itemDef) {
         LogCharacterManagerError([&]() {
           return libcomp::String(
                      "Attempted to create a drop from an invalid item type: "
                      "%1\n")
-              .Arg(drop->GetItemType());
+              .Arg(itemType);
         });
 
         continue;
@@ -2828,7 +2889,7 @@ std::list<std::shared_ptr<objects::Loot>> CharacterManager::CreateLootFromDrops(
         stackSize = (uint32_t)(stackSize - (uint32_t)stack);
 
         auto loot = std::make_shared<objects::Loot>();
-        loot->SetType(drop->GetItemType());
+        loot->SetType(itemType);
         loot->SetCount(stack);
         loot->SetCooldownRestrict(rGroup);
         lootItems.push_back(loot);
@@ -35,8 +35,13 @@
 
 // channel Includes
 #include "ChannelClientConnection.h"
+#include "DropTable.h"
 #include "Zone.h"
 
+// Standard C++11 Includes
+#include <mutex>
+#include <unordered_map>
+
 namespace libcomp {
 class Packet;
 }
@@ -565,6 +570,44 @@ class CharacterManager {
       const std::list<std::shared_ptr<objects::ItemDrop>>& drops, int16_t luck,
       bool minLast = false);
 
+  /**
+   * Filter the item drops of a drop set based on drop rate and luck using
+   * the drop set's compiled drop table.
+   * @param dropSet Pointer to the drop set to determine what should be
+   *  "dropped"
+   * @param luck Current luck value to use when calculating drop chances
+   * @param minLast Optional param to specify if the set needs at least
+   *  one item in which case the last item will be used
+   * @return List of item drops that should be "dropped"
+   */
+  std::list<std::shared_ptr<objects::ItemDrop>> DetermineDrops(
+      const std::shared_ptr<objects::DropSet>& dropSet, int16_t luck,
+      bool minLast = false);
+
+  /**
+   * Filter the item drops of several compiled drop tables based on drop
+   * rate and luck, rolling each table in order as if their drops were one
+   * list.
+   * @param tables List of compiled drop tables to roll
+   * @param luck Current luck value to use when calculating drop chances
+   * @param minLast Optional param to specify if the set needs at least
+   *  one item in which case the last item to pass the filter will be used
+   * @param filter Optional function to skip drops that do not apply
+   * @return List of item drops that should be "dropped"
+   */
+  std::list<std::shared_ptr<objects::ItemDrop>> DetermineDrops(
+      const std::list<std::shared_ptr<DropTable>>& tables, int16_t luck,
+      bool minLast = false, const DropTable::Filter_t& filter = nullptr);
+
+  /**
+   * Get the compiled drop table for a drop set, compiling it the first
+   * time the drop set is used.
+   * @param dropSet Pointer to the drop set
+   * @return Pointer to the drop set's compiled drop table
+   */
+  const std::shared_ptr<DropTable> GetDropTable(
+      const std::shared_ptr<objects::DropSet>& dropSet);
+
   /**
    * Create loot from drops based upon the supplied luck value (can be 0)
    * and add them to the supplied loot box.
@@ -585,6 +628,16 @@ class CharacterManager {
       const std::list<std::shared_ptr<objects::ItemDrop>>& drops, int16_t luck,
       bool minLast = false, float maccaRate = 1.f, float magRate = 1.f);
 
+  /**
+   * Set the loot of a loot box in slot order until either every slot is
+   * set or no loot remains.
+   * @param box Pointer to the loot box
+   * @param lootItems List of pointers to the loot to add
+   * @return true if one or more item was added, false if none were
+   */
+  bool FillLootBox(const std::shared_ptr<objects::LootBox>& box,
+                   std::list<std::shared_ptr<objects::Loot>> lootItems);
+
   /**
    * Create loot from pre-filtered drops
    * @param drops List of pointers to item drops
@@ -1617,6 +1670,12 @@ class CharacterManager {
 
   /// Pointer to the channel server
   std::weak_ptr<ChannelServer> mServer;
+
+  /// Compiled drop tables by drop set ID
+  std::unordered_map<uint32_t, std::shared_ptr<DropTable>> mDropTables;
+
+  /// Server lock for the compiled drop tables
+  std::mutex mDropTableLock;
 };
 
 }  // namespace channel
@@ -4016,18 +4016,32 @@ bool ChatManager::GMCommand_Zone(
             : nullptr;
 
     if (zoneDef) {
-      return SendChatMessage(client, ChatType_t::CHAT_SELF,
-                             libcomp::String("You are in zone %1 (%2)")
-                                 .Arg(zoneData->GetID())
-                                 .Arg(zoneDef->GetBasic()->GetName()));
+      SendChatMessage(client, ChatType_t::CHAT_SELF,
+                      libcomp::String("You are in zone %1 (%2)")
+                          .Arg(zoneData->GetID())
+                          .Arg(zoneDef->GetBasic()->GetName()));
     } else if (zoneData) {
-      return SendChatMessage(
+      SendChatMessage(
           client, ChatType_t::CHAT_SELF,
           libcomp::String("You are in zone %1").Arg(zoneData->GetID()));
     } else {
       return SendChatMessage(client, ChatType_t::CHAT_SELF,
                              "You are (somehow) in the twilight zone");
     }
+
+    // Report AI level of detail tiers if any entity is not at full detail
+    uint32_t full = 0, reduced = 0, dormant = 0;
+    zone->GetAILODCounts(full, reduced, dormant);
+    if (reduced || dormant) {
+      SendChatMessage(
+          client, ChatType_t::CHAT_SELF,
+          libcomp::String("AI detail: %1 full, %2 reduced, %3 dormant")
+              .Arg(full)
+              .Arg(reduced)
+              .Arg(dormant));
+    }
+
+    return true;
   } else if (4 >= args.size()) {
     bool getDynamicMapID = args.size() == 2 || args.size() == 4;
 
@@ -0,0 +1,123 @@
+/**
+ * @file server/channel/src/DropTable.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Pre-compiled, immutable form of a drop set used to roll drops.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DropTable.h"
+
+// libcomp Includes
+#include <Randomizer.h>
+
+// object Includes
+#include <ItemDrop.h>
+
+using namespace channel;
+
+DropTable::DropTable(
+    const std::list<std::shared_ptr<objects::ItemDrop>>& drops) {
+  mEntries.reserve(drops.size());
+  for (auto drop : drops) {
+    Entry entry;
+    entry.Drop = drop;
+    entry.BaseRate = (double)drop->GetRate();
+
+    double deltaDiff = (double)(100.0 - entry.BaseRate);
+    entry.DeltaSquared = deltaDiff * deltaDiff;
+
+    mEntries.push_back(entry);
+  }
+}
+
+std::list<std::shared_ptr<objects::ItemDrop>> DropTable::Roll(
+    int16_t luck, float scalingCap, float dropBonus, bool minLast) const {
+  std::list<std::shared_ptr<objects::ItemDrop>> results;
+
+  auto last = Roll(luck, scalingCap, dropBonus, results);
+  if (minLast && results.size() == 0 && last) {
+    results.push_back(last);
+  }
+
+  return results;
+}
+
+std::shared_ptr<objects::ItemDrop> DropTable::Roll(
+    int16_t luck, float scalingCap, float dropBonus,
+    std::list<std::shared_ptr<objects::ItemDrop>>& results,
+    const Filter_t& filter) const {
+  const Entry* last = nullptr;
+  for (auto& entry : mEntries) {
+    if (filter && !filter(*entry.Drop)) {
+      continue;
+    }
+
+    last = &entry;
+
+    uint32_t dropRate = GetDropRate(entry.BaseRate, entry.DeltaSquared, luck,
+                                    scalingCap, dropBonus);
+    if (dropRate >= 10000 || RNG(uint16_t, 1, 10000) <= dropRate) {
+      results.push_back(entry.Drop);
+    }
+  }
+
+  return last ? last->Drop : nullptr;
+}
+
+void DropTable::GetDrops(std::list<std::shared_ptr<objects::ItemDrop>>& drops,
+                         const Filter_t& filter) const {
+  for (auto& entry : mEntries) {
+    if (!filter || filter(*entry.Drop)) {
+      drops.push_back(entry.Drop);
+    }
+  }
+}
+
+size_t DropTable::Size() const { return mEntries.size(); }
+
+uint32_t DropTable::GetDropRate(double baseRate, double deltaSquared,
+                                int16_t luck, float scalingCap,
+                                float dropBonus) {
+  uint32_t dropRate = (uint32_t)(baseRate * 100.0);
+  if (luck > 0 && scalingCap != 0.f) {
+    // Scale drop rates based on luck, more for high drop rates and higher
+    // luck. Estimates roughly to: 75% base -> 76.47% at 10 luck, 87.26% at 30
+    // luck, 100+% at 44+ luck 50% base -> 51.83% at 20 luck, 57.05% at 40
+    // luck, 100+% at 114+ luck 10% base -> 10.57% at 40 luck, 22.7% at 200
+    // luck, 100+% at 600+ luck 1% base -> 3.33% at 300 luck, 6.83% at 500
+    // luck, 12.78% at 750 luck 0.1% base -> 0.89% at 600 luck, 1.39% at 800
+    // luck, 1.95% at 999 luck
+    dropRate = (uint32_t)(
+        baseRate *
+        (100.f +
+         100.f * (float)(((double)luck / 30.0) * 10.0 * (double)luck) /
+             (1000.0 + 7.0 * (double)luck + deltaSquared)));
+
+    // Limit luck scaling based on cap
+    if (scalingCap > 0.f &&
+        (float)((double)dropRate / (baseRate * 100.0)) > (1.f + scalingCap)) {
+      dropRate = (uint32_t)(baseRate * 100.0 * (1.0 + (double)scalingCap));
+    }
+  }
+
+  return (uint32_t)((double)dropRate * (double)(1.f + dropBonus));
+}
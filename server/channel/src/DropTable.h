@@ -0,0 +1,138 @@
+/**
+ * @file server/channel/src/DropTable.h
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Pre-compiled, immutable form of a drop set used to roll drops.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_DROPTABLE_H
+#define SERVER_CHANNEL_SRC_DROPTABLE_H
+
+// Standard C++11 includes
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace objects {
+class ItemDrop;
+}  // namespace objects
+
+namespace channel {
+
+/**
+ * Immutable list of item drops with every per-drop term of the drop rate
+ * calculation resolved up front. Each drop is an independent roll so the
+ * table is stored as a flat array that can be walked without touching
+ * the drop definitions until a drop succeeds.
+ */
+class DropTable {
+ public:
+  /// Function used to skip drops that do not apply to the current roll.
+  /// Drops it returns false for are skipped without drawing a roll.
+  typedef std::function<bool(const objects::ItemDrop&)> Filter_t;
+
+  /**
+   * Create a new drop table
+   * @param drops List of pointers to the item drops to compile
+   */
+  DropTable(const std::list<std::shared_ptr<objects::ItemDrop>>& drops);
+
+  /**
+   * Roll every drop in the table.
+   * @param luck Current luck value to use when calculating drop chances
+   * @param scalingCap Maximum bonus luck can add to a drop rate
+   * @param dropBonus Global drop rate bonus to apply
+   * @param minLast true if the result needs at least one item in which
+   *  case the last item will be used
+   * @return List of item drops that should be "dropped"
+   */
+  std::list<std::shared_ptr<objects::ItemDrop>> Roll(int16_t luck,
+                                                     float scalingCap,
+                                                     float dropBonus,
+                                                     bool minLast) const;
+
+  /**
+   * Roll every drop in the table that passes a filter and add the ones
+   * that succeed to a result list. Several tables can be rolled into the
+   * same list one after another.
+   * @param luck Current luck value to use when calculating drop chances
+   * @param scalingCap Maximum bonus luck can add to a drop rate
+   * @param dropBonus Global drop rate bonus to apply
+   * @param results List to add item drops that should be "dropped" to
+   * @param filter Optional function to skip drops with
+   * @return Pointer to the last drop in the table that passed the filter
+   *  or null if none did
+   */
+  std::shared_ptr<objects::ItemDrop> Roll(
+      int16_t luck, float scalingCap, float dropBonus,
+      std::list<std::shared_ptr<objects::ItemDrop>>& results,
+      const Filter_t& filter = nullptr) const;
+
+  /**
+   * Get every drop in the table that passes a filter without rolling
+   * @param drops List to add the drops to
+   * @param filter Optional function to skip drops with
+   */
+  void GetDrops(std::list<std::shared_ptr<objects::ItemDrop>>& drops,
+                const Filter_t& filter = nullptr) const;
+
+  /**
+   * Get the number of drops in the table
+   * @return Number of drops
+   */
+  size_t Size() const;
+
+  /**
+   * Calculate the chance out of 10000 that a drop succeeds
+   * @param baseRate Percent drop rate of the drop definition
+   * @param deltaSquared Square of the distance between the base rate and
+   *  100 percent
+   * @param luck Current luck value to use when calculating drop chances
+   * @param scalingCap Maximum bonus luck can add to a drop rate
+   * @param dropBonus Global drop rate bonus to apply
+   * @return Drop chance out of 10000, which can exceed 10000
+   */
+  static uint32_t GetDropRate(double baseRate, double deltaSquared,
+                              int16_t luck, float scalingCap,
+                              float dropBonus);
+
+ private:
+  /// Compiled form of a single item drop
+  struct Entry {
+    /// Pointer to the drop definition
+    std::shared_ptr<objects::ItemDrop> Drop;
+
+    /// Percent drop rate of the drop definition
+    double BaseRate;
+
+    /// Square of the distance between the base rate and 100 percent
+    double DeltaSquared;
+  };
+
+  /// Compiled drops in definition order
+  std::vector<Entry> mEntries;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_DROPTABLE_H
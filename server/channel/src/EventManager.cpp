@@ -890,7 +890,7 @@ bool EventManager::EvaluateEventCondition(
         engine->Using<Zone>();
         engine->Using<libcomp::Randomizer>();
 
-        if (engine->Eval(script->Source)) {
+        if (engine->EvalServerScript(*script)) {
           Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
 
           Sqrat::Array sqParams(engine->GetVM());
@@ -3092,8 +3092,7 @@ void EventManager::AddDemonQuestRewards(
         auto dropSet = serverDataManager->GetDropSetData(dropSetID);
         if (!dropSet) continue;
 
-        for (auto drop :
-             characterManager->DetermineDrops(dropSet->GetDrops(), 0)) {
+        for (auto drop : characterManager->DetermineDrops(dropSet, 0)) {
           dQuest->SetRewardItems(
               drop->GetItemType(),
               RNG(uint16_t, drop->GetMinStack(), drop->GetMaxStack()));
@@ -3125,8 +3124,7 @@ void EventManager::AddDemonQuestRewards(
           auto dropSet = serverDataManager->GetDropSetData(dropSetID);
           if (!dropSet) continue;
 
-          for (auto drop :
-               characterManager->DetermineDrops(dropSet->GetDrops(), 0)) {
+          for (auto drop : characterManager->DetermineDrops(dropSet, 0)) {
             drops.push_back(drop);
           }
         }
@@ -3238,8 +3236,7 @@ void EventManager::AddDemonQuestRewards(
       auto dropSet = serverDataManager->GetDropSetData(dropSetID);
       if (!dropSet) continue;
 
-      for (auto drop :
-           characterManager->DetermineDrops(dropSet->GetDrops(), 0)) {
+      for (auto drop : characterManager->DetermineDrops(dropSet, 0)) {
         drops.push_back(drop);
       }
     }
@@ -3786,7 +3783,7 @@ void EventManager::HandleNext(EventContext& ctx) {
         engine->Using<Zone>();
         engine->Using<libcomp::Randomizer>();
 
-        if (engine->Eval(script->Source)) {
+        if (engine->EvalServerScript(*script)) {
           Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
 
           Sqrat::Array sqParams(engine->GetVM());
@@ -0,0 +1,144 @@
+/**
+ * @file server/channel/src/InventoryIndex.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Index of the items in an item box by item type.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InventoryIndex.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+
+// object Includes
+#include <Item.h>
+#include <ItemBox.h>
+
+using namespace channel;
+
+InventoryIndex::InventoryIndex(const std::shared_ptr<objects::ItemBox>& box)
+    : mBox(box), mFreeSlots(0) {
+  for (size_t i = 0; i < SLOT_COUNT; i++) {
+    AddSlot(i);
+  }
+}
+
+std::list<std::shared_ptr<objects::Item>> InventoryIndex::GetItems(
+    uint32_t itemType) const {
+  std::list<std::shared_ptr<objects::Item>> items;
+
+  auto it = mSlots.find(itemType);
+  if (it == mSlots.end()) {
+    return items;
+  }
+
+  auto boxUUID = mBox->GetUUID();
+  for (size_t slot : it->second) {
+    // Make sure nothing is somehow added twice
+    auto item = mItems[slot];
+    if (item->GetItemBox() == boxUUID &&
+        std::find(items.begin(), items.end(), item) == items.end()) {
+      items.push_back(item);
+    }
+  }
+
+  return items;
+}
+
+std::list<std::shared_ptr<objects::Item>> InventoryIndex::GetPartialStacks(
+    uint32_t itemType, uint16_t maxStack) const {
+  auto items = GetItems(itemType);
+  items.remove_if([maxStack](const std::shared_ptr<objects::Item>& item) {
+    return item->GetStackSize() >= maxStack;
+  });
+
+  return items;
+}
+
+uint64_t InventoryIndex::GetCount(uint32_t itemType) const {
+  uint64_t count = 0;
+  for (auto item : GetItems(itemType)) {
+    count += (uint64_t)item->GetStackSize();
+  }
+
+  return count;
+}
+
+std::list<size_t> InventoryIndex::GetFreeSlots() const {
+  std::list<size_t> slots;
+  for (size_t i = 0; i < SLOT_COUNT; i++) {
+    if (mFreeSlots & ((uint64_t)1 << i)) {
+      slots.push_back(i);
+    }
+  }
+
+  return slots;
+}
+
+size_t InventoryIndex::GetFreeSlotCount() const {
+  size_t count = 0;
+  for (uint64_t bits = mFreeSlots; bits; bits &= bits - 1) {
+    count++;
+  }
+
+  return count;
+}
+
+void InventoryIndex::SlotUpdated(size_t slot) {
+  if (slot >= SLOT_COUNT) {
+    return;
+  }
+
+  if (mItems[slot]) {
+    auto it = mSlots.find(mTypes[slot]);
+    if (it != mSlots.end()) {
+      auto& slots = it->second;
+      slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+      if (slots.empty()) {
+        mSlots.erase(it);
+      }
+    }
+
+    mItems[slot] = nullptr;
+  }
+
+  mFreeSlots &= ~((uint64_t)1 << slot);
+
+  AddSlot(slot);
+}
+
+void InventoryIndex::AddSlot(size_t slot) {
+  auto ref = mBox->GetItems(slot);
+  if (ref.IsNull()) {
+    mFreeSlots |= (uint64_t)1 << slot;
+    return;
+  }
+
+  auto item = ref.Get();
+  if (item) {
+    mItems[slot] = item;
+    mTypes[slot] = item->GetType();
+
+    auto& slots = mSlots[mTypes[slot]];
+    slots.insert(std::upper_bound(slots.begin(), slots.end(), slot), slot);
+  }
+}
@@ -0,0 +1,131 @@
+/**
+ * @file server/channel/src/InventoryIndex.h
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Index of the items in an item box by item type.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_INVENTORYINDEX_H
+#define SERVER_CHANNEL_SRC_INVENTORYINDEX_H
+
+// Standard C++11 includes
+#include <array>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace objects {
+class Item;
+class ItemBox;
+}  // namespace objects
+
+namespace channel {
+
+/**
+ * Index of the items in an item box by item type along with a bitmap of
+ * the free slots, built with a single pass over the box. Operations that
+ * look up several item types in the same box should build one index and
+ * query it instead of scanning every slot for each item type. Stack sizes
+ * are always read from the items themselves but any change to which item
+ * is in which slot must be reported with SlotUpdated while the index is
+ * in use.
+ */
+class InventoryIndex {
+ public:
+  /// Number of slots in an item box
+  static const size_t SLOT_COUNT = 50;
+
+  /**
+   * Create a new index of an item box
+   * @param box Pointer to the item box to index
+   */
+  InventoryIndex(const std::shared_ptr<objects::ItemBox>& box);
+
+  /**
+   * Get the items of a specific type in the box in slot order
+   * @param itemType Item type to retrieve
+   * @return List of pointers to the items of the requested type
+   */
+  std::list<std::shared_ptr<objects::Item>> GetItems(uint32_t itemType) const;
+
+  /**
+   * Get the items of a specific type in the box that are not at their
+   * max stack size in slot order
+   * @param itemType Item type to retrieve
+   * @param maxStack Max stack size of the item type
+   * @return List of pointers to the partial stacks of the requested type
+   */
+  std::list<std::shared_ptr<objects::Item>> GetPartialStacks(
+      uint32_t itemType, uint16_t maxStack) const;
+
+  /**
+   * Get the total stack size of all items of a specific type in the box
+   * @param itemType Item type to count
+   * @return Total stack size of the item type
+   */
+  uint64_t GetCount(uint32_t itemType) const;
+
+  /**
+   * Get the free slots in the box
+   * @return List of free slots in ascending order
+   */
+  std::list<size_t> GetFreeSlots() const;
+
+  /**
+   * Get the number of free slots in the box
+   * @return Number of free slots
+   */
+  size_t GetFreeSlotCount() const;
+
+  /**
+   * Re-read a slot from the box after the item assigned to it changed
+   * @param slot Slot that was updated
+   */
+  void SlotUpdated(size_t slot);
+
+ private:
+  /**
+   * Add the item currently in a slot of the box to the index
+   * @param slot Slot to add
+   */
+  void AddSlot(size_t slot);
+
+  /// Pointer to the indexed item box
+  std::shared_ptr<objects::ItemBox> mBox;
+
+  /// Items in each slot of the box
+  std::array<std::shared_ptr<objects::Item>, SLOT_COUNT> mItems;
+
+  /// Item type each slot is indexed under
+  std::array<uint32_t, SLOT_COUNT> mTypes;
+
+  /// Slots containing each item type in ascending order
+  std::unordered_map<uint32_t, std::vector<size_t>> mSlots;
+
+  /// Bitmap of the free slots in the box
+  uint64_t mFreeSlots;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_INVENTORYINDEX_H
@@ -54,8 +54,21 @@ void PerformanceTimer::Stop(const libcomp::String& metric) {
   if (mEnabled) {
     ServerTime diff = mServer->GetServerTime() - mStart;
 
-    LogGeneralDebug([&]() {
-      return libcomp::String("PERF: %1 in %2 us\n").Arg(metric).Arg(diff);
-    });
+    // Formatted by the log writer thread when async logging is enabled.
+    LogPerformanceDebugDelayed(
+        [](libcomp::String name, ServerTime elapsed) {
+          return libcomp::String("PERF: %1 in %2 us\n").Arg(name).Arg(elapsed);
+        },
+        libcomp::String(metric), (ServerTime)diff);
+  }
+}
+
+void PerformanceTimer::Count(const libcomp::String& metric, uint64_t count) {
+  if (mEnabled) {
+    LogPerformanceDebugDelayed(
+        [](libcomp::String name, uint64_t value) {
+          return libcomp::String("PERF: %1 = %2\n").Arg(name).Arg(value);
+        },
+        libcomp::String(metric), (uint64_t)count);
   }
 }
@@ -72,6 +72,13 @@ class PerformanceTimer {
    * @param metric Name of the task that was measured.
    */
   void Stop(const libcomp::String &metric);
+
+  /**
+   * Log a counted value alongside the performance measurements.
+   * @param metric Name of the value that was counted.
+   * @param count Value to log.
+   */
+  void Count(const libcomp::String &metric, uint64_t count);
 };
 
 }  // namespace channel
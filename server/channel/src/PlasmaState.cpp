@@ -186,6 +186,35 @@ bool PlasmaState::HasStateChangePoints(bool respawn, uint64_t now) {
   return false;
 }
 
+bool PlasmaState::GetNextStateChange(uint64_t& time) {
+  bool found = false;
+
+  std::lock_guard<std::mutex> lock(mLock);
+
+  // Points will not respawn if enabled but still deactivated
+  if (!mDisabled && !mDeactivated) {
+    for (auto pair : mPoints) {
+      if (pair.second->mHidden) {
+        auto rIter = mPointRespawns.find(pair.second->GetID());
+        uint64_t t = rIter != mPointRespawns.end() ? rIter->second : 0;
+        if (!found || t < time) {
+          time = t;
+          found = true;
+        }
+      }
+    }
+  }
+
+  for (auto pair : mPointHides) {
+    if (!found || pair.second < time) {
+      time = pair.second;
+      found = true;
+    }
+  }
+
+  return found;
+}
+
 std::list<std::shared_ptr<PlasmaPoint>> PlasmaState::PopRespawnPoints(
     uint64_t now) {
   if (now == 0) {
@@ -162,6 +162,16 @@ class PlasmaState : public EntityState<objects::PlasmaSpawn> {
    */
   bool HasStateChangePoints(bool respawn, uint64_t now = 0);
 
+  /**
+   * Get the earliest server time any point will need to be hidden or
+   * respawned
+   * @param time Output parameter to set the time to, a time in the past
+   *  means a change is already pending
+   * @return true if any point has a pending change, false if nothing will
+   *  change until the state is updated again
+   */
+  bool GetNextStateChange(uint64_t& time);
+
   /**
    * Get a list of plasma points that have respawned
    * and prepare them to be shown within the state
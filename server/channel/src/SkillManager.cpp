@@ -33,6 +33,7 @@
 #include <Log.h>
 #include <ManagerPacket.h>
 #include <PacketCodes.h>
+#include <PacketPool.h>
 #include <Randomizer.h>
 #include <ServerConstants.h>
 #include <ServerDataManager.h>
@@ -449,7 +450,7 @@ void SkillManager::LoadScripts() {
   for (auto def : scriptDefs) {
     auto script = std::make_shared<libhack::ScriptEngine>();
 
-    if (!script->Eval(def->Source)) {
+    if (!script->EvalServerScript(*def)) {
       LogSkillManagerError([def]() {
         return libcomp::String("Failed to prepare skill logic script: %1\n")
             .Arg(def->Name);
@@ -6761,25 +6762,7 @@ void SkillManager::HandleKills(
         }
       }
 
-      auto drops = GetItemDrops(source, eState, sourceClient, zone);
-
-      // Remove cooldown restricted drops
-      std::set<int32_t> invalid;
-      for (auto& pair : drops) {
-        for (auto loot : pair.second) {
-          int32_t cd = loot->GetCooldownRestrict();
-          if (cd) {
-            if (sourceCooldowns.find(cd) == sourceCooldowns.end()) {
-              invalid.insert(cd);
-            }
-          }
-        }
-
-        pair.second.remove_if(
-            [invalid](const std::shared_ptr<objects::ItemDrop>& drop) {
-              return invalid.find(drop->GetCooldownRestrict()) != invalid.end();
-            });
-      }
+      auto tables = GetItemDropTables(eState, sourceClient, zone);
 
       if (validLooterIDs.size() > 0) {
         lootBody->SetValidLooterIDs(validLooterIDs);
@@ -6791,12 +6774,15 @@ void SkillManager::HandleKills(
         }
       }
 
-      auto nDrops = drops[(uint8_t)objects::DropSet::Type_t::NORMAL];
-      auto dDrops = drops[(uint8_t)objects::DropSet::Type_t::DESTINY];
+      auto nDrops =
+          RollItemDrops(tables[(uint8_t)objects::DropSet::Type_t::NORMAL],
+                        source, eState, luck, false, &sourceCooldowns);
+      auto& dTables = tables[(uint8_t)objects::DropSet::Type_t::DESTINY];
 
       uint64_t lootTime = 0;
-      if (characterManager->CreateLootFromDrops(lootBody, nDrops, luck, false,
-                                                maccaRate, magRate)) {
+      if (characterManager->FillLootBox(
+              lootBody, characterManager->CreateLootFromDrops(
+                            nDrops, maccaRate, magRate))) {
         // Bodies remain lootable for 120 seconds with loot
         lootTime = (uint64_t)(now + 120000000);
       } else {
@@ -6811,12 +6797,10 @@ void SkillManager::HandleKills(
         zoneManager->SendLootBoxData(firstClient, lState, eState, true, true);
       }
 
-      if (dDrops.size() > 0 && instance && sourceState) {
+      if (dTables.size() > 0 && instance && sourceState) {
         // Always add at least one item
-        auto filtered = characterManager->DetermineDrops(dDrops, 0, false);
-        if (filtered.size() == 0) {
-          filtered = {libcomp::Randomizer::GetEntry(dDrops)};
-        }
+        auto filtered = RollItemDrops(dTables, source, eState, 0, false,
+                                      &sourceCooldowns, true);
 
         if (filtered.size() > 0) {
           // Create loot one drop at a time so we don't combine
@@ -7947,10 +7931,12 @@ void SkillManager::HandleNegotiations(
           lBox->SetType(objects::LootBox::Type_t::GIFT_BOX);
           lBox->SetEnemy(enemy);
 
-          auto drops = GetItemDrops(source, eState, sourceClient, zone, true);
-          auto gifts = drops[(uint8_t)objects::DropSet::Type_t::NORMAL];
-          characterManager->CreateLootFromDrops(lBox, gifts, source->GetLUCK(),
-                                                true);
+          auto tables = GetItemDropTables(eState, sourceClient, zone, true);
+          auto gifts =
+              RollItemDrops(tables[(uint8_t)objects::DropSet::Type_t::NORMAL],
+                            source, eState, source->GetLUCK(), true);
+          characterManager->FillLootBox(
+              lBox, characterManager->CreateLootFromDrops(gifts));
 
           fGainPossible = true;
         } break;
@@ -9569,19 +9555,17 @@ int8_t SkillManager::CalculateStatusEffectStack(int8_t minStack,
              : (int8_t)RNG(int16_t, (int16_t)minStack, (int16_t)maxStack);
 }
 
-std::unordered_map<uint8_t, std::list<std::shared_ptr<objects::ItemDrop>>>
-SkillManager::GetItemDrops(
-    const std::shared_ptr<ActiveEntityState>& source,
+std::unordered_map<uint8_t, std::list<std::shared_ptr<DropTable>>>
+SkillManager::GetItemDropTables(
     const std::shared_ptr<ActiveEntityState>& eState,
     const std::shared_ptr<ChannelClientConnection>& client,
     const std::shared_ptr<Zone>& zone, bool giftMode) {
-  std::unordered_map<uint8_t, std::list<std::shared_ptr<objects::ItemDrop>>>
-      drops;
+  std::unordered_map<uint8_t, std::list<std::shared_ptr<DropTable>>> tables;
 
   auto eBase = eState ? eState->GetEnemyBase() : nullptr;
   auto spawn = eBase ? eBase->GetSpawnSource() : nullptr;
   if (!spawn) {
-    return drops;
+    return tables;
   }
 
   auto server = mServer.lock();
@@ -9590,11 +9574,10 @@ SkillManager::GetItemDrops(
 
   // Add specific spawn drops, then drop sets
   std::list<uint32_t> dropSetIDs;
-  std::unordered_map<uint8_t, std::list<std::shared_ptr<objects::ItemDrop>>>
-      dropsTemp;
   if (giftMode) {
-    for (auto gift : spawn->GetGifts()) {
-      dropsTemp[(uint8_t)objects::DropSet::Type_t::NORMAL].push_back(gift);
+    if (spawn->GiftsCount() > 0) {
+      tables[(uint8_t)objects::DropSet::Type_t::NORMAL].push_back(
+          std::make_shared<DropTable>(spawn->GetGifts()));
     }
 
     for (uint32_t giftSetID : spawn->GetGiftSetIDs()) {
@@ -9616,8 +9599,9 @@ SkillManager::GetItemDrops(
       }
     }
   } else {
-    for (auto drop : spawn->GetDrops()) {
-      dropsTemp[(uint8_t)objects::DropSet::Type_t::NORMAL].push_back(drop);
+    if (spawn->DropsCount() > 0) {
+      tables[(uint8_t)objects::DropSet::Type_t::NORMAL].push_back(
+          std::make_shared<DropTable>(spawn->GetDrops()));
     }
 
     for (uint32_t dropSetID : spawn->GetDropSetIDs()) {
@@ -9640,46 +9624,70 @@ SkillManager::GetItemDrops(
     }
   }
 
-  // Get drops from drop sets
+  // Drop sets use the tables compiled once for the life of the server
   for (auto dropSet :
        characterManager->DetermineDropSets(dropSetIDs, zone, client)) {
-    uint8_t type = (uint8_t)dropSet->GetType();
-    for (auto drop : dropSet->GetDrops()) {
-      dropsTemp[type].push_back(drop);
+    tables[(uint8_t)dropSet->GetType()].push_back(
+        characterManager->GetDropTable(dropSet));
+  }
+
+  return tables;
+}
+
+std::list<std::shared_ptr<objects::ItemDrop>> SkillManager::RollItemDrops(
+    const std::list<std::shared_ptr<DropTable>>& tables,
+    const std::shared_ptr<ActiveEntityState>& source,
+    const std::shared_ptr<ActiveEntityState>& eState, int16_t luck,
+    bool minLast, const std::set<int32_t>* sourceCooldowns, bool fallback) {
+  auto characterManager = mServer.lock()->GetCharacterManager();
+
+  auto filter = [source, eState,
+                 sourceCooldowns](const objects::ItemDrop& drop) {
+    // Drops restricted by cooldown only apply while the source has the
+    // cooldown active
+    int32_t cd = drop.GetCooldownRestrict();
+    if (cd && sourceCooldowns &&
+        sourceCooldowns->find(cd) == sourceCooldowns->end()) {
+      return false;
+    }
+
+    // Only add if the (non-source) relative entity's level is at least
+    // the same as the source's level + the modifier
+    if (drop.GetType() == objects::ItemDrop::Type_t::RELATIVE_LEVEL_MIN) {
+      return eState != source &&
+             (int32_t)eState->GetLevel() >=
+                 (int32_t)(source->GetLevel() + drop.GetModifier());
+    }
+
+    return true;
+  };
+
+  auto drops = characterManager->DetermineDrops(tables, luck, minLast, filter);
+  if (drops.size() == 0 && fallback) {
+    std::list<std::shared_ptr<objects::ItemDrop>> candidates;
+    for (auto& table : tables) {
+      table->GetDrops(candidates, filter);
+    }
+
+    if (candidates.size() > 0) {
+      drops.push_back(libcomp::Randomizer::GetEntry(candidates));
     }
   }
 
-  // Now apply special drop definitions
-  for (auto& pair : dropsTemp) {
-    auto type = pair.first;
-    for (auto drop : pair.second) {
-      switch (drop->GetType()) {
-        case objects::ItemDrop::Type_t::LEVEL_MULTIPLY: {
-          // Copy the drop and scale stacks
-          auto copy = std::make_shared<objects::ItemDrop>(*drop);
+  // Now apply special drop definitions to the drops that succeeded
+  for (auto& drop : drops) {
+    if (drop->GetType() == objects::ItemDrop::Type_t::LEVEL_MULTIPLY) {
+      // Copy the drop and scale stacks
+      auto copy = std::make_shared<objects::ItemDrop>(*drop);
 
-          uint16_t min = copy->GetMinStack();
-          uint16_t max = copy->GetMaxStack();
-          float multiplier = (float)eState->GetLevel() * copy->GetModifier();
+      uint16_t min = copy->GetMinStack();
+      uint16_t max = copy->GetMaxStack();
+      float multiplier = (float)eState->GetLevel() * copy->GetModifier();
 
-          copy->SetMinStack((uint16_t)((float)min * multiplier));
-          copy->SetMaxStack((uint16_t)((float)max * multiplier));
+      copy->SetMinStack((uint16_t)((float)min * multiplier));
+      copy->SetMaxStack((uint16_t)((float)max * multiplier));
 
-          drops[type].push_back(copy);
-        } break;
-        case objects::ItemDrop::Type_t::RELATIVE_LEVEL_MIN:
-          // Only add if the (non-source) relative entity's level is
-          // at least the same as the source's level + the modifier
-          if (eState != source &&
-              (int32_t)eState->GetLevel() >=
-                  (int32_t)(source->GetLevel() + drop->GetModifier())) {
-            drops[type].push_back(drop);
-          }
-          break;
-        case objects::ItemDrop::Type_t::NORMAL:
-          drops[type].push_back(drop);
-          break;
-      }
+      drop = copy;
     }
   }
 
@@ -11310,7 +11318,7 @@ bool SkillManager::RandomItem(
   }
 
   // Get one drop from the set
-  auto drops = characterManager->DetermineDrops(dropSet->GetDrops(), 0, true);
+  auto drops = characterManager->DetermineDrops(dropSet, 0, true);
   auto drop = libcomp::Randomizer::GetEntry(drops);
   if (!drop) {
     SendFailure(activated, client, (uint8_t)SkillErrorCodes_t::ITEM_USE);
@@ -12407,7 +12415,8 @@ void SkillManager::SendExecuteSkill(
 
     RelativeTimeMap timeMap;
 
-    libcomp::Packet p;
+    libhack::PooledPacket pooled;
+    libcomp::Packet& p = *pooled;
     p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_SKILL_EXECUTED);
     p.WriteS32Little(source->GetEntityID());
     p.WriteU32Little(pSkill->SkillID);
@@ -12466,7 +12475,8 @@ void SkillManager::SendExecuteSkillInstant(
 
     RelativeTimeMap timeMap;
 
-    libcomp::Packet p;
+    libhack::PooledPacket pooled;
+    libcomp::Packet& p = *pooled;
     p.WritePacketCode(
         ChannelToClientPacketCode_t::PACKET_SKILL_EXECUTED_INSTANT);
     p.WriteU8(errorCode);
@@ -12507,7 +12517,8 @@ void SkillManager::SendCompleteSkill(
   if (zConnections.size() > 0) {
     RelativeTimeMap timeMap;
 
-    libcomp::Packet p;
+    libhack::PooledPacket pooled;
+    libcomp::Packet& p = *pooled;
     p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_SKILL_COMPLETED);
     p.WriteS32Little(source->GetEntityID());
     p.WriteU32Little(activated->GetSkillData()->GetCommon()->GetID());
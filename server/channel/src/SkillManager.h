@@ -60,6 +60,7 @@ class SkillTargetResult;
 class ActiveEntityState;
 class AIState;
 class ChannelServer;
+class DropTable;
 
 /**
  * Container for skill execution contextual parameters.
@@ -1014,9 +1015,8 @@ class SkillManager {
   int8_t CalculateStatusEffectStack(int8_t minStack, int8_t maxStack) const;
 
   /**
-   * Gather drops for a specific enemy spawn from its own drops, global drops
-   * and demon family drops.
-   * @param source Pointer to the entity that activated the skill
+   * Gather the compiled drop tables for a specific enemy spawn from its own
+   * drops, global drops and demon family drops.
    * @param eState Pointer to enemy which may or may not have spawn
    *  information (ex: GM created enemy)
    * @param client Pointer to the client connection related to the source,
@@ -1024,14 +1024,37 @@ class SkillManager {
    * @param zone Pointer to the zone the entities belong to
    * @param giftMode true if the enemy's negotation gifts should be gathered
    *  instead of their normal drops
-   * @return Map of drop set types to list of item drops from each different
-   *  source
-   */
-  std::unordered_map<uint8_t, std::list<std::shared_ptr<objects::ItemDrop>>>
-  GetItemDrops(const std::shared_ptr<ActiveEntityState>& source,
-               const std::shared_ptr<ActiveEntityState>& eState,
-               const std::shared_ptr<ChannelClientConnection>& client,
-               const std::shared_ptr<Zone>& zone, bool giftMode = false);
+   * @return Map of drop set types to the drop tables of each different
+   *  source, in roll order
+   */
+  std::unordered_map<uint8_t, std::list<std::shared_ptr<DropTable>>>
+  GetItemDropTables(const std::shared_ptr<ActiveEntityState>& eState,
+                    const std::shared_ptr<ChannelClientConnection>& client,
+                    const std::shared_ptr<Zone>& zone, bool giftMode = false);
+
+  /**
+   * Roll the drop tables gathered for an enemy. Drops that do not apply to
+   * the source are skipped without being rolled and level scaled drops
+   * that succeed have their stacks scaled.
+   * @param tables List of drop tables to roll, in order
+   * @param source Pointer to the entity that activated the skill
+   * @param eState Pointer to the enemy the drops belong to
+   * @param luck Current luck value to use when calculating drop chances
+   * @param minLast true if at least one item is needed in which case the
+   *  last applicable item will be used
+   * @param sourceCooldowns Optional set of cooldown restrictions active
+   *  on the source. If supplied, drops with a cooldown restriction not in
+   *  the set are skipped.
+   * @param fallback true if a random applicable drop should be used when
+   *  nothing is dropped
+   * @return List of item drops that should be "dropped"
+   */
+  std::list<std::shared_ptr<objects::ItemDrop>> RollItemDrops(
+      const std::list<std::shared_ptr<DropTable>>& tables,
+      const std::shared_ptr<ActiveEntityState>& source,
+      const std::shared_ptr<ActiveEntityState>& eState, int16_t luck,
+      bool minLast, const std::set<int32_t>* sourceCooldowns = nullptr,
+      bool fallback = false);
 
   /**
    * Schedule the adjustment of who is a valid looter for one or more loot
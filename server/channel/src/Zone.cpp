@@ -32,6 +32,7 @@
 
 // C++ Standard Includes
 #include <cmath>
+#include <limits>
 
 // object Includes
 #include <ActionSpawn.h>
@@ -123,8 +124,10 @@ BaseScriptEngine& BaseScriptEngine::Using<Zone>() {
 }  // namespace libcomp
 
 Zone::Zone(uint32_t id, const std::shared_ptr<objects::ServerZone>& definition)
-    : mNextRentalExpiration(0),
+    : mNextSpawnCheck(0),
+      mNextRentalExpiration(0),
       mNextEncounterID(1),
+      mAILODCounts{0, 0, 0},
       mDiasporaMiniBossUpdated(false) {
   SetDefinition(definition);
   SetID(id);
@@ -193,6 +196,39 @@ const std::shared_ptr<DynamicMap> Zone::GetDynamicMap() const {
 
 bool Zone::HasRespawns() const { return mHasRespawns; }
 
+bool Zone::SpawnCheckDue(uint64_t now) const {
+  return mNextSpawnCheck <= now;
+}
+
+void Zone::ScheduleSpawnCheck(uint64_t time) {
+  uint64_t current = mNextSpawnCheck;
+  while (time < current &&
+         !mNextSpawnCheck.compare_exchange_weak(current, time)) {
+  }
+}
+
+void Zone::RefreshSpawnCheck() {
+  // Anything scheduled while this is calculated must not be overwritten
+  uint64_t expected = mNextSpawnCheck;
+
+  uint64_t next = std::numeric_limits<uint64_t>::max();
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mRespawnTimes.size() > 0) {
+      next = mRespawnTimes.begin()->first;
+    }
+
+    for (auto& pPair : mPlasma) {
+      uint64_t pTime = 0;
+      if (pPair.second->GetNextStateChange(pTime) && pTime < next) {
+        next = pTime;
+      }
+    }
+  }
+
+  mNextSpawnCheck.compare_exchange_strong(expected, next);
+}
+
 bool Zone::HasStaggeredSpawns(uint64_t now) {
   std::lock_guard<std::mutex> lock(mLock);
   return mStaggeredSpawns.size() > 0 && mStaggeredSpawns.begin()->first <= now;
@@ -350,6 +386,7 @@ void Zone::RemoveEntity(int32_t entityID, uint32_t spawnDelay) {
                              (double)(spawnDelay * 1000));
 
               mRespawnTimes[rTime].insert(slgID);
+              ScheduleSpawnCheck(rTime);
             }
           }
 
@@ -672,6 +709,21 @@ std::list<std::shared_ptr<ActiveEntityState>> Zone::GetEnemiesAndAllies(
   return all;
 }
 
+void Zone::SetAILODCounts(uint32_t full, uint32_t reduced, uint32_t dormant) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mAILODCounts[0] = full;
+  mAILODCounts[1] = reduced;
+  mAILODCounts[2] = dormant;
+}
+
+void Zone::GetAILODCounts(uint32_t& full, uint32_t& reduced,
+                          uint32_t& dormant) {
+  std::lock_guard<std::mutex> lock(mLock);
+  full = mAILODCounts[0];
+  reduced = mAILODCounts[1];
+  dormant = mAILODCounts[2];
+}
+
 std::shared_ptr<LootBoxState> Zone::GetLootBox(int32_t id) {
   return std::dynamic_pointer_cast<LootBoxState>(GetEntity(id));
 }
@@ -1186,6 +1238,8 @@ bool Zone::UpdateTimedSpawns(const WorldClock& clock, bool initializing) {
         // Plasma disabled
         pPair.second->Toggle(false);
       }
+
+      ScheduleSpawnCheck();
     }
   }
 
@@ -1783,6 +1837,7 @@ void Zone::EnableSpawnGroups(const std::set<uint32_t>& spawnGroupIDs,
       }
 
       mRespawnTimes[rTime].insert(slgID);
+      ScheduleSpawnCheck(rTime);
     }
   }
 
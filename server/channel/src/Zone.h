@@ -44,6 +44,7 @@
 #include <ZoneObject.h>
 
 // Standard C++11 includes
+#include <atomic>
 #include <map>
 
 namespace objects {
@@ -161,6 +162,30 @@ class Zone : public objects::ZoneObject {
    */
   bool HasRespawns() const;
 
+  /**
+   * Check if a spawn location group respawn or plasma state change may be
+   * due, meaning the zone's spawn logic needs to run
+   * @param now Current server time
+   * @return true if the spawn logic needs to run
+   */
+  bool SpawnCheckDue(uint64_t now) const;
+
+  /**
+   * Request that the zone's spawn logic run no later than the supplied
+   * time. This must be called whenever something outside of the zone
+   * changes the timing of a respawn, such as a plasma point being picked.
+   * @param time Server time to run the spawn logic by, 0 for the next
+   *  zone update
+   */
+  void ScheduleSpawnCheck(uint64_t time = 0);
+
+  /**
+   * Recalculate the next time the zone's spawn logic needs to run from
+   * the pending respawn times and plasma state changes. Call this after
+   * the spawn logic has run.
+   */
+  void RefreshSpawnCheck();
+
   /**
    * Check if the zone has staggered spawns ready
    * @param now System time representing the current server time
@@ -388,6 +413,24 @@ class Zone : public objects::ZoneObject {
   std::list<std::shared_ptr<ActiveEntityState>> GetEnemiesAndAllies(
       bool includeStaggered = false);
 
+  /**
+   * Store the number of AI controlled entities in each AI level of detail
+   * tier as of the last AI update
+   * @param full Number of entities updated at full detail
+   * @param reduced Number of entities updated at a reduced rate
+   * @param dormant Number of dormant entities
+   */
+  void SetAILODCounts(uint32_t full, uint32_t reduced, uint32_t dormant);
+
+  /**
+   * Get the number of AI controlled entities in each AI level of detail
+   * tier as of the last AI update
+   * @param full Output parameter for entities updated at full detail
+   * @param reduced Output parameter for entities updated at a reduced rate
+   * @param dormant Output parameter for dormant entities
+   */
+  void GetAILODCounts(uint32_t& full, uint32_t& reduced, uint32_t& dormant);
+
   /**
    * Get a loot box instance by it's ID.
    * @param id Instance ID of the loot box.
@@ -975,12 +1018,20 @@ class Zone : public objects::ZoneObject {
   /// Zone instance pointer for non-global zones
   std::shared_ptr<ZoneInstance> mZoneInstance;
 
+  /// Next server time the spawn logic needs to run, 0 if it should run
+  /// on the next update and max if nothing is pending
+  std::atomic<uint64_t> mNextSpawnCheck;
+
   /// Next entity rental expiration time that will occur
   uint32_t mNextRentalExpiration;
 
   /// Next ID to use for encounters registered for the zone
   uint32_t mNextEncounterID;
 
+  /// Number of AI controlled entities in each AI level of detail tier as
+  /// of the last AI update, ordered full, reduced then dormant
+  uint32_t mAILODCounts[3];
+
   /// Quick reference flag to determine if the zone has respwa
   bool mHasRespawns;
 
@@ -28,6 +28,7 @@
 #include "ZoneGeometry.h"
 
 // Standard C++11 includes
+#include <algorithm>
 #include <cmath>
 #include <map>
 
@@ -113,19 +114,7 @@ bool ZoneShape::Collides(const Line& path, Point& point, Line& surface) const {
   float dist = 0.f;
   std::map<float, std::pair<const Line*, Point>> collisions;
   for (const Line& s : Lines) {
-    bool intersect = s.Intersect(path, point, dist);
-    bool passThrough = false;
-
-    if (intersect && OneWay) {
-      // If the first point of the line being drawn is to the right of the
-      // direction of the path, allow pass through
-      if (((path.second.x - path.first.x) * (s.first.y - path.first.y) -
-           (path.second.y - path.first.y) * (s.first.x - path.first.x)) < 0) {
-        passThrough = true;
-      }
-    }
-
-    if (intersect && !passThrough) {
+    if (Blocks(s, path, point, dist)) {
       collisions[dist] = std::pair<const Line*, Point>(&s, point);
     }
   }
@@ -142,6 +131,23 @@ bool ZoneShape::Collides(const Line& path, Point& point, Line& surface) const {
   }
 }
 
+bool ZoneShape::Blocks(const Line& line, const Line& path, Point& point,
+                       float& dist) const {
+  if (!line.Intersect(path, point, dist)) {
+    return false;
+  }
+
+  // If the first point of the line being drawn is to the right of the
+  // direction of the path, allow pass through
+  if (OneWay &&
+      ((path.second.x - path.first.x) * (line.first.y - path.first.y) -
+       (path.second.y - path.first.y) * (line.first.x - path.first.x)) < 0) {
+    return false;
+  }
+
+  return true;
+}
+
 ZoneQmpShape::ZoneQmpShape() : ShapeID(0), InstanceID(0), Active(true) {}
 
 ZoneQmpShape::~ZoneQmpShape() {}
@@ -159,33 +165,159 @@ ZoneSpotShape::ZoneSpotShape() {}
 
 ZoneSpotShape::~ZoneSpotShape() {}
 
+namespace {
+/**
+ * Get the collision index key of the grid cell at the supplied coordinates
+ * @param cx X coordinate of the cell
+ * @param cy Y coordinate of the cell
+ * @return Key of the cell
+ */
+uint64_t GetCellKey(int32_t cx, int32_t cy) {
+  return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cy;
+}
+
+/**
+ * Get the grid cell coordinate containing a point coordinate
+ * @param val X or Y value of the point
+ * @param cellSize Width and height of each grid cell
+ * @return Cell coordinate
+ */
+int32_t GetCellCoordinate(float val, float cellSize) {
+  return (int32_t)std::floor(val / cellSize);
+}
+}  // namespace
+
+ZoneGeometry::ZoneGeometry() : IndexCellSize(0.f) {}
+
+void ZoneGeometry::BuildIndex(float cellSize) {
+  Index.clear();
+  IndexCellSize = 0.f;
+
+  if (cellSize <= 0.f) {
+    return;
+  }
+
+  for (auto& s : Shapes) {
+    for (const Line& line : s->Lines) {
+      int32_t x1 =
+          GetCellCoordinate(std::min(line.first.x, line.second.x), cellSize);
+      int32_t x2 =
+          GetCellCoordinate(std::max(line.first.x, line.second.x), cellSize);
+      int32_t y1 =
+          GetCellCoordinate(std::min(line.first.y, line.second.y), cellSize);
+      int32_t y2 =
+          GetCellCoordinate(std::max(line.first.y, line.second.y), cellSize);
+
+      ZoneIndexedLine indexed;
+      indexed.Shape = s;
+      indexed.Segment = &line;
+      indexed.CellX = x1;
+      indexed.CellY = y1;
+
+      for (int32_t cx = x1; cx <= x2; cx++) {
+        for (int32_t cy = y1; cy <= y2; cy++) {
+          Index[GetCellKey(cx, cy)].push_back(indexed);
+        }
+      }
+    }
+  }
+
+  IndexCellSize = cellSize;
+}
+
 bool ZoneGeometry::Collides(const Line& path, Point& point, Line& surface,
                             std::shared_ptr<ZoneShape>& shape,
                             const std::set<uint32_t> disabledBarriers) const {
-  std::map<float,
-           std::pair<std::shared_ptr<ZoneShape>, std::pair<const Line*, Point>>>
-      collisions;
-  for (auto s : Shapes) {
-    bool disabled = s->Element ? disabledBarriers.find(s->Element->GetID()) !=
-                                     disabledBarriers.end()
-                               : false;
-    if (!disabled && s->Collides(path, point, surface)) {
-      float dSquared = (float)(std::pow((path.first.x - point.x), 2) +
-                               std::pow((path.first.y - point.y), 2));
-      std::pair<const Line*, Point> p(&surface, point);
-      collisions[dSquared] =
-          std::pair<std::shared_ptr<ZoneShape>, std::pair<const Line*, Point>>(
-              shape, p);
+  if (IndexCellSize <= 0.f) {
+    // No index, check every shape
+    std::map<float, std::pair<std::shared_ptr<ZoneShape>,
+                              std::pair<Line, Point>>>
+        collisions;
+    for (auto s : Shapes) {
+      bool disabled = s->Element ? disabledBarriers.find(s->Element->GetID()) !=
+                                       disabledBarriers.end()
+                                 : false;
+      if (!disabled && s->Collides(path, point, surface)) {
+        float dSquared = (float)(std::pow((path.first.x - point.x), 2) +
+                                 std::pow((path.first.y - point.y), 2));
+        collisions[dSquared] = std::pair<std::shared_ptr<ZoneShape>,
+                                         std::pair<Line, Point>>(
+            s, std::pair<Line, Point>(surface, point));
+      }
+    }
+
+    // If a collision exists, return true with the closest point, surface
+    // and shape in the output params
+    if (collisions.size() > 0) {
+      auto pair = collisions.begin()->second;
+      point = pair.second.second;
+      surface = pair.second.first;
+      shape = pair.first;
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  // Only the lines in cells overlapped by the path's bounding box can
+  // intersect it
+  int32_t x1 = GetCellCoordinate(std::min(path.first.x, path.second.x),
+                                 IndexCellSize);
+  int32_t x2 = GetCellCoordinate(std::max(path.first.x, path.second.x),
+                                 IndexCellSize);
+  int32_t y1 = GetCellCoordinate(std::min(path.first.y, path.second.y),
+                                 IndexCellSize);
+  int32_t y2 = GetCellCoordinate(std::max(path.first.y, path.second.y),
+                                 IndexCellSize);
+
+  const ZoneIndexedLine* closest = nullptr;
+  Point closestPoint;
+  float closestDist = 0.f;
+  for (int32_t cx = x1; cx <= x2; cx++) {
+    for (int32_t cy = y1; cy <= y2; cy++) {
+      auto it = Index.find(GetCellKey(cx, cy));
+      if (it == Index.end()) {
+        // Nothing to collide with in this cell
+        continue;
+      }
+
+      for (const ZoneIndexedLine& indexed : it->second) {
+        // A line stored in several cells the path overlaps is only tested
+        // in the lowest of those cells so no per call set of checked
+        // lines is needed
+        if (cx != std::max(x1, indexed.CellX) ||
+            cy != std::max(y1, indexed.CellY)) {
+          continue;
+        }
+
+        auto& s = indexed.Shape;
+        if (!s->Active) {
+          continue;
+        }
+
+        if (s->Element && disabledBarriers.find(s->Element->GetID()) !=
+                              disabledBarriers.end()) {
+          continue;
+        }
+
+        Point p;
+        float dist = 0.f;
+        if (s->Blocks(*indexed.Segment, path, p, dist) &&
+            (!closest || dist < closestDist)) {
+          closest = &indexed;
+          closestPoint = p;
+          closestDist = dist;
+        }
+      }
     }
   }
 
   // If a collision exists, return true with the closest point, surface
   // and shape in the output params
-  if (collisions.size() > 0) {
-    auto pair = collisions.begin()->second;
-    point = pair.second.second;
-    surface = *pair.second.first;
-    shape = pair.first;
+  if (closest) {
+    point = closestPoint;
+    surface = *closest->Segment;
+    shape = closest->Shape;
     return true;
   } else {
     return false;
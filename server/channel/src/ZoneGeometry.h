@@ -34,8 +34,10 @@
 // Standard C++11 includes
 #include <array>
 #include <list>
+#include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace objects {
 class MiSpotData;
@@ -161,6 +163,19 @@ class ZoneShape {
    */
   virtual bool Collides(const Line& path, Point& point, Line& surface) const;
 
+  /**
+   * Determines if the supplied path is blocked by one line of the shape,
+   * taking one way lines into account
+   * @param line Line of the shape to check
+   * @param path Line representing a path
+   * @param point Output parameter to set where the intersection occurs
+   * @param dist Output parameter to return the squared distance from the
+   *  start of the path to the intersection point
+   * @return true if the line blocks the path, false if it does not
+   */
+  bool Blocks(const Line& line, const Line& path, Point& point,
+              float& dist) const;
+
   /// List of all lines that make up the shape.
   std::list<Line> Lines;
 
@@ -230,12 +245,43 @@ class ZoneSpotShape : public ZoneShape {
   std::shared_ptr<objects::MiSpotData> Definition;
 };
 
+/**
+ * Line of a shape stored in the collision index of a @ref ZoneGeometry.
+ */
+struct ZoneIndexedLine {
+  /// Pointer to the shape the line belongs to
+  std::shared_ptr<ZoneQmpShape> Shape;
+
+  /// Pointer to the line within the shape
+  const Line* Segment;
+
+  /// X coordinate of the lowest grid cell the line is stored in
+  int32_t CellX;
+
+  /// Y coordinate of the lowest grid cell the line is stored in
+  int32_t CellY;
+};
+
 /**
  * Represents all zone geometry retrieved from a QMP file for use in
  * calculating collisions
  */
 class ZoneGeometry {
  public:
+  /**
+   * Create new zone geometry with no collision index
+   */
+  ZoneGeometry();
+
+  /**
+   * Build a uniform grid index of every shape line so collision checks
+   * only test lines near the path. Paths that stay within cells with no
+   * lines at all are known to be collision free without testing anything.
+   * This must be called again if any shapes are added.
+   * @param cellSize Width and height of each grid cell
+   */
+  void BuildIndex(float cellSize = 500.f);
+
   /**
    * Determines if the supplied path collides with any shape
    * @param path Line representing a path
@@ -270,6 +316,14 @@ class ZoneGeometry {
   /// List of all Qmp elements
   std::list<std::shared_ptr<objects::QmpElement>> Elements;
 
+  /// Map of grid cell keys to the shape lines that overlap the cell, empty
+  /// if the index has not been built
+  std::unordered_map<uint64_t, std::vector<ZoneIndexedLine>> Index;
+
+  /// Width and height of each grid cell in the collision index, 0 if the
+  /// index has not been built
+  float IndexCellSize;
+
   /// List of nav points in zones that use this geometry. In zones that
   /// contain player zone-in spots, these are filtered to the active play
   /// area only.
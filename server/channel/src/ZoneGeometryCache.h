@@ -0,0 +1,169 @@
+/**
+ * @file server/channel/src/ZoneGeometryCache.h
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Cache of zone geometry loaded on demand and evicted when idle.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_ZONEGEOMETRYCACHE_H
+#define SERVER_CHANNEL_SRC_ZONEGEOMETRYCACHE_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace channel {
+
+#ifndef ServerTime
+typedef uint64_t ServerTime;
+#endif  // ServerTime
+
+/**
+ * Cache of geometry (such as the zone geometry built from a QMP file or the
+ * spot shapes of a dynamic map) keyed by what it was built from. Entries
+ * are either added up front and kept for the life of the cache or loaded
+ * the first time they are requested. Zones hold the geometry through
+ * shared_ptr so the pointer use count serves as the reference count and a
+ * loaded entry that only the cache references can be evicted once it has
+ * been idle long enough. A load that fails is cached too so the same file
+ * is not read (and the failure logged) again on every request.
+ */
+template <typename Key, typename T>
+class ZoneGeometryCache {
+ public:
+  /// Function that loads the geometry for a key or returns null on failure
+  typedef std::function<std::shared_ptr<T>()> Loader_t;
+
+  /**
+   * Add geometry that is never evicted.
+   * @param key Key of the geometry
+   * @param geometry Geometry to add
+   */
+  void Insert(const Key& key, const std::shared_ptr<T>& geometry) {
+    std::lock_guard<std::mutex> lock(mLock);
+    mGeometry[key] = geometry;
+    mLastUsed.erase(key);
+  }
+
+  /**
+   * Get the geometry for a key, loading it first if a loader is given and
+   * the key has not been requested before. The load is done without the
+   * cache locked and the first result wins if two threads load the same
+   * key at once.
+   * @param key Key of the geometry
+   * @param now Current server time
+   * @param loader Function to load the geometry or null to only return
+   *  geometry that is already in the cache
+   * @returns Pointer to the geometry or null if it is not in the cache or
+   *  it failed to load
+   */
+  std::shared_ptr<T> Get(const Key& key, ServerTime now,
+                         const Loader_t& loader) {
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      auto it = mGeometry.find(key);
+      if (it != mGeometry.end()) {
+        auto usedIter = mLastUsed.find(key);
+        if (usedIter != mLastUsed.end()) {
+          usedIter->second = now;
+        }
+
+        return it->second;
+      } else if (!loader) {
+        return nullptr;
+      }
+    }
+
+    auto geometry = loader();
+
+    // If another thread loaded the same key first, use that one. A failed
+    // load stays in the cache (as null) and is never evicted.
+    std::lock_guard<std::mutex> lock(mLock);
+    auto result = mGeometry.insert(std::make_pair(key, geometry));
+    if (result.second && geometry) {
+      mLastUsed[key] = now;
+    }
+
+    return result.first->second;
+  }
+
+  /**
+   * Free loaded geometry that no zone has used for at least the idle
+   * timeout. Geometry still referenced outside of the cache is in use so
+   * only the time since the last reference went away is counted.
+   * @param now Current server time
+   * @param idleTimeout Time in microseconds geometry can go unused before
+   *  it is evicted
+   * @returns Number of entries evicted
+   */
+  size_t Evict(ServerTime now, ServerTime idleTimeout) {
+    std::lock_guard<std::mutex> lock(mLock);
+
+    size_t evicted = 0;
+    for (auto it = mLastUsed.begin(); it != mLastUsed.end();) {
+      auto geoIter = mGeometry.find(it->first);
+      if (geoIter == mGeometry.end()) {
+        it = mLastUsed.erase(it);
+      } else if (geoIter->second.use_count() > 1) {
+        it->second = now;
+        it++;
+      } else if (now - it->second >= idleTimeout) {
+        mGeometry.erase(geoIter);
+        it = mLastUsed.erase(it);
+        evicted++;
+      } else {
+        it++;
+      }
+    }
+
+    return evicted;
+  }
+
+  /**
+   * Get the number of entries in the cache including failed loads.
+   * @returns Number of entries in the cache
+   */
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mGeometry.size();
+  }
+
+ private:
+  /// Lock for the cache
+  std::mutex mLock;
+
+  /// Geometry by key. Null geometry marks a load that failed.
+  std::unordered_map<Key, std::shared_ptr<T>> mGeometry;
+
+  /// Map of keys loaded on demand to the last server time they were in
+  /// use. Geometry not in this map is never evicted.
+  std::unordered_map<Key, ServerTime> mLastUsed;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_ZONEGEOMETRYCACHE_H
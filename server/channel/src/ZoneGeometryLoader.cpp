@@ -98,16 +98,30 @@ bool ZoneGeometryLoader::LoadZoneQMP(
     return true;
   }
 
+  auto geometry = LoadQMPFile(filename, zonePair.second, server);
+  if (geometry) {
+    mDataLock.lock();
+    mZoneGeometry[filename.C()] = geometry;
+    mDataLock.unlock();
+  }
+
+  return true;
+}
+
+std::shared_ptr<ZoneGeometry> ZoneGeometryLoader::LoadQMPFile(
+    const libcomp::String& filename, const std::set<uint32_t>& dynamicMapIDs,
+    const std::shared_ptr<ChannelServer>& server) {
+  auto definitionManager = server->GetDefinitionManager();
+
   auto qmpFile =
       definitionManager->LoadQmpFile(filename, server->GetDataStore());
   if (!qmpFile) {
-    // success = false;
     LogZoneManagerError([&]() {
       return libcomp::String("Failed to load zone geometry file: %1\n")
           .Arg(filename);
     });
 
-    return true;
+    return nullptr;
   }
 
   auto geometry = std::make_shared<ZoneGeometry>();
@@ -236,12 +250,16 @@ bool ZoneGeometryLoader::LoadZoneQMP(
     }
   }
 
+  // Index every line now that all shapes are built so collision checks,
+  // starting with the navpoint filtering below, only test nearby lines
+  geometry->BuildIndex();
+
   // If any zone-in spots exist, remove all navpoints that are outside
   // of all play areas by checking if the center point of zone-in spot
   // connects to the points (in large zones this often times cuts the
   // number of points in half)
   std::list<Point> zoneInPoints;
-  for (auto dynamicMapID : zonePair.second) {
+  for (auto dynamicMapID : dynamicMapIDs) {
     auto spots = definitionManager->GetSpotData(dynamicMapID);
     for (auto spotPair : spots) {
       if (spotPair.second->GetType() ==
@@ -337,9 +355,5 @@ bool ZoneGeometryLoader::LoadZoneQMP(
         .Arg(filterString);
   });
 
-  mDataLock.lock();
-  mZoneGeometry[filename.C()] = geometry;
-  mDataLock.unlock();
-
-  return true;
+  return geometry;
 }
@@ -51,6 +51,18 @@ class ZoneGeometryLoader {
       std::unordered_map<uint32_t, std::set<uint32_t>> localZoneIDs,
       const std::shared_ptr<ChannelServer>& server);
 
+  /**
+   * Load a single QMP zone geometry file.
+   * @param filename Name of the QMP file to load.
+   * @param dynamicMapIDs Dynamic map IDs of the zones using the file. The
+   *  zone-in spots from these are used to filter out unreachable nav points.
+   * @param server Pointer to the channel server.
+   * @returns Loaded zone geometry or null if the file failed to load.
+   */
+  std::shared_ptr<ZoneGeometry> LoadQMPFile(
+      const libcomp::String& filename, const std::set<uint32_t>& dynamicMapIDs,
+      const std::shared_ptr<ChannelServer>& server);
+
  private:
   /**
    * Load a QMP for the next zone in the list.
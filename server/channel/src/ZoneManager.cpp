@@ -44,6 +44,7 @@
 #include <ActionStartEvent.h>
 #include <ActivatedAbility.h>
 #include <Ally.h>
+#include <ChannelConfig.h>
 #include <ChannelLogin.h>
 #include <CharacterLogin.h>
 #include <CharacterProgress.h>
@@ -157,7 +158,10 @@ BaseScriptEngine& BaseScriptEngine::Using<ZoneManager>() {
 }  // namespace libcomp
 
 ZoneManager::ZoneManager(const std::weak_ptr<ChannelServer>& server)
-    : mTrackingRefresh(0),
+    : mLazyGeometry(false),
+      mGeometryIdleTimeout(0),
+      mGeometryEvictCheck(0),
+      mTrackingRefresh(0),
       mNextZoneID(1),
       mNextZoneInstanceID(1),
       mServer(server) {}
@@ -172,6 +176,8 @@ void ZoneManager::LoadGeometry() {
   auto server = mServer.lock();
   auto sharedConfig = server->GetWorldSharedConfig();
   uint8_t channelID = server->GetChannelID();
+  auto conf =
+      std::dynamic_pointer_cast<objects::ChannelConfig>(server->GetConfig());
 
   auto definitionManager = server->GetDefinitionManager();
   auto serverDataManager = server->GetServerDataManager();
@@ -201,84 +207,202 @@ void ZoneManager::LoadGeometry() {
     }
   }
 
+  if (conf->GetLazyZoneGeometry()) {
+    // Only load the prefetch zones now, the rest load as they are used
+    std::unordered_map<uint32_t, std::set<uint32_t>> prefetchZoneIDs;
+    for (uint32_t zoneID : conf->GetZoneGeometryPrefetchIDs()) {
+      auto it = localZoneIDs.find(zoneID);
+      if (it != localZoneIDs.end()) {
+        prefetchZoneIDs.insert(*it);
+      }
+    }
+
+    LogZoneManagerInfo([&]() {
+      return libcomp::String(
+                 "Zone geometry will be loaded on demand for %1 zone(s) with "
+                 "%2 prefetched.\n")
+          .Arg(localZoneIDs.size())
+          .Arg(prefetchZoneIDs.size());
+    });
+
+    std::lock_guard<libcomp::Mutex> lock(mLock);
+    mLazyGeometry = true;
+    mGeometryIdleTimeout =
+        (ServerTime)conf->GetZoneGeometryIdleTimeout() * 1000000ULL;
+    mLocalZoneIDs = localZoneIDs;
+
+    localZoneIDs = prefetchZoneIDs;
+  }
+
   // Build zone geometry from QMP files
   ZoneGeometryLoader loader;
-  mZoneGeometry = loader.LoadQMP(localZoneIDs, server);
+  auto zoneGeometry = loader.LoadQMP(localZoneIDs, server);
 
   // Build any existing zone spots as polygons
   // Loop through a second time instead of handling in the first loop
   // because dynamic map/QMP file combos are not the same on all zones
+  std::unordered_map<uint32_t, std::shared_ptr<DynamicMap>> dynamicMaps;
   for (auto zonePair : localZoneIDs) {
     uint32_t zoneID = zonePair.first;
     auto zoneData = definitionManager->GetZoneData(zoneID);
 
     for (auto dynamicMapID : zonePair.second) {
       auto serverZone = serverDataManager->GetZoneData(zoneID, dynamicMapID);
-      if (zoneData && serverZone) {
-        auto dynamicMap = definitionManager->GetDynamicMapData(dynamicMapID);
-        if (dynamicMap &&
-            mDynamicMaps.find(dynamicMapID) == mDynamicMaps.end()) {
-          auto dMap = std::make_shared<DynamicMap>();
-          auto spots = definitionManager->GetSpotData(dynamicMapID);
-          for (auto spotPair : spots) {
-            Point center(spotPair.second->GetCenterX(),
-                         spotPair.second->GetCenterY());
-            float rot = spotPair.second->GetRotation();
-
-            float x1 = center.x - spotPair.second->GetSpanX();
-            float y1 = center.y - spotPair.second->GetSpanY();
-
-            float x2 = center.x + spotPair.second->GetSpanX();
-            float y2 = center.y + spotPair.second->GetSpanY();
-
-            // Build the unrotated rectangle
-            std::vector<Point> points;
-            points.push_back(Point(x1, y1));
-            points.push_back(Point(x2, y1));
-            points.push_back(Point(x2, y2));
-            points.push_back(Point(x1, y2));
-
-            auto shape = std::make_shared<ZoneSpotShape>();
-
-            // Rotate each point around the center
-            for (auto& p : points) {
-              p = RotatePoint(p, center, rot);
-              shape->Vertices.push_back(p);
-            }
+      if (zoneData && serverZone &&
+          dynamicMaps.find(dynamicMapID) == dynamicMaps.end()) {
+        auto dMap = BuildDynamicMap(dynamicMapID);
+        if (dMap) {
+          dynamicMaps[dynamicMapID] = dMap;
+        }
+      }
+    }
+  }
+
+  for (auto& pair : zoneGeometry) {
+    mZoneGeometry.Insert(pair.first, pair.second);
+  }
 
-            shape->Definition = spotPair.second;
-            shape->Lines.push_back(Line(points[0], points[1]));
-            shape->Lines.push_back(Line(points[1], points[2]));
-            shape->Lines.push_back(Line(points[2], points[3]));
-            shape->Lines.push_back(Line(points[3], points[0]));
+  for (auto& pair : dynamicMaps) {
+    mDynamicMaps.Insert(pair.first, pair.second);
+  }
+}
 
-            // Determine the boundaries of the completed shape
-            std::list<float> xVals;
-            std::list<float> yVals;
+std::shared_ptr<ZoneGeometry> ZoneManager::GetZoneGeometry(
+    const std::shared_ptr<objects::MiZoneData>& zoneData) {
+  libcomp::String qmpFile;
+  if (zoneData) {
+    qmpFile = zoneData->GetFile()->GetQmpFile();
+  }
 
-            for (Line& line : shape->Lines) {
-              for (const Point& p : {line.first, line.second}) {
-                xVals.push_back(p.x);
-                yVals.push_back(p.y);
-              }
-            }
+  if (qmpFile.IsEmpty()) {
+    return nullptr;
+  }
 
-            xVals.sort([](const float& a, const float& b) { return a < b; });
+  ZoneGeometryCache<std::string, ZoneGeometry>::Loader_t loader;
+  {
+    std::lock_guard<libcomp::Mutex> lock(mLock);
+    if (mLazyGeometry) {
+      std::set<uint32_t> dynamicMapIDs;
 
-            yVals.sort([](const float& a, const float& b) { return a < b; });
+      auto zoneIter = mLocalZoneIDs.find(zoneData->GetBasic()->GetID());
+      if (zoneIter != mLocalZoneIDs.end()) {
+        dynamicMapIDs = zoneIter->second;
+      }
 
-            shape->Boundaries[0] = Point(xVals.front(), yVals.front());
-            shape->Boundaries[1] = Point(xVals.back(), yVals.back());
+      auto server = mServer.lock();
+      loader = [qmpFile, dynamicMapIDs, server]() {
+        ZoneGeometryLoader qmpLoader;
+        return qmpLoader.LoadQMPFile(qmpFile, dynamicMapIDs, server);
+      };
+    }
+  }
 
-            dMap->Spots[spotPair.first] = shape;
-            dMap->SpotTypes[(uint8_t)spotPair.second->GetType()].push_back(
-                shape);
-          }
+  // The cache loads outside of its lock as this can take a while for large
+  // zones. A file that fails to load is only read (and logged) once.
+  return mZoneGeometry.Get(qmpFile.C(), ChannelServer::GetServerTime(),
+                           loader);
+}
 
-          mDynamicMaps[dynamicMapID] = dMap;
-        }
+std::shared_ptr<DynamicMap> ZoneManager::GetDynamicMap(uint32_t dynamicMapID) {
+  ZoneGeometryCache<uint32_t, DynamicMap>::Loader_t loader;
+  {
+    std::lock_guard<libcomp::Mutex> lock(mLock);
+    if (mLazyGeometry) {
+      loader = [this, dynamicMapID]() { return BuildDynamicMap(dynamicMapID); };
+    }
+  }
+
+  // A dynamic map with no definition is only looked up once
+  return mDynamicMaps.Get(dynamicMapID, ChannelServer::GetServerTime(), loader);
+}
+
+std::shared_ptr<DynamicMap> ZoneManager::BuildDynamicMap(
+    uint32_t dynamicMapID) {
+  auto definitionManager = mServer.lock()->GetDefinitionManager();
+  if (!definitionManager->GetDynamicMapData(dynamicMapID)) {
+    return nullptr;
+  }
+
+  auto dMap = std::make_shared<DynamicMap>();
+  auto spots = definitionManager->GetSpotData(dynamicMapID);
+  for (auto spotPair : spots) {
+    Point center(spotPair.second->GetCenterX(), spotPair.second->GetCenterY());
+    float rot = spotPair.second->GetRotation();
+
+    float x1 = center.x - spotPair.second->GetSpanX();
+    float y1 = center.y - spotPair.second->GetSpanY();
+
+    float x2 = center.x + spotPair.second->GetSpanX();
+    float y2 = center.y + spotPair.second->GetSpanY();
+
+    // Build the unrotated rectangle
+    std::vector<Point> points;
+    points.push_back(Point(x1, y1));
+    points.push_back(Point(x2, y1));
+    points.push_back(Point(x2, y2));
+    points.push_back(Point(x1, y2));
+
+    auto shape = std::make_shared<ZoneSpotShape>();
+
+    // Rotate each point around the center
+    for (auto& p : points) {
+      p = RotatePoint(p, center, rot);
+      shape->Vertices.push_back(p);
+    }
+
+    shape->Definition = spotPair.second;
+    shape->Lines.push_back(Line(points[0], points[1]));
+    shape->Lines.push_back(Line(points[1], points[2]));
+    shape->Lines.push_back(Line(points[2], points[3]));
+    shape->Lines.push_back(Line(points[3], points[0]));
+
+    // Determine the boundaries of the completed shape
+    std::list<float> xVals;
+    std::list<float> yVals;
+
+    for (Line& line : shape->Lines) {
+      for (const Point& p : {line.first, line.second}) {
+        xVals.push_back(p.x);
+        yVals.push_back(p.y);
       }
     }
+
+    xVals.sort([](const float& a, const float& b) { return a < b; });
+
+    yVals.sort([](const float& a, const float& b) { return a < b; });
+
+    shape->Boundaries[0] = Point(xVals.front(), yVals.front());
+    shape->Boundaries[1] = Point(xVals.back(), yVals.back());
+
+    dMap->Spots[spotPair.first] = shape;
+    dMap->SpotTypes[(uint8_t)spotPair.second->GetType()].push_back(shape);
+  }
+
+  return dMap;
+}
+
+void ZoneManager::EvictIdleGeometry(ServerTime now) {
+  std::lock_guard<libcomp::Mutex> lock(mLock);
+  if (!mLazyGeometry || !mGeometryIdleTimeout || now < mGeometryEvictCheck) {
+    return;
+  }
+
+  // Check again 10 seconds from now
+  mGeometryEvictCheck = now + (ServerTime)10000000ULL;
+
+  // Anything still referenced outside of the cache is bound to a zone
+  // so only the idle time since the last zone went away is counted
+  size_t geometryEvicted = mZoneGeometry.Evict(now, mGeometryIdleTimeout);
+  size_t mapsEvicted = mDynamicMaps.Evict(now, mGeometryIdleTimeout);
+
+  if (geometryEvicted || mapsEvicted) {
+    LogZoneManagerDebug([&]() {
+      return libcomp::String(
+                 "Evicted %1 idle zone geometry file(s) and %2 dynamic "
+                 "map(s).\n")
+          .Arg(geometryEvicted)
+          .Arg(mapsEvicted);
+    });
   }
 }
 
@@ -320,7 +444,7 @@ void ZoneManager::InstanceGlobalZones() {
     uint32_t zoneID = zoneData->GetID();
     uint32_t dynamicMapID = zoneData->GetDynamicMapID();
 
-    auto zone = CreateZone(zoneData);
+    auto zone = CreateZone(BuildZonePrototype(zoneData));
 
     std::lock_guard<libcomp::Mutex> lock(mLock);
     mGlobalZoneMap[zoneID][dynamicMapID] = zone->GetID();
@@ -350,6 +474,31 @@ void ZoneManager::InstanceGlobalZones() {
   }
 }
 
+void ZoneManager::WarmZonePrototypes() {
+  auto server = mServer.lock();
+  auto serverDataManager = server->GetServerDataManager();
+  auto conf =
+      std::dynamic_pointer_cast<objects::ChannelConfig>(server->GetConfig());
+
+  for (uint32_t instanceID : conf->GetZonePrototypeWarmInstanceIDs()) {
+    auto instanceDef = serverDataManager->GetZoneInstanceData(instanceID);
+    if (!instanceDef) {
+      LogZoneManagerWarning([&]() {
+        return libcomp::String(
+                   "Skipping zone prototypes for invalid zone instance: %1\n")
+            .Arg(instanceID);
+      });
+
+      continue;
+    }
+
+    for (size_t i = 0; i < instanceDef->ZoneIDsCount(); i++) {
+      GetZonePrototype(instanceDef->GetZoneIDs(i),
+                       instanceDef->GetDynamicMapIDs(i), nullptr);
+    }
+  }
+}
+
 std::shared_ptr<Zone> ZoneManager::GetCurrentZone(
     const std::shared_ptr<ChannelClientConnection>& client) {
   auto worldCID = client->GetClientState()->GetWorldCID();
@@ -2507,6 +2656,7 @@ void ZoneManager::UpdateStatusEffectStates(
   const static std::set<uint32_t> dgStatusEffectIDs = {
       SVR_CONST.STATUS_DIGITALIZE[0], SVR_CONST.STATUS_DIGITALIZE[1]};
 
+  // Packets are built in place in the list to avoid copying each one
   std::list<libcomp::Packet> zonePackets;
   std::set<uint32_t> added, updated, removed;
   std::set<std::shared_ptr<ActiveEntityState>> displayStateModified;
@@ -2520,10 +2670,10 @@ void ZoneManager::UpdateStatusEffectStates(
 
     // Send removes first in case an effect is removed then added back
     if (removed.size() > 0) {
-      libcomp::Packet p;
-      if (characterManager->GetRemovedStatusesPacket(p, entity->GetEntityID(),
-                                                     removed)) {
-        zonePackets.push_back(p);
+      zonePackets.emplace_back();
+      if (!characterManager->GetRemovedStatusesPacket(
+              zonePackets.back(), entity->GetEntityID(), removed)) {
+        zonePackets.pop_back();
       }
 
       recalc.insert(entity);
@@ -2559,10 +2709,10 @@ void ZoneManager::UpdateStatusEffectStates(
         }
       }
 
-      libcomp::Packet p;
-      if (characterManager->GetActiveStatusesPacket(p, entity->GetEntityID(),
-                                                    active)) {
-        zonePackets.push_back(p);
+      zonePackets.emplace_back();
+      if (!characterManager->GetActiveStatusesPacket(
+              zonePackets.back(), entity->GetEntityID(), active)) {
+        zonePackets.pop_back();
       }
 
       recalc.insert(entity);
@@ -2581,10 +2731,9 @@ void ZoneManager::UpdateStatusEffectStates(
 
         displayStateModified.insert(entity);
 
-        libcomp::Packet p;
-        CharacterManager::GetTDamagePacket(p, entity->GetEntityID(), hpAdjusted,
-                                           mpAdjusted);
-        zonePackets.push_back(p);
+        zonePackets.emplace_back();
+        CharacterManager::GetTDamagePacket(
+            zonePackets.back(), entity->GetEntityID(), hpAdjusted, mpAdjusted);
 
         hpMpRecalc = true;
       }
@@ -2597,12 +2746,12 @@ void ZoneManager::UpdateStatusEffectStates(
                           mpAdjusted)) {
         displayStateModified.insert(entity);
 
-        libcomp::Packet p;
+        zonePackets.emplace_back();
+        libcomp::Packet& p = zonePackets.back();
         p.WritePacketCode(
             ChannelToClientPacketCode_t::PACKET_SKILL_UPKEEP_COST);
         p.WriteS32Little(entity->GetEntityID());
         p.WriteU32Little((uint32_t)(-mpAdjusted));
-        zonePackets.push_back(p);
 
         hpMpRecalc = true;
       }
@@ -2751,23 +2900,14 @@ void ZoneManager::HandleSpecialInstancePopulate(
 void ZoneManager::BroadcastPacket(
     const std::shared_ptr<ChannelClientConnection>& client, libcomp::Packet& p,
     bool includeSelf) {
-  std::list<std::shared_ptr<libcomp::TcpConnection>> connections;
-  for (auto connection : GetZoneConnections(client, includeSelf)) {
-    connections.push_back(connection);
-  }
-
-  libcomp::TcpConnection::BroadcastPacket(connections, p);
+  ChannelClientConnection::BroadcastPacket(
+      GetZoneConnections(client, includeSelf), p);
 }
 
 void ZoneManager::BroadcastPacket(const std::shared_ptr<Zone>& zone,
                                   libcomp::Packet& p) {
   if (nullptr != zone) {
-    std::list<std::shared_ptr<libcomp::TcpConnection>> connections;
-    for (auto connectionPair : zone->GetConnections()) {
-      connections.push_back(connectionPair.second);
-    }
-
-    libcomp::TcpConnection::BroadcastPacket(connections, p);
+    ChannelClientConnection::BroadcastPacket(zone->GetConnectionList(), p);
   }
 }
 
@@ -2781,7 +2921,7 @@ void ZoneManager::SendToRange(
 
   cState->RefreshCurrentPosition(now);
 
-  std::list<std::shared_ptr<libcomp::TcpConnection>> zConnections;
+  std::list<std::shared_ptr<ChannelClientConnection>> zConnections;
   if (includeSelf) {
     zConnections.push_back(client);
   }
@@ -2795,7 +2935,7 @@ void ZoneManager::SendToRange(
       zConnections.push_back(zConnection);
     }
   }
-  libcomp::TcpConnection::BroadcastPacket(zConnections, p);
+  ChannelClientConnection::BroadcastPacket(zConnections, p);
 }
 
 std::list<std::shared_ptr<ChannelClientConnection>>
@@ -3856,6 +3996,11 @@ void ZoneManager::FailPlasma(
     pointID = (int8_t)point->GetID();
   }
 
+  if (point) {
+    // The point is now hidden and needs to respawn
+    zone->ScheduleSpawnCheck();
+  }
+
   if (point) {
     // Send the faillure notification to the player next
     libcomp::Packet notify;
@@ -4071,6 +4216,8 @@ std::shared_ptr<ActiveEntityState> ZoneManager::CreateEnemy(
 void ZoneManager::UpdateActiveZoneStates() {
   auto serverTime = ChannelServer::GetServerTime();
 
+  EvictIdleGeometry(serverTime);
+
   bool refreshTracking = false;
   std::list<std::shared_ptr<Zone>> zones;
   {
@@ -4129,12 +4276,16 @@ void ZoneManager::UpdateActiveZoneStates() {
       UpdateStaggeredSpawns(zone, serverTime);
     }
 
-    if (zone->HasRespawns()) {
+    // Only run the spawn logic when a respawn or plasma change is due
+    if (zone->HasRespawns() && zone->SpawnCheckDue(serverTime)) {
       // Spawn new enemies next (since they should not immediately act)
       UpdateSpawnGroups(zone, false, serverTime);
 
       // Now update plasma spawns
       UpdatePlasma(zone, serverTime);
+
+      // Sleep until the next respawn or plasma change
+      zone->RefreshSpawnCheck();
     }
 
     mTimeRestrictUpdatedZones.erase(zone->GetID());
@@ -5845,16 +5996,7 @@ Point ZoneManager::GetRandomSpotPoint(
 
   if (zoneData) {
     // Ensure that the random spot is in the zone boundaries
-    std::shared_ptr<ZoneGeometry> geometry;
-
-    auto qmpFile = zoneData->GetFile()->GetQmpFile();
-    if (!qmpFile.IsEmpty()) {
-      std::lock_guard<libcomp::Mutex> lock(mLock);
-      auto geoIter = mZoneGeometry.find(qmpFile.C());
-      if (geoIter != mZoneGeometry.end()) {
-        geometry = geoIter->second;
-      }
-    }
+    auto geometry = GetZoneGeometry(zoneData);
 
     Line centerLine(center, transformed);
 
@@ -6668,28 +6810,19 @@ std::shared_ptr<Zone> ZoneManager::GetInstanceZone(
   auto instanceDef = instance->GetDefinition();
   auto instVariant = instance->GetVariant();
 
-  auto server = mServer.lock();
-  auto serverDataManager = server->GetServerDataManager();
-
-  std::shared_ptr<objects::ServerZone> zoneDefinition;
+  std::shared_ptr<ZonePrototype> prototype;
 
   for (size_t i = 0; i < instanceDef->ZoneIDsCount(); i++) {
     uint32_t zID = instanceDef->GetZoneIDs(i);
     uint32_t dID = instanceDef->GetDynamicMapIDs(i);
     if (zID == zoneID && (dynamicMapID == 0 || dID == dynamicMapID)) {
-      std::set<uint32_t> partialIDs;
-      if (instVariant) {
-        partialIDs = instVariant->GetZonePartialIDs();
-      }
-
-      zoneDefinition =
-          serverDataManager->GetZoneData(zID, dID, true, partialIDs);
+      prototype = GetZonePrototype(zID, dID, instVariant);
       break;
     }
   }
 
-  if (zoneDefinition) {
-    zone = CreateZone(zoneDefinition, instance);
+  if (prototype) {
+    zone = CreateZone(prototype, instance);
     if (!instance->AddZone(zone)) {
       LogZoneManagerError([&]() {
         return libcomp::String("Failed to add zone to instance: %1 (%2)\n")
@@ -6830,13 +6963,69 @@ bool ZoneManager::GetLoginZone(
   }
 }
 
+std::shared_ptr<ZonePrototype> ZoneManager::GetZonePrototype(
+    uint32_t zoneID, uint32_t dynamicMapID,
+    const std::shared_ptr<objects::ServerZoneInstanceVariant>& variant) {
+  std::tuple<uint32_t, uint32_t, uint32_t> key(
+      zoneID, dynamicMapID, variant ? variant->GetID() : 0);
+
+  {
+    std::lock_guard<libcomp::Mutex> lock(mLock);
+    auto it = mZonePrototypes.find(key);
+    if (it != mZonePrototypes.end()) {
+      return it->second;
+    }
+  }
+
+  std::set<uint32_t> partialIDs;
+  if (variant) {
+    partialIDs = variant->GetZonePartialIDs();
+  }
+
+  auto definition = mServer.lock()->GetServerDataManager()->GetZoneData(
+      zoneID, dynamicMapID, true, partialIDs);
+  if (!definition) {
+    return nullptr;
+  }
+
+  auto prototype = BuildZonePrototype(definition);
+
+  LogZoneManagerDebug([&]() {
+    return libcomp::String("Built zone prototype: %1 (%2%3)\n")
+        .Arg(zoneID)
+        .Arg(dynamicMapID)
+        .Arg(variant ? libcomp::String(": %1").Arg(variant->GetID()) : "");
+  });
+
+  // If another thread built the same prototype first, use that one
+  std::lock_guard<libcomp::Mutex> lock(mLock);
+  return mZonePrototypes.insert(std::make_pair(key, prototype)).first->second;
+}
+
+std::shared_ptr<ZonePrototype> ZoneManager::BuildZonePrototype(
+    const std::shared_ptr<objects::ServerZone>& definition) {
+  if (!definition) {
+    return nullptr;
+  }
+
+  std::unordered_map<uint32_t, std::shared_ptr<objects::MiSpotData>> spots;
+  if (definition->GetDynamicMapID()) {
+    spots = mServer.lock()->GetDefinitionManager()->GetSpotData(
+        definition->GetDynamicMapID());
+  }
+
+  return std::make_shared<ZonePrototype>(definition, spots);
+}
+
 std::shared_ptr<Zone> ZoneManager::CreateZone(
-    const std::shared_ptr<objects::ServerZone>& definition,
+    const std::shared_ptr<ZonePrototype>& prototype,
     const std::shared_ptr<ZoneInstance>& instance) {
-  if (nullptr == definition) {
+  if (nullptr == prototype) {
     return nullptr;
   }
 
+  auto definition = prototype->GetDefinition();
+
   uint32_t zoneID = definition->GetID();
   uint32_t dynamicMapID = definition->GetDynamicMapID();
 
@@ -6847,6 +7036,10 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
   auto definitionManager = server->GetDefinitionManager();
   auto zoneData = definitionManager->GetZoneData(zoneID);
 
+  // Bind the geometry before taking the lock as it may need to be loaded
+  auto geometry = GetZoneGeometry(zoneData);
+  auto dynamicMap = GetDynamicMap(dynamicMapID);
+
   std::shared_ptr<Zone> zone;
   {
     std::lock_guard<libcomp::Mutex> lock(mLock);
@@ -6859,16 +7052,12 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
       zone->SetMatch(instance->GetMatch());
     }
 
-    auto qmpFile = zoneData->GetFile()->GetQmpFile();
-    auto geoIter = !qmpFile.IsEmpty() ? mZoneGeometry.find(qmpFile.C())
-                                      : mZoneGeometry.end();
-    if (geoIter != mZoneGeometry.end()) {
-      zone->SetGeometry(geoIter->second);
+    if (geometry) {
+      zone->SetGeometry(geometry);
     }
 
-    auto it = mDynamicMaps.find(dynamicMapID);
-    if (it != mDynamicMaps.end()) {
-      zone->SetDynamicMap(it->second);
+    if (dynamicMap) {
+      zone->SetDynamicMap(dynamicMap);
     } else {
       LogZoneManagerWarning([zoneID, dynamicMapID]() {
         return libcomp::String(
@@ -6890,7 +7079,7 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
     float y = npc->GetY();
     float rot = npc->GetRotation();
     if (npc->GetSpotID() &&
-        !GetSpotPosition(dynamicMapID, npc->GetSpotID(), x, y, rot)) {
+        !prototype->GetSpotPosition(npc->GetSpotID(), x, y, rot)) {
       LogZoneManagerWarning([&]() {
         return libcomp::String(
                    "NPC %1 in zone %2 is placed in an invalid spot and will be "
@@ -6933,11 +7122,7 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
       case InstanceType_t::DIASPORA:
         // If a server object is placed on the same spot ID as a diaspora
         // base, do not place it as the spot will be bound to it later
-        for (auto& spotPair : definition->GetSpots()) {
-          if (spotPair.second->GetMatchBase()) {
-            diasporaSpots.insert(spotPair.first);
-          }
-        }
+        diasporaSpots = prototype->GetMatchBaseSpots();
 
         AddDiasporaBases(zone);
         break;
@@ -6961,7 +7146,7 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
     float y = obj->GetY();
     float rot = obj->GetRotation();
     if (obj->GetSpotID() &&
-        !GetSpotPosition(dynamicMapID, obj->GetSpotID(), x, y, rot)) {
+        !prototype->GetSpotPosition(obj->GetSpotID(), x, y, rot)) {
       LogZoneManagerWarning([&]() {
         return libcomp::String(
                    "Object %1 in zone %2 is placed in an invalid spot and will "
@@ -6996,7 +7181,7 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
       float y = pSpawn->GetY();
       float rot = pSpawn->GetRotation();
       if (pSpawn->GetSpotID() &&
-          !GetSpotPosition(dynamicMapID, pSpawn->GetSpotID(), x, y, rot)) {
+          !prototype->GetSpotPosition(pSpawn->GetSpotID(), x, y, rot)) {
         LogZoneManagerWarning([&]() {
           return libcomp::String(
                      "Plasma %1 in zone %2 is placed in an invalid spot and "
@@ -7049,7 +7234,7 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
       float y = bazaar->GetY();
       float rot = bazaar->GetRotation();
       if (bazaar->GetSpotID() &&
-          !GetSpotPosition(dynamicMapID, bazaar->GetSpotID(), x, y, rot)) {
+          !prototype->GetSpotPosition(bazaar->GetSpotID(), x, y, rot)) {
         LogZoneManagerWarning([&]() {
           return libcomp::String(
                      "Bazaar %1 in zone %2 is placed in an invalid spot and "
@@ -7095,7 +7280,7 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
         float y = machine->GetY();
         float rot = machine->GetRotation();
         if (machine->GetSpotID() &&
-            !GetSpotPosition(dynamicMapID, machine->GetSpotID(), x, y, rot)) {
+            !prototype->GetSpotPosition(machine->GetSpotID(), x, y, rot)) {
           LogZoneManagerWarning([&]() {
             return libcomp::String(
                        "Culture machine %1 in zone %2 is placed in an invalid "
@@ -7501,6 +7686,8 @@ void ZoneManager::RemoveZone(const std::shared_ptr<Zone>& zone,
     mZones.erase(zone->GetID());
     zone->Cleanup();
     mTimeRestrictUpdatedZones.erase(zone->GetID());
+
+    mServer.lock()->GetAIManager()->ReleaseZoneScripts(zone->GetID());
   } else {
     // Remove any AI aggro in the zone
     auto eBases = zone->GetEnemiesAndAllies();
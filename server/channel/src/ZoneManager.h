@@ -40,7 +40,12 @@
 #include "ChannelClientConnection.h"
 #include "Zone.h"
 #include "ZoneGeometry.h"
+#include "ZoneGeometryCache.h"
 #include "ZoneInstance.h"
+#include "ZonePrototype.h"
+
+// Standard C++11 includes
+#include <tuple>
 
 namespace libcomp {
 class Packet;
@@ -82,7 +87,10 @@ class ZoneManager {
    * Load all QMP zone geometry files and prepare them to be bound
    * to zones as they are instantiated. If a specific file fails to
    * load, an error will be returned but the zone will still be
-   * accessible without server side collision support.
+   * accessible without server side collision support. If lazy zone
+   * geometry is configured, only the geometry for the prefetch zones
+   * is loaded here and everything else is loaded when a zone using
+   * it is first created.
    */
   void LoadGeometry();
 
@@ -93,6 +101,14 @@ class ZoneManager {
    */
   void InstanceGlobalZones();
 
+  /**
+   * Build the zone prototypes for every zone in each instance listed in
+   * the channel config so the first instances created after startup do
+   * not need to resolve their zone definitions. Prototypes for instance
+   * variants are still built the first time each one is used.
+   */
+  void WarmZonePrototypes();
+
   /**
    * Get the zone associated to a client connection
    * @param client Client connection connected to a zone
@@ -1167,6 +1183,37 @@ class ZoneManager {
       std::list<std::shared_ptr<objects::InstanceAccess>> removes);
 
  private:
+  /**
+   * Get the geometry built from the QMP file of a zone, loading it first
+   * if lazy zone geometry is enabled and it is not loaded yet.
+   * @param zoneData Binary definition of the zone
+   * @returns Pointer to the zone geometry or null if the zone has none
+   */
+  std::shared_ptr<ZoneGeometry> GetZoneGeometry(
+      const std::shared_ptr<objects::MiZoneData>& zoneData);
+
+  /**
+   * Get the spot shapes of a dynamic map, building them first if lazy
+   * zone geometry is enabled and they are not built yet.
+   * @param dynamicMapID ID of the dynamic map
+   * @returns Pointer to the dynamic map or null if it is not valid
+   */
+  std::shared_ptr<DynamicMap> GetDynamicMap(uint32_t dynamicMapID);
+
+  /**
+   * Build the spot shapes of a dynamic map from its binary definition.
+   * @param dynamicMapID ID of the dynamic map
+   * @returns Pointer to the dynamic map or null if it has no definition
+   */
+  std::shared_ptr<DynamicMap> BuildDynamicMap(uint32_t dynamicMapID);
+
+  /**
+   * Free lazily loaded zone geometry and dynamic maps that no zone has
+   * used for longer than the configured idle timeout.
+   * @param now Current server time
+   */
+  void EvictIdleGeometry(ServerTime now);
+
   /**
    * Select a spot for a spawn group and get it's location.
    * @param useSpotID If the spot ID should be used.
@@ -1326,13 +1373,35 @@ class ZoneManager {
       uint32_t currentInstanceID = 0);
 
   /**
-   * Create a new zone based off of the supplied definition
+   * Get the cached prototype for an instance zone, resolving the zone
+   * definition with the variant's partials applied and caching it if this
+   * is the first time it has been requested
+   * @param zoneID Definition ID of the zone
+   * @param dynamicMapID Dynamic map ID of the zone
+   * @param variant Optional pointer to the instance variant
+   * @return Pointer to the zone prototype or null if the zone definition
+   *  is not valid
+   */
+  std::shared_ptr<ZonePrototype> GetZonePrototype(
+      uint32_t zoneID, uint32_t dynamicMapID,
+      const std::shared_ptr<objects::ServerZoneInstanceVariant>& variant);
+
+  /**
+   * Build a new zone prototype from a resolved zone definition
    * @param definition Pointer to a zone definition
+   * @return Pointer to the new zone prototype
+   */
+  std::shared_ptr<ZonePrototype> BuildZonePrototype(
+      const std::shared_ptr<objects::ServerZone>& definition);
+
+  /**
+   * Create a new zone based off of the supplied prototype
+   * @param prototype Pointer to the zone prototype
    * @param instance Optional pointer to the instance the zone will belong to
    * @return Pointer to a new zone
    */
   std::shared_ptr<Zone> CreateZone(
-      const std::shared_ptr<objects::ServerZone>& definition,
+      const std::shared_ptr<ZonePrototype>& prototype,
       const std::shared_ptr<ZoneInstance>& instance = nullptr);
 
   /**
@@ -1439,12 +1508,32 @@ class ZoneManager {
   /// Map of world CIDs to zone unique IDs
   std::unordered_map<int32_t, uint32_t> mEntityMap;
 
-  /// Map of QMP filenames to the geometry structures built from them
-  std::unordered_map<std::string, std::shared_ptr<ZoneGeometry>> mZoneGeometry;
+  /// Cache of QMP filenames to the geometry structures built from them
+  ZoneGeometryCache<std::string, ZoneGeometry> mZoneGeometry;
 
-  /// Map of dynamic map IDs to geometry information built from their
+  /// Cache of dynamic map IDs to geometry information built from their
   /// corresponding binary definitions
-  std::unordered_map<uint32_t, std::shared_ptr<DynamicMap>> mDynamicMaps;
+  ZoneGeometryCache<uint32_t, DynamicMap> mDynamicMaps;
+
+  /// Map of zone IDs hosted by the server to the dynamic map IDs they are
+  /// used with, kept to load zone geometry on demand
+  std::unordered_map<uint32_t, std::set<uint32_t>> mLocalZoneIDs;
+
+  /// Indicates zone geometry and dynamic maps are loaded on demand
+  bool mLazyGeometry;
+
+  /// Time in microseconds lazily loaded geometry can go unused before it
+  /// is evicted or 0 to never evict it
+  ServerTime mGeometryIdleTimeout;
+
+  /// Next server time idle geometry will be checked for eviction
+  ServerTime mGeometryEvictCheck;
+
+  /// Map of zone definition ID, dynamic map ID and instance variant ID
+  /// (or 0 for none) to the prototypes instance zones are created from
+  std::map<std::tuple<uint32_t, uint32_t, uint32_t>,
+           std::shared_ptr<ZonePrototype>>
+      mZonePrototypes;
 
   /// Map of global boss group IDs to zones in that group on the server
   std::unordered_map<uint32_t, std::set<uint32_t>> mGlobalBossZones;
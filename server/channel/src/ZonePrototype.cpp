@@ -0,0 +1,74 @@
+/**
+ * @file server/channel/src/ZonePrototype.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Pre-resolved, immutable zone data shared by every zone created
+ *  from the same definition.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ZonePrototype.h"
+
+// object Includes
+#include <MiSpotData.h>
+#include <ServerZone.h>
+#include <ServerZoneSpot.h>
+
+using namespace channel;
+
+ZonePrototype::ZonePrototype(
+    const std::shared_ptr<objects::ServerZone>& definition,
+    const std::unordered_map<uint32_t, std::shared_ptr<objects::MiSpotData>>&
+        spots)
+    : mDefinition(definition), mSpots(spots) {
+  for (auto& spotPair : definition->GetSpots()) {
+    if (spotPair.second->GetMatchBase()) {
+      mMatchBaseSpots.insert(spotPair.first);
+    }
+  }
+}
+
+const std::shared_ptr<objects::ServerZone> ZonePrototype::GetDefinition()
+    const {
+  return mDefinition;
+}
+
+bool ZonePrototype::GetSpotPosition(uint32_t spotID, float& x, float& y,
+                                    float& rot) const {
+  if (spotID == 0) {
+    return false;
+  }
+
+  auto spotIter = mSpots.find(spotID);
+  if (spotIter != mSpots.end()) {
+    x = spotIter->second->GetCenterX();
+    y = spotIter->second->GetCenterY();
+    rot = spotIter->second->GetRotation();
+
+    return true;
+  }
+
+  return false;
+}
+
+const std::set<uint32_t>& ZonePrototype::GetMatchBaseSpots() const {
+  return mMatchBaseSpots;
+}
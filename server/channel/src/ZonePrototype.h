@@ -0,0 +1,99 @@
+/**
+ * @file server/channel/src/ZonePrototype.h
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Pre-resolved, immutable zone data shared by every zone created
+ *  from the same definition.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_ZONEPROTOTYPE_H
+#define SERVER_CHANNEL_SRC_ZONEPROTOTYPE_H
+
+// Standard C++11 includes
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+namespace objects {
+class MiSpotData;
+class ServerZone;
+}  // namespace objects
+
+namespace channel {
+
+/**
+ * Immutable zone data resolved once per zone, dynamic map and instance
+ * variant combination. The zone definition (with any partials already
+ * applied) and spot data are shared by every zone created from the
+ * prototype so creating another instance of the zone only needs to copy
+ * the per-zone entity state.
+ */
+class ZonePrototype {
+ public:
+  /**
+   * Create a new zone prototype
+   * @param definition Pointer to the fully resolved zone definition
+   * @param spots Map of spot IDs to spot definitions for the definition's
+   *  dynamic map
+   */
+  ZonePrototype(
+      const std::shared_ptr<objects::ServerZone>& definition,
+      const std::unordered_map<uint32_t, std::shared_ptr<objects::MiSpotData>>&
+          spots);
+
+  /**
+   * Get the fully resolved zone definition
+   * @return Pointer to the zone definition
+   */
+  const std::shared_ptr<objects::ServerZone> GetDefinition() const;
+
+  /**
+   * Get the center position and rotation of a spot in the zone's dynamic
+   * map
+   * @param spotID Spot ID to retrieve
+   * @param x Output parameter for the spot's X coordinate
+   * @param y Output parameter for the spot's Y coordinate
+   * @param rot Output parameter for the spot's rotation
+   * @return true if the spot exists, false if it does not
+   */
+  bool GetSpotPosition(uint32_t spotID, float& x, float& y, float& rot) const;
+
+  /**
+   * Get the spot IDs the zone definition binds to match bases
+   * @return Set of spot IDs bound to match bases
+   */
+  const std::set<uint32_t>& GetMatchBaseSpots() const;
+
+ private:
+  /// Fully resolved zone definition
+  std::shared_ptr<objects::ServerZone> mDefinition;
+
+  /// Map of spot IDs to spot definitions for the zone's dynamic map
+  std::unordered_map<uint32_t, std::shared_ptr<objects::MiSpotData>> mSpots;
+
+  /// Set of spot IDs bound to match bases
+  std::set<uint32_t> mMatchBaseSpots;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_ZONEPROTOTYPE_H
@@ -59,6 +59,7 @@
 #include "ChannelServer.h"
 #include "CharacterManager.h"
 #include "EventManager.h"
+#include "InventoryIndex.h"
 
 using namespace channel;
 
@@ -512,6 +513,7 @@ void HandleBarter(const std::shared_ptr<ChannelServer> server,
     // If there have not been failures yet, determine item adjustments
     // and apply all changes
     auto inventory = character->GetItemBoxes(0).Get();
+    InventoryIndex index(inventory);
 
     std::list<std::shared_ptr<objects::Item>> insertItems;
     std::unordered_map<std::shared_ptr<objects::Item>, uint16_t>
@@ -531,8 +533,7 @@ void HandleBarter(const std::shared_ptr<ChannelServer> server,
 
       int32_t qtyLeft = itemPair.second;
 
-      auto existing = characterManager->GetExistingItems(
-          character, itemPair.first, inventory);
+      auto existing = index.GetItems(itemPair.first);
       if (qtyLeft > 0) {
         // Update existing stacks first if we aren't adding a full stack
         int32_t maxStack = (int32_t)itemData->GetPossession()->GetStackSize();
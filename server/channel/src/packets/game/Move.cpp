@@ -121,28 +121,40 @@ bool Parsers::Move::Parse(
     if (result) {
       switch (result) {
         case 1:
-          LogGeneralDebug([&]() {
-            return libcomp::String(
-                       "Player movement rolled-back in zone %1: %2\n")
-                .Arg(zone->GetDefinitionID())
-                .Arg(state->GetAccountUID().ToString());
-          });
+          // Formatted by the log writer thread when async logging is
+          // enabled as moves are one of the most common requests.
+          LogZoneManagerDebugDelayed(
+              [](uint32_t zoneID, libcomp::String account) {
+                return libcomp::String(
+                           "Player movement rolled-back in zone %1: %2\n")
+                    .Arg(zoneID)
+                    .Arg(account);
+              },
+              (uint32_t)zone->GetDefinitionID(),
+              libcomp::String(state->GetAccountUID().ToString()));
 
           break;
         case 2:
-          LogGeneralDebug([&]() {
-            return libcomp::String(
-                       "Player movement corrected in zone %1: %2 ([%3, %4] => "
-                       "[%5, %6] to [%7, %8])\n")
-                .Arg(zone->GetDefinitionID())
-                .Arg(state->GetAccountUID().ToString())
-                .Arg(src.x)
-                .Arg(src.y)
-                .Arg(destX)
-                .Arg(destY)
-                .Arg(dest.x)
-                .Arg(dest.y);
-          });
+          LogZoneManagerDebugDelayed(
+              [](uint32_t zoneID, libcomp::String account, float srcX,
+                 float srcY, float oldDestX, float oldDestY, float newDestX,
+                 float newDestY) {
+                return libcomp::String(
+                           "Player movement corrected in zone %1: %2 ([%3, "
+                           "%4] => [%5, %6] to [%7, %8])\n")
+                    .Arg(zoneID)
+                    .Arg(account)
+                    .Arg(srcX)
+                    .Arg(srcY)
+                    .Arg(oldDestX)
+                    .Arg(oldDestY)
+                    .Arg(newDestX)
+                    .Arg(newDestY);
+              },
+              (uint32_t)zone->GetDefinitionID(),
+              libcomp::String(state->GetAccountUID().ToString()), (float)src.x,
+              (float)src.y, (float)destX, (float)destY, (float)dest.x,
+              (float)dest.y);
           break;
         default:
           break;
@@ -138,6 +138,9 @@ bool Parsers::PlasmaItem::Parse(
       }
 
       if (pState->HideIfEmpty(point)) {
+        // The point is now hidden and needs to respawn
+        zone->ScheduleSpawnCheck();
+
         libcomp::Packet notify;
         pState->GetPointStatusData(notify, (uint32_t)point->GetID());
         server->GetZoneManager()->BroadcastPacket(client, notify, true);
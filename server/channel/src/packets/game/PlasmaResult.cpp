@@ -72,6 +72,11 @@ bool Parsers::PlasmaResult::Parse(
 
   bool failure = result < 0;
 
+  if (point) {
+    // The point will now hide or respawn
+    zone->ScheduleSpawnCheck();
+  }
+
   libcomp::Packet reply;
   reply.WritePacketCode(ChannelToClientPacketCode_t::PACKET_PLASMA_RESULT);
   reply.WriteS32Little(plasmaID);
@@ -0,0 +1,170 @@
+/**
+ * @file server/channel/tests/AIHookTable.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Test resolving AI script hooks.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libhack Includes
+#include <ScriptEngine.h>
+
+// channel Includes
+#include <AIHookTable.h>
+
+using namespace channel;
+
+/**
+ * AI script with a default and a renamed function for the combat hook.
+ */
+static const char* AI_SCRIPT =
+    "function combat()\n"
+    "{\n"
+    "    return 1;\n"
+    "}\n"
+    "\n"
+    "function altCombat()\n"
+    "{\n"
+    "    return 2;\n"
+    "}\n";
+
+/**
+ * Build an engine with the test AI script loaded.
+ * @param source Source code of the script
+ * @return Pointer to the script engine
+ */
+static std::shared_ptr<libhack::ScriptEngine> MakeEngine(
+    const libcomp::String& source) {
+  std::vector<char> bytecode;
+
+  auto engine = std::make_shared<libhack::ScriptEngine>();
+  EXPECT_TRUE(engine->Compile(source, "test_ai.nut", bytecode));
+  EXPECT_TRUE(engine->EvalBytecode(bytecode, "test_ai.nut"));
+
+  return engine;
+}
+
+/**
+ * Call the function resolved for a hook.
+ * @param hooks Hook table to get the function from
+ * @param hook Hook to call
+ * @return Value returned by the function or -1 if it could not be called
+ */
+static SQInteger CallHook(const AIHookTable& hooks, AIHook_t hook) {
+  auto f = hooks.GetFunction(hook);
+  if (f.IsNull()) {
+    return -1;
+  }
+
+  auto result = f.Evaluate<SQInteger>();
+
+  return result ? *result : -1;
+}
+
+TEST(AIHookTable, Names) {
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    EXPECT_EQ((AIHook_t)i,
+              AIHookTable::GetHook(AIHookTable::GetName((AIHook_t)i)));
+  }
+
+  EXPECT_EQ(AI_HOOK_COMBAT_SKILL_HIT, AIHookTable::GetHook("combatSkillHit"));
+  EXPECT_EQ(AI_HOOK_COUNT, AIHookTable::GetHook("unknown"));
+  EXPECT_STREQ("", AIHookTable::GetName(AI_HOOK_COUNT));
+}
+
+TEST(AIHookTable, OverrideAfterScript) {
+  AIHookTable hooks;
+  hooks.SetScript(MakeEngine(AI_SCRIPT));
+
+  EXPECT_FALSE(hooks.Has(AI_HOOK_COMBAT));
+  EXPECT_EQ(-1, CallHook(hooks, AI_HOOK_COMBAT));
+
+  // Overriding with no function name uses the default function
+  hooks.SetOverride("combat", "");
+  EXPECT_TRUE(hooks.Has(AI_HOOK_COMBAT));
+  EXPECT_EQ(1, CallHook(hooks, AI_HOOK_COMBAT));
+
+  // Changing the override after the script is set resolves it again
+  hooks.SetOverride("combat", "altCombat");
+  EXPECT_EQ(libcomp::String("altCombat"), hooks.GetOverride(AI_HOOK_COMBAT));
+  EXPECT_EQ(2, CallHook(hooks, AI_HOOK_COMBAT));
+
+  hooks.RemoveOverride("combat");
+  EXPECT_FALSE(hooks.Has(AI_HOOK_COMBAT));
+  EXPECT_EQ(-1, CallHook(hooks, AI_HOOK_COMBAT));
+
+  // Keys that are not hooks are ignored
+  hooks.SetOverride("unknown", "altCombat");
+  for (uint8_t i = 0; i < AI_HOOK_COUNT; i++) {
+    EXPECT_FALSE(hooks.Has((AIHook_t)i));
+  }
+}
+
+TEST(AIHookTable, ScriptAfterOverride) {
+  AIHookTable hooks;
+  hooks.SetOverride("combat", "altCombat");
+
+  // Overrides are kept without a script but nothing is resolved
+  EXPECT_TRUE(hooks.Has(AI_HOOK_COMBAT));
+  EXPECT_EQ(-1, CallHook(hooks, AI_HOOK_COMBAT));
+
+  hooks.SetScript(MakeEngine(AI_SCRIPT));
+  EXPECT_EQ(2, CallHook(hooks, AI_HOOK_COMBAT));
+
+  // Replacing the script resolves against the new one
+  hooks.SetScript(MakeEngine("function altCombat() { return 3; }"));
+  EXPECT_EQ(3, CallHook(hooks, AI_HOOK_COMBAT));
+
+  hooks.SetScript(nullptr);
+  EXPECT_TRUE(hooks.Has(AI_HOOK_COMBAT));
+  EXPECT_EQ(-1, CallHook(hooks, AI_HOOK_COMBAT));
+}
+
+TEST(AIHookTable, Clear) {
+  AIHookTable hooks;
+  hooks.SetScript(MakeEngine(AI_SCRIPT));
+  hooks.SetOverride("combat", "");
+  hooks.SetOverride("idle", "altCombat");
+
+  hooks.ClearOverrides();
+  EXPECT_FALSE(hooks.Has(AI_HOOK_COMBAT));
+  EXPECT_FALSE(hooks.Has(AI_HOOK_IDLE));
+  EXPECT_EQ(-1, CallHook(hooks, AI_HOOK_IDLE));
+  EXPECT_TRUE(hooks.GetOverride(AI_HOOK_IDLE).IsEmpty());
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
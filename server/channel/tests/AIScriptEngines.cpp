@@ -0,0 +1,298 @@
+/**
+ * @file server/channel/tests/AIScriptEngines.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Test shared and per zone AI script engines.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libhack Includes
+#include <ScriptEngine.h>
+#include <ServerDataManager.h>
+
+// channel Includes
+#include <AIScriptEngines.h>
+
+// Standard C++11 Includes
+#include <thread>
+
+using namespace channel;
+
+/// Number of zones simulated by the determinism tests
+static const uint32_t ZONE_COUNT = 4;
+
+/// Number of AI controlled entities simulated in each zone
+static const size_t ENTITY_COUNT = 16;
+
+/// Number of AI updates run for every entity
+static const uint64_t TICK_COUNT = 200;
+
+/**
+ * AI script that keeps entity state and a count of every update in the VM
+ * so anything else running in the same VM changes the results.
+ */
+static const char* AI_SCRIPT =
+    "updates <- 0;\n"
+    "states <- {};\n"
+    "\n"
+    "function prepare(id)\n"
+    "{\n"
+    "    ::states[id] <- id & 0x7FFFFFFF;\n"
+    "    return ::states[id];\n"
+    "}\n"
+    "\n"
+    "function update(id, now)\n"
+    "{\n"
+    "    ::updates += 1;\n"
+    "    local state = ::states[id];\n"
+    "    local target = (state * 1103515245 + 12345 + now + ::updates) &\n"
+    "        0x7FFFFFFF;\n"
+    "    ::states[id] = (target % 3) == 0 ? target / 2 : target;\n"
+    "    return ::states[id];\n"
+    "}\n"
+    "\n"
+    "function getUpdates()\n"
+    "{\n"
+    "    return ::updates;\n"
+    "}\n";
+
+/**
+ * Build an AI script definition with compiled bytecode, the same way the
+ * ServerDataManager does when it loads a script.
+ * @param name Name of the script
+ * @param source Source code of the script
+ * @param instantiated true if each entity gets its own engine
+ * @return Script definition
+ */
+static libhack::ServerScript MakeScript(const libcomp::String& name,
+                                        const libcomp::String& source,
+                                        bool instantiated = false) {
+  libhack::ServerScript script;
+  script.Name = name;
+  script.Path = name + ".nut";
+  script.Source = source;
+  script.Type = "AI";
+  script.Instantiated = instantiated;
+
+  libhack::ScriptEngine compiler;
+  EXPECT_TRUE(compiler.Compile(source, script.Path, script.Bytecode));
+
+  return script;
+}
+
+/**
+ * Prepare and update every entity in a zone with one engine.
+ * @param engine Engine to run the AI script in
+ * @param zoneID ID of the zone, used to seed each entity
+ * @param states Output vector of the state of every entity after every
+ *  update, in update order
+ */
+static void RunZone(const std::shared_ptr<libhack::ScriptEngine>& engine,
+                    uint32_t zoneID, std::vector<SQInteger>& states) {
+  Sqrat::RootTable root(engine->GetVM());
+  Sqrat::Function prepare(root, "prepare");
+  Sqrat::Function update(root, "update");
+
+  std::vector<SQInteger> entities;
+  for (size_t i = 0; i < ENTITY_COUNT; i++) {
+    auto id = (SQInteger)(zoneID * 1000 + i + 1);
+    prepare.Evaluate<SQInteger>(id);
+    entities.push_back(id);
+  }
+
+  for (uint64_t now = 1; now <= TICK_COUNT; now++) {
+    for (auto id : entities) {
+      auto result = update.Evaluate<SQInteger>(id, (SQInteger)now);
+      states.push_back(result ? *result : -1);
+    }
+  }
+}
+
+/**
+ * Get the number of updates an engine has run.
+ * @param engine Engine the AI script is loaded in
+ * @return Number of updates recorded in the VM
+ */
+static SQInteger GetUpdates(
+    const std::shared_ptr<libhack::ScriptEngine>& engine) {
+  Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "getUpdates");
+  auto result = f.Evaluate<SQInteger>();
+
+  return result ? *result : -1;
+}
+
+TEST(AIScriptEngines, SharedEngine) {
+  AIScriptEngines engines(nullptr);
+  auto script = MakeScript("test_ai", AI_SCRIPT);
+
+  auto engine = engines.GetShared(script);
+  ASSERT_NE(nullptr, engine);
+  EXPECT_EQ(engine, engines.GetShared(script));
+  EXPECT_EQ(0u, engines.GetZoneCount());
+}
+
+TEST(AIScriptEngines, ZoneEngines) {
+  AIScriptEngines engines(nullptr);
+  auto script = MakeScript("test_ai", AI_SCRIPT);
+
+  auto shared = engines.GetShared(script);
+  auto zone1 = engines.GetForZone(script, 1);
+  auto zone2 = engines.GetForZone(script, 2);
+
+  ASSERT_NE(nullptr, zone1);
+  ASSERT_NE(nullptr, zone2);
+
+  // Every zone gets its own engine that is reused within the zone
+  EXPECT_NE(shared, zone1);
+  EXPECT_NE(zone1, zone2);
+  EXPECT_EQ(zone1, engines.GetForZone(script, 1));
+  EXPECT_EQ(2u, engines.GetZoneCount());
+
+  // Releasing a zone drops its engines only
+  engines.ReleaseZone(1);
+  EXPECT_EQ(1u, engines.GetZoneCount());
+  EXPECT_NE(zone1, engines.GetForZone(script, 1));
+  EXPECT_EQ(zone2, engines.GetForZone(script, 2));
+}
+
+TEST(AIScriptEngines, Instantiated) {
+  AIScriptEngines engines(nullptr);
+  auto script = MakeScript("test_ai", AI_SCRIPT, true);
+
+  auto engine = engines.GetShared(script);
+  ASSERT_NE(nullptr, engine);
+  EXPECT_NE(engine, engines.GetShared(script));
+  EXPECT_NE(engines.GetForZone(script, 1), engines.GetForZone(script, 1));
+}
+
+TEST(AIScriptEngines, InvalidScript) {
+  AIScriptEngines engines(nullptr);
+
+  libhack::ServerScript script;
+  script.Name = "broken_ai";
+  script.Path = "broken_ai.nut";
+  script.Source = "function prepare( {";
+
+  EXPECT_EQ(nullptr, engines.GetShared(script));
+  EXPECT_EQ(nullptr, engines.GetForZone(script, 1));
+}
+
+TEST(AIScriptEngines, Binder) {
+  size_t bound = 0;
+  AIScriptEngines engines([&bound](libhack::ScriptEngine&) { bound++; });
+  auto script = MakeScript("test_ai", AI_SCRIPT);
+
+  engines.GetShared(script);
+  engines.GetShared(script);
+  engines.GetForZone(script, 1);
+
+  EXPECT_EQ(2u, bound);
+}
+
+TEST(AIScriptEngines, IsolatedZones) {
+  auto script = MakeScript("test_ai", AI_SCRIPT);
+
+  // Expected results: every zone runs alone in a fresh engine
+  std::vector<std::vector<SQInteger>> expected(ZONE_COUNT);
+  for (uint32_t zoneID = 1; zoneID <= ZONE_COUNT; zoneID++) {
+    AIScriptEngines engines(nullptr);
+    auto engine = engines.GetForZone(script, zoneID);
+    ASSERT_NE(nullptr, engine);
+
+    RunZone(engine, zoneID, expected[zoneID - 1]);
+  }
+
+  // Isolated mode: every zone runs at the same time in its own engine
+  AIScriptEngines zoneEngines(nullptr);
+  std::vector<std::shared_ptr<libhack::ScriptEngine>> isolated;
+  for (uint32_t zoneID = 1; zoneID <= ZONE_COUNT; zoneID++) {
+    isolated.push_back(zoneEngines.GetForZone(script, zoneID));
+    ASSERT_NE(nullptr, isolated.back());
+  }
+
+  std::vector<std::vector<SQInteger>> isolatedStates(ZONE_COUNT);
+  std::vector<std::thread> workers;
+  for (uint32_t zoneID = 1; zoneID <= ZONE_COUNT; zoneID++) {
+    workers.push_back(std::thread([&, zoneID]() {
+      RunZone(isolated[zoneID - 1], zoneID, isolatedStates[zoneID - 1]);
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  // No zone saw the state of another
+  for (uint32_t i = 0; i < ZONE_COUNT; i++) {
+    ASSERT_EQ(ENTITY_COUNT * TICK_COUNT, isolatedStates[i].size());
+    EXPECT_EQ(expected[i], isolatedStates[i]);
+    EXPECT_EQ((SQInteger)(ENTITY_COUNT * TICK_COUNT), GetUpdates(isolated[i]));
+  }
+
+  // Zones seed their entities differently so they must not all match
+  EXPECT_NE(expected[0], expected[1]);
+}
+
+TEST(AIScriptEngines, SharedEngineState) {
+  auto script = MakeScript("test_ai", AI_SCRIPT);
+
+  // Shared mode: every zone runs one after another in the same engine
+  AIScriptEngines sharedEngines(nullptr);
+  auto shared = sharedEngines.GetShared(script);
+  ASSERT_NE(nullptr, shared);
+
+  std::vector<std::vector<SQInteger>> sharedStates(ZONE_COUNT);
+  for (uint32_t zoneID = 1; zoneID <= ZONE_COUNT; zoneID++) {
+    RunZone(shared, zoneID, sharedStates[zoneID - 1]);
+  }
+
+  AIScriptEngines zoneEngines(nullptr);
+  std::vector<SQInteger> first;
+  RunZone(zoneEngines.GetForZone(script, 1), 1, first);
+
+  // The first zone runs on a fresh VM either way but every later zone
+  // sees the updates the earlier zones left in the shared VM
+  EXPECT_EQ(first, sharedStates[0]);
+  EXPECT_EQ((SQInteger)(ZONE_COUNT * ENTITY_COUNT * TICK_COUNT),
+            GetUpdates(shared));
+
+  std::vector<SQInteger> second;
+  RunZone(zoneEngines.GetForZone(script, 2), 2, second);
+  EXPECT_NE(second, sharedStates[1]);
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,386 @@
+/**
+ * @file server/channel/tests/DropTable.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Test that compiled drop tables keep the drop distributions.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <Randomizer.h>
+
+// object Includes
+#include <ItemDrop.h>
+
+// channel Includes
+#include <DropTable.h>
+
+// Standard C++11 Includes
+#include <cmath>
+#include <map>
+#include <vector>
+
+using namespace channel;
+
+/// Number of rolls made for each distribution
+static const size_t ROLL_COUNT = 200000;
+
+/// Number of standard deviations a count may be off by before the
+/// distributions are considered different. The rolls are not seeded so
+/// this is set high enough to never fail by chance.
+static const double MAX_DEVIATION = 5.0;
+
+/// Item drop list type
+typedef std::list<std::shared_ptr<objects::ItemDrop>> DropList_t;
+
+/**
+ * Create an item drop.
+ * @param itemType Item type of the drop, used to identify it
+ * @param rate Percent drop rate
+ * @param cooldown Optional cooldown restriction
+ * @return Pointer to the new drop
+ */
+static std::shared_ptr<objects::ItemDrop> MakeDrop(uint32_t itemType,
+                                                   float rate,
+                                                   int32_t cooldown = 0) {
+  auto drop = std::make_shared<objects::ItemDrop>();
+  drop->SetItemType(itemType);
+  drop->SetRate(rate);
+  drop->SetCooldownRestrict(cooldown);
+
+  return drop;
+}
+
+/**
+ * Work out the drop rate of a drop with the formula CharacterManager used
+ * before drop tables were compiled. This is a copy so the tests do not
+ * compare the drop table against itself.
+ * @param baseRate Percent drop rate of the drop
+ * @param luck Current luck value
+ * @param scalingCap Maximum bonus luck can add to a drop rate
+ * @param dropBonus Global drop rate bonus to apply
+ * @return Drop rate out of 10000
+ */
+static uint32_t ListDropRate(double baseRate, int16_t luck, float scalingCap,
+                             float dropBonus) {
+  uint32_t dropRate = (uint32_t)(baseRate * 100.0);
+  if (luck > 0 && scalingCap != 0.f) {
+    double deltaDiff = (double)(100.0 - baseRate);
+    dropRate = (uint32_t)(
+        baseRate *
+        (100.f +
+         100.f * (float)(((double)luck / 30.0) * 10.0 * (double)luck) /
+             (1000.0 + 7.0 * (double)luck + (deltaDiff * deltaDiff))));
+
+    // Limit luck scaling based on cap
+    if (scalingCap > 0.f &&
+        (float)((double)dropRate / (baseRate * 100.0)) > (1.f + scalingCap)) {
+      dropRate = (uint32_t)(baseRate * 100.0 * (1.0 + (double)scalingCap));
+    }
+  }
+
+  return (uint32_t)((double)dropRate * (double)(1.f + dropBonus));
+}
+
+/**
+ * Roll a list of drops the way CharacterManager did before drop tables
+ * were compiled: every drop is rolled in list order with the full rate
+ * formula worked out from the definition each time.
+ * @param drops Drops to roll
+ * @param luck Current luck value
+ * @param scalingCap Maximum bonus luck can add to a drop rate
+ * @param dropBonus Global drop rate bonus to apply
+ * @param minLast true if at least one item is needed
+ * @return List of item drops that should be "dropped"
+ */
+static DropList_t RollList(const DropList_t& drops, int16_t luck,
+                           float scalingCap, float dropBonus, bool minLast) {
+  DropList_t results;
+  for (auto drop : drops) {
+    uint32_t dropRate =
+        ListDropRate((double)drop->GetRate(), luck, scalingCap, dropBonus);
+
+    if (dropRate >= 10000 || RNG(uint16_t, 1, 10000) <= dropRate ||
+        (minLast && results.size() == 0 && drops.back() == drop)) {
+      results.push_back(drop);
+    }
+  }
+
+  return results;
+}
+
+/**
+ * Counts gathered from many rolls of the same drops.
+ */
+struct RollCounts {
+  /// Number of times each item type dropped
+  std::map<uint32_t, uint64_t> Items;
+
+  /// Number of rolls that dropped each number of items
+  std::map<size_t, uint64_t> Sizes;
+
+  /**
+   * Add the result of one roll.
+   * @param results Drops from the roll
+   */
+  void Add(const DropList_t& results) {
+    Sizes[results.size()]++;
+    for (auto drop : results) {
+      Items[drop->GetItemType()]++;
+    }
+  }
+};
+
+/**
+ * Check that two sets of counts from the same number of rolls could have
+ * come from the same distribution.
+ * @param expected Counts from the reference rolls
+ * @param actual Counts from the rolls being tested
+ */
+static void ExpectSameDistribution(const std::map<size_t, uint64_t>& expected,
+                                   const std::map<size_t, uint64_t>& actual) {
+  std::map<size_t, std::pair<uint64_t, uint64_t>> merged;
+  for (auto& pair : expected) {
+    merged[pair.first].first = pair.second;
+  }
+
+  for (auto& pair : actual) {
+    merged[pair.first].second = pair.second;
+  }
+
+  for (auto& pair : merged) {
+    double a = (double)pair.second.first;
+    double b = (double)pair.second.second;
+
+    // Two sample test on a pair of counts
+    double deviation = std::fabs(a - b) / std::sqrt(std::max(a + b, 1.0));
+    EXPECT_GT(MAX_DEVIATION, deviation)
+        << "key " << pair.first << " expected " << pair.second.first
+        << " but got " << pair.second.second;
+  }
+}
+
+/**
+ * Check that the counts of every item match between two sets of rolls.
+ * @param expected Counts from the reference rolls
+ * @param actual Counts from the rolls being tested
+ */
+static void ExpectSameDistribution(const RollCounts& expected,
+                                   const RollCounts& actual) {
+  std::map<size_t, uint64_t> expectedItems, actualItems;
+  for (auto& pair : expected.Items) {
+    expectedItems[pair.first] = pair.second;
+  }
+
+  for (auto& pair : actual.Items) {
+    actualItems[pair.first] = pair.second;
+  }
+
+  ExpectSameDistribution(expectedItems, actualItems);
+  ExpectSameDistribution(expected.Sizes, actual.Sizes);
+}
+
+/**
+ * Get a drop list covering guaranteed, common, rare and near impossible
+ * drops.
+ * @return Drop list
+ */
+static DropList_t GetDrops() {
+  return {MakeDrop(1, 100.f), MakeDrop(2, 75.f), MakeDrop(3, 50.f),
+          MakeDrop(4, 10.f),  MakeDrop(5, 1.f),  MakeDrop(6, 0.1f)};
+}
+
+TEST(DropTable, ExactRates) {
+  // Fixed inputs worked out by hand
+  EXPECT_EQ(5000u, DropTable::GetDropRate(50.0, 2500.0, 0, 0.f, 0.f));
+  EXPECT_EQ(7500u, DropTable::GetDropRate(50.0, 2500.0, 0, 0.f, 0.5f));
+  EXPECT_EQ(5000u, DropTable::GetDropRate(50.0, 2500.0, 300, 0.f, 0.f));
+  EXPECT_EQ(11250u, DropTable::GetDropRate(75.0, 625.0, 300, 0.5f, 0.f));
+  EXPECT_EQ(10u, DropTable::GetDropRate(0.1, 99.9 * 99.9, 0, 0.f, 0.f));
+
+  // Every combination must match the list formula exactly
+  for (double baseRate : {100.0, 75.0, 50.0, 10.0, 1.0, 0.1}) {
+    double deltaDiff = 100.0 - baseRate;
+    for (int16_t luck : {0, 1, 10, 40, 114, 300, 600, 999}) {
+      for (float scalingCap : {0.f, 0.5f, 1.f, -1.f}) {
+        for (float dropBonus : {0.f, 0.25f, 1.f}) {
+          EXPECT_EQ(ListDropRate(baseRate, luck, scalingCap, dropBonus),
+                    DropTable::GetDropRate(baseRate, deltaDiff * deltaDiff,
+                                           luck, scalingCap, dropBonus))
+              << "rate " << baseRate << " luck " << luck << " cap "
+              << scalingCap << " bonus " << dropBonus;
+        }
+      }
+    }
+  }
+}
+
+TEST(DropTable, RatesMatchFormula) {
+  auto drops = GetDrops();
+  DropTable table(drops);
+
+  ASSERT_EQ(drops.size(), table.Size());
+
+  RollCounts counts;
+  for (size_t i = 0; i < ROLL_COUNT; i++) {
+    counts.Add(table.Roll(0, 0.f, 0.f, false));
+  }
+
+  for (auto drop : drops) {
+    double p = std::min((double)drop->GetRate() / 100.0, 1.0);
+    double mean = (double)ROLL_COUNT * p;
+    double sigma = std::sqrt(mean * (1.0 - p));
+
+    double actual = (double)counts.Items[drop->GetItemType()];
+    EXPECT_GE(MAX_DEVIATION * sigma + 1.0, std::fabs(actual - mean))
+        << "item " << drop->GetItemType();
+  }
+}
+
+TEST(DropTable, MatchesListRolls) {
+  auto drops = GetDrops();
+  DropTable table(drops);
+
+  // Cover no luck, luck scaling with and without a cap and a global bonus
+  struct Settings {
+    int16_t Luck;
+    float ScalingCap;
+    float DropBonus;
+    bool MinLast;
+  };
+
+  for (auto& settings : std::vector<Settings>{{0, 0.f, 0.f, false},
+                                              {300, 0.f, 0.f, false},
+                                              {300, 0.5f, 0.f, false},
+                                              {40, 1.f, 0.5f, false},
+                                              {0, 0.f, 0.f, true}}) {
+    RollCounts expected, actual;
+    for (size_t i = 0; i < ROLL_COUNT; i++) {
+      expected.Add(RollList(drops, settings.Luck, settings.ScalingCap,
+                            settings.DropBonus, settings.MinLast));
+      actual.Add(table.Roll(settings.Luck, settings.ScalingCap,
+                            settings.DropBonus, settings.MinLast));
+    }
+
+    ExpectSameDistribution(expected, actual);
+  }
+}
+
+TEST(DropTable, MinLast) {
+  // Every drop is rare so most rolls fall back to the last drop
+  DropList_t drops = {MakeDrop(1, 1.f), MakeDrop(2, 1.f), MakeDrop(3, 1.f)};
+  DropTable table(drops);
+
+  RollCounts counts;
+  for (size_t i = 0; i < ROLL_COUNT; i++) {
+    auto results = table.Roll(0, 0.f, 0.f, true);
+    ASSERT_LT(0u, results.size());
+
+    counts.Add(results);
+  }
+
+  // The last drop is used when it rolls or when nothing else does
+  double p = 0.01 + 0.99 * 0.99 * 0.99;
+  double mean = (double)ROLL_COUNT * p;
+  double sigma = std::sqrt(mean * (1.0 - p));
+  EXPECT_GE(MAX_DEVIATION * sigma + 1.0,
+            std::fabs((double)counts.Items[3] - mean));
+}
+
+TEST(DropTable, FilteredTablesMatchFilteredList) {
+  // Enemy loot is rolled one table at a time with drops that do not apply
+  // to the killer skipped. This must match rolling one combined list of
+  // the drops that apply.
+  DropList_t spawnDrops = {MakeDrop(1, 50.f), MakeDrop(2, 25.f, 7)};
+  DropList_t setDrops = {MakeDrop(3, 10.f), MakeDrop(4, 30.f, 8),
+                         MakeDrop(5, 5.f)};
+
+  std::list<std::shared_ptr<DropTable>> tables = {
+      std::make_shared<DropTable>(spawnDrops),
+      std::make_shared<DropTable>(setDrops)};
+
+  // Only cooldown 7 is active
+  DropTable::Filter_t filter = [](const objects::ItemDrop& drop) {
+    return drop.GetCooldownRestrict() == 0 || drop.GetCooldownRestrict() == 7;
+  };
+
+  DropList_t filtered;
+  for (auto& table : tables) {
+    table->GetDrops(filtered, filter);
+  }
+
+  ASSERT_EQ(4u, filtered.size());
+  EXPECT_EQ(5u, filtered.back()->GetItemType());
+
+  for (bool minLast : {false, true}) {
+    RollCounts expected, actual;
+    for (size_t i = 0; i < ROLL_COUNT; i++) {
+      expected.Add(RollList(filtered, 100, 0.f, 0.f, minLast));
+
+      DropList_t results;
+      std::shared_ptr<objects::ItemDrop> last;
+      for (auto& table : tables) {
+        auto tableLast = table->Roll(100, 0.f, 0.f, results, filter);
+        if (tableLast) {
+          last = tableLast;
+        }
+      }
+
+      if (minLast && results.size() == 0 && last) {
+        results.push_back(last);
+      }
+
+      actual.Add(results);
+    }
+
+    EXPECT_EQ(0u, actual.Items[4]);
+    ExpectSameDistribution(expected, actual);
+  }
+}
+
+TEST(DropTable, Empty) {
+  DropTable table({});
+
+  EXPECT_EQ(0u, table.Size());
+  EXPECT_EQ(0u, table.Roll(0, 0.f, 0.f, true).size());
+
+  DropList_t results;
+  EXPECT_EQ(nullptr, table.Roll(0, 0.f, 0.f, results));
+  EXPECT_EQ(0u, results.size());
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,361 @@
+/**
+ * @file server/channel/tests/ZoneGeometry.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Test and benchmark indexed zone geometry collision checks.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// object Includes
+#include <QmpElement.h>
+
+// channel Includes
+#include <ZoneGeometry.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+using namespace channel;
+
+/// Width and height of the generated zone
+static const float ZONE_SIZE = 40000.f;
+
+/// Number of wall boxes in the generated zone
+static const size_t BOX_COUNT = 1500;
+
+/// Number of players moving around the generated zone
+static const size_t PLAYER_COUNT = 64;
+
+/// Number of moves in the generated move stream
+static const size_t MOVE_COUNT = 50000;
+
+/// Number of times the move stream is replayed when timing it
+static const size_t REPLAY_PASSES = 3;
+
+/**
+ * Build a shape from a list of points.
+ * @param points Points of the shape, in order
+ * @param closed true if the last point connects back to the first
+ * @return Pointer to the new shape
+ */
+static std::shared_ptr<ZoneQmpShape> MakeShape(
+    const std::vector<Point>& points, bool closed) {
+  auto shape = std::make_shared<ZoneQmpShape>();
+  shape->IsLine = !closed;
+
+  Point minimum = points.front();
+  Point maximum = points.front();
+  for (size_t i = 0; i < points.size(); i++) {
+    const Point& p = points[i];
+    shape->Vertices.push_back(p);
+
+    minimum.x = std::min(minimum.x, p.x);
+    minimum.y = std::min(minimum.y, p.y);
+    maximum.x = std::max(maximum.x, p.x);
+    maximum.y = std::max(maximum.y, p.y);
+
+    if (i + 1 < points.size()) {
+      shape->Lines.push_back(Line(p, points[i + 1]));
+    } else if (closed) {
+      shape->Lines.push_back(Line(p, points.front()));
+    }
+  }
+
+  shape->Boundaries[0] = minimum;
+  shape->Boundaries[1] = maximum;
+
+  return shape;
+}
+
+/**
+ * Build the same set of shapes into one geometry with a collision index
+ * and one without.
+ * @param shapes Shapes to add to both
+ * @param indexed Output geometry with the index built
+ * @param unindexed Output geometry without an index
+ */
+static void MakeGeometry(
+    const std::list<std::shared_ptr<ZoneQmpShape>>& shapes,
+    ZoneGeometry& indexed, ZoneGeometry& unindexed) {
+  indexed.Shapes = shapes;
+  unindexed.Shapes = shapes;
+
+  indexed.BuildIndex();
+}
+
+/**
+ * Generate a zone filled with wall boxes and a few long walls that cross
+ * many index cells.
+ * @return Shapes of the zone
+ */
+static std::list<std::shared_ptr<ZoneQmpShape>> GenerateZone() {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> pos(0.f, ZONE_SIZE);
+  std::uniform_real_distribution<float> size(50.f, 600.f);
+
+  std::list<std::shared_ptr<ZoneQmpShape>> shapes;
+  for (size_t i = 0; i < BOX_COUNT; i++) {
+    float x = pos(rng);
+    float y = pos(rng);
+    float w = size(rng);
+    float h = size(rng);
+
+    shapes.push_back(MakeShape(
+        {Point(x, y), Point(x + w, y), Point(x + w, y + h), Point(x, y + h)},
+        true));
+  }
+
+  // Long walls with openings
+  for (float y = 5000.f; y < ZONE_SIZE; y += 10000.f) {
+    shapes.push_back(MakeShape({Point(0.f, y), Point(18000.f, y)}, false));
+    shapes.push_back(
+        MakeShape({Point(20000.f, y), Point(ZONE_SIZE, y)}, false));
+  }
+
+  return shapes;
+}
+
+/**
+ * Generate a stream of player moves like the ones sent by clients. If the
+ * COMP_MOVE_STREAM environment variable is set, the moves are read from
+ * that file instead, one "x1 y1 x2 y2" move per line.
+ * @return List of moves
+ */
+static std::vector<Line> GenerateMoves() {
+  std::vector<Line> moves;
+
+  const char* path = std::getenv("COMP_MOVE_STREAM");
+  if (path) {
+    std::ifstream in(path);
+
+    float x1, y1, x2, y2;
+    while (in >> x1 >> y1 >> x2 >> y2) {
+      moves.push_back(Line(x1, y1, x2, y2));
+    }
+
+    if (!moves.empty()) {
+      return moves;
+    }
+  }
+
+  std::mt19937 rng(5678);
+  std::uniform_real_distribution<float> pos(0.f, ZONE_SIZE);
+  std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+  std::uniform_real_distribution<float> dist(20.f, 400.f);
+
+  std::vector<Point> players;
+  for (size_t i = 0; i < PLAYER_COUNT; i++) {
+    players.push_back(Point(pos(rng), pos(rng)));
+  }
+
+  for (size_t i = 0; i < MOVE_COUNT; i++) {
+    Point& src = players[i % PLAYER_COUNT];
+
+    float a = angle(rng);
+    float d = dist(rng);
+    Point dest(std::min(std::max(src.x + std::cos(a) * d, 0.f), ZONE_SIZE),
+               std::min(std::max(src.y + std::sin(a) * d, 0.f), ZONE_SIZE));
+
+    moves.push_back(Line(src, dest));
+    src = dest;
+  }
+
+  return moves;
+}
+
+/**
+ * Replay a move stream against a geometry.
+ * @param geometry Geometry to check the moves against
+ * @param moves Moves to check
+ * @return Number of moves that collided
+ */
+static size_t Replay(const ZoneGeometry& geometry,
+                     const std::vector<Line>& moves) {
+  size_t collisions = 0;
+
+  Point point;
+  for (const Line& move : moves) {
+    if (geometry.Collides(move, point)) {
+      collisions++;
+    }
+  }
+
+  return collisions;
+}
+
+TEST(ZoneGeometry, IndexMatchesFullScan) {
+  ZoneGeometry indexed, unindexed;
+  MakeGeometry(GenerateZone(), indexed, unindexed);
+
+  ASSERT_LT(0.f, indexed.IndexCellSize);
+  ASSERT_EQ(0.f, unindexed.IndexCellSize);
+
+  size_t collisions = 0;
+  for (const Line& move : GenerateMoves()) {
+    Point indexedPoint, unindexedPoint;
+    Line indexedSurface, unindexedSurface;
+    std::shared_ptr<ZoneShape> indexedShape, unindexedShape;
+
+    bool hit = indexed.Collides(move, indexedPoint, indexedSurface,
+                                indexedShape);
+    ASSERT_EQ(unindexed.Collides(move, unindexedPoint, unindexedSurface,
+                                 unindexedShape),
+              hit);
+
+    if (hit) {
+      collisions++;
+
+      EXPECT_NEAR(unindexedPoint.x, indexedPoint.x, 0.01f);
+      EXPECT_NEAR(unindexedPoint.y, indexedPoint.y, 0.01f);
+      EXPECT_NE(nullptr, indexedShape);
+    }
+  }
+
+  // The stream should be a mix of open and blocked moves
+  EXPECT_LT(0u, collisions);
+}
+
+TEST(ZoneGeometry, LineAcrossManyCells) {
+  ZoneGeometry indexed, unindexed;
+  MakeGeometry({MakeShape({Point(-5000.f, 0.f), Point(5000.f, 0.f)}, false)},
+               indexed, unindexed);
+
+  // The wall is in 20 cells and the path overlaps several of them
+  Point point;
+  Line surface;
+  std::shared_ptr<ZoneShape> shape;
+  ASSERT_TRUE(indexed.Collides(Line(-1200.f, -100.f, 1200.f, 100.f), point,
+                               surface, shape));
+  EXPECT_NEAR(0.f, point.x, 0.01f);
+  EXPECT_NEAR(0.f, point.y, 0.01f);
+  EXPECT_EQ(indexed.Shapes.front(), shape);
+
+  EXPECT_FALSE(indexed.Collides(Line(-1200.f, 100.f, 1200.f, 200.f), point));
+}
+
+TEST(ZoneGeometry, ClosestCollision) {
+  ZoneGeometry indexed, unindexed;
+  MakeGeometry({MakeShape({Point(900.f, -100.f), Point(900.f, 100.f)}, false),
+                MakeShape({Point(300.f, -100.f), Point(300.f, 100.f)}, false)},
+               indexed, unindexed);
+
+  Point point;
+  ASSERT_TRUE(indexed.Collides(Line(0.f, 0.f, 1200.f, 0.f), point));
+  EXPECT_NEAR(300.f, point.x, 0.01f);
+
+  ASSERT_TRUE(indexed.Collides(Line(1200.f, 0.f, 0.f, 0.f), point));
+  EXPECT_NEAR(900.f, point.x, 0.01f);
+}
+
+TEST(ZoneGeometry, InactiveAndDisabled) {
+  auto shape = MakeShape({Point(0.f, -100.f), Point(0.f, 100.f)}, false);
+  shape->Element = std::make_shared<objects::QmpElement>();
+  shape->Element->SetID(7);
+
+  ZoneGeometry indexed, unindexed;
+  MakeGeometry({shape}, indexed, unindexed);
+
+  Line path(-100.f, 0.f, 100.f, 0.f);
+  Point point;
+  Line surface;
+  std::shared_ptr<ZoneShape> hit;
+
+  EXPECT_TRUE(indexed.Collides(path, point, surface, hit));
+  EXPECT_FALSE(indexed.Collides(path, point, surface, hit, {7}));
+
+  shape->Active = false;
+  EXPECT_FALSE(indexed.Collides(path, point));
+  EXPECT_FALSE(unindexed.Collides(path, point));
+}
+
+TEST(ZoneGeometry, OneWay) {
+  auto shape = MakeShape({Point(0.f, -100.f), Point(0.f, 100.f)}, false);
+  shape->OneWay = true;
+
+  ZoneGeometry indexed, unindexed;
+  MakeGeometry({shape}, indexed, unindexed);
+
+  Point point;
+  EXPECT_NE(indexed.Collides(Line(-100.f, 0.f, 100.f, 0.f), point),
+            indexed.Collides(Line(100.f, 0.f, -100.f, 0.f), point));
+  EXPECT_EQ(unindexed.Collides(Line(-100.f, 0.f, 100.f, 0.f), point),
+            indexed.Collides(Line(-100.f, 0.f, 100.f, 0.f), point));
+}
+
+TEST(ZoneGeometry, ReplayMoveStream) {
+  ZoneGeometry indexed, unindexed;
+  MakeGeometry(GenerateZone(), indexed, unindexed);
+
+  auto moves = GenerateMoves();
+
+  auto time = [&](const ZoneGeometry& geometry, size_t& collisions) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < REPLAY_PASSES; i++) {
+      collisions = Replay(geometry, moves);
+    }
+
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+
+  size_t fullCollisions = 0, indexedCollisions = 0;
+  uint64_t fullTime = time(unindexed, fullCollisions);
+  uint64_t indexedTime = time(indexed, indexedCollisions);
+
+  EXPECT_EQ(fullCollisions, indexedCollisions);
+
+  double checks = (double)(moves.size() * REPLAY_PASSES);
+  std::printf(
+      "Replayed %u move(s) %u time(s), %u collision(s)\n"
+      "  full scan: %llu us (%.3f us/move)\n"
+      "  indexed:   %llu us (%.3f us/move)\n",
+      (unsigned)moves.size(), (unsigned)REPLAY_PASSES,
+      (unsigned)indexedCollisions, (unsigned long long)fullTime,
+      (double)fullTime / checks, (unsigned long long)indexedTime,
+      (double)indexedTime / checks);
+
+  RecordProperty("FullScanMicroseconds", (int)fullTime);
+  RecordProperty("IndexedMicroseconds", (int)indexedTime);
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
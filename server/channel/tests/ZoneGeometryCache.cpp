@@ -0,0 +1,171 @@
+/**
+ * @file server/channel/tests/ZoneGeometryCache.cpp
+ * @ingroup channel
+ *
+ * @author HACKfrost
+ *
+ * @brief Test loading, failure caching and eviction of zone geometry.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// channel Includes
+#include <ZoneGeometryCache.h>
+
+// Standard C++11 Includes
+#include <string>
+
+using namespace channel;
+
+/// Idle timeout used by the eviction tests
+static const ServerTime IDLE_TIMEOUT = 300;
+
+/**
+ * Stand in for geometry that counts how often it was loaded.
+ */
+struct TestGeometry {
+  int Value = 0;
+};
+
+typedef ZoneGeometryCache<std::string, TestGeometry> TestCache_t;
+
+/**
+ * Create a loader that counts how many times it was called.
+ * @param loads Counter incremented by each load
+ * @param fail If the load should fail
+ * @returns Loader for the cache
+ */
+static TestCache_t::Loader_t CountingLoader(int& loads, bool fail = false) {
+  return [&loads, fail]() -> std::shared_ptr<TestGeometry> {
+    loads++;
+
+    if (fail) {
+      return nullptr;
+    }
+
+    auto geometry = std::make_shared<TestGeometry>();
+    geometry->Value = loads;
+
+    return geometry;
+  };
+}
+
+TEST(ZoneGeometryCache, LoadOnce) {
+  TestCache_t cache;
+  int loads = 0;
+
+  auto first = cache.Get("a.qmp", 0, CountingLoader(loads));
+  auto second = cache.Get("a.qmp", 1, CountingLoader(loads));
+
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(1, loads);
+
+  // Without a loader only cached geometry is returned.
+  EXPECT_EQ(first, cache.Get("a.qmp", 2, nullptr));
+  EXPECT_EQ(nullptr, cache.Get("b.qmp", 2, nullptr));
+  EXPECT_EQ(1u, cache.Size());
+}
+
+TEST(ZoneGeometryCache, FailedLoadIsCached) {
+  TestCache_t cache;
+  int loads = 0;
+
+  EXPECT_EQ(nullptr, cache.Get("missing.qmp", 0, CountingLoader(loads, true)));
+  EXPECT_EQ(nullptr, cache.Get("missing.qmp", 1, CountingLoader(loads, true)));
+  EXPECT_EQ(nullptr, cache.Get("missing.qmp", 2, CountingLoader(loads)));
+
+  EXPECT_EQ(1, loads);
+
+  // A failed load is never evicted so it is not read again later.
+  EXPECT_EQ(0u, cache.Evict(IDLE_TIMEOUT * 10, IDLE_TIMEOUT));
+  EXPECT_EQ(1u, cache.Size());
+}
+
+TEST(ZoneGeometryCache, EvictOnlyUnreferenced) {
+  TestCache_t cache;
+  int loads = 0;
+
+  // A zone holds the geometry so it is in use no matter how long it is.
+  auto zoneGeometry = cache.Get("a.qmp", 0, CountingLoader(loads));
+  ASSERT_NE(nullptr, zoneGeometry);
+
+  EXPECT_EQ(0u, cache.Evict(IDLE_TIMEOUT * 10, IDLE_TIMEOUT));
+  EXPECT_EQ(1u, cache.Size());
+
+  // Once the zone is gone the idle time counts from the last check that
+  // saw it in use.
+  zoneGeometry.reset();
+
+  EXPECT_EQ(0u, cache.Evict(IDLE_TIMEOUT * 10 + IDLE_TIMEOUT - 1,
+                            IDLE_TIMEOUT));
+  EXPECT_EQ(1u, cache.Size());
+
+  EXPECT_EQ(1u, cache.Evict(IDLE_TIMEOUT * 11, IDLE_TIMEOUT));
+  EXPECT_EQ(0u, cache.Size());
+
+  // The next request loads it again.
+  auto reloaded = cache.Get("a.qmp", IDLE_TIMEOUT * 12, CountingLoader(loads));
+  ASSERT_NE(nullptr, reloaded);
+  EXPECT_EQ(2, loads);
+  EXPECT_EQ(2, reloaded->Value);
+}
+
+TEST(ZoneGeometryCache, GetRefreshesIdleTime) {
+  TestCache_t cache;
+  int loads = 0;
+
+  cache.Get("a.qmp", 0, CountingLoader(loads));
+
+  // Requested again just before it would expire.
+  cache.Get("a.qmp", IDLE_TIMEOUT - 1, CountingLoader(loads));
+
+  EXPECT_EQ(0u, cache.Evict(IDLE_TIMEOUT, IDLE_TIMEOUT));
+  EXPECT_EQ(1u, cache.Evict(IDLE_TIMEOUT * 2, IDLE_TIMEOUT));
+  EXPECT_EQ(1, loads);
+}
+
+TEST(ZoneGeometryCache, InsertedNeverEvicted) {
+  TestCache_t cache;
+  int loads = 0;
+
+  cache.Insert("a.qmp", std::make_shared<TestGeometry>());
+
+  EXPECT_EQ(0u, cache.Evict(IDLE_TIMEOUT * 10, IDLE_TIMEOUT));
+  EXPECT_NE(nullptr, cache.Get("a.qmp", IDLE_TIMEOUT * 10,
+                               CountingLoader(loads)));
+  EXPECT_EQ(0, loads);
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
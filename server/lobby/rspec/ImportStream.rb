@@ -0,0 +1,133 @@
+#!/usr/bin/env ruby
+#
+# This file is part of COMP_hack.
+#
+# Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+require 'json'
+require 'net/http'
+require 'securerandom'
+
+server = 'http://127.0.0.1:10999'
+
+# Number of accounts in the generated dump. This may be overridden to run a
+# larger import by hand.
+accountCount = (ENV['IMPORT_BENCH_ACCOUNTS'] || '500').to_i
+
+# Generate a dump with one account and its world data per account.
+def GenerateDump(count)
+    prefix = SecureRandom.hex(4)
+
+    (1..count).map do |i|
+        accountUUID = SecureRandom.uuid
+        username = "import#{prefix}x#{i}"
+
+        "<objects>" \
+            "<object name=\"Account\">" \
+                "<member name=\"UUID\">#{accountUUID}</member>" \
+                "<member name=\"Username\">#{username}</member>" \
+                "<member name=\"DisplayName\">#{username}</member>" \
+                "<member name=\"Email\">#{username}@test.account</member>" \
+                "<member name=\"Password\">#{SecureRandom.hex(64)}</member>" \
+                "<member name=\"Salt\">#{SecureRandom.hex(5)}</member>" \
+            "</object>" \
+            "<object name=\"AccountWorldData\">" \
+                "<member name=\"UUID\">#{SecureRandom.uuid}</member>" \
+                "<member name=\"Account\">#{accountUUID}</member>" \
+            "</object>" \
+        "</objects>\n"
+    end.join
+end
+
+# Stream a dump to the server and return the result lines.
+def ImportDump(server, dump)
+    uri = URI(server + '/import/stream')
+
+    response = Net::HTTP.start(uri.host, uri.port, :read_timeout => 600) do |http|
+        http.post(uri.path, dump, {'Content-Type' => 'application/xml'})
+    end
+
+    response.body.lines.map { |line| JSON.parse(line) }
+end
+
+describe "Import stream" do
+    before(:all) do
+        @serverProcess = fork do
+            comp_manager = ENV['TESTING_DIR'] + '/bin/comp_manager'
+            # Accounts are imported into world 0 so the world must run too.
+            config_path = ENV['TESTING_DIR'] + '/bin/testing/programs.xml'
+
+            Dir.chdir ENV['TESTING_DIR']
+            Kernel.exec comp_manager, config_path
+        end
+
+        sleep 10.0
+    end
+
+    after(:all) do
+        begin
+            Process.kill "INT", @serverProcess
+
+            # If the process does not exit, force it to.
+            begin
+                Timeout::timeout(3.0) {
+                    Process.wait @serverProcess
+                }
+            rescue Timeout::Error
+                Process.kill "KILL", @serverProcess
+            end
+
+            Process.wait @serverProcess
+        rescue SystemCallError
+            # Do nothing if an error occurs.
+        end
+    end
+
+    it "Generated dump" do
+        dump = GenerateDump(accountCount)
+
+        start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+        results = ImportDump(server, dump)
+        elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start
+
+        puts "Import stream: #{accountCount} accounts " \
+            "(#{(dump.size / 1024.0).round(1)} KiB) in #{elapsed.round(3)} s " \
+            "(#{(accountCount / elapsed).round(1)} accounts/s)"
+
+        summary = results.pop
+
+        expect(summary["error"]).to eq("Success")
+        expect(summary["imported"]).to eq(accountCount)
+        expect(summary["failed"]).to eq(0)
+        expect(summary["next"]).to eq(accountCount)
+        expect(results.map { |r| r["index"] }).to eq((0...accountCount).to_a)
+
+        # Importing the same dump again must fail every account because
+        # the UUIDs (and usernames) already exist.
+        summary = ImportDump(server, dump).pop
+
+        expect(summary["imported"]).to eq(0)
+        expect(summary["failed"]).to eq(accountCount)
+    end
+
+    it "Duplicate account in one batch" do
+        dump = GenerateDump(1)
+        summary = ImportDump(server, dump + dump).pop
+
+        expect(summary["imported"]).to eq(1)
+        expect(summary["failed"]).to eq(1)
+    end
+end
@@ -0,0 +1,127 @@
+#!/usr/bin/env ruby
+#
+# This file is part of COMP_hack.
+#
+# Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+load 'Session.rb'
+
+username = 'testalpha'
+password = 'same_as_my_luggage'
+server = 'http://127.0.0.1:10999'
+
+# Log in through the login web page the client shows, which runs the web
+# authentication and returns the session ID the client passes to the lobby.
+# Returns the session ID or nil if the login failed.
+def WebLogin(server, username, password)
+    m = Mechanize.new
+    page = m.post(server + '/index.nut', {
+        'ID' => username,
+        'PASS' => password,
+        'cv' => '1.666',
+        'login' => '1'
+    })
+
+    match = /1stSID:"([0-9a-f]+)"/.match(page.body)
+
+    return match ? match[1] : nil
+end
+
+# Number of concurrent clients and login attempts made by each client. These
+# may be overridden to run a larger storm by hand.
+threadCount = (ENV['LOGIN_STORM_THREADS'] || '16').to_i
+loginCount = (ENV['LOGIN_STORM_LOGINS'] || '25').to_i
+
+describe "Login storm" do
+    before(:all) do
+        @serverProcess = fork do
+            comp_manager = ENV['TESTING_DIR'] + '/bin/comp_manager'
+            config_path = ENV['TESTING_DIR'] + '/bin/testing/programs-lobby.xml'
+
+            Dir.chdir ENV['TESTING_DIR']
+            Kernel.exec comp_manager, config_path
+        end
+
+        sleep 3.0
+    end
+
+    after(:all) do
+        begin
+            Process.kill "INT", @serverProcess
+
+            # If the process does not exit, force it to.
+            begin
+                Timeout::timeout(3.0) {
+                    Process.wait @serverProcess
+                }
+            rescue Timeout::Error
+                Process.kill "KILL", @serverProcess
+            end
+
+            Process.wait @serverProcess
+        rescue SystemCallError
+            # Do nothing if an error occurs.
+        end
+    end
+
+    it "Concurrent logins" do
+        # Each client logs in as the same user, as a second real user and as
+        # a user that does not exist (which still goes to the database) so
+        # requests collide on one login lock and spread over the others.
+        failures = Queue.new
+        start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+
+        threads = (1..threadCount).map do |i|
+            Thread.new do
+                loginCount.times do |j|
+                    begin
+                        if WebLogin(server, username, password).nil?
+                            failures << "#{username} login failed"
+                        end
+
+                        if WebLogin(server, 'testbeta', 'its12345').nil?
+                            failures << 'testbeta login failed'
+                        end
+
+                        unless WebLogin(server, "storm#{i}x#{j}", 'hackMe').nil?
+                            failures << 'Unknown user logged in'
+                        end
+                    rescue StandardError => e
+                        failures << e
+                    end
+                end
+            end
+        end
+
+        threads.each(&:join)
+
+        elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start
+        total = threadCount * loginCount * 3
+
+        puts "Login storm: #{total} logins from #{threadCount} clients in " \
+            "#{elapsed.round(3)} s (#{(total / elapsed).round(1)} logins/s)"
+
+        expect(failures.size).to eq(0)
+
+        # The server must still handle a normal login after the storm.
+        expect(WebLogin(server, username, password)).not_to be_nil
+        expect(WebLogin(server, username, 'wrong_password')).to be_nil
+
+        s = Session.new(server, username, password)
+        s.Authenticate()
+        expect(s.Request('/account/get_cp')["cp"]).to eq(1000000)
+    end
+end
@@ -28,6 +28,8 @@
 
 // libcomp Includes
 #include <Crypto.h>
+#include <Database.h>
+#include <DatabaseQuery.h>
 #include <Log.h>
 #include <ServerConstants.h>
 
@@ -54,6 +56,9 @@
 
 using namespace lobby;
 
+/// Number of kill time exceeded characters to load at once when purging
+#define KILL_TIME_PURGE_BATCH_SIZE (500)
+
 AccountManager::AccountManager(LobbyServer* pServer) : mServer(pServer) {}
 
 ErrorCodes_t AccountManager::WebAuthLogin(const libcomp::String& username,
@@ -116,12 +121,25 @@ ErrorCodes_t AccountManager::WebAuthLogin(const libcomp::String& username,
     return ErrorCodes_t::WRONG_CLIENT_VERSION;
   }
 
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Hash the password before locking the accounts too. The account on the
+  // login never changes once loaded so this needs no lock.
+  bool passwordValid = true;
+  if (checkPassword && login && login->GetAccount()) {
+    auto account = login->GetAccount();
+    passwordValid = account->GetPassword() ==
+                    libcomp::Crypto::HashPassword(password, account->GetSalt());
+  }
+
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -158,8 +176,7 @@ ErrorCodes_t AccountManager::WebAuthLogin(const libcomp::String& username,
   // The API version of this function does not have to check the password.
   if (checkPassword) {
     // Tell them nothing about the account until they authenticate.
-    if (account->GetPassword() !=
-        libcomp::Crypto::HashPassword(password, account->GetSalt())) {
+    if (!passwordValid) {
       LogAccountManagerDebug([&]() {
         return libcomp::String(
                    "Web auth login for account '%1' failed with a bad "
@@ -260,12 +277,16 @@ ErrorCodes_t AccountManager::LobbyLogin(const libcomp::String& username,
         .Arg(username);
   });
 
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -345,12 +366,16 @@ ErrorCodes_t AccountManager::LobbyLogin(const libcomp::String& username,
         .Arg(username);
   });
 
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -509,12 +534,16 @@ bool AccountManager::IsAccountEnabled(
 std::shared_ptr<objects::AccountLogin> AccountManager::StartChannelLogin(
     const libcomp::String& username,
     const std::shared_ptr<objects::Character>& character) {
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -556,12 +585,16 @@ ErrorCodes_t AccountManager::SwitchToChannel(const libcomp::String& username,
         .Arg(username);
   });
 
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -593,6 +626,8 @@ ErrorCodes_t AccountManager::SwitchToChannel(const libcomp::String& username,
   cLogin->SetWorldID(worldID);
   cLogin->SetChannelID(channelID);
 
+  IndexLogin(username.ToLower(), worldID, channelID);
+
   return ErrorCodes_t::SUCCESS;
 }
 
@@ -607,12 +642,16 @@ ErrorCodes_t AccountManager::CompleteChannelLogin(
         .Arg(username);
   });
 
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -655,18 +694,24 @@ ErrorCodes_t AccountManager::CompleteChannelLogin(
   // Update the state of the login.
   login->SetState(objects::AccountLogin::State_t::CHANNEL);
 
+  IndexLogin(username.ToLower(), worldID, channelID);
+
   return ErrorCodes_t::SUCCESS;
 }
 
 bool AccountManager::ChannelToChannelSwitch(const libcomp::String& username,
                                             int8_t channelID,
                                             uint32_t sessionKey) {
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username. This may load the account
+  // from the database so do it before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen.
   if (!login) {
     LogAccountManagerDebug([&]() {
@@ -695,6 +740,8 @@ bool AccountManager::ChannelToChannelSwitch(const libcomp::String& username,
   cLogin->SetChannelID(channelID);
   login->SetSessionKey(sessionKey);
 
+  IndexLogin(username.ToLower(), cLogin->GetWorldID(), channelID);
+
   // Always clear the web-game session
   mWebGameSessions.erase(username.ToLower());
   mWebGameAPISessions.erase(username.ToLower());
@@ -714,12 +761,15 @@ bool AccountManager::Logout(const libcomp::String& username) {
   auto config =
       std::dynamic_pointer_cast<objects::LobbyConfig>(mServer->GetConfig());
 
-  // Lock the accounts now so this is thread safe.
-  std::lock_guard<std::mutex> lock(mAccountLock);
+  // Serialize requests for this username without blocking other accounts.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
 
-  // Get the login object for this username.
+  // Get the login object for this username before locking the accounts.
   auto login = GetOrCreateLogin(username);
 
+  // Lock the accounts now so this is thread safe.
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   // This should never happen but if it does ignore it.
   if (!login) {
     return false;
@@ -765,6 +815,8 @@ bool AccountManager::Logout(const libcomp::String& username) {
   cLogin->SetChannelID(-1);
   cLogin->SetZoneID(0);
 
+  UnindexLogin(username.ToLower());
+
   // Let the account return to the lobby (if they did a logout to lobby).
   login->SetState(objects::AccountLogin::State_t::LOBBY_WAIT);
 
@@ -776,6 +828,10 @@ void AccountManager::ExpireSession(const libcomp::String& username,
   // Convert the username to lowercase for lookup.
   libcomp::String lookup = username.ToLower();
 
+  // Take the login lock first so a login request holding the login object
+  // never sees it removed from the map part way through.
+  std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
+
   // Lock the accounts now so this is thread safe.
   std::lock_guard<std::mutex> lock(mAccountLock);
 
@@ -800,6 +856,7 @@ void AccountManager::ExpireSession(const libcomp::String& username,
 
       // It's still set to expire so do so.
       mAccountMap.erase(pair);
+      UnindexLogin(lookup);
 
       UpdateDebugStatus();
     }
@@ -808,42 +865,55 @@ void AccountManager::ExpireSession(const libcomp::String& username,
 
 std::shared_ptr<objects::AccountLogin> AccountManager::GetOrCreateLogin(
     const libcomp::String& username) {
-  std::shared_ptr<objects::AccountLogin> login;
-
   // Convert the username to lowercase for lookup.
   libcomp::String lookup = username.ToLower();
 
-  // Look for the account in the map.
-  auto pair = mAccountMap.find(lookup);
+  {
+    std::lock_guard<std::mutex> lock(mAccountLock);
 
-  // If it's there we have a previous login attempt.
-  if (mAccountMap.end() == pair) {
-    // Create a new login object.
-    login = std::shared_ptr<objects::AccountLogin>(new objects::AccountLogin);
+    // Look for the account in the map.
+    auto pair = mAccountMap.find(lookup);
 
-    auto res = mAccountMap.insert(std::make_pair(lookup, login));
+    // If it's there we have a previous login attempt so return the
+    // existing login object.
+    if (mAccountMap.end() != pair) {
+      return pair->second;
+    }
+  }
 
-    UpdateDebugStatus();
+  if (!mServer) {
+    return nullptr;
+  }
 
-    // This pair is the iterator (first) and a bool indicating it was
-    // inserted into the map (second).
-    if (!res.second || !mServer) {
-      login.reset();
-    } else {
-      // Load the account from the database and set the initial state
-      // to offline.
-      login->SetState(objects::AccountLogin::State_t::OFFLINE);
-      login->SetAccount(objects::Account::LoadAccountByUsername(
-          mServer->GetMainDatabase(), lookup));
-    }
-  } else {
-    // Return the existing login object.
-    login = pair->second;
+  // Create a new login object. Load the account from the database and set
+  // the initial state to offline without holding the account lock so a
+  // slow load does not stall every other account.
+  auto login = std::make_shared<objects::AccountLogin>();
+  login->SetState(objects::AccountLogin::State_t::OFFLINE);
+  login->SetAccount(objects::Account::LoadAccountByUsername(
+      mServer->GetMainDatabase(), lookup));
+
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
+  auto res = mAccountMap.insert(std::make_pair(lookup, login));
+
+  UpdateDebugStatus();
+
+  // This pair is the iterator (first) and a bool indicating it was
+  // inserted into the map (second).
+  if (!res.second) {
+    login.reset();
   }
 
   return login;
 }
 
+std::mutex& AccountManager::GetLoginLock(const libcomp::String& username) {
+  size_t hash = std::hash<libcomp::String>()(username.ToLower());
+
+  return mLoginLocks[hash % mLoginLocks.size()];
+}
+
 void AccountManager::EraseLogin(const libcomp::String& username,
                                 bool updateDebugStatus) {
   UnregisterMachineClient(username);
@@ -854,6 +924,7 @@ void AccountManager::EraseLogin(const libcomp::String& username,
   mAccountMap.erase(lookup);
   mWebGameSessions.erase(lookup);
   mWebGameAPISessions.erase(lookup);
+  UnindexLogin(lookup);
 
   if (updateDebugStatus) {
     UpdateDebugStatus();
@@ -936,17 +1007,41 @@ std::list<libcomp::String> AccountManager::GetUsersInWorld(int8_t world,
   std::lock_guard<std::mutex> lock(mAccountLock);
 
   std::list<libcomp::String> usernames;
-  for (auto pair : mAccountMap) {
-    auto charLogin = pair.second->GetCharacterLogin();
-    if (charLogin->GetWorldID() == world &&
-        (channel < 0 || charLogin->GetChannelID() == channel)) {
-      usernames.push_back(pair.first);
+
+  auto worldIter = mOnlineIndex.find(world);
+  if (worldIter != mOnlineIndex.end()) {
+    for (auto& channelPair : worldIter->second) {
+      if (channel < 0 || channelPair.first == channel) {
+        usernames.insert(usernames.end(), channelPair.second.begin(),
+                         channelPair.second.end());
+      }
     }
   }
 
   return usernames;
 }
 
+size_t AccountManager::GetUserCountInWorld(int8_t world, int8_t channel) {
+  if (0 > world) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
+  size_t count = 0;
+
+  auto worldIter = mOnlineIndex.find(world);
+  if (worldIter != mOnlineIndex.end()) {
+    for (auto& channelPair : worldIter->second) {
+      if (channel < 0 || channelPair.first == channel) {
+        count = (size_t)(count + channelPair.second.size());
+      }
+    }
+  }
+
+  return count;
+}
+
 std::list<libcomp::String> AccountManager::LogoutUsersInWorld(int8_t world,
                                                               int8_t channel) {
   auto usernames = GetUsersInWorld(world, channel);
@@ -954,15 +1049,31 @@ std::list<libcomp::String> AccountManager::LogoutUsersInWorld(int8_t world,
     return usernames;
   }
 
-  std::lock_guard<std::mutex> lock(mAccountLock);
-
+  // Take each login lock on its own (never two at once) so a login request
+  // holding the login object never sees it removed from the map part way
+  // through. The user may have moved or logged out since the list was
+  // gathered so only erase logins still in the world (and channel).
+  std::list<libcomp::String> loggedOut;
   for (auto username : usernames) {
+    std::lock_guard<std::mutex> loginLock(GetLoginLock(username));
+    std::lock_guard<std::mutex> lock(mAccountLock);
+
+    auto locationIter = mOnlineLocations.find(username);
+    if (locationIter == mOnlineLocations.end() ||
+        locationIter->second.first != world ||
+        (channel >= 0 && locationIter->second.second != channel)) {
+      continue;
+    }
+
     EraseLogin(username, false);
+    loggedOut.push_back(username);
   }
 
+  std::lock_guard<std::mutex> lock(mAccountLock);
+
   UpdateDebugStatus();
 
-  return usernames;
+  return loggedOut;
 }
 
 bool AccountManager::UpdateKillTime(const libcomp::String& username,
@@ -1029,52 +1140,86 @@ bool AccountManager::DeleteKillTimeExceededCharacters(uint8_t worldID) {
         .Arg(svr->GetName());
   });
 
-  std::list<std::shared_ptr<objects::Character>> exceeded;
-  for (auto character :
-       libcomp::PersistentObject::LoadAll<objects::Character>(worldDB)) {
-    if (character->GetKillTime() && character->GetKillTime() < now) {
-      exceeded.push_back(character);
-    }
-  }
-
-  if (exceeded.size() > 0) {
-    LogAccountManagerDebug([&]() {
-      return libcomp::String("%1 character(s) found for deletion\n")
-          .Arg(exceeded.size());
-    });
+  // Only select the characters that need to be deleted (using the kill
+  // time index) and page through them by UID so a world with a large
+  // number of characters never has to load all of them at once
+  size_t deleted = 0;
+  libobjgen::UUID after;
+  while (true) {
+    auto query = worldDB->Prepare(
+        libcomp::String("SELECT `UID`, `Account` FROM `Character` WHERE "
+                        "`KillTime` > 0 AND `KillTime` < :now AND `UID` > "
+                        ":after ORDER BY `UID` LIMIT %1;")
+            .Arg(KILL_TIME_PURGE_BATCH_SIZE));
+    if (!query.IsValid() || !query.Bind("now", (int64_t)now) ||
+        !query.Bind("after", after) || !query.Execute()) {
+      LogAccountManagerErrorMsg(
+          "Failed to query kill time exceeded characters.\n");
 
-    while (exceeded.size() > 0) {
-      auto accountUID = exceeded.front()->GetAccount();
+      return false;
+    }
 
-      std::list<std::shared_ptr<objects::Character>> subset;
-      exceeded.remove_if(
-          [accountUID, &subset](const std::shared_ptr<objects::Character>& c) {
-            // Who says you ONLY have to remove here? :P
-            if (c->GetAccount() == accountUID) {
-              subset.push_back(c);
-            }
+    // Group the batch by account in a single pass
+    std::unordered_map<std::string, std::list<libobjgen::UUID>>
+        accountCharacters;
+    auto previous = after;
+    size_t count = 0;
+    while (query.Next()) {
+      libobjgen::UUID uid, accountUID;
+      if (query.GetValue("UID", uid) &&
+          query.GetValue("Account", accountUID)) {
+        accountCharacters[accountUID.ToString()].push_back(uid);
+        after = uid;
+      }
 
-            return c->GetAccount() == accountUID;
-          });
+      count++;
+    }
 
+    for (auto& pair : accountCharacters) {
       auto account =
           libcomp::PersistentObject::LoadObjectByUUID<objects::Account>(
-              mainDB, accountUID);
-      if (account) {
-        for (auto character : subset) {
-          DeleteCharacter(account, character);
-        }
-      } else {
+              mainDB, libobjgen::UUID(pair.first));
+      if (!account) {
         LogAccountManagerDebug([&]() {
           return libcomp::String(
                      "Failed to load account %1 associated to kill time "
                      "exceeded character(s)\n")
-              .Arg(accountUID.ToString());
+              .Arg(pair.first);
         });
+
+        continue;
+      }
+
+      for (auto& uid : pair.second) {
+        auto character =
+            libcomp::PersistentObject::LoadObjectByUUID<objects::Character>(
+                worldDB, uid);
+        if (character && character->GetKillTime() &&
+            character->GetKillTime() < now &&
+            DeleteCharacter(account, character)) {
+          deleted++;
+        }
       }
     }
 
-    LogAccountManagerDebugMsg("Character deletions complete\n");
+    if (count < KILL_TIME_PURGE_BATCH_SIZE) {
+      break;
+    } else if (after == previous) {
+      // No row in a full page could be read so the next page would be the
+      // same one again
+      LogAccountManagerErrorMsg(
+          "Failed to read any kill time exceeded character in a full page. "
+          "Stopping the purge.\n");
+
+      return false;
+    }
+  }
+
+  if (deleted > 0) {
+    LogAccountManagerDebug([&]() {
+      return libcomp::String("%1 kill time exceeded character(s) deleted\n")
+          .Arg(deleted);
+    });
   } else {
     LogAccountManagerDebugMsg("No characters deletions required\n");
   }
@@ -1307,6 +1452,53 @@ bool AccountManager::EndWebGameSession(const libcomp::String& username) {
   return false;
 }
 
+void AccountManager::IndexLogin(const libcomp::String& lookup, int8_t world,
+                                int8_t channel) {
+  auto locationIter = mOnlineLocations.find(lookup);
+  if (locationIter != mOnlineLocations.end()) {
+    if (locationIter->second.first == world &&
+        locationIter->second.second == channel) {
+      // Already indexed here
+      return;
+    }
+
+    UnindexLogin(lookup);
+  }
+
+  if (0 > world) {
+    return;
+  }
+
+  mOnlineIndex[world][channel].insert(lookup);
+  mOnlineLocations[lookup] = std::make_pair(world, channel);
+}
+
+void AccountManager::UnindexLogin(const libcomp::String& lookup) {
+  auto locationIter = mOnlineLocations.find(lookup);
+  if (locationIter == mOnlineLocations.end()) {
+    return;
+  }
+
+  int8_t world = locationIter->second.first;
+  int8_t channel = locationIter->second.second;
+  mOnlineLocations.erase(locationIter);
+
+  auto worldIter = mOnlineIndex.find(world);
+  if (worldIter != mOnlineIndex.end()) {
+    auto channelIter = worldIter->second.find(channel);
+    if (channelIter != worldIter->second.end()) {
+      channelIter->second.erase(lookup);
+      if (channelIter->second.empty()) {
+        worldIter->second.erase(channelIter);
+      }
+    }
+
+    if (worldIter->second.empty()) {
+      mOnlineIndex.erase(worldIter);
+    }
+  }
+}
+
 void AccountManager::PrintAccounts() const {
   LogAccountManagerDebugMsg("----------------------------------------\n");
 
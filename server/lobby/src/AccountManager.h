@@ -32,8 +32,10 @@
 #include <ErrorCodes.h>
 
 // Standard C++11 Includes
+#include <array>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 // object Includes
 #include <AccountLogin.h>
@@ -267,6 +269,16 @@ class AccountManager {
    */
   std::list<libcomp::String> GetUsersInWorld(int8_t world, int8_t channel = -1);
 
+  /**
+   * Get the number of users in a given world (and optionally on a specific
+   * channel) without building the list of usernames.
+   * @param world World to count users in.
+   * @param channel Channel in the world to count users in. If this is
+   * empty, all users in the world will be counted.
+   * @return Number of users in the world (and channel).
+   */
+  size_t GetUserCountInWorld(int8_t world, int8_t channel = -1);
+
   /**
    * Log out all users in a given world (and optionally on a specific
    * channel). This should only be called when a world or channel disconnects.
@@ -372,18 +384,30 @@ class AccountManager {
    * new login object if one does not already exist.
    * @param username Username for the login object to return.
    * @returns The login object for the given username or null on error.
-   * @note This function is NOT thread safe. You MUST lock access first!
+   * @note The caller MUST hold the login lock for the username and MUST
+   *  NOT hold the account lock as the account may be loaded from the
+   *  database.
    */
   std::shared_ptr<objects::AccountLogin> GetOrCreateLogin(
       const libcomp::String& username);
 
+  /**
+   * Get the lock that serializes login requests for a username. Usernames
+   * that hash to the same stripe share a lock. A login lock must always be
+   * taken before the account lock.
+   * @param username Username to get the lock for
+   * @returns Login lock for the username
+   */
+  std::mutex& GetLoginLock(const libcomp::String& username);
+
   /**
    * This will remove a login entry for the account map. Accounts not in
    * the map are considered OFFLINE.
    * @param username Username of the account to remove from the login map.
    * @param updateDebugStatus Optional flag to update the debug status after
    * removing the login information. Defaults to true.
-   * @note This function is NOT thread safe. You MUST lock access first!
+   * @note This function is NOT thread safe. You MUST hold the login lock
+   *  for the username and then the account lock first!
    */
   void EraseLogin(const libcomp::String& username,
                   bool updateDebugStatus = true);
@@ -396,6 +420,23 @@ class AccountManager {
    */
   void UnregisterMachineClient(const libcomp::String& username);
 
+  /**
+   * Add or move a login in the online index for the world and channel it
+   * is on. A world of -1 removes the login from the index.
+   * @param lookup Lowercase username of the login.
+   * @param world World the login is on.
+   * @param channel Channel the login is on.
+   * @note This function is NOT thread safe. You MUST lock access first!
+   */
+  void IndexLogin(const libcomp::String& lookup, int8_t world, int8_t channel);
+
+  /**
+   * Remove a login from the online index.
+   * @param lookup Lowercase username of the login.
+   * @note This function is NOT thread safe. You MUST lock access first!
+   */
+  void UnindexLogin(const libcomp::String& lookup);
+
   /**
    * Print the status of the accounts managed by this object.
    * @note This function is NOT thread safe. You MUST lock access first!
@@ -415,6 +456,10 @@ class AccountManager {
   /// Mutex to lock access to the account map.
   std::mutex mAccountLock;
 
+  /// Striped locks that serialize login requests per username so slow
+  /// account loads and password checks do not hold the account lock.
+  std::array<std::mutex, 64> mLoginLocks;
+
   /// Map of accounts with associated login information.
   std::unordered_map<libcomp::String, std::shared_ptr<objects::AccountLogin>>
       mAccountMap;
@@ -431,6 +476,16 @@ class AccountManager {
 
   /// List of clients connected for each machine UUID.
   std::unordered_map<libcomp::String, int32_t> mMachineUUIDs;
+
+  /// Lowercase usernames of the logins on each channel of each world.
+  std::unordered_map<
+      int8_t,
+      std::unordered_map<int8_t, std::unordered_set<libcomp::String>>>
+      mOnlineIndex;
+
+  /// World and channel each login in the online index is on.
+  std::unordered_map<libcomp::String, std::pair<int8_t, int8_t>>
+      mOnlineLocations;
 };
 
 }  // namespace lobby
@@ -41,9 +41,17 @@
 #include <Log.h>
 #include <PacketCodes.h>
 #include <Randomizer.h>
+#include <ScriptBytecodeCache.h>
 #include <ScriptEngine.h>
+#include <ScriptEnginePool.h>
 #include <ServerConstants.h>
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <set>
+
 // object Includes
 #include <AccountWorldData.h>
 #include <Character.h>
@@ -65,6 +73,9 @@ using namespace lobby;
 
 #define MAX_PAYLOAD (4096)
 
+#define ACCOUNT_PAGE_SIZE (100)
+#define MAX_ACCOUNT_PAGE_SIZE (1000)
+
 #ifdef _WIN32
 // Disable "decorated name length exceeded" warning for
 // JsonBox::Object binding
@@ -79,14 +90,16 @@ void ApiSession::Reset() {
 
 ApiHandler::ApiHandler(const std::shared_ptr<objects::LobbyConfig>& config,
                        const std::shared_ptr<lobby::LobbyServer>& server)
-    : mConfig(config), mServer(server), mAccountManager(nullptr) {
+    : mConfig(config),
+      mServer(server),
+      mAccountManager(nullptr) {
   mParsers["/auth/get_challenge"] = &ApiHandler::Auth_Token;
   mParsers["/account/get_cp"] = &ApiHandler::Account_GetCP;
   mParsers["/account/get_details"] = &ApiHandler::Account_GetDetails;
   mParsers["/account/change_password"] = &ApiHandler::Account_ChangePassword;
   mParsers["/account/client_login"] = &ApiHandler::Account_ClientLogin;
   mParsers["/account/register"] = &ApiHandler::Account_Register;
-  mParsers["/admin/get_accounts"] = &ApiHandler::Admin_GetAccounts;
+  mStreamParsers["/admin/get_accounts"] = &ApiHandler::Admin_GetAccounts;
   mParsers["/admin/get_account"] = &ApiHandler::Admin_GetAccount;
   mParsers["/admin/delete_account"] = &ApiHandler::Admin_DeleteAccount;
   mParsers["/admin/update_account"] = &ApiHandler::Admin_UpdateAccount;
@@ -100,6 +113,35 @@ ApiHandler::ApiHandler(const std::shared_ptr<objects::LobbyConfig>& config,
   mParsers["/webgame/get_coins"] = &ApiHandler::WebGame_GetCoins;
   mParsers["/webgame/start"] = &ApiHandler::WebGame_Start;
   mParsers["/webgame/update"] = &ApiHandler::WebGame_Update;
+  mParsers["/admin/api_stats"] = &ApiHandler::Admin_ApiStats;
+
+  // These never read or modify session state another request could be
+  // changing so they skip the request lock and route limits entirely.
+  // The web game routes are not included as a game being started
+  // replaces the session's game state.
+  mReadOnlyRoutes = {"/account/get_cp", "/account/get_details",
+                     "/admin/api_stats", "/admin/online"};
+
+  // Script and database heavy routes are limited by default so they
+  // cannot tie up every web thread. All web apps share one limit.
+  mRoutes["/admin/post_items"].limit = 2;
+  mRoutes["/webapp/"].limit = 8;
+  mRoutes["/webgame/start"].limit = 8;
+  mRoutes["/webgame/update"].limit = 8;
+
+  for (auto& pair : config->GetApiRouteLimits()) {
+    if (mReadOnlyRoutes.find(pair.first) != mReadOnlyRoutes.end()) {
+      LogWebAPIWarning([&]() {
+        return libcomp::String(
+                   "Ignoring the API route limit for read-only route %1.\n")
+            .Arg(pair.first);
+      });
+
+      continue;
+    }
+
+    mRoutes[pair.first].limit = pair.second;
+  }
 
   LogWebAPIDebugMsg("Loading API binary definitions...\n");
 
@@ -111,12 +153,29 @@ ApiHandler::ApiHandler(const std::shared_ptr<objects::LobbyConfig>& config,
   auto serverDataManager = new libhack::ServerDataManager;
   bool scriptsLoaded = false;
 
+  if (!config->GetScriptCacheDirectory().IsEmpty()) {
+    auto cache = std::make_shared<libhack::ScriptBytecodeCache>(
+        config->GetScriptCacheDirectory(), config->GetScriptCacheValidate());
+    serverDataManager->SetBytecodeCache(cache);
+  }
+
   LogWebAPIDebugMsg("Loading web apps...\n");
 
+  size_t warmCount = (size_t)config->GetScriptPoolWarmCount();
+
   for (auto serverScript : serverDataManager->LoadScripts(
            server->GetDataStore(), "/webapps", scriptsLoaded, false)) {
     if (serverScript->Type.ToLower() == "webapp") {
+      // Web apps do not store state so each VM is reset after use
+      auto pool = std::make_shared<libhack::ScriptEnginePool>(
+          serverScript->Name, &BindWebApp, true, config->GetWebThreads());
+      if (!pool->Initialize(serverScript->Bytecode, warmCount)) {
+        scriptsLoaded = false;
+        continue;
+      }
+
       mAppDefinitions[serverScript->Name.ToLower()] = serverScript;
+      mScriptPools["webapp/" + serverScript->Name.ToLower()] = pool;
     }
   }
 
@@ -139,7 +198,18 @@ ApiHandler::ApiHandler(const std::shared_ptr<objects::LobbyConfig>& config,
   for (auto serverScript : serverDataManager->LoadScripts(
            server->GetDataStore(), "/webgames", scriptsLoaded, false)) {
     if (serverScript->Type.ToLower() == "webgame") {
+      // Game VMs hold per session state so they are never returned to the
+      // pool, the pool just keeps a few ready to start and is refilled as
+      // games are started
+      auto pool = std::make_shared<libhack::ScriptEnginePool>(
+          serverScript->Name, &BindWebGame, false, warmCount);
+      if (!pool->Initialize(serverScript->Bytecode, warmCount)) {
+        scriptsLoaded = false;
+        continue;
+      }
+
       mGameDefinitions[serverScript->Name.ToLower()] = serverScript;
+      mScriptPools["webgame/" + serverScript->Name.ToLower()] = pool;
     }
   }
 
@@ -158,6 +228,10 @@ ApiHandler::ApiHandler(const std::shared_ptr<objects::LobbyConfig>& config,
     });
   }
 
+  if (auto cache = serverDataManager->GetBytecodeCache()) {
+    cache->Prune();
+  }
+
   delete serverDataManager;
 }
 
@@ -490,54 +564,186 @@ bool ApiHandler::Account_Register(const JsonBox::Object& request,
 
 bool ApiHandler::Admin_GetAccounts(const JsonBox::Object& request,
                                    JsonBox::Object& response,
+                                   struct mg_connection* pConnection,
                                    const std::shared_ptr<ApiSession>& session) {
-  (void)request;
-  (void)session;
-
   if (!HaveUserLevel(response, session, SVR_CONST.API_ADMIN_LVL_GET_ACCOUNTS)) {
+    WriteResponse(pConnection, response);
+
     return true;
   }
 
-  auto accounts =
-      libcomp::PersistentObject::LoadAll<objects::Account>(GetDatabase());
+  // Accounts are paged by username. The cursor is the last username
+  // queried for the previous page so each page is a single index seek.
+  // It is compared exactly as stored so it matches the ORDER BY.
+  libcomp::String after;
+  size_t limit = ACCOUNT_PAGE_SIZE;
+  std::set<std::string> fields;
+
+  auto it = request.find("after");
+  if (it != request.end()) {
+    after = it->second.getString();
+  }
+
+  it = request.find("limit");
+  if (it != request.end()) {
+    int requested = it->second.getInteger();
+    if (requested <= 0) {
+      return false;
+    }
+
+    limit = std::min((size_t)requested, (size_t)MAX_ACCOUNT_PAGE_SIZE);
+  }
+
+  it = request.find("fields");
+  if (it != request.end()) {
+    for (auto& field : it->second.getArray()) {
+      fields.insert(field.getString());
+    }
+  }
 
-  JsonBox::Array accountObjects;
+  // Load the whole page with one query instead of one query per account
+  auto db = GetDatabase();
+  auto query = db->Prepare(
+      libcomp::String("SELECT * FROM `Account` WHERE `Username` > :after "
+                      "ORDER BY `Username` LIMIT %1;")
+          .Arg(limit));
+  if (!query.IsValid() || !query.Bind("after", after) || !query.Execute()) {
+    LogWebAPIErrorMsg("Failed to query the account page.\n");
+
+    return false;
+  }
+
+  // The cursor comes from the last row queried rather than the last
+  // account loaded so rows that fail to load never restart the listing
+  std::list<std::shared_ptr<objects::Account>> accounts;
+  size_t rows = 0;
+  libcomp::String last;
+  while (query.Next()) {
+    query.GetValue("Username", last);
+    rows++;
 
-  for (auto account : accounts) {
+    // Prefer the cached account as it may have changes not saved yet
+    libobjgen::UUID uid;
+    if (!query.GetValue("UID", uid)) {
+      continue;
+    }
+
+    auto account = std::dynamic_pointer_cast<objects::Account>(
+        libcomp::PersistentObject::GetObjectByUUID(uid));
+    if (!account) {
+      account = std::make_shared<objects::Account>();
+      if (!account->LoadDatabaseValues(query)) {
+        continue;
+      }
+    }
+
+    accounts.push_back(account);
+  }
+
+  auto include = [&fields](const char* field) {
+    return fields.empty() || fields.find(field) != fields.end();
+  };
+
+  // Stream the page one account at a time so only the current record is
+  // ever held as JSON. The fields set by the caller (the next challenge)
+  // are written first.
+  {
+    std::stringstream ss;
+    ss << "{";
+
+    for (auto& pair : response) {
+      JsonBox::Value(pair.first).writeToStream(ss, false);
+      ss << ":";
+      pair.second.writeToStream(ss, false);
+      ss << ",";
+    }
+
+    ss << "\"accounts\":[";
+
+    mg_printf(pConnection,
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Type: application/json\r\n"
+              "Connection: close\r\n"
+              "\r\n%s",
+              ss.str().c_str());
+  }
+
+  bool first = true;
+  for (auto& account : accounts) {
     JsonBox::Object obj;
 
-    obj["cp"] = (int)account->GetCP();
-    obj["username"] = account->GetUsername().ToUtf8();
-    obj["disp_name"] = account->GetDisplayName().ToUtf8();
-    obj["email"] = account->GetEmail().ToUtf8();
-    obj["ticket_count"] = (int)account->GetTicketCount();
-    obj["user_level"] = (int)account->GetUserLevel();
-    obj["enabled"] = account->GetEnabled();
-    obj["last_login"] = (int)account->GetLastLogin();
-    obj["ban_reason"] = account->GetBanReason().ToUtf8();
-    obj["ban_initiator"] = account->GetBanInitiator().ToUtf8();
-    obj["ban_expiration"] = (int)account->GetBanExpiration();
-
-    int count = 0;
-
-    for (size_t i = 0; i < account->CharactersCount(); ++i) {
-      if (!account->GetCharacters(i).IsNull()) {
-        count++;
+    if (include("cp")) {
+      obj["cp"] = (int)account->GetCP();
+    }
+    if (include("username")) {
+      obj["username"] = account->GetUsername().ToUtf8();
+    }
+    if (include("disp_name")) {
+      obj["disp_name"] = account->GetDisplayName().ToUtf8();
+    }
+    if (include("email")) {
+      obj["email"] = account->GetEmail().ToUtf8();
+    }
+    if (include("ticket_count")) {
+      obj["ticket_count"] = (int)account->GetTicketCount();
+    }
+    if (include("user_level")) {
+      obj["user_level"] = (int)account->GetUserLevel();
+    }
+    if (include("enabled")) {
+      obj["enabled"] = account->GetEnabled();
+    }
+    if (include("last_login")) {
+      obj["last_login"] = (int)account->GetLastLogin();
+    }
+    if (include("ban_reason")) {
+      obj["ban_reason"] = account->GetBanReason().ToUtf8();
+    }
+    if (include("ban_initiator")) {
+      obj["ban_initiator"] = account->GetBanInitiator().ToUtf8();
+    }
+    if (include("ban_expiration")) {
+      obj["ban_expiration"] = (int)account->GetBanExpiration();
+    }
+
+    if (include("character_count")) {
+      int count = 0;
+
+      for (size_t i = 0; i < account->CharactersCount(); ++i) {
+        if (!account->GetCharacters(i).IsNull()) {
+          count++;
+        }
       }
+
+      obj["character_count"] = count;
+    }
+
+    std::stringstream ss;
+    if (!first) {
+      ss << ",";
     }
 
-    obj["character_count"] = count;
+    JsonBox::Value(obj).writeToStream(ss, false);
 
-    accountObjects.push_back(obj);
+    auto chunk = ss.str();
+    mg_write(pConnection, chunk.c_str(), chunk.size());
+
+    first = false;
+  }
+
+  // Only hand out a cursor if there may be more accounts to read
+  std::stringstream ss;
+  ss << "]";
+
+  if (rows == limit) {
+    ss << ",\"next\":";
+    JsonBox::Value(last.ToUtf8()).writeToStream(ss, false);
   }
 
-  std::sort(accountObjects.begin(), accountObjects.end(),
-            [](const JsonBox::Value& a, const JsonBox::Value& b) {
-              return a.getObject().at("username").getString() <
-                     b.getObject().at("username").getString();
-            });
+  ss << "}";
 
-  response["accounts"] = accountObjects;
+  auto chunk = ss.str();
+  mg_write(pConnection, chunk.c_str(), chunk.size());
 
   return true;
 }
@@ -940,15 +1146,15 @@ bool ApiHandler::Admin_Online(const JsonBox::Object& request,
     size_t total = 0;
     for (auto world : mServer->GetManagerConnection()->GetWorlds()) {
       auto rWorld = world->GetRegisteredWorld();
-      auto usernames =
-          mAccountManager->GetUsersInWorld((int8_t)rWorld->GetID());
+      size_t count =
+          mAccountManager->GetUserCountInWorld((int8_t)rWorld->GetID());
 
       JsonBox::Object obj;
 
       obj["world_id"] = (int)rWorld->GetID();
-      obj["character_count"] = (int)usernames.size();
+      obj["character_count"] = (int)count;
 
-      total = (size_t)(total + usernames.size());
+      total = (size_t)(total + count);
 
       objectList.push_back(obj);
     }
@@ -1419,49 +1625,161 @@ bool ApiHandler::Admin_DeletePromo(const JsonBox::Object& request,
   return true;
 }
 
+bool ApiHandler::Admin_ApiStats(const JsonBox::Object& request,
+                                JsonBox::Object& response,
+                                const std::shared_ptr<ApiSession>& session) {
+  (void)request;
+
+  if (!HaveUserLevel(response, session, SVR_CONST.API_ADMIN_LVL_API_STATS)) {
+    return true;
+  }
+
+  JsonBox::Object routes;
+
+  std::lock_guard<std::mutex> lock(mRouteLock);
+  for (auto& pair : mRoutes) {
+    JsonBox::Object route;
+    route["limit"] = (int)pair.second.limit;
+    route["active"] = (int)pair.second.active;
+    route["completed"] = libcomp::String("%1")
+                             .Arg(pair.second.completed)
+                             .ToUtf8();
+    route["rejected"] = libcomp::String("%1")
+                            .Arg(pair.second.rejected)
+                            .ToUtf8();
+
+    routes[pair.first.ToUtf8()] = route;
+  }
+
+  response["routes"] = routes;
+
+  std::list<std::shared_ptr<libhack::ScriptEnginePool>> pools;
+  if (mLoginScriptPool) {
+    pools.push_back(mLoginScriptPool);
+  }
+
+  for (auto& pair : mScriptPools) {
+    pools.push_back(pair.second);
+  }
+
+  JsonBox::Object scripts;
+
+  for (auto& pool : pools) {
+    JsonBox::Object script;
+    script["hits"] = (double)pool->GetHits();
+    script["misses"] = (double)pool->GetMisses();
+    script["executions"] = (double)pool->GetExecutions();
+    script["total_us"] = libcomp::String("%1")
+                             .Arg(pool->GetTotalExecutionTime())
+                             .ToUtf8();
+    script["max_us"] = libcomp::String("%1")
+                           .Arg(pool->GetMaxExecutionTime())
+                           .ToUtf8();
+
+    scripts[pool->GetName().ToUtf8()] = script;
+  }
+
+  response["scripts"] = scripts;
+
+  return true;
+}
+
+void ApiHandler::BindWebApp(libhack::ScriptEngine& engine) {
+  engine.Using<libcomp::Randomizer>();
+  engine.Using<objects::Account>();
+  engine.Using<objects::AccountWorldData>();
+  engine.Using<objects::Character>();
+  engine.Using<objects::PostItem>();
+  engine.Using<objects::Promo>();
+  engine.Using<objects::PromoExchange>();
+
+  auto vm = engine.GetVM();
+
+  Sqrat::Class<ApiSession, Sqrat::NoConstructor<ApiSession>> sBinding(
+      vm, "ApiSession");
+  Sqrat::RootTable(vm).Bind("ApiSession", sBinding);
+  Sqrat::Class<JsonBox::Object, Sqrat::NoConstructor<JsonBox::Object>>
+      oBinding(vm, "JsonObject");
+  Sqrat::RootTable(vm).Bind("JsonObject", oBinding);
+  Sqrat::Class<ApiHandler, Sqrat::NoConstructor<ApiHandler>> apiBinding(
+      vm, "ApiHandler");
+  apiBinding.Func("SetResponse", &ApiHandler::Script_SetResponse)
+      .Func("GetTimestamp", &ApiHandler::Script_GetTimestamp)
+      .Func("GetLobbyDatabase", &ApiHandler::WebAppScript_GetLobbyDatabase)
+      .Func("GetWorldDatabase", &ApiHandler::WebAppScript_GetWorldDatabase);
+  Sqrat::RootTable(vm).Bind("ApiHandler", apiBinding);
+}
+
+void ApiHandler::BindWebGame(libhack::ScriptEngine& engine) {
+  engine.Using<libcomp::Randomizer>();
+  engine.Using<objects::Character>();
+  engine.Using<objects::PostItem>();
+
+  // Bind the handler and the JSON response structure and session as well
+  // but nothing on them since we only need to pass through to the API
+  // functions
+  auto vm = engine.GetVM();
+
+  Sqrat::Class<ApiSession, Sqrat::NoConstructor<ApiSession>> sBinding(
+      vm, "ApiSession");
+  Sqrat::RootTable(vm).Bind("ApiSession", sBinding);
+
+  Sqrat::Class<JsonBox::Object, Sqrat::NoConstructor<JsonBox::Object>>
+      oBinding(vm, "JsonObject");
+  Sqrat::RootTable(vm).Bind("JsonObject", oBinding);
+
+  Sqrat::Class<ApiHandler, Sqrat::NoConstructor<ApiHandler>> apiBinding(
+      vm, "ApiHandler");
+  apiBinding.Func("GetCoins", &ApiHandler::WebGameScript_GetCoins)
+      .Func("GetDatabase", &ApiHandler::WebGameScript_GetDatabase)
+      .Func("GetSystemTime", &ApiHandler::WebGameScript_GetSystemTime)
+      .Func("GetTimestamp", &ApiHandler::Script_GetTimestamp)
+      .Func("SetResponse", &ApiHandler::Script_SetResponse)
+      .Func("UpdateCoins", &ApiHandler::WebGameScript_UpdateCoins);
+  Sqrat::RootTable(vm).Bind("ApiHandler", apiBinding);
+}
+
 bool ApiHandler::WebApp_Request(const libcomp::String& appName,
                                 const libcomp::String& method,
                                 const JsonBox::Object& request,
                                 JsonBox::Object& response,
                                 const std::shared_ptr<ApiSession>& session) {
-  // Build the web app and hit the method every time. No state is stored.
+  // Grab a ready web app VM and hit the method every time. No state is
+  // stored as pooled VMs drop any added globals and re-run the app script
+  // when they are returned.
   auto appIter = mAppDefinitions.find(appName);
   if (appIter == mAppDefinitions.end()) {
     return false;
   }
 
-  auto app = std::make_shared<libhack::ScriptEngine>();
-  app->Using<libcomp::Randomizer>();
-  app->Using<objects::Account>();
-  app->Using<objects::AccountWorldData>();
-  app->Using<objects::Character>();
-  app->Using<objects::PostItem>();
-  app->Using<objects::Promo>();
-  app->Using<objects::PromoExchange>();
-
-  if (!app->Eval(appIter->second->Source, appIter->second->Name)) {
+  auto poolIter = mScriptPools.find("webapp/" + appName);
+  auto pool = poolIter != mScriptPools.end() ? poolIter->second : nullptr;
+  auto app = pool ? pool->Acquire() : nullptr;
+  if (!app) {
     response["error"] = "App could not be started";
     return true;
   }
 
-  auto vm = app->GetVM();
-  {
-    Sqrat::Class<ApiSession, Sqrat::NoConstructor<ApiSession>> sBinding(
-        vm, "ApiSession");
-    Sqrat::RootTable(vm).Bind("ApiSession", sBinding);
+  auto start = std::chrono::steady_clock::now();
 
-    Sqrat::Class<JsonBox::Object, Sqrat::NoConstructor<JsonBox::Object>>
-        oBinding(vm, "JsonObject");
-    Sqrat::RootTable(vm).Bind("JsonObject", oBinding);
+  WebApp_Run(app, method, request, response, session);
 
-    Sqrat::Class<ApiHandler, Sqrat::NoConstructor<ApiHandler>> apiBinding(
-        vm, "ApiHandler");
-    apiBinding.Func("SetResponse", &ApiHandler::Script_SetResponse)
-        .Func("GetTimestamp", &ApiHandler::Script_GetTimestamp)
-        .Func("GetLobbyDatabase", &ApiHandler::WebAppScript_GetLobbyDatabase)
-        .Func("GetWorldDatabase", &ApiHandler::WebAppScript_GetWorldDatabase);
-    Sqrat::RootTable(vm).Bind("ApiHandler", apiBinding);
-  }
+  pool->RecordExecution(
+      (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+  pool->Release(app);
+  RefillScriptPool(pool);
+
+  return true;
+}
+
+void ApiHandler::WebApp_Run(const std::shared_ptr<libhack::ScriptEngine>& app,
+                            const libcomp::String& method,
+                            const JsonBox::Object& request,
+                            JsonBox::Object& response,
+                            const std::shared_ptr<ApiSession>& session) {
+  auto vm = app->GetVM();
 
   // Call the start function first then write standard response values
   Sqrat::Function p(Sqrat::RootTable(vm), "prepare");
@@ -1476,11 +1794,11 @@ bool ApiHandler::WebApp_Request(const libcomp::String& appName,
             " web app";
       }
 
-      return true;
+      return;
     }
   } else {
     response["error"] = "Failed to prepare web app";
-    return true;
+    return;
   }
 
   int8_t worldID = -1;
@@ -1510,19 +1828,17 @@ bool ApiHandler::WebApp_Request(const libcomp::String& appName,
                               : 0;
     if (!result || (*result != 0)) {
       response["error"] = "Unknown error encountered";
-      return true;
+      return;
     }
   } else {
     response["error"] =
         libcomp::String("Invalid web app method supplied: %1").Arg(method).C();
-    return true;
+    return;
   }
 
   if (response.find("error") == response.end()) {
     response["error"] = "Success";
   }
-
-  return true;
 }
 
 std::shared_ptr<libcomp::Database> ApiHandler::WebAppScript_GetLobbyDatabase() {
@@ -1587,41 +1903,17 @@ bool ApiHandler::WebGame_Start(const JsonBox::Object& request,
     return true;
   }
 
-  webGameSession->gameState = std::make_shared<libhack::ScriptEngine>();
-  webGameSession->gameState->Using<libcomp::Randomizer>();
-  webGameSession->gameState->Using<objects::Character>();
-  webGameSession->gameState->Using<objects::PostItem>();
-
-  // Bind the handler and the JSON response structure and session as well
-  // but nothing on them since we only need to pass through to the API
-  // functions
-  {
-    auto vm = webGameSession->gameState->GetVM();
-
-    Sqrat::Class<ApiSession, Sqrat::NoConstructor<ApiSession>> sBinding(
-        vm, "ApiSession");
-    Sqrat::RootTable(vm).Bind("ApiSession", sBinding);
-
-    Sqrat::Class<JsonBox::Object, Sqrat::NoConstructor<JsonBox::Object>>
-        oBinding(vm, "JsonObject");
-    Sqrat::RootTable(vm).Bind("JsonObject", oBinding);
-
-    Sqrat::Class<ApiHandler, Sqrat::NoConstructor<ApiHandler>> apiBinding(
-        vm, "ApiHandler");
-    apiBinding.Func("GetCoins", &ApiHandler::WebGameScript_GetCoins)
-        .Func("GetDatabase", &ApiHandler::WebGameScript_GetDatabase)
-        .Func("GetSystemTime", &ApiHandler::WebGameScript_GetSystemTime)
-        .Func("GetTimestamp", &ApiHandler::Script_GetTimestamp)
-        .Func("SetResponse", &ApiHandler::Script_SetResponse)
-        .Func("UpdateCoins", &ApiHandler::WebGameScript_UpdateCoins);
-    Sqrat::RootTable(vm).Bind("ApiHandler", apiBinding);
-  }
-
-  if (!webGameSession->gameState->Eval(gameIter->second->Source)) {
+  auto poolIter = mScriptPools.find("webgame/" + type);
+  auto pool = poolIter != mScriptPools.end() ? poolIter->second : nullptr;
+  webGameSession->gameState = pool ? pool->Acquire() : nullptr;
+  if (!webGameSession->gameState) {
     response["error"] = "Game could not be started";
     return true;
   }
 
+  // Game VMs are never returned so replace the one just taken
+  RefillScriptPool(pool);
+
   auto worldDB = world->GetWorldDatabase();
 
   auto character = gameSession->GetCharacter().Get(worldDB, true);
@@ -1636,9 +1928,17 @@ bool ApiHandler::WebGame_Start(const JsonBox::Object& request,
   auto vm = webGameSession->gameState->GetVM();
   Sqrat::Function f(Sqrat::RootTable(vm), "start");
   if (!f.IsNull()) {
+    auto start = std::chrono::steady_clock::now();
+
     auto result = !f.IsNull() ? f.Evaluate<int>(this, character,
                                                 progress->GetCoins(), &response)
                               : 0;
+
+    pool->RecordExecution(
+        (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+
     if (!result || (*result != 0)) {
       response["error"] = "Unknown error encountered while starting game";
       return true;
@@ -1777,6 +2077,11 @@ int64_t ApiHandler::WebGameScript_GetSystemTime() {
   }
 }
 
+void ApiHandler::SetLoginScriptPool(
+    const std::shared_ptr<libhack::ScriptEnginePool>& pool) {
+  mLoginScriptPool = pool;
+}
+
 uint32_t ApiHandler::Script_GetTimestamp() { return (uint32_t)std::time(0); }
 
 void ApiHandler::Script_SetResponse(JsonBox::Object* response,
@@ -1982,7 +2287,6 @@ bool ApiHandler::handlePost(CivetServer* pServer,
 
   delete[] szPostData;
 
-  std::stringstream ss;
   JsonBox::Object response;
 
   libcomp::String clientAddress(pRequestInfo->remote_addr);
@@ -2075,11 +2379,23 @@ bool ApiHandler::handlePost(CivetServer* pServer,
       auto app = parts.front();
       auto appMethod = parts.back();
 
-      std::lock_guard<std::mutex> guard(*session->requestLock);
+      if (!BeginRoute("/webapp/")) {
+        mg_printf(pConnection,
+                  "HTTP/1.1 503 Service Unavailable\r\n"
+                  "Connection: close\r\n\r\n");
+
+        return true;
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(*session->requestLock);
 
-      if (!WebApp_Request(app, appMethod, obj, response, session)) {
-        badRequest = true;
+        if (!WebApp_Request(app, appMethod, obj, response, session)) {
+          badRequest = true;
+        }
       }
+
+      EndRoute("/webapp/");
     } else {
       badRequest = true;
     }
@@ -2090,6 +2406,32 @@ bool ApiHandler::handlePost(CivetServer* pServer,
 
       return true;
     }
+  } else if (mStreamParsers.find(method) != mStreamParsers.end()) {
+    if (!BeginRoute(method)) {
+      mg_printf(pConnection,
+                "HTTP/1.1 503 Service Unavailable\r\n"
+                "Connection: close\r\n\r\n");
+
+      return true;
+    }
+
+    // Streamed handlers write their own response
+    bool result = false;
+    {
+      std::lock_guard<std::mutex> guard(*session->requestLock);
+
+      result =
+          mStreamParsers[method](*this, obj, response, pConnection, session);
+    }
+
+    EndRoute(method);
+
+    if (!result) {
+      mg_printf(pConnection,
+                "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+    }
+
+    return true;
   } else {
     auto it = mParsers.find(method);
 
@@ -2100,10 +2442,31 @@ bool ApiHandler::handlePost(CivetServer* pServer,
       return true;
     }
 
-    // Lock the mutex while processing the request
-    std::lock_guard<std::mutex> guard(*session->requestLock);
+    bool result = false;
+    if (mReadOnlyRoutes.find(method) != mReadOnlyRoutes.end()) {
+      // Read-only requests run immediately without waiting on anything
+      // else the session is doing
+      result = it->second(*this, obj, response, session);
+    } else {
+      if (!BeginRoute(method)) {
+        mg_printf(pConnection,
+                  "HTTP/1.1 503 Service Unavailable\r\n"
+                  "Connection: close\r\n\r\n");
+
+        return true;
+      }
+
+      {
+        // Lock the mutex while processing the request
+        std::lock_guard<std::mutex> guard(*session->requestLock);
+
+        result = it->second(*this, obj, response, session);
+      }
 
-    if (!it->second(*this, obj, response, session)) {
+      EndRoute(method);
+    }
+
+    if (!result) {
       mg_printf(pConnection,
                 "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
 
@@ -2111,6 +2474,15 @@ bool ApiHandler::handlePost(CivetServer* pServer,
     }
   }
 
+  WriteResponse(pConnection, response);
+
+  return true;
+}
+
+void ApiHandler::WriteResponse(struct mg_connection* pConnection,
+                               const JsonBox::Object& response) {
+  std::stringstream ss;
+
   JsonBox::Value responseValue(response);
   responseValue.writeToStream(ss);
 
@@ -2121,10 +2493,52 @@ bool ApiHandler::handlePost(CivetServer* pServer,
             "Connection: close\r\n"
             "\r\n%s",
             (uint32_t)ss.str().size(), ss.str().c_str());
+}
+
+bool ApiHandler::BeginRoute(const libcomp::String& route) {
+  std::lock_guard<std::mutex> lock(mRouteLock);
+
+  // Requests over the limit are rejected rather than waited on as waiting
+  // would tie up the web worker thread the limit is meant to protect
+  auto& state = mRoutes[route];
+  if (state.limit && state.active >= state.limit) {
+    state.rejected++;
+
+    LogWebAPIWarning([&]() {
+      return libcomp::String(
+                 "API route %1 rejected a request with %2 active.\n")
+          .Arg(route)
+          .Arg(state.active);
+    });
+
+    return false;
+  }
+
+  state.active++;
 
   return true;
 }
 
+void ApiHandler::EndRoute(const libcomp::String& route) {
+  std::lock_guard<std::mutex> lock(mRouteLock);
+
+  auto& state = mRoutes[route];
+  state.active--;
+  state.completed++;
+}
+
+void ApiHandler::RefillScriptPool(
+    const std::shared_ptr<libhack::ScriptEnginePool>& pool) {
+  // Resets and new VMs are built on a worker instead of the web thread
+  if (mServer && pool->ClaimRefill()) {
+    mServer->QueueWork(
+        [](std::shared_ptr<libhack::ScriptEnginePool> scriptPool) {
+          scriptPool->Refill();
+        },
+        pool);
+  }
+}
+
 void ApiHandler::SetAccountManager(AccountManager* pManager) {
   mAccountManager = pManager;
 }
@@ -46,6 +46,7 @@
 #include <JsonBox.h>
 
 // Standard C++11 Includes
+#include <set>
 #include <unordered_map>
 
 namespace objects {
@@ -55,6 +56,7 @@ class WebGameSession;
 namespace libhack {
 class DefinitionManager;
 class ScriptEngine;
+class ScriptEnginePool;
 }  // namespace libhack
 
 namespace lobby {
@@ -77,6 +79,17 @@ class ApiSession {
   std::mutex* requestLock;
 };
 
+class ApiRouteState {
+ public:
+  ApiRouteState()
+      : limit(0), active(0), completed(0), rejected(0) {}
+
+  uint16_t limit;
+  uint32_t active;
+  uint64_t completed;
+  uint64_t rejected;
+};
+
 class WebGameApiSession : public ApiSession {
  public:
   std::shared_ptr<objects::WebGameSession> webGameSession;
@@ -120,6 +133,7 @@ class ApiHandler : public CivetHandler {
 
   bool Admin_GetAccounts(const JsonBox::Object& request,
                          JsonBox::Object& response,
+                         struct mg_connection* pConnection,
                          const std::shared_ptr<ApiSession>& session);
   bool Admin_GetAccount(const JsonBox::Object& request,
                         JsonBox::Object& response,
@@ -150,6 +164,9 @@ class ApiHandler : public CivetHandler {
   bool Admin_DeletePromo(const JsonBox::Object& request,
                          JsonBox::Object& response,
                          const std::shared_ptr<ApiSession>& session);
+  bool Admin_ApiStats(const JsonBox::Object& request,
+                      JsonBox::Object& response,
+                      const std::shared_ptr<ApiSession>& session);
 
   bool WebApp_Request(const libcomp::String& appName,
                       const libcomp::String& method,
@@ -175,6 +192,9 @@ class ApiHandler : public CivetHandler {
   bool WebGameScript_UpdateCoins(const std::shared_ptr<ApiSession>& session,
                                  int64_t coins, bool adjust);
 
+  void SetLoginScriptPool(
+      const std::shared_ptr<libhack::ScriptEnginePool>& pool);
+
   uint32_t Script_GetTimestamp();
   void Script_SetResponse(JsonBox::Object* response, const libcomp::String& key,
                           const libcomp::String& value);
@@ -194,6 +214,22 @@ class ApiHandler : public CivetHandler {
                      const std::shared_ptr<ApiSession>& session,
                      uint32_t requiredLevel);
 
+  void WriteResponse(struct mg_connection* pConnection,
+                     const JsonBox::Object& response);
+
+  bool BeginRoute(const libcomp::String& route);
+  void EndRoute(const libcomp::String& route);
+
+  void RefillScriptPool(const std::shared_ptr<libhack::ScriptEnginePool>& pool);
+
+  void WebApp_Run(const std::shared_ptr<libhack::ScriptEngine>& app,
+                  const libcomp::String& method,
+                  const JsonBox::Object& request, JsonBox::Object& response,
+                  const std::shared_ptr<ApiSession>& session);
+
+  static void BindWebApp(libhack::ScriptEngine& engine);
+  static void BindWebGame(libhack::ScriptEngine& engine);
+
   // List of API sessions.
   std::unordered_map<libcomp::String, std::shared_ptr<ApiSession>> mSessions;
 
@@ -205,6 +241,17 @@ class ApiHandler : public CivetHandler {
                          const std::shared_ptr<ApiSession>& session)>>
       mParsers;
 
+  /// List of API parsers that stream their response to the connection.
+  /// The response passed in holds the fields every reply must include
+  /// (such as the next challenge) and must be written out by the parser.
+  std::unordered_map<
+      libcomp::String,
+      std::function<bool(ApiHandler&, const JsonBox::Object& request,
+                         JsonBox::Object& response,
+                         struct mg_connection* pConnection,
+                         const std::shared_ptr<ApiSession>& session)>>
+      mStreamParsers;
+
   std::shared_ptr<objects::LobbyConfig> mConfig;
   std::shared_ptr<lobby::LobbyServer> mServer;
 
@@ -214,10 +261,30 @@ class ApiHandler : public CivetHandler {
   std::unordered_map<libcomp::String, std::shared_ptr<libhack::ServerScript>>
       mGameDefinitions;
 
+  /// Pre-warmed script engines for each web app and web game, keyed by
+  /// "webapp/<name>" or "webgame/<name>". Only filled in by the
+  /// constructor, request threads must only look pools up with find().
+  std::unordered_map<libcomp::String,
+                     std::shared_ptr<libhack::ScriptEnginePool>>
+      mScriptPools;
+
+  /// Script engine pool used by the login web handler, reported with the
+  /// other pools in the API stats.
+  std::shared_ptr<libhack::ScriptEnginePool> mLoginScriptPool;
+
   AccountManager* mAccountManager;
   libhack::DefinitionManager* mDefinitionManager;
 
   std::mutex mSessionLock;
+
+  /// Concurrency limits and queue metrics for each API route.
+  std::unordered_map<libcomp::String, ApiRouteState> mRoutes;
+
+  /// Routes that do not modify the session and can skip the per-session
+  /// request lock and route limits.
+  std::set<libcomp::String> mReadOnlyRoutes;
+
+  std::mutex mRouteLock;
 };
 
 }  // namespace lobby
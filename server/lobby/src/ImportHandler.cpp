@@ -35,8 +35,20 @@
 // lobby Includes
 #include "World.h"
 
+// Standard C Includes
+#include <cstdlib>
+
+// Standard C++11 Includes
+#include <vector>
+
 using namespace lobby;
 
+/// Number of bytes to read at a time from a streamed import request.
+#define IMPORT_STREAM_CHUNK_SIZE (64 * 1024)
+
+/// Number of streamed accounts imported together in one batch.
+#define IMPORT_STREAM_BATCH_SIZE 32
+
 ImportHandler::ImportHandler(
     const std::shared_ptr<objects::LobbyConfig> &config,
     const std::shared_ptr<lobby::LobbyServer> &server)
@@ -65,6 +77,18 @@ bool ImportHandler::handlePost(CivetServer *pServer,
 
   libcomp::String requestURI(pRequestInfo->request_uri);
 
+  if ("/import/stream" == requestURI) {
+    // Streams are not authenticated so they must be enabled on their own.
+    if (!mConfig->GetAllowImportStream()) {
+      mg_printf(pConnection,
+                "HTTP/1.1 401 Unauthorized\r\nConnection: close\r\n\r\n");
+
+      return true;
+    }
+
+    return HandleStream(pConnection, pRequestInfo);
+  }
+
   if ("/import" != requestURI) {
     return false;
   }
@@ -154,6 +178,189 @@ bool ImportHandler::handlePost(CivetServer *pServer,
   return true;
 }
 
+bool ImportHandler::HandleStream(struct mg_connection *pConnection,
+                                 const mg_request_info *pRequestInfo) {
+  // Number of accounts to skip when resuming an earlier import.
+  size_t skip = 0;
+
+  if (pRequestInfo->query_string) {
+    char szSkip[32];
+
+    if (0 < mg_get_var(pRequestInfo->query_string,
+                       strlen(pRequestInfo->query_string), "skip", szSkip,
+                       sizeof(szSkip))) {
+      skip = static_cast<size_t>(std::strtoull(szSkip, nullptr, 10));
+    }
+  }
+
+  // The payload limit applies to each account with separate limits for
+  // the whole request.
+  size_t maxAccountSize = (size_t)(mConfig->GetImportMaxPayload() * 1024);
+  size_t maxStreamSize =
+      (size_t)mConfig->GetImportStreamMaxPayload() * (size_t)1024;
+  size_t maxAccounts = (size_t)mConfig->GetImportStreamMaxAccounts();
+
+  if (0 < pRequestInfo->content_length &&
+      maxStreamSize < (size_t)pRequestInfo->content_length) {
+    LogWebAPIErrorMsg(
+        libcomp::String("Import stream of %1 bytes rejected.\n")
+            .Arg((uint64_t)pRequestInfo->content_length));
+
+    mg_printf(pConnection,
+              "HTTP/1.1 413 Payload Too Large\r\nConnection: close\r\n\r\n");
+
+    return true;
+  }
+
+  static const std::string endTag = "</objects>";
+
+  mg_printf(pConnection,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/x-ndjson\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+
+  size_t index = 0;
+  size_t imported = 0;
+  size_t failed = 0;
+  size_t totalRead = 0;
+
+  libcomp::String streamError;
+
+  std::string pending;
+  std::vector<char> chunk(IMPORT_STREAM_CHUNK_SIZE);
+
+  // Accounts waiting to be imported. These always end at the current index.
+  std::vector<libcomp::String> batch;
+
+  auto importBatch = [&]() {
+    std::vector<libcomp::String> errors;
+
+    if (mServer) {
+      errors = mServer->ImportAccounts(batch, mConfig->GetImportWorld());
+    } else {
+      errors.assign(batch.size(), "Internal error.");
+    }
+
+    size_t batchIndex = index - batch.size();
+
+    for (auto& importError : errors) {
+      if (importError.IsEmpty()) {
+        imported++;
+      } else {
+        failed++;
+      }
+
+      WriteStreamResult(pConnection, batchIndex++, importError);
+    }
+
+    batch.clear();
+  };
+
+  int bytesRead;
+
+  while (streamError.IsEmpty() &&
+         0 < (bytesRead = mg_read(pConnection, chunk.data(), chunk.size()))) {
+    // Only search the new data (and enough before it to catch a split tag).
+    size_t searchFrom = pending.size() > endTag.size()
+                            ? pending.size() - endTag.size()
+                            : 0;
+
+    pending.append(chunk.data(), static_cast<size_t>(bytesRead));
+    totalRead += static_cast<size_t>(bytesRead);
+
+    // Import every complete account dump received so far.
+    size_t dumpStart = 0;
+    size_t dumpEnd;
+
+    while (std::string::npos !=
+           (dumpEnd = pending.find(endTag, searchFrom))) {
+      if (maxAccounts <= index) {
+        streamError = "Too many accounts in the stream.";
+        break;
+      }
+
+      dumpEnd += endTag.size();
+      searchFrom = dumpEnd;
+
+      if (index >= skip) {
+        batch.push_back(pending.substr(dumpStart, dumpEnd - dumpStart));
+      }
+
+      index++;
+      dumpStart = dumpEnd;
+
+      if (IMPORT_STREAM_BATCH_SIZE <= batch.size()) {
+        importBatch();
+      }
+    }
+
+    pending.erase(0, dumpStart);
+
+    if (!streamError.IsEmpty()) {
+      LogWebAPIErrorMsg(
+          libcomp::String("Import stream stopped at the %1 account limit.\n")
+              .Arg(maxAccounts));
+    } else if (maxStreamSize < totalRead) {
+      LogWebAPIErrorMsg(
+          libcomp::String("Import stream exceeded the %1 byte limit.\n")
+              .Arg(maxStreamSize));
+
+      streamError = "Import stream too large.";
+    } else if (maxAccountSize < pending.size()) {
+      LogWebAPIErrorMsg(
+          libcomp::String("Streamed account %1 exceeded the %2 byte limit.\n")
+              .Arg(index)
+              .Arg(maxAccountSize));
+
+      streamError = "Account data too large.";
+    }
+  }
+
+  // Import what is left of the last batch.
+  if (!batch.empty()) {
+    importBatch();
+  }
+
+  if (streamError.IsEmpty() && !libcomp::String(pending).Trimmed().IsEmpty()) {
+    streamError = "Incomplete account data at the end of the stream.";
+  }
+
+  // Finish with a summary the client can use to resume the import.
+  JsonBox::Object summary;
+  summary["imported"] = (int)imported;
+  summary["failed"] = (int)failed;
+  summary["next"] = (int)index;
+  summary["error"] = streamError.IsEmpty() ? "Success" : streamError.ToUtf8();
+
+  std::stringstream ss;
+  JsonBox::Value(summary).writeToStream(ss, false);
+  ss << "\n";
+
+  mg_write(pConnection, ss.str().c_str(), ss.str().size());
+
+  return true;
+}
+
+void ImportHandler::WriteStreamResult(struct mg_connection *pConnection,
+                                      size_t index,
+                                      const libcomp::String &importError) {
+  JsonBox::Object result;
+  result["index"] = (int)index;
+
+  if (importError.IsEmpty()) {
+    result["error"] = "Success";
+  } else {
+    result["error"] = importError.ToUtf8();
+  }
+
+  std::stringstream ss;
+  JsonBox::Value(result).writeToStream(ss, false);
+  ss << "\n";
+
+  mg_write(pConnection, ss.str().c_str(), ss.str().size());
+}
+
 libcomp::String ImportHandler::ExtractFile(const libcomp::String &contentType,
                                            const libcomp::String &contentData) {
   libcomp::String boundary;
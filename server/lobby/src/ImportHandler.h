@@ -54,6 +54,31 @@ class ImportHandler : public CivetHandler {
                           struct mg_connection* pConnection);
 
  private:
+  /**
+   * Import a stream of account dumps in batches as the request body is
+   * read so only one batch of accounts is ever held in memory. Each batch
+   * is written to the databases with one transaction per database. Each
+   * account is reported on its own line once its batch is imported
+   * followed by a summary line with the index to resume from. Streams are
+   * only accepted when AllowImportStream is set and stop at the total
+   * size and account count limits in the config.
+   * @param pConnection Connection the request was received on
+   * @param pRequestInfo Information about the request
+   * @returns true if the request was handled
+   */
+  bool HandleStream(struct mg_connection* pConnection,
+                    const mg_request_info* pRequestInfo);
+
+  /**
+   * Write the result of importing one streamed account.
+   * @param pConnection Connection to write the result to
+   * @param index Index of the account in the stream
+   * @param importError Error from importing the account or empty if the
+   *  import succeeded
+   */
+  void WriteStreamResult(struct mg_connection* pConnection, size_t index,
+                         const libcomp::String& importError);
+
   libcomp::String ExtractFile(const libcomp::String& contentType,
                               const libcomp::String& contentData);
 
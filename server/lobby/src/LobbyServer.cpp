@@ -52,6 +52,9 @@
 
 using namespace lobby;
 
+/// Number of UUIDs checked by one query when importing accounts.
+#define IMPORT_UUID_BATCH_SIZE 100
+
 LobbyServer::LobbyServer(
     const char* szProgram, std::shared_ptr<objects::ServerConfig> config,
     std::shared_ptr<libcomp::ServerCommandLineParser> commandLine,
@@ -544,14 +547,12 @@ libcomp::String LobbyServer::GetFakeAccountSalt(
 
 libcomp::String LobbyServer::ImportAccount(const libcomp::String& data,
                                            uint8_t worldID) {
-  tinyxml2::XMLDocument doc;
-
-  if (tinyxml2::XML_SUCCESS != doc.Parse(data.C())) {
-    return "Failed to parse account data.";
-  }
+  return ImportAccounts({data}, worldID).front();
+}
 
-  const tinyxml2::XMLElement* pImportObject =
-      doc.RootElement()->FirstChildElement("object");
+std::vector<libcomp::String> LobbyServer::ImportAccounts(
+    const std::vector<libcomp::String>& data, uint8_t worldID) {
+  std::vector<libcomp::String> errors(data.size());
 
   std::shared_ptr<libcomp::Database> lobbyDB, worldDB;
 
@@ -566,15 +567,180 @@ libcomp::String LobbyServer::ImportAccount(const libcomp::String& data,
   }
 
   if (!lobbyDB || !worldDB) {
-    return "Failed to connect to database.";
+    for (auto& error : errors) {
+      error = "Failed to connect to database.";
+    }
+
+    return errors;
+  }
+
+  std::vector<ImportedAccount> accounts(data.size());
+
+  // Names and UUIDs claimed by an earlier account in the batch.
+  std::set<std::string> uuids;
+  std::set<libcomp::String> usernames, emails, characterNames;
+
+  for (size_t i = 0; i < data.size(); i++) {
+    auto& account = accounts[i];
+    account.Error = LoadImportAccount(data[i], lobbyDB, worldDB, account);
+
+    for (auto& pair : account.TypeUUIDs) {
+      for (auto& uuid : pair.second) {
+        if (account.Error.IsEmpty() && !uuids.insert(uuid.ToString()).second) {
+          account.Error =
+              libcomp::String("Object with UUID '%1' is imported twice.")
+                  .Arg(uuid.ToString());
+        }
+      }
+    }
+
+    for (auto& pair : account.LobbyObjects) {
+      auto obj = std::dynamic_pointer_cast<objects::Account>(pair.second);
+
+      if (account.Error.IsEmpty() && obj &&
+          (!usernames.insert(obj->GetUsername().ToLower()).second ||
+           !emails.insert(obj->GetEmail().ToLower()).second)) {
+        account.Error =
+            libcomp::String("Account '%1' exists").Arg(obj->GetUsername());
+      }
+    }
+
+    for (auto& pair : account.WorldObjects) {
+      auto obj = std::dynamic_pointer_cast<objects::Character>(pair.second);
+
+      if (account.Error.IsEmpty() && obj &&
+          !characterNames.insert(obj->GetName()).second) {
+        account.Error =
+            libcomp::String("Character '%1' exists").Arg(obj->GetName());
+      }
+    }
+  }
+
+  // Check the UUIDs of the whole batch with one query per object type.
+  std::unordered_map<std::string, std::list<libobjgen::UUID>> typeUUIDs;
+
+  for (auto& account : accounts) {
+    if (account.Error.IsEmpty()) {
+      for (auto& pair : account.TypeUUIDs) {
+        auto& batchUUIDs = typeUUIDs[pair.first];
+        batchUUIDs.insert(batchUUIDs.end(), pair.second.begin(),
+                          pair.second.end());
+      }
+    }
+  }
+
+  std::set<std::string> existing;
+
+  for (auto& pair : typeUUIDs) {
+    auto found = FindExistingImportUUIDs(
+        pair.first, "Account" == pair.first ? lobbyDB : worldDB, pair.second);
+    existing.insert(found.begin(), found.end());
   }
 
-  std::list<
-      std::pair<libobjgen::UUID, std::shared_ptr<libcomp::PersistentObject>>>
-      lobbyObjects;
-  std::list<
-      std::pair<libobjgen::UUID, std::shared_ptr<libcomp::PersistentObject>>>
-      worldObjects;
+  for (auto& account : accounts) {
+    for (auto& pair : account.TypeUUIDs) {
+      for (auto& uuid : pair.second) {
+        if (account.Error.IsEmpty() &&
+            existing.find(uuid.ToString()) != existing.end()) {
+          account.Error = libcomp::String(
+                              "Object with UUID '%1' already exists in "
+                              "database.")
+                              .Arg(uuid.ToString());
+        }
+      }
+    }
+
+    if (!account.Error.IsEmpty()) {
+      continue;
+    }
+
+    for (auto& pair : account.LobbyObjects) {
+      if (account.Error.IsEmpty() &&
+          !pair.second->Register(pair.second, pair.first)) {
+        account.Error = "Failed to register an object.";
+      }
+    }
+
+    for (auto& pair : account.WorldObjects) {
+      if (account.Error.IsEmpty() &&
+          !pair.second->Register(pair.second, pair.first)) {
+        account.Error = "Failed to register an object.";
+      }
+    }
+  }
+
+  // Write the lobby objects and then the world objects of the accounts
+  // that are still good. Each database gets one transaction for the batch
+  // unless it fails, then each account is retried in its own transaction.
+  for (auto lobby : {true, false}) {
+    auto db = lobby ? lobbyDB : worldDB;
+    auto changes = libcomp::DatabaseChangeSet::Create();
+    size_t changeCount = 0;
+
+    for (auto& account : accounts) {
+      if (account.Error.IsEmpty()) {
+        for (auto& pair : lobby ? account.LobbyObjects : account.WorldObjects) {
+          changes->Insert(pair.second);
+          changeCount++;
+        }
+      }
+    }
+
+    if (!changeCount || db->ProcessChangeSet(changes)) {
+      continue;
+    }
+
+    LogGeneralWarning([&]() {
+      return libcomp::String("Import batch failed with %1 database error: %2\n")
+          .Arg(lobby ? "lobby" : "world")
+          .Arg(db->GetLastError());
+    });
+
+    for (auto& account : accounts) {
+      auto& objs = lobby ? account.LobbyObjects : account.WorldObjects;
+
+      if (!account.Error.IsEmpty() || objs.empty()) {
+        continue;
+      }
+
+      changes = libcomp::DatabaseChangeSet::Create();
+
+      for (auto& pair : objs) {
+        changes->Insert(pair.second);
+      }
+
+      if (!db->ProcessChangeSet(changes)) {
+        LogGeneralError([&]() {
+          return libcomp::String("Import failed with %1 database error: %2\n")
+              .Arg(lobby ? "lobby" : "world")
+              .Arg(db->GetLastError());
+        });
+
+        account.Error = "Failed to write account into database.";
+      }
+    }
+  }
+
+  for (size_t i = 0; i < accounts.size(); i++) {
+    errors[i] = accounts[i].Error;
+  }
+
+  return errors;
+}
+
+libcomp::String LobbyServer::LoadImportAccount(
+    const libcomp::String& data,
+    const std::shared_ptr<libcomp::Database>& lobbyDB,
+    const std::shared_ptr<libcomp::Database>& worldDB,
+    ImportedAccount& account) {
+  tinyxml2::XMLDocument doc;
+
+  if (tinyxml2::XML_SUCCESS != doc.Parse(data.C())) {
+    return "Failed to parse account data.";
+  }
+
+  const tinyxml2::XMLElement* pImportObject =
+      doc.RootElement()->FirstChildElement("object");
 
   while (nullptr != pImportObject) {
     std::string objectType(pImportObject->Attribute("name"));
@@ -621,30 +787,13 @@ libcomp::String LobbyServer::ImportAccount(const libcomp::String& data,
           .Arg(uuid.ToString());
     }
 
-    std::shared_ptr<libcomp::Database> db;
-
     if ("Account" == objectType) {
-      db = lobbyDB;
-
-      lobbyObjects.push_back(std::make_pair(uuid, obj));
+      account.LobbyObjects.push_back(std::make_pair(uuid, obj));
     } else {
-      db = worldDB;
-
-      worldObjects.push_back(std::make_pair(uuid, obj));
+      account.WorldObjects.push_back(std::make_pair(uuid, obj));
     }
 
-    if (!db) {
-      return "Failed to connect to database.";
-    }
-
-    auto existingObject =
-        libcomp::PersistentObject::LoadObjectByUUID(typeHash, db, uuid);
-
-    if (existingObject) {
-      return libcomp::String(
-                 "Object with UUID '%1' already exists in database.")
-          .Arg(uuid.ToString());
-    }
+    account.TypeUUIDs[objectType].push_back(uuid);
 
     libcomp::String importError =
         CheckImportObject(objectType, obj, lobbyDB, worldDB);
@@ -656,49 +805,68 @@ libcomp::String LobbyServer::ImportAccount(const libcomp::String& data,
     pImportObject = pImportObject->NextSiblingElement("object");
   }
 
-  for (auto pair : lobbyObjects) {
-    if (!pair.second->Register(pair.second, pair.first)) {
-      return "Failed to register an object.";
-    }
-  }
+  return {};
+}
+
+std::set<std::string> LobbyServer::FindExistingImportUUIDs(
+    const std::string& objectType,
+    const std::shared_ptr<libcomp::Database>& db,
+    const std::list<libobjgen::UUID>& uuids) {
+  std::set<std::string> existing;
+
+  auto it = uuids.begin();
 
-  for (auto pair : worldObjects) {
-    if (!pair.second->Register(pair.second, pair.first)) {
-      return "Failed to register an object.";
+  while (it != uuids.end()) {
+    // Check up to IMPORT_UUID_BATCH_SIZE UUIDs in one query.
+    std::list<libobjgen::UUID> batch;
+    libcomp::String params;
+
+    for (; it != uuids.end() && batch.size() < IMPORT_UUID_BATCH_SIZE; it++) {
+      params += libcomp::String("%1:uid%2")
+                    .Arg(batch.empty() ? "" : ", ")
+                    .Arg(batch.size());
+      batch.push_back(*it);
     }
-  }
 
-  auto lobbyChangeSet = libcomp::DatabaseChangeSet::Create();
+    auto query = db->Prepare(
+        libcomp::String("SELECT `UID` FROM `%1` WHERE `UID` IN (%2);")
+            .Arg(objectType)
+            .Arg(params));
 
-  for (auto pair : lobbyObjects) {
-    lobbyChangeSet->Insert(pair.second);
-  }
+    bool success = query.IsValid();
+    size_t idx = 0;
 
-  if (!lobbyDB->ProcessChangeSet(lobbyChangeSet)) {
-    LogGeneralError([&]() {
-      return libcomp::String("Import failed with lobby database error: %1\n")
-          .Arg(lobbyDB->GetLastError());
-    });
+    for (auto& uuid : batch) {
+      success =
+          success && query.Bind(libcomp::String("uid%1").Arg(idx++), uuid);
+    }
 
-    return "Failed to write account into database.";
-  }
+    if (success && query.Execute()) {
+      while (query.Next()) {
+        libobjgen::UUID uuid;
 
-  auto worldChangeSet = libcomp::DatabaseChangeSet::Create();
+        if (query.GetValue("UID", uuid)) {
+          existing.insert(uuid.ToString());
+        }
+      }
 
-  for (auto pair : worldObjects) {
-    worldChangeSet->Insert(pair.second);
-  }
+      continue;
+    }
 
-  if (!worldDB->ProcessChangeSet(worldChangeSet)) {
-    LogGeneralError([&]() {
-      return libcomp::String("Import failed with world database error: %1\n")
-          .Arg(worldDB->GetLastError());
-    });
+    // Fall back to loading each object if the table could not be queried.
+    auto typeExists = false;
+    auto typeHash =
+        libcomp::PersistentObject::GetTypeHashByName(objectType, typeExists);
 
-    return "Failed to write account into database.";
+    for (auto& uuid : batch) {
+      if (typeExists &&
+          libcomp::PersistentObject::LoadObjectByUUID(typeHash, db, uuid)) {
+        existing.insert(uuid.ToString());
+      }
+    }
   }
 
-  return {};
+  return existing;
 }
 
 libcomp::String LobbyServer::CheckImportObject(
@@ -33,6 +33,11 @@
 // libcomp Includes
 #include <Worker.h>
 
+// Standard C++11 Includes
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 // lobby Includes
 #include "World.h"
 
@@ -157,6 +162,20 @@ class LobbyServer : public libhack::Server {
   libcomp::String ImportAccount(const libcomp::String& data,
                                 uint8_t worldID = 0);
 
+  /**
+   * Import a batch of accounts into the database. The UUIDs of every
+   * account in the batch are checked with one query per object type and
+   * the accounts are written with one change set (transaction) per
+   * database. If a batch write fails each account is written on its own
+   * so a single bad account does not fail the rest of the batch.
+   * @param data XML data for each account.
+   * @param worldID ID of the world to import the characters into.
+   * @returns Error string for each account (empty on success) in the same
+   *  order as the data.
+   */
+  std::vector<libcomp::String> ImportAccounts(
+      const std::vector<libcomp::String>& data, uint8_t worldID = 0);
+
   /**
    * Check if an import object may be imported.
    * @param objectType Type string for the object.
@@ -172,6 +191,56 @@ class LobbyServer : public libhack::Server {
       const std::shared_ptr<libcomp::Database>& worldDB);
 
  protected:
+  /**
+   * Objects loaded from one imported account that are waiting to be
+   * written to the databases.
+   */
+  struct ImportedAccount {
+    /// Error for the account or empty if it may still be imported
+    libcomp::String Error;
+
+    /// Objects to write to the lobby database by UUID
+    std::list<
+        std::pair<libobjgen::UUID, std::shared_ptr<libcomp::PersistentObject>>>
+        LobbyObjects;
+
+    /// Objects to write to the world database by UUID
+    std::list<
+        std::pair<libobjgen::UUID, std::shared_ptr<libcomp::PersistentObject>>>
+        WorldObjects;
+
+    /// UUIDs of the imported objects by object type name
+    std::unordered_map<std::string, std::list<libobjgen::UUID>> TypeUUIDs;
+  };
+
+  /**
+   * Parse and check the objects of one imported account. The UUIDs of the
+   * objects are not checked against the database here.
+   * @param data XML data for the account.
+   * @param lobbyDB Database for the lobby.
+   * @param worldDB Database for the world.
+   * @param account Output for the loaded objects.
+   * @returns Error string or an empty string if the account is good.
+   */
+  libcomp::String LoadImportAccount(
+      const libcomp::String& data,
+      const std::shared_ptr<libcomp::Database>& lobbyDB,
+      const std::shared_ptr<libcomp::Database>& worldDB,
+      ImportedAccount& account);
+
+  /**
+   * Find which of the supplied UUIDs already exist in the table for an
+   * object type using as few queries as possible.
+   * @param objectType Type name of the objects.
+   * @param db Database the objects are stored in.
+   * @param uuids UUIDs to look for.
+   * @returns Set of the UUIDs (as strings) that already exist.
+   */
+  std::set<std::string> FindExistingImportUUIDs(
+      const std::string& objectType,
+      const std::shared_ptr<libcomp::Database>& db,
+      const std::list<libobjgen::UUID>& uuids);
+
   /**
    * Create the first account when none currently exist
    * in the connected database via PromptCreateAccount.
@@ -34,6 +34,9 @@
 #include <LoginScriptReply.h>
 #include <LoginScriptRequest.h>
 
+// Standard C++11 Includes
+#include <chrono>
+
 namespace libcomp {
 
 template <>
@@ -129,23 +132,30 @@ BaseScriptEngine& BaseScriptEngine::Using<objects::LoginScriptReply>() {
 
 using namespace lobby;
 
-LoginHandlerThread::LoginHandlerThread() : mDidInit(false) {
-  mEngine.Using<objects::LoginScriptRequest>();
-  mEngine.Using<objects::LoginScriptReply>();
-}
+LoginHandlerThread::LoginHandlerThread(
+    const std::shared_ptr<libhack::ScriptEnginePool>& pool)
+    : mPool(pool) {}
 
-LoginHandlerThread::~LoginHandlerThread() {}
+LoginHandlerThread::~LoginHandlerThread() {
+  // Hand the VM back for the next request
+  if (mPool && mEngine) {
+    mPool->Release(mEngine);
+  }
+}
 
-bool LoginHandlerThread::DidInit() const { return mDidInit; }
+void LoginHandlerThread::BindTypes(libhack::ScriptEngine& engine) {
+  engine.Using<objects::LoginScriptRequest>();
+  engine.Using<objects::LoginScriptReply>();
+}
 
-bool LoginHandlerThread::Init(const libcomp::String& script) {
-  if (!mDidInit) {
-    mDidInit = true;
+bool LoginHandlerThread::DidInit() const { return mEngine != nullptr; }
 
-    return mEngine.Eval(script);
+bool LoginHandlerThread::Init() {
+  if (!mEngine && mPool) {
+    mEngine = mPool->Acquire();
   }
 
-  return true;
+  return mEngine != nullptr;
 }
 
 bool LoginHandlerThread::ProcessLoginRequest(
@@ -153,10 +163,17 @@ bool LoginHandlerThread::ProcessLoginRequest(
   req->SetOperation(
       to_underlying(objects::LoginScriptRequest::OperationType_t::ERROR));
 
-  auto ref = Sqrat::RootTable(mEngine.GetVM())
+  auto start = std::chrono::steady_clock::now();
+
+  auto ref = Sqrat::RootTable(mEngine->GetVM())
                  .GetFunction("ProcessLoginRequest")
                  .Evaluate<bool>(req);
 
+  mPool->RecordExecution(
+      (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+
   if (!ref || !(*ref)) {
     LogGeneralErrorMsg("Failed to process login request.\n");
 
@@ -168,10 +185,17 @@ bool LoginHandlerThread::ProcessLoginRequest(
 
 bool LoginHandlerThread::ProcessLoginReply(
     const std::shared_ptr<objects::LoginScriptReply>& reply) {
-  auto ref = Sqrat::RootTable(mEngine.GetVM())
+  auto start = std::chrono::steady_clock::now();
+
+  auto ref = Sqrat::RootTable(mEngine->GetVM())
                  .GetFunction("ProcessLoginReply")
                  .Evaluate<bool>(reply);
 
+  mPool->RecordExecution(
+      (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+
   if (!ref || !(*ref)) {
     LogGeneralErrorMsg("Failed to process login reply.\n");
 
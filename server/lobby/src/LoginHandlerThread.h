@@ -27,9 +27,11 @@
 #ifndef SERVER_LOBBY_SRC_LOGINHANDLERTHREAD_H
 #define SERVER_LOBBY_SRC_LOGINHANDLERTHREAD_H
 
+// libhack Includes
+#include <ScriptEnginePool.h>
+
 // libcomp Includes
 #include <CString.h>
-#include <ScriptEngine.h>
 
 // Standard C++11 Includes
 #include <memory>
@@ -45,11 +47,13 @@ namespace lobby {
 
 class LoginHandlerThread {
  public:
-  LoginHandlerThread();
+  LoginHandlerThread(const std::shared_ptr<libhack::ScriptEnginePool>& pool);
   ~LoginHandlerThread();
 
+  static void BindTypes(libhack::ScriptEngine& engine);
+
   bool DidInit() const;
-  bool Init(const libcomp::String& script);
+  bool Init();
 
   bool ProcessLoginRequest(
       const std::shared_ptr<objects::LoginScriptRequest>& req);
@@ -57,9 +61,8 @@ class LoginHandlerThread {
       const std::shared_ptr<objects::LoginScriptReply>& reply);
 
  private:
-  bool mDidInit;
-
-  libhack::ScriptEngine mEngine;
+  std::shared_ptr<libhack::ScriptEnginePool> mPool;
+  std::shared_ptr<libhack::ScriptEngine> mEngine;
 };
 
 }  // namespace lobby
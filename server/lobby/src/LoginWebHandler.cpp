@@ -43,8 +43,6 @@
 
 using namespace lobby;
 
-thread_local LoginHandlerThread LoginHandler::mThreadHandler;
-
 LoginHandler::LoginHandler(const std::shared_ptr<libcomp::Database> &database)
     : mDatabase(database), mAccountManager(nullptr) {
   mVfs.AddArchiveLoader(new ttvfs::VFSZipArchiveLoader);
@@ -68,6 +66,30 @@ void LoginHandler::SetConfig(
         new ttvfs::DiskDir(mConfig->GetWebRoot().C(), new ttvfs::DiskLoader),
         "");
   }
+
+  // Compile the handler script once (after the web root has been added in
+  // case it overrides the built-in one) and warm up VMs for it
+  std::vector<char> pageData = LoadVfsFile("handler.nut");
+  if (!pageData.empty()) {
+    pageData.push_back(0);
+
+    mScriptPool = std::make_shared<libhack::ScriptEnginePool>(
+        "handler.nut", &LoginHandlerThread::BindTypes, false,
+        (size_t)mConfig->GetWebThreads());
+    if (!mScriptPool->Initialize(libcomp::String(&pageData[0]),
+                                 (size_t)mConfig->GetScriptPoolWarmCount())) {
+      mScriptPool = nullptr;
+    }
+  }
+
+  if (!mScriptPool) {
+    LogWebAPIErrorMsg("Failed to load web script handler.nut\n");
+  }
+}
+
+std::shared_ptr<libhack::ScriptEnginePool> LoginHandler::GetScriptPool()
+    const {
+  return mScriptPool;
 }
 
 bool LoginHandler::handleGet(CivetServer *pServer,
@@ -161,18 +183,12 @@ bool LoginHandler::HandlePage(
     uri = uri.Mid(1);
   }
 
-  /// Load the Squirrel handler script once per thread.
-  if (!mThreadHandler.DidInit()) {
-    // Attempt to load the script file.
-    std::vector<char> pageData = LoadVfsFile("handler.nut");
-
-    // This should always load but check anyway.
-    if (pageData.empty() ||
-        !mThreadHandler.Init(libcomp::String(&pageData[0]))) {
-      LogWebAPIErrorMsg("Failed to load web script handler.nut\n");
+  /// Borrow a ready Squirrel handler VM for the rest of the request.
+  LoginHandlerThread handler(mScriptPool);
+  if (".nut" == uri.Right(strlen(".nut")) && !handler.Init()) {
+    LogWebAPIErrorMsg("Failed to load web script handler.nut\n");
 
-      return false;
-    }
+    return false;
   }
 
   // This session ID is never used. If you notice it being used file a bug.
@@ -195,7 +211,7 @@ bool LoginHandler::HandlePage(
   }
 
   if (".nut" == uri.Right(strlen(".nut"))) {
-    if (!mThreadHandler.ProcessLoginRequest(req)) {
+    if (!handler.ProcessLoginRequest(req)) {
       return false;
     }
 
@@ -310,7 +326,7 @@ bool LoginHandler::HandlePage(
       reply->SetSID1(sid1);
       reply->SetSID2(sid2);
 
-      if (!mThreadHandler.ProcessLoginReply(reply)) {
+      if (!handler.ProcessLoginReply(reply)) {
         return false;
       }
 
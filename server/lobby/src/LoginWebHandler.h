@@ -72,6 +72,8 @@ class LoginHandler : public CivetHandler {
 
   void SetAccountManager(AccountManager *pManager);
 
+  std::shared_ptr<libhack::ScriptEnginePool> GetScriptPool() const;
+
  private:
   std::shared_ptr<objects::LoginScriptRequest> ParsePost(
       CivetServer *pServer, struct mg_connection *pConnection);
@@ -88,7 +90,7 @@ class LoginHandler : public CivetHandler {
 
   AccountManager *mAccountManager;
 
-  static thread_local LoginHandlerThread mThreadHandler;
+  std::shared_ptr<libhack::ScriptEnginePool> mScriptPool;
 };
 
 }  // namespace lobby
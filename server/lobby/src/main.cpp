@@ -132,6 +132,11 @@ int main(int argc, const char *argv[])
                          ->GetWebListeningPort()) +
       (useSSL ? "s" : ""));
 
+  options.push_back("num_threads");
+  options.push_back(
+      std::to_string(std::dynamic_pointer_cast<objects::LobbyConfig>(config)
+                         ->GetWebThreads()));
+
   if (useSSL) {
     options.push_back("ssl_certificate");
     options.push_back(std::dynamic_pointer_cast<objects::LobbyConfig>(config)
@@ -146,6 +151,7 @@ int main(int argc, const char *argv[])
 
   auto pApiHandler = new lobby::ApiHandler(config, server);
   pApiHandler->SetAccountManager(server->GetAccountManager());
+  pApiHandler->SetLoginScriptPool(pLoginHandler->GetScriptPool());
 
   auto pImportHandler = new lobby::ImportHandler(config, server);
 
@@ -65,7 +65,7 @@
 using namespace world;
 
 WorldSyncManager::WorldSyncManager(const std::weak_ptr<WorldServer>& server)
-    : libcomp::DataSyncManager(
+    : libhack::CoalescingSyncManager(
           to_underlying(InternalPacketCode_t::PACKET_DATA_SYNC)),
       mNextMatchID(0),
       mServer(server) {
@@ -260,6 +260,36 @@ bool WorldSyncManager::Initialize() {
     SyncOutgoing();
   }
 
+  // Coalesce outgoing records if a flush window is configured
+  auto conf = std::dynamic_pointer_cast<objects::WorldConfig>(
+      server->GetConfig());
+  if (conf->GetDataSyncFlushWindow()) {
+    SetFlushWindow(conf->GetDataSyncFlushWindow());
+
+    server->GetTimerManager()->SchedulePeriodicEvent(
+        std::chrono::milliseconds(GetFlushWindow()),
+        [](WorldSyncManager* pSyncManager) { pSyncManager->FlushOutgoing(); },
+        this);
+
+    // Report how much coalescing saved about once a minute
+    server->GetTimerManager()->SchedulePeriodicEvent(
+        std::chrono::seconds(60),
+        [](WorldSyncManager* pSyncManager) {
+          uint64_t coalesced = 0, bytesSaved = 0;
+          pSyncManager->TakeStats(coalesced, bytesSaved);
+          if (coalesced) {
+            LogDataSyncManagerDebug([coalesced, bytesSaved]() {
+              return libcomp::String(
+                         "Coalesced %1 outgoing record update(s) saving about "
+                         "%2 byte(s) in the last minute.\n")
+                  .Arg(coalesced)
+                  .Arg(bytesSaved);
+            });
+          }
+        },
+        this);
+  }
+
   return true;
 }
 
@@ -1051,7 +1081,7 @@ int8_t WorldSyncManager::Update<objects::SearchEntry>(
 bool WorldSyncManager::RemoveRecord(
     const std::shared_ptr<libcomp::Object>& record,
     const libcomp::String& type) {
-  if (DataSyncManager::RemoveRecord(record, type)) {
+  if (CoalescingSyncManager::RemoveRecord(record, type)) {
     bool recalcTeamPvP = false;
     std::list<std::shared_ptr<libcomp::Object>> additionalRemoves;
     if (type == "MatchEntry") {
@@ -1082,7 +1112,7 @@ bool WorldSyncManager::RemoveRecord(
     }
 
     for (auto entry : additionalRemoves) {
-      DataSyncManager::RemoveRecord(entry, type);
+      CoalescingSyncManager::RemoveRecord(entry, type);
     }
 
     if (recalcTeamPvP) {
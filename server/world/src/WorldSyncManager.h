@@ -28,8 +28,10 @@
 #ifndef SERVER_WORLD_SRC_WORLDSYNCMANAGER_H
 #define SERVER_WORLD_SRC_WORLDSYNCMANAGER_H
 
+// libhack Includes
+#include <CoalescingSyncManager.h>
+
 // libcomp Includes
-#include <DataSyncManager.h>
 #include <EnumMap.h>
 
 // object Includes
@@ -53,7 +55,7 @@ class WorldServer;
  * World specific implementation of the DataSyncManager in charge of
  * performing server side update operations.
  */
-class WorldSyncManager : public libcomp::DataSyncManager {
+class WorldSyncManager : public libhack::CoalescingSyncManager {
  public:
   /**
    * Create a new WorldSyncManager
@@ -29,6 +29,9 @@
 
 // Standard C++11 Includes
 #include <map>
+#include <memory>
+#include <set>
+#include <string>
 
 // libcomp Includes
 #include <BinaryDataSet.h>
@@ -190,6 +193,17 @@
 #include DREAM_OBJGEN_INCLUDE_A
 #endif  // DREAM_OBJGEN_INCLUDE_A
 
+/**
+ * Get the BinaryData types that have no record ID. Records of these types
+ * are numbered in the order they are loaded instead.
+ * @returns Keys of the sequential types
+ */
+inline std::set<std::string>& SequentialBinaryDataTypes() {
+  static std::set<std::string> sequentialTypes;
+
+  return sequentialTypes;
+}
+
 class ManualBinaryDataSet : public libhack::BinaryDataSet {
  public:
   ManualBinaryDataSet(
@@ -225,32 +239,34 @@ class ManualBinaryDataSet : public libhack::BinaryDataSet {
         });                                                             \
   });
 
-#define ADD_TYPE_SEQ(desc, key, objname)                       \
-  binaryTypes[key] = std::make_pair(desc, []() {               \
-    static uint32_t nextID = 0;                                \
-                                                               \
-    return new libhack::BinaryDataSet(                         \
-        []() { return std::make_shared<objects::objname>(); }, \
-                                                               \
-        [](const std::shared_ptr<libcomp::Object>& obj) {      \
-          (void)obj;                                           \
-                                                               \
-          return nextID++;                                     \
-        });                                                    \
+#define ADD_TYPE_SEQ(desc, key, objname)                        \
+  SequentialBinaryDataTypes().insert(key);                      \
+  binaryTypes[key] = std::make_pair(desc, []() {                \
+    auto nextID = std::make_shared<uint32_t>(0);                \
+                                                                \
+    return new libhack::BinaryDataSet(                          \
+        []() { return std::make_shared<objects::objname>(); },  \
+                                                                \
+        [nextID](const std::shared_ptr<libcomp::Object>& obj) { \
+          (void)obj;                                            \
+                                                                \
+          return (*nextID)++;                                   \
+        });                                                     \
   });
 
-#define ADD_TYPE_MAN(desc, key, objname)                       \
-  binaryTypes[key] = std::make_pair(desc, []() {               \
-    static uint32_t nextID = 0;                                \
-                                                               \
-    return new ManualBinaryDataSet(                            \
-        []() { return std::make_shared<objects::objname>(); }, \
-                                                               \
-        [](const std::shared_ptr<libcomp::Object>& obj) {      \
-          (void)obj;                                           \
-                                                               \
-          return nextID++;                                     \
-        });                                                    \
+#define ADD_TYPE_MAN(desc, key, objname)                        \
+  SequentialBinaryDataTypes().insert(key);                      \
+  binaryTypes[key] = std::make_pair(desc, []() {                \
+    auto nextID = std::make_shared<uint32_t>(0);                \
+                                                                \
+    return new ManualBinaryDataSet(                             \
+        []() { return std::make_shared<objects::objname>(); },  \
+                                                                \
+        [nextID](const std::shared_ptr<libcomp::Object>& obj) { \
+          (void)obj;                                            \
+                                                                \
+          return (*nextID)++;                                   \
+        });                                                     \
   });
 
 static std::map<
@@ -28,9 +28,15 @@
 #include "BinaryData.h"
 
 // Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // libcomp Includes
 #include <ArgumentParser.h>
@@ -47,6 +53,24 @@
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+/// Map of BinaryData type key to its description and set factory
+typedef std::map<
+    std::string,
+    std::pair<std::string, std::function<libhack::BinaryDataSet*(void)>>>
+    BinaryTypeMap;
+
+/**
+ * Command read from a batch list.
+ */
+class BatchCommand {
+ public:
+  /// Line of the batch list the command is on (starting at 1)
+  size_t line;
+
+  /// Mode followed by the arguments for the mode
+  std::vector<libcomp::String> args;
+};
+
 /**
  * Class to handle parsing command line arguments for a server.
  */
@@ -54,9 +78,21 @@ class CommandLineParser : public libcomp::ArgumentParser {
  public:
   CommandLineParser();
   virtual ~CommandLineParser();
+
+  /**
+   * Get the number of files to convert at the same time in batch mode.
+   * @returns Number of conversion jobs
+   */
+  int GetJobs() const;
+
+ private:
+  /// Number of files to convert at the same time in batch mode
+  int mJobs;
 };
 
-CommandLineParser::CommandLineParser() : libcomp::ArgumentParser() {
+CommandLineParser::CommandLineParser()
+    : libcomp::ArgumentParser(),
+      mJobs((int)std::max(1u, std::thread::hardware_concurrency())) {
   RegisterArgument(
       'e', "encoding", ArgumentType::REQUIRED,
       std::bind(
@@ -87,22 +123,47 @@ CommandLineParser::CommandLineParser() : libcomp::ArgumentParser() {
             return ok;
           },
           this, std::placeholders::_1, std::placeholders::_2));
+  RegisterArgument(
+      'j', "jobs", ArgumentType::REQUIRED,
+      std::bind(
+          [](CommandLineParser* pParser, ArgumentParser::Argument* pArg,
+             const libcomp::String& arg) -> bool {
+            (void)pArg;
+
+            bool ok = false;
+            int jobs = arg.ToInteger<int>(&ok);
+
+            if (!ok || 1 > jobs) {
+              std::cerr << "Invalid number of jobs: " << arg << std::endl
+                        << std::endl;
+
+              return false;
+            }
+
+            pParser->mJobs = jobs;
+
+            return true;
+          },
+          this, std::placeholders::_1, std::placeholders::_2));
 }
 
 CommandLineParser::~CommandLineParser() {}
 
-int Usage(
-    const char* szAppName,
-    const std::map<
-        std::string,
-        std::pair<std::string, std::function<libhack::BinaryDataSet*(void)>>>&
-        binaryTypes) {
+int CommandLineParser::GetJobs() const { return mJobs; }
+
+int Usage(const char* szAppName, const BinaryTypeMap& binaryTypes) {
   std::cerr << "USAGE: " << szAppName << " [OPTION]... load TYPE IN OUT"
             << std::endl;
   std::cerr << "USAGE: " << szAppName << " [OPTION]... save TYPE IN OUT"
             << std::endl;
   std::cerr << "USAGE: " << szAppName << " [OPTION]... flatten TYPE IN OUT"
             << std::endl;
+  std::cerr << "USAGE: " << szAppName << " [OPTION]... diff TYPE OLD NEW OUT"
+            << std::endl;
+  std::cerr << "USAGE: " << szAppName
+            << " [OPTION]... patch TYPE IN PATCH OUT" << std::endl;
+  std::cerr << "USAGE: " << szAppName << " [OPTION]... batch LIST"
+            << std::endl;
   std::cerr << std::endl;
   std::cerr << "TYPE indicates the format of the BinaryData and can "
             << "be one of:" << std::endl;
@@ -120,6 +181,26 @@ int Usage(
   std::cerr << std::endl;
   std::cerr << "Mode 'flatten' will take the input BinaryData file and "
             << "write the output text file." << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Mode 'diff' will compare the old and new BinaryData files "
+            << "and write an XML file" << std::endl
+            << "with only the records that were added or changed and a "
+            << "remove element with the" << std::endl
+            << "ID of each record that was removed. The TYPE must have a "
+            << "record ID." << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Mode 'patch' will replace the records in the input "
+            << "BinaryData file with the records" << std::endl
+            << "from the XML patch that have the same ID (adding the rest), "
+            << "remove the records" << std::endl
+            << "listed in the patch and write the output BinaryData file."
+            << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Mode 'batch' will run the command on each line of the LIST "
+            << "file (without the" << std::endl
+            << "options) with several files converted at the same time. "
+            << "Empty lines and lines" << std::endl
+            << "starting with # are skipped." << std::endl;
 
   std::cerr << std::endl;
   std::cerr << "Mandatory arguments to long options are mandatory for short "
@@ -128,6 +209,12 @@ int Usage(
   std::cerr << "  -e, --encoding=ENC          set encoding used for conversion "
                "(default=cp932)"
             << std::endl;
+  std::cerr << "  -j, --jobs=N                number of files to convert at "
+               "the same time in"
+            << std::endl
+            << "                              batch mode (default=number of "
+               "cores)"
+            << std::endl;
   std::cerr << std::endl;
   std::cerr << "Valid encodings:" << std::endl;
 
@@ -138,145 +225,358 @@ int Usage(
   return EXIT_FAILURE;
 }
 
-int main(int argc, char* argv[]) {
-  CommandLineParser args;
-
-  auto binaryTypes = EnumerateBinaryDataTypes();
-
-  if (!args.Parse(argc, argv) || (4 != args.GetStandardArguments().size())) {
-    return Usage(argv[0], binaryTypes);
-  }
-
-  libhack::Log::GetSingletonPtr()->AddStandardOutputHook();
-
-  auto standardArgs = args.GetStandardArguments();
-  libcomp::String mode = standardArgs[0];
-  libcomp::String bdType = standardArgs[1];
-  libcomp::String inPath = standardArgs[2];
-  libcomp::String outPath = standardArgs[3];
-
-  if ("load" != mode && "save" != mode && "flatten" != mode) {
-    return Usage(argv[0], binaryTypes);
-  }
-
-  libhack::BinaryDataSet* pSet = nullptr;
-
-  auto match = binaryTypes.find(bdType.ToUtf8());
-
-  if (binaryTypes.end() != match) {
-    pSet = (match->second.second)();
+/**
+ * Get the number of arguments a mode takes (including the mode).
+ * @param mode Mode to check
+ * @returns Number of arguments or 0 if the mode is not valid
+ */
+static size_t ModeArgumentCount(const libcomp::String& mode) {
+  if ("load" == mode || "save" == mode || "flatten" == mode) {
+    return 4;
+  } else if ("diff" == mode || "patch" == mode) {
+    return 5;
+  } else if ("batch" == mode) {
+    return 2;
   }
 
-  if (!pSet) {
-    return Usage(argv[0], binaryTypes);
-  }
+  return 0;
+}
 
-  if ("qmp" == bdType && ("load" == mode || "flatten" == mode)) {
+/**
+ * Load a BinaryData file.
+ * @param pSet Set to load the records into
+ * @param bdType Type of the BinaryData
+ * @param inPath Path to the BinaryData file
+ * @param message Set to the reason the file did not load
+ * @returns true if the file was loaded
+ */
+static bool LoadBinary(libhack::BinaryDataSet* pSet,
+                       const libcomp::String& bdType,
+                       const libcomp::String& inPath,
+                       libcomp::String& message) {
+  std::ifstream file;
+  file.open(inPath.C(), std::ifstream::binary);
+
+  if ("qmp" == bdType) {
     // Manually load single record
-    std::ifstream file;
-    file.open(inPath.C(), std::ifstream::binary);
-
     // Read and discard magic
     uint32_t magic;
     file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
 
     if (magic != QMP_FORMAT_MAGIC) {
-      std::cerr << "File magic invlalid for Qmp file: " << inPath << std::endl;
+      message = libcomp::String("File magic invlalid for Qmp file: %1")
+                    .Arg(inPath);
 
-      return EXIT_FAILURE;
+      return false;
     }
 
     auto qmp = std::make_shared<objects::QmpFile>();
     if (!qmp->Load(file)) {
-      std::cerr << "Failed to load Qmp file: " << inPath << std::endl;
+      message = libcomp::String("Failed to load Qmp file: %1").Arg(inPath);
 
-      return EXIT_FAILURE;
+      return false;
     }
 
     ((ManualBinaryDataSet*)pSet)->AddRecord(qmp);
-  }
+  } else if (!pSet->Load(file)) {
+    message = libcomp::String("Failed to load file: %1").Arg(inPath);
 
-  if ("load" == mode) {
-    if ("qmp" != bdType) {
-      std::ifstream file;
-      file.open(inPath.C(), std::ifstream::binary);
+    return false;
+  }
 
-      if (!pSet->Load(file)) {
-        std::cerr << "Failed to load file: " << inPath << std::endl;
+  return true;
+}
 
-        return EXIT_FAILURE;
+/**
+ * Save a BinaryData file.
+ * @param pSet Set with the records to save
+ * @param bdType Type of the BinaryData
+ * @param outPath Path to the BinaryData file
+ * @param message Set to the reason the file did not save
+ * @returns true if the file was saved
+ */
+static bool SaveBinary(libhack::BinaryDataSet* pSet,
+                       const libcomp::String& bdType,
+                       const libcomp::String& outPath,
+                       libcomp::String& message) {
+  std::ofstream out;
+  out.open(outPath.C(), std::ofstream::binary);
+
+  if ("qmp" == bdType) {
+    // Write magic
+    uint32_t magic = QMP_FORMAT_MAGIC;
+    out.write(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+
+    // Write (single) entry manually
+    for (auto obj : pSet->GetObjects()) {
+      if (!obj->Save(out) || !out.good()) {
+        message =
+            libcomp::String("Failed to save QMP file: %1").Arg(outPath);
+
+        return false;
       }
     }
+  } else if (!pSet->Save(out)) {
+    message = libcomp::String("Failed to save file: %1").Arg(outPath);
 
-    std::ofstream out;
-    out.open(outPath.C());
+    return false;
+  }
 
-    out << pSet->GetXml().c_str();
+  return true;
+}
 
-    if (!out.good()) {
-      std::cerr << "Failed to save file: " << outPath << std::endl;
+/**
+ * Run a single load, save, flatten, diff or patch command.
+ * @param args Mode followed by the arguments for the mode
+ * @param binaryTypes Available BinaryData types
+ * @param message Set to the reason the command failed or a summary of
+ *  what the command did
+ * @returns true if the command was successful
+ */
+static bool RunCommand(const std::vector<libcomp::String>& args,
+                       const BinaryTypeMap& binaryTypes,
+                       libcomp::String& message) {
+  libcomp::String mode = args.empty() ? libcomp::String() : args[0];
 
-      return EXIT_FAILURE;
-    }
-  } else if ("flatten" == mode) {
-    if ("qmp" != bdType) {
-      std::ifstream file;
-      file.open(inPath.C(), std::ifstream::binary);
+  if ("batch" == mode || 0 == ModeArgumentCount(mode) ||
+      args.size() != ModeArgumentCount(mode)) {
+    message = "Invalid command";
 
-      if (!pSet->Load(file)) {
-        std::cerr << "Failed to load file: " << inPath << std::endl;
+    return false;
+  }
 
-        return EXIT_FAILURE;
-      }
+  libcomp::String bdType = args[1];
+
+  auto match = binaryTypes.find(bdType.ToUtf8());
+
+  if (binaryTypes.end() == match) {
+    message = libcomp::String("Unknown BinaryData type: %1").Arg(bdType);
+
+    return false;
+  }
+
+  std::unique_ptr<libhack::BinaryDataSet> pSet((match->second.second)());
+
+  if ("load" == mode || "flatten" == mode) {
+    if (!LoadBinary(pSet.get(), bdType, args[2], message)) {
+      return false;
     }
 
     std::ofstream out;
-    out.open(outPath.C());
+    out.open(args[3].C());
 
-    out << pSet->GetTabular().c_str();
+    bool saved = true;
 
-    if (!out.good()) {
-      std::cerr << "Failed to save file: " << outPath << std::endl;
+    if ("load" == mode) {
+      // Write each record as it is converted.
+      saved = pSet->SaveXml(out);
+    } else {
+      out << pSet->GetTabular().c_str();
+    }
 
-      return EXIT_FAILURE;
+    if (!saved || !out.good()) {
+      message = libcomp::String("Failed to save file: %1").Arg(args[3]);
+
+      return false;
     }
   } else if ("save" == mode) {
-    tinyxml2::XMLDocument doc;
+    std::ifstream file;
+    file.open(args[2].C());
 
-    if (tinyxml2::XML_SUCCESS != doc.LoadFile(inPath.C())) {
-      std::cerr << "Failed to parse file: " << inPath << std::endl;
+    // Parse one record at a time instead of the whole document.
+    if (!pSet->LoadXml(file)) {
+      message = libcomp::String("Failed to load file: %1").Arg(args[2]);
 
-      return EXIT_FAILURE;
+      return false;
     }
 
-    if (!pSet->LoadXml(doc)) {
-      std::cerr << "Failed to load file: " << inPath << std::endl;
+    return SaveBinary(pSet.get(), bdType, args[3], message);
+  } else if ("diff" == mode) {
+    if (SequentialBinaryDataTypes().count(bdType.ToUtf8())) {
+      message = libcomp::String("BinaryData type has no record ID: %1")
+                    .Arg(bdType);
 
-      return EXIT_FAILURE;
+      return false;
     }
 
+    std::unique_ptr<libhack::BinaryDataSet> pNewSet(
+        (match->second.second)());
+
+    if (!LoadBinary(pSet.get(), bdType, args[2], message) ||
+        !LoadBinary(pNewSet.get(), bdType, args[3], message)) {
+      return false;
+    }
+
+    auto changed = pNewSet->GetChangedObjects(*pSet);
+    auto removed = pNewSet->GetRemovedIDs(*pSet);
+
     std::ofstream out;
-    out.open(outPath.C(), std::ofstream::binary);
+    out.open(args[4].C());
 
-    if ("qmp" == bdType) {
-      // Write magic
-      uint32_t magic = QMP_FORMAT_MAGIC;
-      out.write(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+    if (!libhack::BinaryDataSet::SaveXml(out, changed, removed)) {
+      message = libcomp::String("Failed to save file: %1").Arg(args[4]);
 
-      // Write (single) entry manually
-      for (auto obj : pSet->GetObjects()) {
-        if (!obj->Save(out) || !out.good()) {
-          std::cerr << "Failed to save QMP file: " << outPath << std::endl;
+      return false;
+    }
 
-          return EXIT_FAILURE;
-        }
-      }
-    } else {
-      if (!pSet->Save(out)) {
-        std::cerr << "Failed to save file: " << outPath << std::endl;
+    message = libcomp::String("%1: %2 record(s) added or changed, %3 removed")
+                  .Arg(args[4])
+                  .Arg(changed.size())
+                  .Arg(removed.size());
+  } else if ("patch" == mode) {
+    if (SequentialBinaryDataTypes().count(bdType.ToUtf8())) {
+      message = libcomp::String("BinaryData type has no record ID: %1")
+                    .Arg(bdType);
+
+      return false;
+    }
+
+    if (!LoadBinary(pSet.get(), bdType, args[2], message)) {
+      return false;
+    }
+
+    std::ifstream patch;
+    patch.open(args[3].C());
+
+    size_t replaced = 0, added = 0, removed = 0;
+
+    if (!pSet->ApplyXml(patch, replaced, added, removed)) {
+      message = libcomp::String("Failed to load file: %1").Arg(args[3]);
+
+      return false;
+    }
+
+    if (!SaveBinary(pSet.get(), bdType, args[4], message)) {
+      return false;
+    }
+
+    message =
+        libcomp::String("%1: %2 record(s) replaced, %3 added, %4 removed")
+            .Arg(args[4])
+            .Arg(replaced)
+            .Arg(added)
+            .Arg(removed);
+  }
+
+  return true;
+}
+
+/**
+ * Run every command in a batch list, several at the same time.
+ * @param listPath Path to the file with one command on each line
+ * @param jobs Number of commands to run at the same time
+ * @param binaryTypes Available BinaryData types
+ * @returns true if every command was successful
+ */
+static bool RunBatch(const libcomp::String& listPath, int jobs,
+                     const BinaryTypeMap& binaryTypes) {
+  std::ifstream list;
+  list.open(listPath.C());
+
+  if (!list.good()) {
+    std::cerr << "Failed to open batch list: " << listPath << std::endl;
+
+    return false;
+  }
+
+  std::vector<BatchCommand> commands;
+  std::string line;
+  size_t lineNumber = 0;
+
+  while (std::getline(list, line)) {
+    lineNumber++;
+
+    std::istringstream ss(line);
+    BatchCommand command;
+    std::string arg;
+
+    while (ss >> arg) {
+      command.args.push_back(arg);
+    }
 
-        return EXIT_FAILURE;
+    if (!command.args.empty() &&
+        '#' != line[line.find_first_not_of(" \t")]) {
+      command.line = lineNumber;
+      commands.push_back(command);
+    }
+  }
+
+  std::vector<char> results(commands.size(), 0);
+  std::vector<libcomp::String> messages(commands.size());
+  std::vector<std::thread> workers;
+  std::atomic<size_t> nextCommand(0);
+
+  for (size_t i = 0; i < std::min((size_t)jobs, commands.size()); i++) {
+    workers.push_back(std::thread([&]() {
+      size_t idx;
+
+      while ((idx = nextCommand++) < commands.size()) {
+        results[idx] =
+            RunCommand(commands[idx].args, binaryTypes, messages[idx]);
       }
+    }));
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  bool ok = true;
+
+  // Report in the order of the list so the output is stable.
+  for (size_t i = 0; i < commands.size(); i++) {
+    if (!results[i]) {
+      std::cerr << listPath << ":" << commands[i].line << ": " << messages[i]
+                << std::endl;
+
+      ok = false;
+    } else if (!messages[i].IsEmpty()) {
+      std::cout << messages[i] << std::endl;
+    }
+  }
+
+  return ok;
+}
+
+int main(int argc, char* argv[]) {
+  CommandLineParser args;
+
+  auto binaryTypes = EnumerateBinaryDataTypes();
+
+  if (!args.Parse(argc, argv) || args.GetStandardArguments().empty()) {
+    return Usage(argv[0], binaryTypes);
+  }
+
+  auto standardArgs = args.GetStandardArguments();
+  libcomp::String mode = standardArgs[0];
+
+  if (0 == ModeArgumentCount(mode) ||
+      standardArgs.size() != ModeArgumentCount(mode)) {
+    return Usage(argv[0], binaryTypes);
+  }
+
+  if ("batch" != mode &&
+      binaryTypes.end() == binaryTypes.find(standardArgs[1].ToUtf8())) {
+    return Usage(argv[0], binaryTypes);
+  }
+
+  libhack::Log::GetSingletonPtr()->AddStandardOutputHook();
+
+  bool ok;
+
+  if ("batch" == mode) {
+    ok = RunBatch(standardArgs[1], args.GetJobs(), binaryTypes);
+  } else {
+    libcomp::String message;
+
+    ok = RunCommand(std::vector<libcomp::String>(standardArgs.begin(),
+                                                 standardArgs.end()),
+                    binaryTypes, message);
+
+    if (!ok) {
+      std::cerr << message << std::endl;
+    } else if (!message.IsEmpty()) {
+      std::cout << message << std::endl;
     }
   }
 
@@ -285,5 +585,5 @@ int main(int argc, char* argv[]) {
   delete libhack::Log::GetSingletonPtr();
 #endif  // !EXOTIC_PLATFORM
 
-  return EXIT_SUCCESS;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,80 @@
+/**
+ * @file tools/capgrep/src/CaptureGapHistogram.cpp
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Streaming histogram of the gaps between commands.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureGapHistogram.h"
+
+void CaptureGapHistogram::add(uint64_t gap) {
+  mBuckets[bucket(gap)]++;
+  mCount++;
+}
+
+uint64_t CaptureGapHistogram::percentile(double percentile) const {
+  if (!mCount) {
+    return 0;
+  }
+
+  uint64_t rank = (uint64_t)((double)(mCount - 1) * percentile / 100.0);
+  uint64_t seen = 0;
+
+  for (auto it = mBuckets.begin(); it != mBuckets.end(); ++it) {
+    seen += it->second;
+
+    if (seen > rank) {
+      uint64_t lower = lowerBound(it->first);
+      uint64_t upper = lowerBound(it->first + 1);
+
+      return lower + (upper - lower - 1) / 2;
+    }
+  }
+
+  return lowerBound(mBuckets.rbegin()->first);
+}
+
+uint32_t CaptureGapHistogram::bucket(uint64_t gap) {
+  // Gaps below the sub-bucket count each get their own bucket.
+  if (CAPTURE_GAP_SUB_BUCKETS > gap) {
+    return (uint32_t)gap;
+  }
+
+  uint32_t exponent = 0;
+
+  while ((gap >> exponent) >= 2 * CAPTURE_GAP_SUB_BUCKETS) {
+    exponent++;
+  }
+
+  return (exponent + 1) * CAPTURE_GAP_SUB_BUCKETS +
+         (uint32_t)((gap >> exponent) - CAPTURE_GAP_SUB_BUCKETS);
+}
+
+uint64_t CaptureGapHistogram::lowerBound(uint32_t bucket) {
+  if (CAPTURE_GAP_SUB_BUCKETS > bucket) {
+    return bucket;
+  }
+
+  uint32_t exponent = bucket / CAPTURE_GAP_SUB_BUCKETS - 1;
+
+  return (uint64_t)(CAPTURE_GAP_SUB_BUCKETS +
+                    bucket % CAPTURE_GAP_SUB_BUCKETS)
+         << exponent;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file tools/capgrep/src/CaptureGapHistogram.h
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Streaming histogram of the gaps between commands.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_CAPGREP_SRC_CAPTUREGAPHISTOGRAM_H
+#define TOOLS_CAPGREP_SRC_CAPTUREGAPHISTOGRAM_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <map>
+
+/// Number of gap histogram buckets for each power of two
+#define CAPTURE_GAP_SUB_BUCKETS (16)
+
+/**
+ * Streaming log-linear histogram of the gaps between commands. Each power
+ * of two is split into @ref CAPTURE_GAP_SUB_BUCKETS buckets so a
+ * percentile is within 1/16 of the real value while the memory used is
+ * bounded by the number of buckets instead of the number of gaps.
+ */
+class CaptureGapHistogram {
+ public:
+  /**
+   * Add a gap to the histogram.
+   * @arg gap Gap in microseconds.
+   */
+  void add(uint64_t gap);
+
+  /**
+   * Get a percentile of the gaps added.
+   * @arg percentile Percentile to get from 0 to 100.
+   * @returns Middle of the bucket holding the percentile or 0 if there are
+   *   no gaps.
+   */
+  uint64_t percentile(double percentile) const;
+
+ protected:
+  /**
+   * Get the bucket a gap belongs in.
+   * @arg gap Gap in microseconds.
+   * @returns Index of the bucket.
+   */
+  static uint32_t bucket(uint64_t gap);
+
+  /**
+   * Get the smallest gap that belongs in a bucket.
+   * @arg bucket Index of the bucket.
+   * @returns Lower bound of the bucket.
+   */
+  static uint64_t lowerBound(uint32_t bucket);
+
+  /// Number of gaps added
+  uint64_t mCount = 0;
+
+  /// Number of gaps in each bucket that is not empty
+  std::map<uint32_t, uint64_t> mBuckets;
+};
+
+#endif  // TOOLS_CAPGREP_SRC_CAPTUREGAPHISTOGRAM_H
@@ -0,0 +1,375 @@
+/**
+ * @file tools/capgrep/src/CaptureIndex.cpp
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Memory mapped capture file with a sidecar packet index.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureIndex.h"
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <Compress.h>
+
+// Standard C Includes
+#include <string.h>
+
+static const uint32_t INDEX_MAGIC = 0x58444943;  // CIDX
+static const uint32_t INDEX_VER = 1;
+
+/// Smallest packet header in a capture (source, stamp and size)
+static const qint64 MIN_PACKET_HEADER_SIZE = 9;
+
+CaptureIndex::CaptureIndex()
+    : mMap(0), mSize(0), mModified(0), mIsLobby(false) {}
+
+CaptureIndex::~CaptureIndex() { close(); }
+
+bool CaptureIndex::open(const QString &path) {
+  close();
+
+  mFile.setFileName(path);
+
+  if (!mFile.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  mSize = mFile.size();
+  mModified = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+
+  // Mapping can fail for huge captures in a 32-bit build.
+  if (0 < mSize) {
+    mMap = mFile.map(0, mSize);
+  }
+
+  if (!mMap) {
+    close();
+
+    return false;
+  }
+
+  QString indexPath = path + ".idx";
+
+  if (!loadIndex(indexPath)) {
+    if (!buildIndex()) {
+      close();
+
+      return false;
+    }
+
+    // Not fatal, the capture may be in a read only directory.
+    (void)saveIndex(indexPath);
+  }
+
+  return true;
+}
+
+void CaptureIndex::close() {
+  if (mMap) {
+    mFile.unmap(mMap);
+    mMap = 0;
+  }
+
+  mFile.close();
+
+  mSize = 0;
+  mModified = 0;
+  mIsLobby = false;
+  mAddress.clear();
+  mRecords.clear();
+}
+
+bool CaptureIndex::isLobby() const { return mIsLobby; }
+
+QString CaptureIndex::address() const { return mAddress; }
+
+const QVector<CaptureIndexRecord> &CaptureIndex::records() const {
+  return mRecords;
+}
+
+QByteArray CaptureIndex::body(const CaptureIndexRecord &record) const {
+  if (!mMap || (record.offset + record.size) > (uint64_t)mSize) {
+    return QByteArray();
+  }
+
+  bool compressed = false;
+
+  return packetBody(mMap + record.offset, record.size, mIsLobby, compressed);
+}
+
+QByteArray CaptureIndex::packetBody(const uchar *data, uint32_t size,
+                                    bool isLobby, bool &compressed) {
+  capture::PacketBody location;
+
+  compressed = false;
+
+  if (!capture::FindBody(data, size, isLobby, location)) {
+    return QByteArray();
+  }
+
+  if (location.size == location.uncompressedSize) {
+    return QByteArray::fromRawData((const char *)data + location.offset,
+                                   (int)location.size);
+  }
+
+  compressed = true;
+
+  QByteArray decompressed((int)location.uncompressedSize, 0);
+
+  int32_t written = libcomp::Compress::Decompress(
+      data + location.offset, decompressed.data(), (int32_t)location.size,
+      (int32_t)location.uncompressedSize);
+
+  if (0 >= written) {
+    return QByteArray();
+  }
+
+  decompressed.resize(written);
+
+  return decompressed;
+}
+
+capture::ReadFunction CaptureIndex::reader(QIODevice &device) {
+  return [&device](void *pDest, uint32_t size) {
+    return (qint64)size == device.read((char *)pDest, (qint64)size);
+  };
+}
+
+capture::ReadFunction CaptureIndex::mappedReader(qint64 &pos) const {
+  return [this, &pos](void *pDest, uint32_t size) {
+    if (pos + (qint64)size > mSize) {
+      return false;
+    }
+
+    memcpy(pDest, mMap + pos, (size_t)size);
+    pos += size;
+
+    return true;
+  };
+}
+
+bool CaptureIndex::buildIndex() {
+  qint64 pos = 0;
+
+  capture::ReadFunction readMapped = mappedReader(pos);
+  capture::FileHeader header;
+
+  if (!capture::ReadFileHeader(readMapped, header)) {
+    return false;
+  }
+
+  mIsLobby = header.isLobby;
+  mAddress = QString::fromStdString(header.address);
+
+  mRecords.clear();
+
+  while (pos < mSize) {
+    capture::PacketHeader packet;
+
+    // Stop at a truncated packet like the sequential loader does.
+    if (!capture::ReadPacketHeader(readMapped, header, packet) ||
+        pos + (qint64)packet.size > mSize) {
+      break;
+    }
+
+    CaptureIndexRecord record;
+    record.offset = (uint64_t)pos;
+    record.size = packet.size;
+    record.source = packet.source;
+    record.stamp = packet.stamp;
+    record.micro = packet.micro;
+    record.compressed = false;
+
+    pos += packet.size;
+
+    QByteArray packetBody = CaptureIndex::packetBody(
+        mMap + record.offset, record.size, mIsLobby, record.compressed);
+
+    capture::ParseCommands(packetBody.constData(),
+                           (uint32_t)packetBody.size(), record.commands);
+
+    mRecords.append(record);
+  }
+
+  return true;
+}
+
+bool CaptureIndex::loadIndex(const QString &indexPath) {
+  QFile file(indexPath);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic = 0, ver = 0;
+  qint64 size = 0, modified = 0;
+
+  in >> magic >> ver >> size >> modified;
+
+  // The capture changed since the index was built.
+  if (INDEX_MAGIC != magic || INDEX_VER != ver || mSize != size ||
+      mModified != modified) {
+    return false;
+  }
+
+  quint32 recordCount = 0;
+
+  in >> mIsLobby >> mAddress >> recordCount;
+
+  mRecords.clear();
+
+  // Each packet takes at least a packet header in the capture.
+  mRecords.reserve((int)qMin<qint64>(recordCount,
+                                     mSize / MIN_PACKET_HEADER_SIZE));
+
+  for (quint32 i = 0; i < recordCount && in.status() == QDataStream::Ok;
+       i++) {
+    CaptureIndexRecord record;
+
+    quint64 offset, stamp, micro;
+    quint32 recordSize;
+    quint8 source;
+    quint16 commandCount;
+
+    in >> offset >> recordSize >> source >> record.compressed >> stamp >>
+        micro >> commandCount;
+
+    record.offset = offset;
+    record.size = recordSize;
+    record.source = source;
+    record.stamp = stamp;
+    record.micro = micro;
+    record.commands.resize(commandCount);
+
+    for (quint16 j = 0; j < commandCount; j++) {
+      quint16 code, cmdSize;
+      quint32 cmdOffset;
+
+      in >> code >> cmdOffset >> cmdSize;
+
+      record.commands[j].code = code;
+      record.commands[j].offset = cmdOffset;
+      record.commands[j].size = cmdSize;
+    }
+
+    mRecords.append(record);
+  }
+
+  if (in.status() != QDataStream::Ok || !validIndex()) {
+    mRecords.clear();
+    mAddress.clear();
+    mIsLobby = false;
+
+    return false;
+  }
+
+  return true;
+}
+
+bool CaptureIndex::validIndex() const {
+  qint64 pos = 0;
+
+  capture::ReadFunction readMapped = mappedReader(pos);
+  capture::FileHeader header;
+
+  if (!capture::ReadFileHeader(readMapped, header) ||
+      header.isLobby != mIsLobby) {
+    return false;
+  }
+
+  // Packets follow the capture header in order without overlapping.
+  uint64_t end = (uint64_t)pos;
+
+  for (const CaptureIndexRecord &record : mRecords) {
+    capture::PacketBody location;
+
+    if (record.offset < end || record.size > (uint64_t)mSize ||
+        record.offset > (uint64_t)mSize - record.size) {
+      return false;
+    }
+
+    end = record.offset + record.size;
+
+    // A packet without a body is indexed without any commands.
+    if (!capture::FindBody(mMap + record.offset, record.size, mIsLobby,
+                           location)) {
+      if (record.compressed || !record.commands.empty()) {
+        return false;
+      }
+
+      continue;
+    }
+
+    if (record.compressed != (location.size != location.uncompressedSize)) {
+      return false;
+    }
+
+    // Command offsets are relative to the (decompressed) body.
+    for (const CaptureIndexCommand &cmd : record.commands) {
+      if (6 > cmd.offset || location.uncompressedSize < cmd.offset ||
+          location.uncompressedSize - cmd.offset < cmd.size) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool CaptureIndex::saveIndex(const QString &indexPath) const {
+  QSaveFile file(indexPath);
+
+  if (!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_0);
+
+  out << (quint32)INDEX_MAGIC << (quint32)INDEX_VER << mSize << mModified
+      << mIsLobby << mAddress << (quint32)mRecords.size();
+
+  for (const CaptureIndexRecord &record : mRecords) {
+    out << (quint64)record.offset << (quint32)record.size
+        << (quint8)record.source << record.compressed
+        << (quint64)record.stamp << (quint64)record.micro
+        << (quint16)record.commands.size();
+
+    for (const CaptureIndexCommand &cmd : record.commands) {
+      out << (quint16)cmd.code << (quint32)cmd.offset << (quint16)cmd.size;
+    }
+  }
+
+  // Only replace the old index once the new one is complete.
+  return out.status() == QDataStream::Ok && file.commit();
+}
@@ -0,0 +1,211 @@
+/**
+ * @file tools/capgrep/src/CaptureIndex.h
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Memory mapped capture file with a sidecar packet index.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_CAPGREP_SRC_CAPTUREINDEX_H
+#define TOOLS_CAPGREP_SRC_CAPTUREINDEX_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// libcapture Includes
+#include <CaptureFormat.h>
+
+// Standard C++11 Includes
+#include <vector>
+
+/// Location of a single command inside the body of a captured packet
+typedef capture::Command CaptureIndexCommand;
+
+/**
+ * Location and details of a single captured packet.
+ */
+class CaptureIndexRecord {
+ public:
+  /// Offset of the packet data in the capture file
+  uint64_t offset;
+
+  /// Size of the packet data
+  uint32_t size;
+
+  /// 0 if the packet came from the client, 1 if it came from the server
+  uint8_t source;
+
+  /// Indicates the packet body is compressed
+  bool compressed;
+
+  /// Time the packet was captured in seconds
+  uint64_t stamp;
+
+  /// Time the packet was captured in microseconds
+  uint64_t micro;
+
+  /// Commands in the packet
+  std::vector<CaptureIndexCommand> commands;
+};
+
+/**
+ * Capture file that is memory mapped instead of read into memory. The
+ * offset, timestamps and commands of every packet are kept in a sidecar
+ * index file next to the capture (the capture path with ".idx" appended) so
+ * opening the capture again does not need to parse it. The index is rebuilt
+ * when the capture size or modification time no longer match. Uncompressed
+ * packet bodies are returned as views into the mapping so packet data is
+ * only paged in when it is displayed or searched.
+ */
+class CaptureIndex {
+ public:
+  CaptureIndex();
+  ~CaptureIndex();
+
+  /**
+   * Map a capture file and load (or build) its index.
+   * @arg path Path to the capture file.
+   * @returns true if the capture was mapped and indexed.
+   */
+  bool open(const QString &path);
+
+  /**
+   * Unmap the capture file. Any packet data returned by @ref body must no
+   * longer be used.
+   */
+  void close();
+
+  /**
+   * Determine if the capture is of a lobby connection.
+   * @returns true for a lobby capture, false for a channel capture.
+   */
+  bool isLobby() const;
+
+  /**
+   * Address of the client the capture was recorded for. This identifies
+   * the connection the packets belong to.
+   * @returns Client address from the capture header.
+   */
+  QString address() const;
+
+  /**
+   * Every packet in the capture in the order it was captured.
+   * @returns Indexed packets.
+   */
+  const QVector<CaptureIndexRecord> &records() const;
+
+  /**
+   * Get the body of a packet that command offsets are relative to. An
+   * uncompressed body is a view into the mapped file while a compressed
+   * body is decompressed into a new buffer.
+   * @arg record Packet to get the body of.
+   * @returns The packet body or an empty array on error.
+   */
+  QByteArray body(const CaptureIndexRecord &record) const;
+
+  /**
+   * Get the body of a packet after the packet and compression headers.
+   * @arg data Packet data including the packet header.
+   * @arg size Size of the packet data.
+   * @arg isLobby If the packet is from a lobby capture.
+   * @arg compressed Set to true if the body had to be decompressed.
+   * @returns The packet body or an empty array on error. An uncompressed
+   *   body refers to @p data instead of copying it.
+   */
+  static QByteArray packetBody(const uchar *data, uint32_t size, bool isLobby,
+                               bool &compressed);
+
+  /**
+   * Read a capture from a device with the shared capture reader.
+   * @arg device Device to read from.
+   * @returns Function that reads the next bytes of the device.
+   */
+  static capture::ReadFunction reader(QIODevice &device);
+
+ protected:
+  /**
+   * Read the mapped capture with the shared capture reader.
+   * @arg pos Offset to read from that is advanced past each read.
+   * @returns Function that reads the next bytes of the mapping.
+   */
+  capture::ReadFunction mappedReader(qint64 &pos) const;
+
+  /**
+   * Parse the mapped capture and build the index.
+   * @returns true if the capture was valid.
+   */
+  bool buildIndex();
+
+  /**
+   * Load the sidecar index if it matches the capture. The index is only
+   * used if @ref validIndex accepts it.
+   * @arg indexPath Path to the sidecar index.
+   * @returns true if the index was loaded.
+   */
+  bool loadIndex(const QString &indexPath);
+
+  /**
+   * Check the loaded index against the mapped capture. Every packet and
+   * command must lie inside the capture so a stale or corrupt index is
+   * rebuilt instead of reading past the mapping.
+   * @returns true if the index matches the capture.
+   */
+  bool validIndex() const;
+
+  /**
+   * Save the index to the sidecar file.
+   * @arg indexPath Path to the sidecar index.
+   * @returns true if the index was saved.
+   */
+  bool saveIndex(const QString &indexPath) const;
+
+  /// Mapped capture file
+  QFile mFile;
+
+  /// Start of the mapped capture file
+  uchar *mMap;
+
+  /// Size of the capture file
+  qint64 mSize;
+
+  /// Modification time of the capture file in msecs since the epoch
+  qint64 mModified;
+
+  /// Indicates this is a lobby capture
+  bool mIsLobby;
+
+  /// Client address from the capture header
+  QString mAddress;
+
+  /// Indexed packets
+  QVector<CaptureIndexRecord> mRecords;
+};
+
+#endif  // TOOLS_CAPGREP_SRC_CAPTUREINDEX_H
@@ -0,0 +1,288 @@
+/**
+ * @file tools/capgrep/src/CaptureStats.cpp
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Packet statistics for a capture file.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureStats.h"
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+#include "CaptureIndex.h"
+#include "PacketListModel.h"
+
+/// Upper bound (exclusive) of each histogram bucket but the last
+static const uint32_t BUCKET_LIMITS[CAPTURE_STATS_BUCKETS - 1] = {
+    16, 64, 256, 1024, 4096};
+
+/**
+ * Get the name of a command code from the packet list.
+ * @arg code Command code.
+ * @returns Name of the command or an empty string if it is unknown.
+ */
+static QString commandName(uint16_t code) {
+  const PacketInfo *info = PacketListModel::getPacketInfo(code);
+
+  return info ? info->name : QString();
+}
+
+/**
+ * Format a command code as hex.
+ * @arg code Command code.
+ * @returns Command code as "0x" followed by 4 hex digits.
+ */
+static QString codeName(uint16_t code) {
+  return QString("0x%1").arg(
+      QString("%1").arg(code, 4, 16, QLatin1Char('0')).toUpper());
+}
+
+/**
+ * Quote a field for a CSV file.
+ * @arg field Field to quote.
+ * @returns Quoted field.
+ */
+static QString csvField(QString field) {
+  return QString("\"%1\"").arg(field.replace("\"", "\"\""));
+}
+
+CaptureCommandStats::CaptureCommandStats()
+    : source(0), code(0), count(0), bytes(0), lastMicro(0) {
+  for (int i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+    histogram[i] = 0;
+  }
+}
+
+CaptureStats::CaptureStats() : mIsLobby(false), mPackets(0), mPacketBytes(0) {}
+
+bool CaptureStats::process(const QString &path) {
+  mPath = path;
+
+  QFile log(path);
+
+  if (!log.open(QIODevice::ReadOnly)) {
+    mError = "failed to open the capture file";
+
+    return false;
+  }
+
+  capture::ReadFunction read = CaptureIndex::reader(log);
+  capture::FileHeader header;
+
+  if (!capture::ReadFileHeader(read, header)) {
+    mError = "invalid or corrupt capture file";
+
+    return false;
+  }
+
+  mIsLobby = header.isLobby;
+  mAddress = QString::fromStdString(header.address);
+
+  QByteArray buffer;
+  std::vector<CaptureIndexCommand> commands;
+
+  while (!log.atEnd()) {
+    capture::PacketHeader packet;
+
+    // Stop at a truncated packet like the packet list does.
+    if (!capture::ReadPacketHeader(read, header, packet)) {
+      break;
+    }
+
+    buffer.resize((int)packet.size);
+
+    if (!read(buffer.data(), packet.size)) {
+      break;
+    }
+
+    mPackets++;
+    mPacketBytes += packet.size;
+
+    // Version 1 captures only have the time in seconds.
+    uint64_t micro = packet.micro ? packet.micro : packet.stamp * 1000000ULL;
+
+    bool compressed = false;
+
+    QByteArray body = CaptureIndex::packetBody(
+        (const uchar *)buffer.constData(), packet.size, mIsLobby, compressed);
+
+    commands.clear();
+    capture::ParseCommands(body.constData(), (uint32_t)body.size(),
+                           commands);
+
+    for (const CaptureIndexCommand &cmd : commands) {
+      addCommand(packet.source, cmd.code, cmd.size, micro);
+    }
+  }
+
+  return true;
+}
+
+void CaptureStats::addCommand(uint8_t source, uint16_t code, uint16_t size,
+                              uint64_t micro) {
+  CaptureCommandStats &stats = mCommands[((uint32_t)source << 16) | code];
+
+  if (!stats.count) {
+    stats.source = source;
+    stats.code = code;
+  } else {
+    stats.gaps.add(micro > stats.lastMicro ? micro - stats.lastMicro : 0);
+  }
+
+  stats.count++;
+  stats.bytes += (uint64_t)size + 4;
+  stats.lastMicro = micro;
+
+  int bucket = 0;
+
+  while (bucket < CAPTURE_STATS_BUCKETS - 1 && size >= BUCKET_LIMITS[bucket]) {
+    bucket++;
+  }
+
+  stats.histogram[bucket]++;
+}
+
+QString CaptureStats::path() const { return mPath; }
+
+QString CaptureStats::address() const { return mAddress; }
+
+QString CaptureStats::error() const { return mError; }
+
+bool CaptureStats::isLobby() const { return mIsLobby; }
+
+uint64_t CaptureStats::packets() const { return mPackets; }
+
+uint64_t CaptureStats::packetBytes() const { return mPacketBytes; }
+
+const QMap<uint32_t, CaptureCommandStats> &CaptureStats::commands() const {
+  return mCommands;
+}
+
+QString CaptureStats::bucketName(int bucket) {
+  if (0 > bucket || CAPTURE_STATS_BUCKETS <= bucket) {
+    return QString();
+  }
+
+  uint32_t lower = bucket ? BUCKET_LIMITS[bucket - 1] : 0;
+
+  if (CAPTURE_STATS_BUCKETS - 1 == bucket) {
+    return QString("%1+").arg(lower);
+  }
+
+  return QString("%1-%2").arg(lower).arg(BUCKET_LIMITS[bucket] - 1);
+}
+
+void CaptureStats::writeCSV(QIODevice &out,
+                            const std::vector<CaptureStats> &stats) {
+  QTextStream csv(&out);
+
+  csv << "capture,address,source,code,name,count,bytes";
+
+  for (int i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+    csv << ",size_" << bucketName(i);
+  }
+
+  csv << ",gap_p50_us,gap_p95_us,gap_p99_us\n";
+
+  for (const CaptureStats &capture : stats) {
+    for (const CaptureCommandStats &cmd : capture.commands()) {
+      csv << csvField(capture.path()) << "," << csvField(capture.address())
+          << "," << (cmd.source ? "server" : "client") << ","
+          << codeName(cmd.code)
+          << "," << csvField(commandName(cmd.code)) << "," << cmd.count
+          << "," << cmd.bytes;
+
+      for (int i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        csv << "," << cmd.histogram[i];
+      }
+
+      csv << "," << cmd.gaps.percentile(50.0) << ","
+          << cmd.gaps.percentile(95.0) << "," << cmd.gaps.percentile(99.0)
+          << "\n";
+    }
+  }
+}
+
+void CaptureStats::writeJSON(QIODevice &out,
+                             const std::vector<CaptureStats> &stats) {
+  QJsonArray captures;
+
+  for (const CaptureStats &capture : stats) {
+    QJsonArray commands;
+
+    for (const CaptureCommandStats &cmd : capture.commands()) {
+      QJsonArray histogram;
+
+      for (int i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        histogram.append((double)cmd.histogram[i]);
+      }
+
+      QJsonObject gapPercentiles;
+      gapPercentiles["p50"] = (double)cmd.gaps.percentile(50.0);
+      gapPercentiles["p95"] = (double)cmd.gaps.percentile(95.0);
+      gapPercentiles["p99"] = (double)cmd.gaps.percentile(99.0);
+
+      QJsonObject command;
+      command["source"] = cmd.source ? "server" : "client";
+      command["code"] = codeName(cmd.code);
+      command["name"] = commandName(cmd.code);
+      command["count"] = (double)cmd.count;
+      command["bytes"] = (double)cmd.bytes;
+      command["sizes"] = histogram;
+      command["gap_us"] = gapPercentiles;
+
+      commands.append(command);
+    }
+
+    QJsonObject obj;
+    obj["capture"] = capture.path();
+    obj["address"] = capture.address();
+    obj["lobby"] = capture.isLobby();
+    obj["packets"] = (double)capture.packets();
+    obj["packet_bytes"] = (double)capture.packetBytes();
+    obj["commands"] = commands;
+
+    captures.append(obj);
+  }
+
+  // Names of the entries in each "sizes" array
+  QJsonArray buckets;
+
+  for (int i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+    buckets.append(bucketName(i));
+  }
+
+  QJsonObject root;
+  root["size_buckets"] = buckets;
+  root["captures"] = captures;
+
+  out.write(QJsonDocument(root).toJson());
+}
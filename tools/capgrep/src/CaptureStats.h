@@ -0,0 +1,193 @@
+/**
+ * @file tools/capgrep/src/CaptureStats.h
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Packet statistics for a capture file.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_CAPGREP_SRC_CAPTURESTATS_H
+#define TOOLS_CAPGREP_SRC_CAPTURESTATS_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <QIODevice>
+#include <QMap>
+#include <QString>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// Standard C++11 Includes
+#include <vector>
+
+#include "CaptureGapHistogram.h"
+
+/// Number of buckets in the command size histogram
+#define CAPTURE_STATS_BUCKETS (6)
+
+/**
+ * Statistics for one command code sent in one direction.
+ */
+class CaptureCommandStats {
+ public:
+  CaptureCommandStats();
+
+  /// 0 if the command came from the client, 1 if it came from the server
+  uint8_t source;
+
+  /// Command code
+  uint16_t code;
+
+  /// Number of times the command was seen
+  uint64_t count;
+
+  /// Total size of the commands including the 4 byte command header
+  uint64_t bytes;
+
+  /// Number of commands in each size bucket (see @ref bucketName)
+  uint64_t histogram[CAPTURE_STATS_BUCKETS];
+
+  /// Capture time of the last command in microseconds
+  uint64_t lastMicro;
+
+  /// Microseconds between each command and the one before it
+  CaptureGapHistogram gaps;
+};
+
+/**
+ * Packet statistics for a single capture (one connection). The capture is
+ * read one packet at a time so any size of capture can be processed with
+ * the memory of a single packet plus the statistics themselves.
+ */
+class CaptureStats {
+ public:
+  CaptureStats();
+
+  /**
+   * Read a capture and collect the statistics for it.
+   * @arg path Path to the capture file.
+   * @returns true if the capture was read, false with @ref error set
+   *   otherwise.
+   */
+  bool process(const QString &path);
+
+  /**
+   * Path of the capture the statistics are for.
+   * @returns Path to the capture file.
+   */
+  QString path() const;
+
+  /**
+   * Address of the client the capture was recorded for.
+   * @returns Client address from the capture header.
+   */
+  QString address() const;
+
+  /**
+   * Reason the capture could not be read.
+   * @returns Error message or an empty string.
+   */
+  QString error() const;
+
+  /**
+   * Determine if the capture is of a lobby connection.
+   * @returns true for a lobby capture, false for a channel capture.
+   */
+  bool isLobby() const;
+
+  /**
+   * Number of packets in the capture.
+   * @returns Packet count.
+   */
+  uint64_t packets() const;
+
+  /**
+   * Number of bytes the packets took on the wire (after compression).
+   * @returns Packet bytes.
+   */
+  uint64_t packetBytes() const;
+
+  /**
+   * Statistics for each command code and direction in the capture.
+   * @returns Statistics keyed by the source and command code.
+   */
+  const QMap<uint32_t, CaptureCommandStats> &commands() const;
+
+  /**
+   * Name of a bucket in the command size histogram.
+   * @arg bucket Index of the bucket.
+   * @returns Range of command data sizes in the bucket.
+   */
+  static QString bucketName(int bucket);
+
+  /**
+   * Write the statistics of several captures as CSV with one row for each
+   * command code and direction of each capture.
+   * @arg out Device to write to.
+   * @arg stats Statistics to write.
+   */
+  static void writeCSV(QIODevice &out, const std::vector<CaptureStats> &stats);
+
+  /**
+   * Write the statistics of several captures as a JSON document.
+   * @arg out Device to write to.
+   * @arg stats Statistics to write.
+   */
+  static void writeJSON(QIODevice &out,
+                        const std::vector<CaptureStats> &stats);
+
+ protected:
+  /**
+   * Add a command to the statistics.
+   * @arg source 0 for a client command, 1 for a server command.
+   * @arg code Command code.
+   * @arg size Size of the command data.
+   * @arg micro Capture time of the command in microseconds.
+   */
+  void addCommand(uint8_t source, uint16_t code, uint16_t size,
+                  uint64_t micro);
+
+  /// Path to the capture file
+  QString mPath;
+
+  /// Client address from the capture header
+  QString mAddress;
+
+  /// Reason the capture could not be read
+  QString mError;
+
+  /// Indicates this is a lobby capture
+  bool mIsLobby;
+
+  /// Number of packets in the capture
+  uint64_t mPackets;
+
+  /// Number of bytes the packets took on the wire
+  uint64_t mPacketBytes;
+
+  /// Statistics keyed by the source (high word) and command code
+  QMap<uint32_t, CaptureCommandStats> mCommands;
+};
+
+#endif  // TOOLS_CAPGREP_SRC_CAPTURESTATS_H
@@ -281,6 +281,11 @@ void Find::doubleClicked(const QModelIndex& index) {
                                                offset + term.size() - 1);
 }
 
+void Find::stopSearch() {
+  // Reset the filter to stop the search threads and show nothing.
+  mFilter->reset();
+}
+
 void Find::cancelSearch() {
   // Clear the search box.
   ui.findEdit->clear();
@@ -60,6 +60,12 @@ class Find : public QWidget {
    */
   Find(PacketListFilter *model, QWidget *parent = 0);
 
+  /**
+   * Stop the current search and clear the results. This must be called
+   * before the packets in the model are deleted.
+   */
+  void stopSearch();
+
  public slots:
   /**
    * Find the current search term.
@@ -54,37 +54,6 @@
 // libcomp
 #include <Convert.h>
 #include <Endian.h>
-#include <zlib.h>
-
-static const uint32_t FORMAT_MAGIC = 0x4B434148;   // HACK
-static const uint32_t FORMAT_MAGIC2 = 0x504D4F43;  // COMP
-static const uint32_t FORMAT_VER1 = 0x00010000;  // Major, Minor, Patch (1.0.0)
-static const uint32_t FORMAT_VER2 = 0x00010100;  // Major, Minor, Patch (1.1.0)
-
-static int uncompressChunk(const void *src, void *dest, int in_size,
-                           int chunk_size) {
-  z_stream strm;
-
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-
-  strm.avail_in = static_cast<uInt>(in_size);
-  strm.next_in = (Bytef *)src;
-
-  if (inflateInit(&strm) != Z_OK) return 0;
-
-  strm.avail_out = static_cast<uInt>(chunk_size);
-  strm.next_out = (Bytef *)dest;
-
-  if (inflate(&strm, Z_FINISH) != Z_STREAM_END) return 0;
-
-  int written = chunk_size - static_cast<int>(strm.avail_out);
-
-  if (inflateEnd(&strm) != Z_OK) return 0;
-
-  return written;
-}
 
 static MainWindow *g_mainwindow = 0;
 
@@ -370,7 +339,9 @@ void MainWindow::startLiveMode() {
   mLiveSockets.clear();
   mLiveStates.clear();
 
+  mFindWindow->stopSearch();
   mModel->clear();
+  mCaptureIndex.close();
   ui.packetData->setData(QByteArray());
   ui.packetDetails->clear();
 
@@ -488,7 +459,9 @@ void MainWindow::loadCaptures(const QStringList &inPaths) {
   mLiveSockets.clear();
   mLiveStates.clear();
 
+  mFindWindow->stopSearch();
   mModel->clear();
+  mCaptureIndex.close();
   ui.packetData->setData(QByteArray());
   ui.packetDetails->clear();
 
@@ -534,13 +507,9 @@ void MainWindow::loadCaptures(const QStringList &inPaths) {
       return;
     }
 
-    uint32_t magic = 0, ver = 0;
-
-    file->read((char *)&magic, 4);
-    file->read((char *)&ver, 4);
+    capture::FileHeader header;
 
-    if ((magic != FORMAT_MAGIC && magic != FORMAT_MAGIC2) ||
-        (ver != FORMAT_VER1 && ver != FORMAT_VER2)) {
+    if (!capture::ReadFileHeader(CaptureIndex::reader(*file), header)) {
       foreach (CaptureLoadData *cap, capData) { delete cap; }
 
       QMessageBox::critical(this, tr("Capture File Error"),
@@ -549,25 +518,11 @@ void MainWindow::loadCaptures(const QStringList &inPaths) {
       return;
     }
 
-    uint64_t stamp = 0;
-    uint32_t addrlen = 0;
-    char address[1024];
-
-    memset(address, 0, 1024);
-
-    if (ver == FORMAT_VER1)
-      file->read((char *)&stamp, 4);
-    else
-      file->read((char *)&stamp, 8);
-
-    file->read((char *)&addrlen, 4);
-    file->read(address, addrlen);
-
     CaptureLoadData *cap = new CaptureLoadData;
     cap->path = path;
     cap->file = file;
     cap->state = state;
-    cap->ver = ver;
+    cap->header = header;
 
     if (!loadCapturePacket(cap))
       delete cap;
@@ -599,7 +554,7 @@ void MainWindow::loadCaptures(const QStringList &inPaths) {
     p.WriteArray(cap->buffer, cap->sz);
 
     createPacketData(packetData, cap->source, cap->stamp, cap->micro, p,
-                     cap->state);
+                     cap->header.isLobby, cap->state);
 
     // Read in the next packet
     if (!loadCapturePacket(cap)) {
@@ -627,24 +582,17 @@ bool MainWindow::loadCapturePacket(CaptureLoadData *d) {
 
   if (d->file->atEnd()) return false;
 
-  if (d->file->read((char *)&d->source, sizeof(d->source)) !=
-      (qint64)sizeof(d->source))
-    return false;
-
-  if (d->ver == FORMAT_VER1) {
-    if (d->file->read((char *)&d->stamp, 4) != 4) return false;
-  } else {
-    if (d->file->read((char *)&d->stamp, 8) != 8) return false;
-
-    if (d->file->read((char *)&d->micro, 8) != 8) return false;
-  }
+  capture::ReadFunction read = CaptureIndex::reader(*d->file);
+  capture::PacketHeader packet;
 
-  if (d->file->read((char *)&d->sz, sizeof(d->sz)) != (qint64)sizeof(d->sz))
-    return false;
+  if (!capture::ReadPacketHeader(read, d->header, packet)) return false;
 
-  if (d->file->read((char *)d->buffer, d->sz) != d->sz) return false;
+  d->source = packet.source;
+  d->stamp = packet.stamp;
+  d->micro = packet.micro;
+  d->sz = packet.size;
 
-  return true;
+  return read(d->buffer, d->sz);
 }
 
 void MainWindow::loadCapture(const QString &path) {
@@ -676,12 +624,28 @@ void MainWindow::loadCapture(const QString &path) {
   mLiveSockets.clear();
   mLiveStates.clear();
 
+  // Stop searching the packets before they are deleted and only unmap the
+  // old capture once nothing refers to it.
+  mFindWindow->stopSearch();
   mModel->clear();
+  mCaptureIndex.close();
   ui.packetData->setData(QByteArray());
   ui.packetDetails->clear();
 
   updateValues();
 
+  // Map the capture and use the packet index when possible. Otherwise fall
+  // back to reading the whole capture below.
+  if (mCaptureIndex.open(path)) {
+    loadIndexedCapture();
+
+    setWindowTitle(tr("Capture Grep - %1").arg(QFileInfo(path).fileName()));
+
+    mStatusBar->setText(QDir::toNativeSeparators(path));
+
+    return;
+  }
+
   QFile log(path);
 
   // Open the log
@@ -692,39 +656,17 @@ void MainWindow::loadCapture(const QString &path) {
     return;
   }
 
-  uint32_t magic = 0, ver = 0;
-
-  log.read((char *)&magic, 4);
-  log.read((char *)&ver, 4);
+  capture::ReadFunction read = CaptureIndex::reader(log);
+  capture::FileHeader header;
 
-  if ((magic != FORMAT_MAGIC && magic != FORMAT_MAGIC2) ||
-      (ver != FORMAT_VER1 && ver != FORMAT_VER2)) {
+  if (!capture::ReadFileHeader(read, header)) {
     QMessageBox::critical(this, tr("Capture File Error"),
                           tr("Invalid or corrupt capture file."));
 
     return;
   }
 
-  bool isLobby = (FORMAT_MAGIC2 == magic);
-
-  uint64_t stamp = 0;
-  uint64_t micro = 0;
-  uint32_t addrlen = 0;
-  char address[1024];
-
-  memset(address, 0, 1024);
-
-  if (ver == FORMAT_VER1)
-    log.read((char *)&stamp, 4);
-  else
-    log.read((char *)&stamp, 8);
-
-  log.read((char *)&addrlen, 4);
-  log.read(address, addrlen);
-
-  uint8_t *pBuffer = new uint8_t[1048576];
-  uint8_t source;
-  uint32_t sz;
+  std::vector<char> buffer;
 
   libcomp::Packet p;
 
@@ -732,25 +674,20 @@ void MainWindow::loadCapture(const QString &path) {
   QList<PacketData *> packetData;
 
   while (!log.atEnd()) {
-    stamp = 0;
-    micro = 0;
+    capture::PacketHeader packet;
 
-    log.read((char *)&source, sizeof(source));
+    // Stop at a truncated packet.
+    if (!capture::ReadPacketHeader(read, header, packet)) break;
 
-    if (ver == FORMAT_VER1) {
-      log.read((char *)&stamp, 4);
-    } else {
-      log.read((char *)&stamp, 8);
-      log.read((char *)&micro, 8);
-    }
+    buffer.resize(packet.size);
 
-    log.read((char *)&sz, sizeof(sz));
-    log.read((char *)pBuffer, sz);
+    if (!read(buffer.data(), packet.size)) break;
 
     p.Clear();
-    p.WriteArray(pBuffer, sz);
+    p.WriteArray(buffer.data(), packet.size);
 
-    createPacketData(packetData, source, stamp, micro, p, isLobby);
+    createPacketData(packetData, packet.source, packet.stamp, packet.micro, p,
+                     header.isLobby);
   }
 
   log.close();
@@ -761,8 +698,6 @@ void MainWindow::loadCapture(const QString &path) {
   setWindowTitle(tr("Capture Grep - %1").arg(QFileInfo(path).fileName()));
 
   mStatusBar->setText(QDir::toNativeSeparators(path));
-
-  delete[] pBuffer;
 }
 
 void MainWindow::addPacket(uint8_t source, uint64_t stamp, uint64_t micro,
@@ -783,6 +718,29 @@ void MainWindow::createPacketData(QList<PacketData *> &packetData,
                                   bool isLobby, CaptureLoadState *state) {
   if (!state) state = &mDefaultState;
 
+  std::vector<char> body;
+  std::vector<capture::Command> commands;
+
+  if (capture::ReadBody((const uint8_t *)p.Data(), p.Size(), isLobby, body)) {
+    capture::ParseCommands(body.data(), (uint32_t)body.size(), commands);
+  }
+
+  for (const capture::Command &cmd : commands) {
+    packetData.append(createCommandData(
+        source, stamp, micro, cmd.code,
+        QByteArray(body.data() + cmd.offset, cmd.size), state));
+  }
+
+  if (source == 0)
+    state->packetSeqA++;
+  else
+    state->packetSeqB++;
+}
+
+PacketData *MainWindow::createCommandData(uint8_t source, uint64_t stamp,
+                                          uint64_t micro, uint16_t cmd,
+                                          const QByteArray &data,
+                                          CaptureLoadState *state) {
   if (mCopyActions.isEmpty()) {
     mCopyActions[0x0014] = &action0014;
     mCopyActions[0x0015] = &action0015;
@@ -792,106 +750,90 @@ void MainWindow::createPacketData(QList<PacketData *> &packetData,
     mCopyActions[0x00B9] = &action00B9;
   }
 
-  p.Seek(8);
-
-  // Check for compression
-  if (!isLobby && p.ReadU32Big() == 0x677A6970) {
-    int32_t uncompressed_size = p.ReadS32Little();
-    int32_t compressed_size = p.ReadS32Little();
-
-    uint32_t lv6 = p.ReadU32Big();
-
-    (void)lv6;
-
-    Q_ASSERT(lv6 == 0x6C763600);  // lv6
-
-    if (compressed_size != uncompressed_size) {
-      uint8_t *decomp = new uint8_t[uncompressed_size];
-
-      int written = uncompressChunk(p.Data() + p.Tell(), decomp,
-                                    compressed_size, uncompressed_size);
-
-      libcomp::Packet dpacket;
-      dpacket.WriteArray(p.Data(), p.Tell());
-      dpacket.WriteArray(decomp, static_cast<uint32_t>(written));
+  PacketData *d = new PacketData;
+  d->cmd = cmd;
+  d->source = source;
+  d->data = data;
+  d->copyAction = 0;
+  d->micro = micro;
+
+  if (d->cmd == 0x00F3) {
+    memcpy(&state->nextUpdate, d->data.constData(), 4);
+  } else if (d->cmd == 0x00F4) {
+    memcpy(&state->nextTicks, d->data.constData() + 4, 4);
+
+    if ((state->nextUpdate - state->lastUpdate) != 0) {
+      state->servRate = (float)(state->nextTicks - state->lastTicks) /
+                        (float)((state->nextUpdate - state->lastUpdate) * 1000);
+    }
 
-      p.Clear();
-      p.WriteArray(dpacket.Data(), dpacket.Size());
+    state->lastTicks = state->nextTicks;
+    state->lastUpdate = state->nextUpdate;
 
-      delete[] decomp;
-    }
+    state->nextTicks = 0;
+    state->nextUpdate = 0;
   }
 
-  p.Rewind();
-  p.Skip(isLobby ? 8 : 24);
+  d->servRate = state->servRate;
+  d->servTime =
+      (uint32_t)((float)state->lastTicks +
+                 (((float)stamp - (float)state->lastUpdate) * d->servRate));
 
-  while (p.Left() >= 6) {
-    p.Skip(2);  // Big endian size
+  if (mCopyActions.contains(d->cmd))
+    d->copyAction = mCopyActions.value(d->cmd);
 
-    uint32_t cmd_start = p.Tell();
-    uint16_t cmd_size = p.ReadU16Little();
-    if (cmd_size < 4) continue;
+  if (d->shortName.isEmpty())
+    d->text = tr("CMD%1").arg(d->cmd, 4, 16, QLatin1Char('0'));
+  else
+    d->text = d->shortName;
 
-    PacketData *d = new PacketData;
-    d->cmd = p.ReadU16Little();
-    d->source = source;
-    d->data = QByteArray(p.Data() + cmd_start + 4, cmd_size - 4);
-    d->copyAction = 0;
-    d->micro = micro;
+  if (d->desc.isEmpty()) {
+    const PacketInfo *info = PacketListModel::getPacketInfo(d->cmd);
 
-    if (d->cmd == 0x00F3) {
-      memcpy(&state->nextUpdate, d->data.constData(), 4);
-    } else if (d->cmd == 0x00F4) {
-      memcpy(&state->nextTicks, d->data.constData() + 4, 4);
+    if (info) d->desc = info->desc;
+  }
 
-      if ((state->nextUpdate - state->lastUpdate) != 0) {
-        state->servRate =
-            (float)(state->nextTicks - state->lastTicks) /
-            (float)((state->nextUpdate - state->lastUpdate) * 1000);
-      }
+  if (source == 0)
+    d->seq = state->packetSeqA;
+  else
+    d->seq = state->packetSeqB;
 
-      state->lastTicks = state->nextTicks;
-      state->lastUpdate = state->nextUpdate;
+  d->client = state->client;
 
-      state->nextTicks = 0;
-      state->nextUpdate = 0;
-    }
+  return d;
+}
 
-    d->servRate = state->servRate;
-    d->servTime =
-        (uint32_t)((float)state->lastTicks +
-                   (((float)stamp - (float)state->lastUpdate) * d->servRate));
+void MainWindow::loadIndexedCapture() {
+  // Variable to store list of loaded PacketData objects
+  QList<PacketData *> packetData;
 
-    if (mCopyActions.contains(d->cmd))
-      d->copyAction = mCopyActions.value(d->cmd);
+  for (const CaptureIndexRecord &record : mCaptureIndex.records()) {
+    QByteArray body = mCaptureIndex.body(record);
 
-    if (d->shortName.isEmpty())
-      d->text = tr("CMD%1").arg(d->cmd, 4, 16, QLatin1Char('0'));
-    else
-      d->text = d->shortName;
+    for (const CaptureIndexCommand &cmd : record.commands) {
+      if ((int)(cmd.offset + cmd.size) > body.size()) break;
 
-    if (d->desc.isEmpty()) {
-      const PacketInfo *info = PacketListModel::getPacketInfo(d->cmd);
+      // Uncompressed command data stays in the mapped file until it is
+      // modified. Decompressed command data is copied out of the body.
+      QByteArray data =
+          record.compressed
+              ? body.mid((int)cmd.offset, (int)cmd.size)
+              : QByteArray::fromRawData(body.constData() + cmd.offset,
+                                        (int)cmd.size);
 
-      if (info) d->desc = info->desc;
+      packetData.append(createCommandData(record.source, record.stamp,
+                                          record.micro, cmd.code, data,
+                                          &mDefaultState));
     }
 
-    if (source == 0)
-      d->seq = state->packetSeqA;
+    if (record.source == 0)
+      mDefaultState.packetSeqA++;
     else
-      d->seq = state->packetSeqB;
-
-    d->client = state->client;
-
-    packetData.append(d);
-
-    p.Seek(cmd_start + cmd_size);
+      mDefaultState.packetSeqB++;
   }
 
-  if (source == 0)
-    state->packetSeqA++;
-  else
-    state->packetSeqB++;
+  // Add the final list of PacketData objects to the model in one shot
+  mModel->addPacketData(packetData);
 }
 
 void MainWindow::itemSelectionChanged() {
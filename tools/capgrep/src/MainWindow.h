@@ -37,6 +37,7 @@
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+#include "CaptureIndex.h"
 #include "Find.h"
 #include "Packet.h"
 #include "PacketData.h"
@@ -66,11 +67,11 @@ class CaptureLoadData {
  public:
   QFile *file;
   QString path;
-  uint32_t ver;
+  capture::FileHeader header;
   uint64_t stamp;
   uint64_t micro;
   CaptureLoadState *state;
-  uint8_t buffer[1048576];
+  uint8_t buffer[CAPTURE_MAX_PACKET_SIZE];
   uint8_t source;
   uint32_t sz;
 
@@ -110,6 +111,11 @@ class MainWindow : public QMainWindow {
   void createPacketData(QList<PacketData *> &packetData, uint8_t source,
                         uint64_t stamp, uint64_t micro, libcomp::Packet &p,
                         bool isLobby, CaptureLoadState *state = 0);
+  PacketData *createCommandData(uint8_t source, uint64_t stamp,
+                                uint64_t micro, uint16_t cmd,
+                                const QByteArray &data,
+                                CaptureLoadState *state);
+  void loadIndexedCapture();
 
   void packetLimitChanged(int limit);
 
@@ -176,6 +182,7 @@ class MainWindow : public QMainWindow {
   QMap<int32_t, CaptureLoadState *> mLiveStates;
 
   CaptureLoadState mDefaultState;
+  CaptureIndex mCaptureIndex;
 };
 
 #endif  // TOOLS_CAPGREP_SRC_MAINWINDOW_H
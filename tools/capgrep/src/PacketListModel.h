@@ -70,9 +70,9 @@ class PacketListModel : public QAbstractListModel {
   void setPacketLimit(int32_t limit);
 
   static const PacketInfo* getPacketInfo(uint16_t code);
+  static void loadPacketInfo();
 
  protected:
-  static void loadPacketInfo();
 
   int32_t mPacketLimit;
 
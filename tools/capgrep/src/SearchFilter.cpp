@@ -34,12 +34,34 @@
 #include <PushIgnore.h>
 
 #include <QSettings>
+#include <QTimer>
 
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+// Standard C++11 Includes
+#include <algorithm>
+
+/// Number of packets a search thread claims at a time
+static const size_t SEARCH_CHUNK_SIZE = 1024;
+
+/// Milliseconds between adding new matches to the search results
+static const int SEARCH_COLLECT_INTERVAL = 100;
+
 SearchFilter::SearchFilter(QObject* p)
-    : QSortFilterProxyModel(p), mSearchType(SearchType_None), mCommand(0) {}
+    : QSortFilterProxyModel(p),
+      mSearchType(SearchType_None),
+      mCommand(0),
+      mNextChunk(0),
+      mRunning(0),
+      mStop(false),
+      mCollectTimer(new QTimer(this)) {
+  mCollectTimer->setInterval(SEARCH_COLLECT_INTERVAL);
+
+  connect(mCollectTimer, SIGNAL(timeout()), this, SLOT(collectMatches()));
+}
+
+SearchFilter::~SearchFilter() { stopSearch(); }
 
 bool SearchFilter::filterAcceptsRow(int row, const QModelIndex& p) const {
   Q_UNUSED(p)
@@ -57,7 +79,10 @@ bool SearchFilter::filterAcceptsRow(int row, const QModelIndex& p) const {
   switch (mSearchType) {
     case SearchType_Binary:
     case SearchType_Text:
-      return d->data.contains(mTerm);
+      // Packets added since the search started (in live mode) are not in
+      // the search data so check them here.
+      return mMatches.contains(d) ||
+             (!mSearched.contains(d) && d->data.contains(mTerm));
     case SearchType_Command:
       return d->cmd == mCommand;
     case SearchType_None:
@@ -69,6 +94,8 @@ bool SearchFilter::filterAcceptsRow(int row, const QModelIndex& p) const {
 }
 
 void SearchFilter::reset() {
+  stopSearch();
+
   mSearchType = SearchType_None;
   mTerm.clear();
   mCommand = 0;
@@ -79,13 +106,17 @@ void SearchFilter::reset() {
 }
 
 void SearchFilter::findBinary(const QByteArray& term) {
+  stopSearch();
+
   mSearchType = SearchType_Binary;
   mTerm = term;
 
-  invalidateFilter();
+  startSearch();
 }
 
 void SearchFilter::findText(const QString& encoding, const QString& text) {
+  stopSearch();
+
   mSearchType = SearchType_Text;
   if ("CP1252" == encoding) {
     std::vector<char> term = libcomp::Convert::ToEncoding(
@@ -100,10 +131,12 @@ void SearchFilter::findText(const QString& encoding, const QString& text) {
   }
   mTerm.chop(1);
 
-  invalidateFilter();
+  startSearch();
 }
 
 void SearchFilter::findCommand(uint16_t cmd) {
+  stopSearch();
+
   mSearchType = SearchType_Command;
   mCommand = cmd;
 
@@ -134,3 +167,125 @@ bool SearchFilter::searchResult(const QModelIndex& idx, int& packet,
 
   return true;
 }
+
+void SearchFilter::stopSearch() {
+  mStop = true;
+
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+
+  mWorkers.clear();
+  mCollectTimer->stop();
+
+  mSearchData.clear();
+  mPending.clear();
+  mSearched.clear();
+  mMatches.clear();
+
+  mStop = false;
+}
+
+void SearchFilter::startSearch() {
+  PacketListFilter* filter = qobject_cast<PacketListFilter*>(sourceModel());
+  PacketListModel* model =
+      filter ? qobject_cast<PacketListModel*>(filter->sourceModel()) : 0;
+
+  // Take a copy of the data to search so the packet list can keep changing.
+  // The copies share the packet data so this does not copy any bytes.
+  if (model) {
+    int count = filter->rowCount();
+
+    mSearchData.reserve((size_t)count);
+
+    for (int row = 0; row < count; row++) {
+      PacketData* d = model->packetAt(filter->mapRow(row));
+
+      if (d) {
+        mSearchData.push_back(std::make_pair(d, d->data));
+        mSearched.insert(d);
+      }
+    }
+  }
+
+  // Clear the old results.
+  invalidateFilter();
+
+  if (mSearchData.empty()) {
+    return;
+  }
+
+  size_t chunkCount =
+      (mSearchData.size() + SEARCH_CHUNK_SIZE - 1) / SEARCH_CHUNK_SIZE;
+  size_t threadCount = std::min(
+      chunkCount,
+      std::max((size_t)1, (size_t)std::thread::hardware_concurrency()));
+
+  mNextChunk = 0;
+  mRunning = (int)threadCount;
+
+  for (size_t i = 0; i < threadCount; i++) {
+    mWorkers.push_back(std::thread([this]() { searchWorker(); }));
+  }
+
+  mCollectTimer->start();
+}
+
+void SearchFilter::searchWorker() {
+  std::vector<PacketData*> matches;
+
+  while (!mStop) {
+    size_t start = mNextChunk.fetch_add(1) * SEARCH_CHUNK_SIZE;
+
+    if (start >= mSearchData.size()) {
+      break;
+    }
+
+    size_t end = std::min(start + SEARCH_CHUNK_SIZE, mSearchData.size());
+
+    for (size_t i = start; i < end; i++) {
+      if (mSearchData[i].second.contains(mTerm)) {
+        matches.push_back(mSearchData[i].first);
+      }
+    }
+
+    if (!matches.empty()) {
+      std::lock_guard<std::mutex> lock(mPendingLock);
+      mPending.insert(mPending.end(), matches.begin(), matches.end());
+      matches.clear();
+    }
+  }
+
+  mRunning--;
+}
+
+void SearchFilter::collectMatches() {
+  // Check this first so no matches are missed when the threads finish while
+  // the pending matches are being collected.
+  bool done = (0 == mRunning);
+
+  std::vector<PacketData*> pending;
+
+  {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    pending.swap(mPending);
+  }
+
+  if (!pending.empty()) {
+    for (auto d : pending) {
+      mMatches.insert(d);
+    }
+
+    invalidateFilter();
+  }
+
+  if (done) {
+    for (auto& worker : mWorkers) {
+      worker.join();
+    }
+
+    mWorkers.clear();
+    mCollectTimer->stop();
+    mSearchData.clear();
+  }
+}
@@ -31,20 +31,38 @@
 #include <PushIgnore.h>
 
 #include <QByteArray>
+#include <QSet>
 #include <QSortFilterProxyModel>
 #include <QString>
 
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+// Standard C++11 Includes
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class PacketData;
+class QTimer;
+
 class SearchFilter : public QSortFilterProxyModel {
   Q_OBJECT
 
  public:
   SearchFilter(QObject* parent = 0);
+  ~SearchFilter();
 
   void reset();
 
+  /**
+   * Stop any background search and wait for the search threads to exit.
+   * This must be called before the packets being searched are deleted.
+   */
+  void stopSearch();
+
   typedef enum _SearchType {
     SearchType_None = -1,
     SearchType_Binary = 0,
@@ -59,13 +77,61 @@ class SearchFilter : public QSortFilterProxyModel {
   bool searchResult(const QModelIndex& index, int& packet, int& offset,
                     QByteArray& term);
 
+ protected slots:
+  /**
+   * Add the packets the search threads matched so far to the results.
+   */
+  void collectMatches();
+
  protected:
   bool filterAcceptsRow(int row, const QModelIndex& parent) const;
 
+  /**
+   * Search the data of every packet for the search term. The packet data is
+   * split into chunks that are searched by one thread per core while the
+   * results are added to the list as they are found.
+   */
+  void startSearch();
+
+  /**
+   * Search chunks of packets until every chunk has been claimed.
+   */
+  void searchWorker();
+
   SearchType mSearchType;
 
   QByteArray mTerm;
   uint16_t mCommand;
+
+  /// Packet data being searched by the search threads
+  std::vector<std::pair<PacketData*, QByteArray>> mSearchData;
+
+  /// Index of the next chunk of packets to search
+  std::atomic<size_t> mNextChunk;
+
+  /// Number of search threads still running
+  std::atomic<int> mRunning;
+
+  /// Indicates the search threads should stop
+  std::atomic<bool> mStop;
+
+  /// Search threads
+  std::vector<std::thread> mWorkers;
+
+  /// Matches found by the search threads that are not in the results yet
+  std::vector<PacketData*> mPending;
+
+  /// Lock for the pending matches
+  std::mutex mPendingLock;
+
+  /// Packets searched by the search threads
+  QSet<PacketData*> mSearched;
+
+  /// Packets in the search results
+  QSet<PacketData*> mMatches;
+
+  /// Timer to add the pending matches to the results
+  QTimer* mCollectTimer;
 };
 
 #endif  // TOOLS_CAPGREP_SRC_SEARCHFILTER_H
@@ -24,16 +24,150 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "CaptureStats.h"
 #include "MainWindow.h"
 
 // Ignore warnings
 #include <PushIgnore.h>
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
 
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+// Standard C Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+/**
+ * Print packet statistics for captures without opening the main window.
+ * This is used when the application is run with the --stats option.
+ * @arg argc Number of arguments passed to the application.
+ * @arg argv Array of arguments passed to the application.
+ * @returns Return code when appplication exits.
+ */
+static int statsMain(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("comp_capgrep");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Print per command statistics for channel and lobby captures.");
+  parser.addHelpOption();
+
+  QCommandLineOption statsOption(
+      "stats", "Print statistics instead of opening the main window.");
+  QCommandLineOption formatOption(
+      QStringList() << "f"
+                    << "format",
+      "Output format (csv or json).", "format", "csv");
+  QCommandLineOption jobsOption(
+      QStringList() << "j"
+                    << "jobs",
+      "Number of captures to read at the same time.", "jobs",
+      QString::number(std::max(1u, std::thread::hardware_concurrency())));
+  QCommandLineOption outputOption(
+      QStringList() << "o"
+                    << "output",
+      "Write the statistics to a file instead of standard output.", "file");
+
+  parser.addOption(statsOption);
+  parser.addOption(formatOption);
+  parser.addOption(jobsOption);
+  parser.addOption(outputOption);
+  parser.addPositionalArgument("captures", "Capture files to read.",
+                               "CAPTURE...");
+  parser.process(app);
+
+  QStringList paths = parser.positionalArguments();
+  QString format = parser.value(formatOption).toLower();
+  int jobs = parser.value(jobsOption).toInt();
+
+  if (paths.isEmpty()) {
+    fprintf(stderr, "At least one capture file must be specified.\n");
+
+    return EXIT_FAILURE;
+  } else if ("csv" != format && "json" != format) {
+    fprintf(stderr, "The format must be csv or json.\n");
+
+    return EXIT_FAILURE;
+  } else if (1 > jobs) {
+    fprintf(stderr, "At least one job must be run.\n");
+
+    return EXIT_FAILURE;
+  }
+
+  // Each capture is one connection and is read by a single thread.
+  std::vector<CaptureStats> stats((size_t)paths.count());
+  std::vector<std::thread> workers;
+  std::atomic<int> nextCapture(0);
+
+  for (int i = 0; i < std::min(jobs, paths.count()); i++) {
+    workers.push_back(std::thread([&]() {
+      int idx;
+
+      while ((idx = nextCapture++) < paths.count()) {
+        stats[(size_t)idx].process(paths.at(idx));
+      }
+    }));
+  }
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  int ret = EXIT_SUCCESS;
+
+  std::vector<CaptureStats> processed;
+
+  for (CaptureStats &capture : stats) {
+    if (capture.error().isEmpty()) {
+      processed.push_back(std::move(capture));
+    } else {
+      fprintf(stderr, "Failed to read %s: %s\n",
+              capture.path().toLocal8Bit().constData(),
+              capture.error().toLocal8Bit().constData());
+
+      ret = EXIT_FAILURE;
+    }
+  }
+
+  // Command names come from the same list the main window uses.
+  PacketListModel::loadPacketInfo();
+
+  QFile out;
+
+  if (parser.isSet(outputOption)) {
+    out.setFileName(parser.value(outputOption));
+
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      fprintf(stderr, "Failed to open the output file.\n");
+
+      return EXIT_FAILURE;
+    }
+  } else if (!out.open(stdout, QIODevice::WriteOnly)) {
+    return EXIT_FAILURE;
+  }
+
+  if ("json" == format) {
+    CaptureStats::writeJSON(out, processed);
+  } else {
+    CaptureStats::writeCSV(out, processed);
+  }
+
+  return ret;
+}
+
 /**
  * This is the main function for the packet analysis application. This
  * application displays channel packet captures produced by the logger.
@@ -42,6 +176,13 @@
  * @returns Return code when appplication exits.
  */
 int main(int argc, char *argv[]) {
+  // Run without a window when only statistics are wanted.
+  for (int i = 1; i < argc; i++) {
+    if (0 == strcmp(argv[i], "--stats")) {
+      return statsMain(argc, argv);
+    }
+  }
+
   QApplication app(argc, argv);
 
   // These settings are used to specify how the settings are stored. On
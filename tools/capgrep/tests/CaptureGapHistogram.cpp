@@ -0,0 +1,193 @@
+/**
+ * @file tools/capgrep/tests/CaptureGapHistogram.cpp
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Test the command gap histogram.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// capgrep Includes
+#include <CaptureGapHistogram.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/**
+ * Histogram with access to the bucket math.
+ */
+class TestGapHistogram : public CaptureGapHistogram {
+ public:
+  using CaptureGapHistogram::bucket;
+  using CaptureGapHistogram::lowerBound;
+};
+
+/**
+ * Get a percentile from sorted gaps with the same rank the histogram uses.
+ * @param sorted Gaps sorted from smallest to largest
+ * @param percentile Percentile to get from 0 to 100
+ * @return Exact gap at the percentile
+ */
+static uint64_t ExactPercentile(const std::vector<uint64_t>& sorted,
+                                double percentile) {
+  return sorted[(size_t)((double)(sorted.size() - 1) * percentile / 100.0)];
+}
+
+TEST(CaptureGapHistogram, Empty) {
+  CaptureGapHistogram histogram;
+
+  EXPECT_EQ(0u, histogram.percentile(0.0));
+  EXPECT_EQ(0u, histogram.percentile(50.0));
+  EXPECT_EQ(0u, histogram.percentile(100.0));
+}
+
+TEST(CaptureGapHistogram, Buckets) {
+  // Gaps below the sub-bucket count are exact.
+  for (uint32_t gap = 0; gap < CAPTURE_GAP_SUB_BUCKETS; gap++) {
+    EXPECT_EQ(gap, TestGapHistogram::bucket(gap));
+    EXPECT_EQ(gap, TestGapHistogram::lowerBound(gap));
+  }
+
+  // Each power of two after that has its own set of sub-buckets.
+  EXPECT_EQ(16u, TestGapHistogram::bucket(16));
+  EXPECT_EQ(31u, TestGapHistogram::bucket(31));
+  EXPECT_EQ(32u, TestGapHistogram::bucket(32));
+  EXPECT_EQ(32u, TestGapHistogram::bucket(33));
+  EXPECT_EQ(33u, TestGapHistogram::bucket(34));
+  EXPECT_EQ(48u, TestGapHistogram::bucket(64));
+  EXPECT_EQ(64u, TestGapHistogram::lowerBound(48));
+  EXPECT_EQ(68u, TestGapHistogram::lowerBound(49));
+
+  // Every gap is inside its bucket and each bucket is at most 1/16 of its
+  // lower bound wide.
+  std::vector<uint64_t> gaps;
+
+  for (uint64_t gap = 0; gap < 5000; gap++) {
+    gaps.push_back(gap);
+  }
+
+  for (uint32_t shift = 13; shift < 63; shift++) {
+    gaps.push_back((1ull << shift) - 1);
+    gaps.push_back(1ull << shift);
+    gaps.push_back((1ull << shift) + (1ull << (shift - 3)) + 7);
+  }
+
+  for (uint64_t gap : gaps) {
+    uint32_t bucket = TestGapHistogram::bucket(gap);
+    uint64_t lower = TestGapHistogram::lowerBound(bucket);
+    uint64_t upper = TestGapHistogram::lowerBound(bucket + 1);
+
+    ASSERT_LE(lower, gap) << gap;
+    ASSERT_LT(gap, upper) << gap;
+
+    if (CAPTURE_GAP_SUB_BUCKETS <= gap) {
+      ASSERT_LE((upper - lower) * CAPTURE_GAP_SUB_BUCKETS, lower) << gap;
+    } else {
+      ASSERT_EQ(1u, upper - lower) << gap;
+    }
+  }
+}
+
+TEST(CaptureGapHistogram, ExactSmallGaps) {
+  CaptureGapHistogram histogram;
+
+  for (uint64_t gap = 0; gap < CAPTURE_GAP_SUB_BUCKETS; gap++) {
+    histogram.add(gap);
+  }
+
+  EXPECT_EQ(0u, histogram.percentile(0.0));
+  EXPECT_EQ(7u, histogram.percentile(50.0));
+  EXPECT_EQ(14u, histogram.percentile(95.0));
+  EXPECT_EQ(15u, histogram.percentile(100.0));
+}
+
+TEST(CaptureGapHistogram, SingleBucket) {
+  CaptureGapHistogram histogram;
+
+  // 1000 is in the bucket [992, 1024) so every percentile is its middle.
+  for (int i = 0; i < 100; i++) {
+    histogram.add(1000);
+  }
+
+  EXPECT_EQ(1007u, histogram.percentile(0.0));
+  EXPECT_EQ(1007u, histogram.percentile(50.0));
+  EXPECT_EQ(1007u, histogram.percentile(100.0));
+}
+
+TEST(CaptureGapHistogram, Accuracy) {
+  // Command gaps are roughly log-normal: mostly a few milliseconds with a
+  // long tail of idle periods.
+  std::mt19937_64 rng(0x47415053);
+  std::lognormal_distribution<double> distribution(8.0, 1.5);
+
+  CaptureGapHistogram histogram;
+  std::vector<uint64_t> gaps;
+  gaps.reserve(200000);
+
+  for (int i = 0; i < 200000; i++) {
+    uint64_t gap = (uint64_t)distribution(rng);
+
+    histogram.add(gap);
+    gaps.push_back(gap);
+  }
+
+  std::sort(gaps.begin(), gaps.end());
+
+  // The histogram returns the middle of the bucket holding the exact value
+  // so it is off by at most half a bucket, or 1/32 of the value.
+  for (double percentile : {0.0, 1.0, 25.0, 50.0, 75.0, 90.0, 95.0, 99.0,
+                            99.9, 100.0}) {
+    SCOPED_TRACE(percentile);
+
+    uint64_t exact = ExactPercentile(gaps, percentile);
+    uint64_t estimate = histogram.percentile(percentile);
+    uint64_t error = exact > estimate ? exact - estimate : estimate - exact;
+
+    EXPECT_LE(error * 2 * CAPTURE_GAP_SUB_BUCKETS, exact);
+  }
+
+  // The reported percentiles are within 3% of the sorted values.
+  for (double percentile : {50.0, 95.0, 99.0}) {
+    SCOPED_TRACE(percentile);
+
+    double exact = (double)ExactPercentile(gaps, percentile);
+    double estimate = (double)histogram.percentile(percentile);
+
+    EXPECT_NEAR(exact, estimate, exact * 0.03);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
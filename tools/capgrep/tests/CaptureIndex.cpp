@@ -0,0 +1,416 @@
+/**
+ * @file tools/capgrep/tests/CaptureIndex.cpp
+ * @ingroup capgrep
+ *
+ * @author HACKfrost
+ *
+ * @brief Test indexing capture files and the sidecar index.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QTemporaryDir>
+
+#include <zlib.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// capgrep Includes
+#include <CaptureIndex.h>
+
+// Standard C Includes
+#include <string.h>
+
+// Standard C++11 Includes
+#include <functional>
+#include <vector>
+
+static const uint32_t CHANNEL_MAGIC = 0x4B434148;  // HACK
+static const uint32_t LOBBY_MAGIC = 0x504D4F43;    // COMP
+static const uint32_t FORMAT_VER2 = 0x00010100;    // 1.1.0
+
+/// Address written into every test capture
+static const char *ADDRESS = "127.0.0.1:14666";
+
+/**
+ * Index with access to the sidecar index so a test can corrupt it.
+ */
+class TestCaptureIndex : public CaptureIndex {
+ public:
+  using CaptureIndex::loadIndex;
+  using CaptureIndex::saveIndex;
+
+  QVector<CaptureIndexRecord> &editRecords() { return mRecords; }
+};
+
+/**
+ * Append a value to a buffer in host (little endian) order.
+ * @param data Buffer to append to
+ * @param value Value to append
+ */
+template <typename T>
+static void Append(QByteArray &data, T value) {
+  data.append((const char *)&value, (int)sizeof(value));
+}
+
+/**
+ * Build a command for a packet body.
+ * @param code Command code
+ * @param payload Command data following the code
+ * @return Command with its sizes and code
+ */
+static QByteArray Command(uint16_t code, const QByteArray &payload) {
+  QByteArray cmd;
+  Append<uint16_t>(cmd, 0);  // Big endian size (ignored)
+  Append<uint16_t>(cmd, (uint16_t)(payload.size() + 4));
+  Append<uint16_t>(cmd, code);
+  cmd.append(payload);
+
+  return cmd;
+}
+
+/**
+ * Build a channel packet around a body.
+ * @param body Packet body holding the commands
+ * @param compress Compress the body like the server does
+ * @return Packet including the packet and compression headers
+ */
+static QByteArray ChannelPacket(const QByteArray &body, bool compress) {
+  QByteArray data = body;
+
+  if (compress) {
+    uLongf size = compressBound((uLong)body.size());
+    data.resize((int)size);
+
+    EXPECT_EQ(Z_OK, compress2((Bytef *)data.data(), &size,
+                              (const Bytef *)body.constData(),
+                              (uLong)body.size(), Z_BEST_COMPRESSION));
+
+    data.resize((int)size);
+  }
+
+  QByteArray packet(8, 0);
+  packet.append("gzip", 4);
+  Append<int32_t>(packet, body.size());
+  Append<int32_t>(packet, data.size());
+  packet.append("lv6\0", 4);
+  packet.append(data);
+
+  return packet;
+}
+
+/**
+ * Build a capture file.
+ * @param lobby Write a lobby capture instead of a channel capture
+ * @param packets Packets to capture, alternating client and server
+ * @return Data of the capture file
+ */
+static QByteArray Capture(bool lobby, const QList<QByteArray> &packets) {
+  QByteArray capture;
+  Append<uint32_t>(capture, lobby ? LOBBY_MAGIC : CHANNEL_MAGIC);
+  Append<uint32_t>(capture, FORMAT_VER2);
+  Append<uint64_t>(capture, 1000);
+  Append<uint32_t>(capture, (uint32_t)strlen(ADDRESS));
+  capture.append(ADDRESS);
+
+  for (int i = 0; i < packets.size(); i++) {
+    Append<uint8_t>(capture, (uint8_t)(i % 2));
+    Append<uint64_t>(capture, (uint64_t)(1000 + i));
+    Append<uint64_t>(capture, (uint64_t)(1000 + i) * 1000000ULL + 5);
+    Append<uint32_t>(capture, (uint32_t)packets[i].size());
+    capture.append(packets[i]);
+  }
+
+  return capture;
+}
+
+/**
+ * Write a file.
+ * @param path Path of the file
+ * @param data Data to write
+ * @return true if the file was written
+ */
+static bool WriteFile(const QString &path, const QByteArray &data) {
+  QFile file(path);
+
+  return file.open(QIODevice::WriteOnly) && data.size() == file.write(data);
+}
+
+/**
+ * Build the channel capture most tests use. It has two uncompressed
+ * commands, one compressed command and a packet with a bad command after a
+ * good one.
+ * @return Data of the capture file
+ */
+static QByteArray ChannelCapture() {
+  QByteArray badBody = Command(0x0030, "ok");
+  Append<uint16_t>(badBody, 0);
+  Append<uint16_t>(badBody, 100);  // Runs past the body
+  Append<uint16_t>(badBody, 0x0031);
+  badBody.append("short");
+
+  return Capture(
+      false,
+      {ChannelPacket(Command(0x0010, "first") + Command(0x0011, "second"),
+                     false),
+       ChannelPacket(Command(0x0020, QByteArray(200, 'z')), true),
+       ChannelPacket(badBody, false)});
+}
+
+/**
+ * Get the data of a command from the indexed capture.
+ * @param index Index of the capture
+ * @param record Packet holding the command
+ * @param cmd Command to get the data of
+ * @return Command data
+ */
+static QByteArray CommandData(const CaptureIndex &index,
+                              const CaptureIndexRecord &record,
+                              const CaptureIndexCommand &cmd) {
+  return index.body(record).mid((int)cmd.offset, (int)cmd.size);
+}
+
+/**
+ * Check that two indexes describe the same packets.
+ * @param expected Records from a freshly parsed capture
+ * @param actual Records to check
+ */
+static void ExpectSameRecords(const QVector<CaptureIndexRecord> &expected,
+                              const QVector<CaptureIndexRecord> &actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+
+  for (int i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].offset, actual[i].offset);
+    EXPECT_EQ(expected[i].size, actual[i].size);
+    EXPECT_EQ(expected[i].source, actual[i].source);
+    EXPECT_EQ(expected[i].compressed, actual[i].compressed);
+    EXPECT_EQ(expected[i].stamp, actual[i].stamp);
+    EXPECT_EQ(expected[i].micro, actual[i].micro);
+    ASSERT_EQ(expected[i].commands.size(), actual[i].commands.size());
+
+    for (size_t j = 0; j < expected[i].commands.size(); j++) {
+      EXPECT_EQ(expected[i].commands[j].code, actual[i].commands[j].code);
+      EXPECT_EQ(expected[i].commands[j].offset, actual[i].commands[j].offset);
+      EXPECT_EQ(expected[i].commands[j].size, actual[i].commands[j].size);
+    }
+  }
+}
+
+TEST(CaptureIndex, Parse) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  QString path = dir.filePath("channel.hack");
+
+  // A truncated packet at the end is ignored.
+  QByteArray capture = ChannelCapture();
+  Append<uint8_t>(capture, 1);
+  Append<uint32_t>(capture, 2000);
+  ASSERT_TRUE(WriteFile(path, capture));
+
+  CaptureIndex index;
+  ASSERT_TRUE(index.open(path));
+  EXPECT_FALSE(index.isLobby());
+  EXPECT_EQ(QString(ADDRESS), index.address());
+
+  const QVector<CaptureIndexRecord> &records = index.records();
+  ASSERT_EQ(3, records.size());
+
+  EXPECT_EQ(0, records[0].source);
+  EXPECT_EQ(1, records[1].source);
+  EXPECT_EQ(1001u, records[1].stamp);
+  EXPECT_EQ(1001000005u, records[1].micro);
+
+  EXPECT_FALSE(records[0].compressed);
+  ASSERT_EQ(2u, records[0].commands.size());
+  EXPECT_EQ(0x0010, records[0].commands[0].code);
+  EXPECT_EQ(0x0011, records[0].commands[1].code);
+  EXPECT_EQ(QByteArray("first"),
+            CommandData(index, records[0], records[0].commands[0]));
+  EXPECT_EQ(QByteArray("second"),
+            CommandData(index, records[0], records[0].commands[1]));
+
+  EXPECT_TRUE(records[1].compressed);
+  ASSERT_EQ(1u, records[1].commands.size());
+  EXPECT_EQ(0x0020, records[1].commands[0].code);
+  EXPECT_EQ(QByteArray(200, 'z'),
+            CommandData(index, records[1], records[1].commands[0]));
+
+  // Only the command before the bad one is found.
+  ASSERT_EQ(1u, records[2].commands.size());
+  EXPECT_EQ(0x0030, records[2].commands[0].code);
+  EXPECT_EQ(QByteArray("ok"),
+            CommandData(index, records[2], records[2].commands[0]));
+}
+
+TEST(CaptureIndex, ParseLobby) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  QString path = dir.filePath("lobby.comp");
+
+  // Lobby packets have an 8 byte header and are never compressed.
+  ASSERT_TRUE(WriteFile(
+      path, Capture(true, {QByteArray(8, 0) + Command(0x0003, "login")})));
+
+  CaptureIndex index;
+  ASSERT_TRUE(index.open(path));
+  EXPECT_TRUE(index.isLobby());
+
+  const QVector<CaptureIndexRecord> &records = index.records();
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(1u, records[0].commands.size());
+  EXPECT_EQ(0x0003, records[0].commands[0].code);
+  EXPECT_EQ(QByteArray("login"),
+            CommandData(index, records[0], records[0].commands[0]));
+}
+
+TEST(CaptureIndex, ParseInvalid) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  QString path = dir.filePath("invalid.hack");
+
+  QByteArray capture = ChannelCapture();
+  capture[0] = 'X';
+  ASSERT_TRUE(WriteFile(path, capture));
+
+  CaptureIndex index;
+  EXPECT_FALSE(index.open(path));
+  EXPECT_TRUE(index.records().isEmpty());
+  EXPECT_FALSE(QFile::exists(path + ".idx"));
+}
+
+TEST(CaptureIndex, SidecarRoundTrip) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  QString path = dir.filePath("channel.hack");
+  QString indexPath = path + ".idx";
+  ASSERT_TRUE(WriteFile(path, ChannelCapture()));
+
+  CaptureIndex parsed;
+  ASSERT_TRUE(parsed.open(path));
+  ASSERT_TRUE(QFile::exists(indexPath));
+
+  QVector<CaptureIndexRecord> expected = parsed.records();
+  parsed.close();
+
+  // Change a field the capture can not confirm so the next open shows
+  // whether the records came from the sidecar index.
+  {
+    TestCaptureIndex edit;
+    ASSERT_TRUE(edit.open(path));
+
+    edit.editRecords()[1].stamp = 42;
+    ASSERT_TRUE(edit.saveIndex(indexPath));
+  }
+
+  expected[1].stamp = 42;
+
+  CaptureIndex loaded;
+  ASSERT_TRUE(loaded.open(path));
+  EXPECT_FALSE(loaded.isLobby());
+  EXPECT_EQ(QString(ADDRESS), loaded.address());
+  ExpectSameRecords(expected, loaded.records());
+  EXPECT_EQ(QByteArray(200, 'z'),
+            CommandData(loaded, loaded.records()[1],
+                        loaded.records()[1].commands[0]));
+}
+
+TEST(CaptureIndex, SidecarValidation) {
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+
+  QString path = dir.filePath("channel.hack");
+  QString indexPath = path + ".idx";
+  ASSERT_TRUE(WriteFile(path, ChannelCapture()));
+
+  QVector<CaptureIndexRecord> expected;
+
+  {
+    CaptureIndex parsed;
+    ASSERT_TRUE(parsed.open(path));
+
+    expected = parsed.records();
+  }
+
+  std::vector<std::function<void(QVector<CaptureIndexRecord> &)>>
+      corruptions = {
+          // Command runs past the body.
+          [](QVector<CaptureIndexRecord> &records) {
+            records[0].commands[1].size = 1000;
+          },
+          // Command offset is past the body.
+          [](QVector<CaptureIndexRecord> &records) {
+            records[1].commands[0].offset = 0x10000;
+          },
+          // Packet runs past the end of the capture.
+          [](QVector<CaptureIndexRecord> &records) {
+            records[2].size += 64;
+          },
+          // Packet offset is past the end of the capture.
+          [](QVector<CaptureIndexRecord> &records) {
+            records[2].offset = 0xFFFFFFFFFFFFull;
+          },
+          // Packets overlap.
+          [](QVector<CaptureIndexRecord> &records) {
+            records[1].offset = records[0].offset;
+          },
+          // Compressed body is read as uncompressed.
+          [](QVector<CaptureIndexRecord> &records) {
+            records[1].compressed = false;
+          },
+      };
+
+  for (size_t i = 0; i < corruptions.size(); i++) {
+    SCOPED_TRACE(i);
+
+    TestCaptureIndex edit;
+    ASSERT_TRUE(edit.open(path));
+
+    corruptions[i](edit.editRecords());
+    ASSERT_TRUE(edit.saveIndex(indexPath));
+    EXPECT_FALSE(edit.loadIndex(indexPath));
+    EXPECT_TRUE(edit.records().isEmpty());
+
+    // Opening the capture again rebuilds the index and saves it.
+    CaptureIndex rebuilt;
+    ASSERT_TRUE(rebuilt.open(path));
+    ExpectSameRecords(expected, rebuilt.records());
+
+    EXPECT_TRUE(edit.loadIndex(indexPath));
+  }
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
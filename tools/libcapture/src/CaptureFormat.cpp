@@ -0,0 +1,206 @@
+/**
+ * @file tools/libcapture/src/CaptureFormat.cpp
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Reader for the capture files recorded by the logger.
+ *
+ * This library is shared by the tools that read captures.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureFormat.h"
+
+// libcomp Includes
+#include <Compress.h>
+
+// Standard C Includes
+#include <string.h>
+
+static const uint32_t FORMAT_MAGIC = 0x4B434148;   // HACK
+static const uint32_t FORMAT_MAGIC2 = 0x504D4F43;  // COMP
+static const uint32_t FORMAT_VER1 = 0x00010000;  // Major, Minor, Patch (1.0.0)
+static const uint32_t FORMAT_VER2 = 0x00010100;  // Major, Minor, Patch (1.1.0)
+
+/// Marker at the start of every compressed channel packet body ("gzip")
+static const uint32_t COMPRESSION_MAGIC = 0x677A6970;
+
+/// Size of the packet header of a lobby packet
+static const uint32_t LOBBY_HEADER_SIZE = 8;
+
+/// Size of the packet header and compression header of a channel packet
+static const uint32_t CHANNEL_HEADER_SIZE = 24;
+
+/// Longest client address a capture may have
+static const uint32_t MAX_ADDRESS_SIZE = 1024;
+
+bool capture::ReadFileHeader(const ReadFunction& read, FileHeader& header) {
+  uint32_t magic = 0, ver = 0;
+
+  if (!read(&magic, 4) || !read(&ver, 4) ||
+      (FORMAT_MAGIC != magic && FORMAT_MAGIC2 != magic) ||
+      (FORMAT_VER1 != ver && FORMAT_VER2 != ver)) {
+    return false;
+  }
+
+  header.isLobby = (FORMAT_MAGIC2 == magic);
+  header.version = ver;
+  header.stamp = 0;
+
+  uint32_t addrlen = 0;
+
+  if (!read(&header.stamp, FORMAT_VER1 == ver ? 4 : 8) ||
+      !read(&addrlen, 4) || MAX_ADDRESS_SIZE < addrlen) {
+    return false;
+  }
+
+  header.address.resize(addrlen);
+
+  if (addrlen && !read(&header.address[0], addrlen)) {
+    return false;
+  }
+
+  // The logger pads the address with nulls.
+  header.address.resize(strnlen(header.address.c_str(), addrlen));
+
+  return true;
+}
+
+bool capture::ReadPacketHeader(const ReadFunction& read,
+                               const FileHeader& file, PacketHeader& packet) {
+  packet.source = 0;
+  packet.stamp = 0;
+  packet.micro = 0;
+  packet.size = 0;
+
+  if (!read(&packet.source, 1) ||
+      !read(&packet.stamp, FORMAT_VER1 == file.version ? 4 : 8) ||
+      (FORMAT_VER1 != file.version && !read(&packet.micro, 8)) ||
+      !read(&packet.size, 4)) {
+    return false;
+  }
+
+  return CAPTURE_MAX_PACKET_SIZE >= packet.size;
+}
+
+bool capture::FindBody(const uint8_t* pData, uint32_t size, bool isLobby,
+                       PacketBody& body) {
+  body.offset = isLobby ? LOBBY_HEADER_SIZE : CHANNEL_HEADER_SIZE;
+
+  if (size < body.offset) {
+    return false;
+  }
+
+  body.size = size - body.offset;
+  body.uncompressedSize = body.size;
+
+  if (!isLobby) {
+    uint32_t magic = ((uint32_t)pData[8] << 24) |
+                     ((uint32_t)pData[9] << 16) |
+                     ((uint32_t)pData[10] << 8) | (uint32_t)pData[11];
+
+    if (COMPRESSION_MAGIC == magic) {
+      int32_t uncompressed, compressed;
+      memcpy(&uncompressed, pData + 12, 4);
+      memcpy(&compressed, pData + 16, 4);
+
+      if (0 > uncompressed || 0 > compressed ||
+          (uint32_t)compressed > body.size ||
+          CAPTURE_MAX_PACKET_SIZE < (uint32_t)uncompressed) {
+        return false;
+      }
+
+      body.size = (uint32_t)compressed;
+      body.uncompressedSize = (uint32_t)uncompressed;
+    }
+  }
+
+  return true;
+}
+
+bool capture::ReadBody(const uint8_t* pData, uint32_t size, bool isLobby,
+                       std::vector<char>& body) {
+  PacketBody location;
+
+  if (!FindBody(pData, size, isLobby, location)) {
+    return false;
+  }
+
+  const uint8_t* pBody = pData + location.offset;
+
+  if (location.size == location.uncompressedSize) {
+    body.assign((const char*)pBody, (const char*)pBody + location.size);
+
+    return true;
+  }
+
+  body.resize(location.uncompressedSize);
+
+  int32_t written = libcomp::Compress::Decompress(
+      pBody, body.data(), (int32_t)location.size,
+      (int32_t)location.uncompressedSize);
+
+  if (0 >= written) {
+    body.clear();
+
+    return false;
+  }
+
+  body.resize((size_t)written);
+
+  return true;
+}
+
+bool capture::ParseCommands(const char* pBody, uint32_t size,
+                            std::vector<Command>& commands) {
+  bool valid = true;
+
+  // Each command starts with a big endian size that is ignored followed by
+  // the little endian size, code and data.
+  uint32_t cmdStart = 0;
+
+  while (size - cmdStart >= 6) {
+    uint16_t cmdSize;
+    memcpy(&cmdSize, pBody + cmdStart + 2, 2);
+
+    if (4 > cmdSize) {
+      valid = false;
+      cmdStart += 4;
+
+      continue;
+    }
+
+    // A bad command size leaves no way to find the next command.
+    if (cmdStart + 2 + cmdSize > size) {
+      valid = false;
+
+      break;
+    }
+
+    Command cmd;
+    memcpy(&cmd.code, pBody + cmdStart + 4, 2);
+    cmd.offset = cmdStart + 6;
+    cmd.size = (uint16_t)(cmdSize - 4);
+
+    commands.push_back(cmd);
+
+    cmdStart += (uint32_t)cmdSize + 2;
+  }
+
+  return valid;
+}
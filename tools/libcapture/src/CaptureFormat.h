@@ -0,0 +1,178 @@
+/**
+ * @file tools/libcapture/src/CaptureFormat.h
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Reader for the capture files recorded by the logger.
+ *
+ * This library is shared by the tools that read captures.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_LIBCAPTURE_SRC_CAPTUREFORMAT_H
+#define TOOLS_LIBCAPTURE_SRC_CAPTUREFORMAT_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Largest packet the logger will record
+#define CAPTURE_MAX_PACKET_SIZE (1048576)
+
+namespace capture {
+
+/**
+ * Function used to read the next bytes of a capture. A capture may be read
+ * from a stream or from a memory mapping so the reader only needs this.
+ * @param pDest Buffer to read into
+ * @param size Number of bytes to read
+ * @returns true if exactly @p size bytes were read, false otherwise
+ */
+typedef std::function<bool(void* pDest, uint32_t size)> ReadFunction;
+
+/**
+ * Header at the start of every capture file.
+ */
+class FileHeader {
+ public:
+  /// Indicates this is a lobby capture instead of a channel capture
+  bool isLobby;
+
+  /// Format version of the capture
+  uint32_t version;
+
+  /// Time the capture was started in seconds
+  uint64_t stamp;
+
+  /// Address of the client the capture was recorded for
+  std::string address;
+};
+
+/**
+ * Header in front of every packet in a capture.
+ */
+class PacketHeader {
+ public:
+  /// 0 if the packet came from the client, 1 if it came from the server
+  uint8_t source;
+
+  /// Time the packet was captured in seconds
+  uint64_t stamp;
+
+  /// Time the packet was captured in microseconds (0 for version 1)
+  uint64_t micro;
+
+  /// Size of the packet data following the header
+  uint32_t size;
+};
+
+/**
+ * Location of the body of a packet after the packet and compression
+ * headers.
+ */
+class PacketBody {
+ public:
+  /// Offset of the body in the packet data
+  uint32_t offset;
+
+  /// Size of the (possibly compressed) body
+  uint32_t size;
+
+  /// Size of the body once decompressed
+  uint32_t uncompressedSize;
+};
+
+/**
+ * Location of a single command inside the body of a packet.
+ */
+class Command {
+ public:
+  /// Command code
+  uint16_t code;
+
+  /// Offset of the command data (after the command code) in the body
+  uint32_t offset;
+
+  /// Size of the command data
+  uint16_t size;
+};
+
+/**
+ * Read and validate the header of a capture file including the client
+ * address.
+ * @param read Function to read the capture with
+ * @param header Header to fill in
+ * @returns true if the header was valid, false otherwise
+ */
+bool ReadFileHeader(const ReadFunction& read, FileHeader& header);
+
+/**
+ * Read the header of the next packet in a capture. The packet data itself
+ * is left for the caller to read.
+ * @param read Function to read the capture with
+ * @param file Header of the capture being read
+ * @param packet Packet header to fill in
+ * @returns true if a complete header of a packet no larger than
+ *  @ref CAPTURE_MAX_PACKET_SIZE was read, false at the end of the capture
+ *  or if it is truncated
+ */
+bool ReadPacketHeader(const ReadFunction& read, const FileHeader& file,
+                      PacketHeader& packet);
+
+/**
+ * Find the body of a packet after the packet and compression headers.
+ * @param pData Packet data including the packet header
+ * @param size Size of the packet data
+ * @param isLobby If the packet is from a lobby capture
+ * @param body Location of the body to fill in
+ * @returns true if the packet has a valid body, false otherwise
+ */
+bool FindBody(const uint8_t* pData, uint32_t size, bool isLobby,
+              PacketBody& body);
+
+/**
+ * Copy the body of a packet, decompressing it if needed.
+ * @param pData Packet data including the packet header
+ * @param size Size of the packet data
+ * @param isLobby If the packet is from a lobby capture
+ * @param body Buffer to write the body to
+ * @returns true if the body was read, false otherwise
+ */
+bool ReadBody(const uint8_t* pData, uint32_t size, bool isLobby,
+              std::vector<char>& body);
+
+/**
+ * Find the commands in a packet body. A command too small to hold its own
+ * header is skipped and a command running past the end of the body stops
+ * the search. Either one makes the body invalid but the commands found
+ * before it are still added.
+ * @param pBody Body returned by @ref ReadBody (or located by @ref FindBody)
+ * @param size Size of the body
+ * @param commands List to add the commands to
+ * @returns true if every command in the body was valid, false otherwise
+ */
+bool ParseCommands(const char* pBody, uint32_t size,
+                   std::vector<Command>& commands);
+
+}  // namespace capture
+
+#endif  // TOOLS_LIBCAPTURE_SRC_CAPTUREFORMAT_H
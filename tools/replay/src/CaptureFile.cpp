@@ -0,0 +1,113 @@
+/**
+ * @file tools/replay/src/CaptureFile.cpp
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Reader for channel capture files recorded by the logger.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureFile.h"
+
+// libcapture Includes
+#include <CaptureFormat.h>
+
+// Standard C++11 Includes
+#include <fstream>
+
+using namespace replay;
+
+bool CaptureFile::Load(const libcomp::String& path) {
+  std::ifstream file(path.C(), std::ifstream::in | std::ifstream::binary);
+
+  if (!file.good()) {
+    return false;
+  }
+
+  capture::ReadFunction read = [&file](void* pDest, uint32_t size) {
+    return (bool)file.read((char*)pDest, (std::streamsize)size);
+  };
+
+  capture::FileHeader header;
+
+  // Lobby captures are not replayed.
+  if (!capture::ReadFileHeader(read, header) || header.isLobby) {
+    return false;
+  }
+
+  mPath = path;
+  mCommands.clear();
+
+  std::vector<char> data;
+
+  while (file.peek() != std::ifstream::traits_type::eof()) {
+    capture::PacketHeader packet;
+
+    if (!capture::ReadPacketHeader(read, header, packet)) {
+      return false;
+    }
+
+    data.resize(packet.size);
+
+    // Version 1 captures only have the time in seconds.
+    uint64_t micro = packet.micro ? packet.micro : packet.stamp * 1000000ULL;
+
+    if (!read(data.data(), packet.size) ||
+        !ParsePacket(packet.source, micro, data)) {
+      return false;
+    }
+  }
+
+  return !mCommands.empty();
+}
+
+libcomp::String CaptureFile::GetPath() const { return mPath; }
+
+const std::vector<CaptureCommand>& CaptureFile::GetCommands() const {
+  return mCommands;
+}
+
+bool CaptureFile::ParsePacket(uint8_t source, uint64_t micro,
+                              const std::vector<char>& data) {
+  std::vector<char> body;
+  std::vector<capture::Command> commands;
+
+  // A bad command leaves no way to find the next one so the capture is
+  // rejected instead of replaying part of the packet.
+  if (!capture::ReadBody((const uint8_t*)data.data(), (uint32_t)data.size(),
+                         false, body) ||
+      !capture::ParseCommands(body.data(), (uint32_t)body.size(),
+                              commands)) {
+    return false;
+  }
+
+  for (const capture::Command& command : commands) {
+    CaptureCommand cmd;
+    cmd.micro = micro;
+    cmd.source = source;
+    cmd.code = command.code;
+    cmd.data.assign(body.begin() + command.offset,
+                    body.begin() + command.offset + command.size);
+
+    mCommands.push_back(std::move(cmd));
+  }
+
+  return true;
+}
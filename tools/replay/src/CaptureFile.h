@@ -0,0 +1,104 @@
+/**
+ * @file tools/replay/src/CaptureFile.h
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Reader for channel capture files recorded by the logger.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_REPLAY_SRC_CAPTUREFILE_H
+#define TOOLS_REPLAY_SRC_CAPTUREFILE_H
+
+// libcomp Includes
+#include <CString.h>
+
+// Standard C++11 Includes
+#include <stdint.h>
+#include <vector>
+
+namespace replay {
+
+/**
+ * A single command read from a capture.
+ */
+class CaptureCommand {
+ public:
+  /// Time the packet holding the command was captured in microseconds
+  uint64_t micro;
+
+  /// 0 if the command came from the client, 1 if it came from the server
+  uint8_t source;
+
+  /// Command code
+  uint16_t code;
+
+  /// Command data following the command code
+  std::vector<char> data;
+};
+
+/**
+ * Channel capture file (.hack) recorded by the logger. Every packet in the
+ * capture is decompressed and split into the commands it holds so they can
+ * be sent again one at a time.
+ */
+class CaptureFile {
+ public:
+  /**
+   * Load a capture file.
+   * @param path Path to the capture file
+   * @returns true if the file was a valid channel capture, false otherwise
+   */
+  bool Load(const libcomp::String& path);
+
+  /**
+   * Get the path the capture was loaded from.
+   * @returns Path of the capture file
+   */
+  libcomp::String GetPath() const;
+
+  /**
+   * Get every command in the capture in the order it was captured.
+   * @returns Commands in the capture
+   */
+  const std::vector<CaptureCommand>& GetCommands() const;
+
+ private:
+  /**
+   * Split a captured packet into its commands.
+   * @param source 0 if the packet came from the client, 1 if it came from
+   *  the server
+   * @param micro Time the packet was captured in microseconds
+   * @param data Decrypted packet including the packet header
+   * @returns true if the packet was parsed, false otherwise
+   */
+  bool ParsePacket(uint8_t source, uint64_t micro,
+                   const std::vector<char>& data);
+
+  /// Path the capture was loaded from
+  libcomp::String mPath;
+
+  /// Commands in the capture
+  std::vector<CaptureCommand> mCommands;
+};
+
+}  // namespace replay
+
+#endif  // TOOLS_REPLAY_SRC_CAPTUREFILE_H
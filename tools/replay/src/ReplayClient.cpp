@@ -0,0 +1,318 @@
+/**
+ * @file tools/replay/src/ReplayClient.cpp
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Client that logs in and replays a channel capture.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplayClient.h"
+
+// libcomp Includes
+#include <EnumUtils.h>
+#include <ErrorCodes.h>
+#include <Packet.h>
+#include <PacketCodes.h>
+
+// libclient Includes
+#include <LogicWorker.h>
+#include <MessageCharacterList.h>
+#include <MessageConnected.h>
+#include <MessageConnectionInfo.h>
+#include <MessageStartGame.h>
+
+// packets Includes
+#include <PacketLobbyCharacterList.h>
+
+// replay Includes
+#include "CaptureFile.h"
+#include "ReplayManager.h"
+
+// Standard C++11 Includes
+#include <chrono>
+#include <thread>
+
+using namespace replay;
+
+using libcomp::Message::MessageClientType;
+
+/**
+ * Get the current steady clock time.
+ * @returns Current time in microseconds
+ */
+static uint64_t SteadyMicro() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * Get the entity ID at the start of a command.
+ * @param data Command data
+ * @returns Entity ID or 0 if the command is too short
+ */
+static int32_t LeadingEntityID(const std::vector<char>& data) {
+  if (4 > data.size()) {
+    return 0;
+  }
+
+  return (int32_t)((uint32_t)(uint8_t)data[0] |
+                   ((uint32_t)(uint8_t)data[1] << 8) |
+                   ((uint32_t)(uint8_t)data[2] << 16) |
+                   ((uint32_t)(uint8_t)data[3] << 24));
+}
+
+ReplayClient::ReplayClient(const std::shared_ptr<CaptureFile>& capture,
+                           const libcomp::String& username,
+                           const libcomp::String& password,
+                           uint8_t characterID)
+    : mCapture(capture),
+      mUsername(username),
+      mPassword(password),
+      mCharacterID(characterID),
+      mEventQueue(std::make_shared<
+                  libcomp::MessageQueue<libcomp::Message::Message*>>()),
+      mCharacterEntityID(0),
+      mPartnerEntityID(0),
+      mReplaying(false),
+      mWaitingSince(0),
+      mCommandsSent(0),
+      mCommandsSkipped(0),
+      mPacketsReceived(0) {}
+
+ReplayClient::~ReplayClient() {
+  if (mWorker) {
+    mWorker->Shutdown();
+    mWorker->Join();
+    mWorker.reset();
+  }
+
+  std::list<libcomp::Message::Message*> msgs;
+  mEventQueue->DequeueAny(msgs);
+
+  for (auto pMessage : msgs) {
+    delete pMessage;
+  }
+}
+
+bool ReplayClient::Login(const libcomp::String& host, uint16_t port,
+                         uint32_t clientVersion, double timeout) {
+  mWorker = std::make_shared<logic::LogicWorker>();
+  mWorker->SetFriendlyName(mUsername);
+  mWorker->SetGameQueue(mEventQueue);
+  mWorker->AddManager(std::make_shared<ReplayManager>(this));
+  mWorker->Start(libcomp::String("replay_%1").Arg(mUsername));
+
+  auto uuid = mWorker->GetUUID();
+
+  mWorker->SendToLogic(new logic::MessageConnectToLobby(
+      uuid, mUsername, mPassword, clientVersion, "lobby", host, port));
+
+  auto connected = std::dynamic_pointer_cast<logic::MessageConnectedToLobby>(
+      WaitForMessage(MessageClientType::CONNECTED_TO_LOBBY, timeout));
+
+  if (!connected || ErrorCodes_t::SUCCESS != connected->GetErrorCode()) {
+    return false;
+  }
+
+  auto characterList = std::dynamic_pointer_cast<logic::MessageCharacterList>(
+      WaitForMessage(MessageClientType::CHARACTER_LIST_UPDATE, timeout));
+
+  if (!characterList || !characterList->GetPayload()) {
+    return false;
+  }
+
+  bool found = false;
+
+  for (auto character : characterList->GetPayload()->GetCharacters()) {
+    if (character && mCharacterID == character->GetCharacterID()) {
+      found = true;
+      break;
+    }
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  mWorker->SendToLogic(new logic::MessageRequestStartGame(uuid, mCharacterID));
+
+  auto channel = std::dynamic_pointer_cast<logic::MessageConnectedToChannel>(
+      WaitForMessage(MessageClientType::CONNECTED_TO_CHANNEL, timeout));
+
+  return channel && ErrorCodes_t::SUCCESS == channel->GetErrorCode();
+}
+
+void ReplayClient::Replay(double speed) {
+  auto& commands = mCapture->GetCommands();
+
+  // Entity IDs from the original session
+  int32_t capturedCharacterID = 0;
+  int32_t capturedPartnerID = 0;
+
+  uint64_t firstMicro = 0;
+  uint64_t start = SteadyMicro();
+
+  mReplaying = true;
+
+  for (auto& cmd : commands) {
+    if (0 != cmd.source) {
+      // Learn the original entity IDs from what the server sent
+      if (to_underlying(ChannelToClientPacketCode_t::PACKET_CHARACTER_DATA) ==
+          cmd.code) {
+        capturedCharacterID = LeadingEntityID(cmd.data);
+      } else if (to_underlying(
+                     ChannelToClientPacketCode_t::PACKET_PARTNER_DATA) ==
+                 cmd.code) {
+        capturedPartnerID = LeadingEntityID(cmd.data);
+      }
+
+      continue;
+    }
+
+    // The live login already sent these with a fresh session key
+    if (to_underlying(ClientToChannelPacketCode_t::PACKET_LOGIN) == cmd.code ||
+        to_underlying(ClientToChannelPacketCode_t::PACKET_AUTH) == cmd.code) {
+      mCommandsSkipped++;
+      continue;
+    }
+
+    if (!firstMicro) {
+      firstMicro = cmd.micro;
+    }
+
+    if (0.0 < speed && cmd.micro > firstMicro) {
+      uint64_t due =
+          start + (uint64_t)((double)(cmd.micro - firstMicro) / speed);
+      uint64_t now = SteadyMicro();
+
+      if (due > now) {
+        std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+      }
+    }
+
+    libcomp::Packet p;
+    p.WriteU16Little(cmd.code);
+
+    size_t offset = 0;
+
+    // Swap the original entity ID for the one from the live session
+    int32_t entityID = LeadingEntityID(cmd.data);
+    if (entityID) {
+      int32_t liveEntityID = 0;
+
+      if (entityID == capturedCharacterID) {
+        liveEntityID = mCharacterEntityID;
+      } else if (entityID == capturedPartnerID) {
+        liveEntityID = mPartnerEntityID;
+      }
+
+      if (liveEntityID) {
+        p.WriteS32Little(liveEntityID);
+        offset = 4;
+      }
+    }
+
+    if (cmd.data.size() > offset) {
+      p.WriteArray(cmd.data.data() + offset,
+                   (uint32_t)(cmd.data.size() - offset));
+    }
+
+    uint64_t idle = 0;
+    mWaitingSince.compare_exchange_strong(idle, SteadyMicro());
+
+    mWorker->SendPacket(p);
+    mCommandsSent++;
+  }
+}
+
+void ReplayClient::PacketReceived(uint16_t commandCode,
+                                  libcomp::ReadOnlyPacket& p) {
+  if (to_underlying(ChannelToClientPacketCode_t::PACKET_CHARACTER_DATA) ==
+          commandCode &&
+      p.Left() >= 4) {
+    mCharacterEntityID = p.PeekS32Little();
+  } else if (to_underlying(ChannelToClientPacketCode_t::PACKET_PARTNER_DATA) ==
+                 commandCode &&
+             p.Left() >= 4) {
+    mPartnerEntityID = p.PeekS32Little();
+  }
+
+  if (!mReplaying) {
+    return;
+  }
+
+  mPacketsReceived++;
+
+  uint64_t sent = mWaitingSince.exchange(0);
+  if (sent) {
+    uint64_t latency = SteadyMicro() - sent;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    mLatencies.push_back(latency);
+  }
+}
+
+libcomp::String ReplayClient::GetUsername() const { return mUsername; }
+
+uint64_t ReplayClient::GetCommandsSent() const { return mCommandsSent; }
+
+uint64_t ReplayClient::GetCommandsSkipped() const { return mCommandsSkipped; }
+
+uint64_t ReplayClient::GetPacketsReceived() const { return mPacketsReceived; }
+
+std::vector<uint64_t> ReplayClient::GetLatencies() {
+  std::lock_guard<std::mutex> lock(mLock);
+  return mLatencies;
+}
+
+std::shared_ptr<libcomp::Message::MessageClient> ReplayClient::WaitForMessage(
+    MessageClientType type, double timeout) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds((int64_t)(timeout * 1000.0));
+
+  std::shared_ptr<libcomp::Message::MessageClient> result;
+
+  while (!result && std::chrono::steady_clock::now() < deadline) {
+    std::list<libcomp::Message::Message*> msgs;
+    mEventQueue->DequeueAny(msgs);
+
+    for (auto pMessage : msgs) {
+      auto pClientMessage =
+          dynamic_cast<libcomp::Message::MessageClient*>(pMessage);
+
+      if (!result && pClientMessage &&
+          to_underlying(type) ==
+              to_underlying(pClientMessage->GetMessageClientType())) {
+        result = std::shared_ptr<libcomp::Message::MessageClient>(
+            pClientMessage);
+      } else {
+        delete pMessage;
+      }
+    }
+
+    if (!result) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  return result;
+}
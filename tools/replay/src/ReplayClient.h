@@ -0,0 +1,195 @@
+/**
+ * @file tools/replay/src/ReplayClient.h
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Client that logs in and replays a channel capture.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_REPLAY_SRC_REPLAYCLIENT_H
+#define TOOLS_REPLAY_SRC_REPLAYCLIENT_H
+
+// libcomp Includes
+#include <CString.h>
+#include <MessageClient.h>
+#include <MessageQueue.h>
+#include <ReadOnlyPacket.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace logic {
+class LogicWorker;
+}  // namespace logic
+
+namespace replay {
+
+class CaptureFile;
+
+/**
+ * One simulated player. The client logs in through the lobby with its own
+ * account so the server hands out a fresh session key, then sends every
+ * client command from a capture to the channel with the original pacing
+ * (optionally sped up). Entity IDs for the character and partner demon are
+ * learned from the character and partner data packets of both the capture
+ * and the live session and rewritten in each command that starts with one.
+ */
+class ReplayClient {
+ public:
+  /**
+   * Create a new replay client.
+   * @param capture Capture to replay
+   * @param username Username of the account to log in with
+   * @param password Password of the account to log in with
+   * @param characterID Character ID from the character list to play
+   */
+  ReplayClient(const std::shared_ptr<CaptureFile>& capture,
+               const libcomp::String& username,
+               const libcomp::String& password, uint8_t characterID);
+
+  /**
+   * Stop the client and close the connection.
+   */
+  ~ReplayClient();
+
+  /**
+   * Log in through the lobby and enter the channel.
+   * @param host Host of the lobby server
+   * @param port Port of the lobby server
+   * @param clientVersion Client version to log in with
+   * @param timeout Seconds to wait for each login step
+   * @returns true if the client is connected to the channel
+   */
+  bool Login(const libcomp::String& host, uint16_t port,
+             uint32_t clientVersion, double timeout);
+
+  /**
+   * Send every client command in the capture. This blocks until the last
+   * command has been sent.
+   * @param speed Pacing multiplier where 1 is the original pacing, 2 is
+   *  twice as fast and 0 sends every command without waiting
+   */
+  void Replay(double speed);
+
+  /**
+   * Handle a packet received from the server. Called from the logic
+   * worker thread.
+   * @param commandCode Command code of the packet
+   * @param p Packet data after the command code
+   */
+  void PacketReceived(uint16_t commandCode, libcomp::ReadOnlyPacket& p);
+
+  /**
+   * Get the username the client logs in with.
+   * @returns Username of the account
+   */
+  libcomp::String GetUsername() const;
+
+  /**
+   * Get the number of commands sent to the server.
+   * @returns Number of commands sent
+   */
+  uint64_t GetCommandsSent() const;
+
+  /**
+   * Get the number of client commands in the capture that were not sent
+   * because the live login already covered them.
+   * @returns Number of commands skipped
+   */
+  uint64_t GetCommandsSkipped() const;
+
+  /**
+   * Get the number of packets received from the server during the replay.
+   * @returns Number of packets received
+   */
+  uint64_t GetPacketsReceived() const;
+
+  /**
+   * Get the time between sending a command and receiving the next packet
+   * from the server for every command that got a reply.
+   * @returns Response latencies in microseconds
+   */
+  std::vector<uint64_t> GetLatencies();
+
+ private:
+  /**
+   * Wait for a message from the logic worker.
+   * @param type Client message type to wait for
+   * @param timeout Seconds to wait for the message
+   * @returns The message or null if it was not received in time
+   */
+  std::shared_ptr<libcomp::Message::MessageClient> WaitForMessage(
+      libcomp::Message::MessageClientType type, double timeout);
+
+  /// Capture to replay
+  std::shared_ptr<CaptureFile> mCapture;
+
+  /// Username of the account to log in with
+  libcomp::String mUsername;
+
+  /// Password of the account to log in with
+  libcomp::String mPassword;
+
+  /// Character ID from the character list to play
+  uint8_t mCharacterID;
+
+  /// Logic worker that holds the connection
+  std::shared_ptr<logic::LogicWorker> mWorker;
+
+  /// Queue the logic worker sends events to
+  std::shared_ptr<libcomp::MessageQueue<libcomp::Message::Message*>>
+      mEventQueue;
+
+  /// Entity ID of the character in the live session
+  std::atomic<int32_t> mCharacterEntityID;
+
+  /// Entity ID of the summoned partner demon in the live session
+  std::atomic<int32_t> mPartnerEntityID;
+
+  /// Indicates the replay has started so received packets are counted
+  std::atomic<bool> mReplaying;
+
+  /// Steady clock time in microseconds the oldest unanswered command was
+  /// sent or 0 if every command has a reply
+  std::atomic<uint64_t> mWaitingSince;
+
+  /// Number of commands sent
+  std::atomic<uint64_t> mCommandsSent;
+
+  /// Number of commands skipped
+  std::atomic<uint64_t> mCommandsSkipped;
+
+  /// Number of packets received during the replay
+  std::atomic<uint64_t> mPacketsReceived;
+
+  /// Response latencies in microseconds
+  std::vector<uint64_t> mLatencies;
+
+  /// Lock for the response latencies
+  std::mutex mLock;
+};
+
+}  // namespace replay
+
+#endif  // TOOLS_REPLAY_SRC_REPLAYCLIENT_H
@@ -0,0 +1,66 @@
+/**
+ * @file tools/replay/src/ReplayManager.cpp
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Manager to watch the packets a replay client receives.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplayManager.h"
+
+// libcomp Includes
+#include <EnumUtils.h>
+#include <ReadOnlyPacket.h>
+
+// replay Includes
+#include "ReplayClient.h"
+
+using namespace replay;
+
+using libcomp::Message::MessageType;
+
+ReplayManager::ReplayManager(ReplayClient *pClient)
+    : libcomp::Manager(), mClient(pClient) {}
+
+ReplayManager::~ReplayManager() {}
+
+std::list<libcomp::Message::MessageType> ReplayManager::GetSupportedTypes()
+    const {
+  return {
+      MessageType::MESSAGE_TYPE_PACKET,
+  };
+}
+
+bool ReplayManager::ProcessMessage(const libcomp::Message::Message *pMessage) {
+  if (to_underlying(MessageType::MESSAGE_TYPE_PACKET) !=
+      to_underlying(pMessage->GetType())) {
+    return false;
+  }
+
+  const libcomp::Message::Packet *pPacket =
+      (const libcomp::Message::Packet *)pMessage;
+
+  libcomp::ReadOnlyPacket p(pPacket->GetPacket());
+
+  mClient->PacketReceived(pPacket->GetCommandCode(), p);
+
+  return true;
+}
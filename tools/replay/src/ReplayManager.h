@@ -0,0 +1,76 @@
+/**
+ * @file tools/replay/src/ReplayManager.h
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Manager to watch the packets a replay client receives.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_REPLAY_SRC_REPLAYMANAGER_H
+#define TOOLS_REPLAY_SRC_REPLAYMANAGER_H
+
+// libcomp Includes
+#include <Manager.h>
+#include <MessagePacket.h>
+
+namespace replay {
+
+class ReplayClient;
+
+/**
+ * Manager added to the logic worker of a replay client so every packet
+ * the client receives is passed to the client for timing and entity ID
+ * tracking.
+ */
+class ReplayManager : public libcomp::Manager {
+ public:
+  /**
+   * Create a new manager.
+   * @param pClient Replay client to pass received packets to
+   */
+  explicit ReplayManager(ReplayClient *pClient);
+
+  /**
+   * Cleanup the manager.
+   */
+  virtual ~ReplayManager();
+
+  /**
+   * Get the different types of messages handled by the manager.
+   * @return List of message types handled by the manager
+   */
+  std::list<libcomp::Message::MessageType> GetSupportedTypes() const override;
+
+  /**
+   * Process a message from the queue.
+   * @param pMessage Message to be processed
+   * @return true on success, false on failure
+   */
+  bool ProcessMessage(const libcomp::Message::Message *pMessage) override;
+
+ private:
+  /// Replay client to pass received packets to
+  ReplayClient *mClient;
+};
+
+}  // namespace replay
+
+#endif  // TOOLS_REPLAY_SRC_REPLAYMANAGER_H
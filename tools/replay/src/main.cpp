@@ -0,0 +1,270 @@
+/**
+ * @file tools/replay/src/main.cpp
+ * @ingroup tools
+ *
+ * @author HACKfrost
+ *
+ * @brief Load driver that replays channel captures against a server.
+ *
+ * This tool will replay channel captures against a local server.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// cpp-optparse Includes
+#include <OptionParser.h>
+
+// libcomp Includes
+#include <Exception.h>
+
+// replay Includes
+#include "CaptureFile.h"
+#include "ReplayClient.h"
+
+// Standard C Includes
+#include <cstdlib>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+/// Responses slower than one server tick in microseconds
+static const uint64_t SLOW_RESPONSE = 100000;
+
+/**
+ * Get a percentile from a sorted list of latencies.
+ * @param latencies Sorted latencies
+ * @param percentile Percentile to get from 0 to 100
+ * @returns Latency at the percentile
+ */
+static uint64_t Percentile(const std::vector<uint64_t>& latencies,
+                           double percentile) {
+  if (latencies.empty()) {
+    return 0;
+  }
+
+  size_t index = (size_t)((double)(latencies.size() - 1) * percentile / 100.0);
+
+  return latencies[index];
+}
+
+int main(int argc, char* argv[]) {
+  optparse::OptionParser parser;
+  parser.description(
+      "Replay channel captures from the logger against a local server.");
+  parser.usage("%prog [OPTIONS...] CAPTURE...");
+  parser.add_option("-n", "--clients")
+      .dest("clients")
+      .type("int")
+      .set_default(1)
+      .help("Number of clients to replay at the same time");
+  parser.add_option("-u", "--username")
+      .dest("username")
+      .set_default("replay")
+      .help("Account username prefix, the client number is appended");
+  parser.add_option("-p", "--password")
+      .dest("password")
+      .set_default("replay")
+      .help("Password of every replay account");
+  parser.add_option("-c", "--character")
+      .dest("character")
+      .type("int")
+      .set_default(0)
+      .help("Character ID from the character list to play");
+  parser.add_option("-H", "--host")
+      .dest("host")
+      .set_default("127.0.0.1")
+      .help("Host of the lobby server");
+  parser.add_option("-P", "--port")
+      .dest("port")
+      .type("int")
+      .set_default(10666)
+      .help("Port of the lobby server");
+  parser.add_option("-v", "--client-version")
+      .dest("version")
+      .type("int")
+      .set_default(1666)
+      .help("Client version to log in with");
+  parser.add_option("-s", "--speed")
+      .dest("speed")
+      .type("double")
+      .set_default(1.0)
+      .help("Pacing multiplier, 1 is the original pacing and 0 sends "
+            "without waiting");
+  parser.add_option("-t", "--timeout")
+      .dest("timeout")
+      .type("double")
+      .set_default(10.0)
+      .help("Seconds to wait for each login step");
+  parser.add_option("-l", "--linger")
+      .dest("linger")
+      .type("double")
+      .set_default(2.0)
+      .help("Seconds to keep listening for responses after the replay");
+
+  optparse::Values options;
+  std::vector<std::string> args;
+
+  try {
+    options = parser.parse_args(argc, argv);
+    args = parser.args();
+
+    if (args.empty()) {
+      parser.error("at least one capture file must be specified");
+    } else if (1 > (int)options.get("clients")) {
+      parser.error("at least one client must be replayed");
+    }
+  } catch (int ret) {
+    return ret;
+  }
+
+  libcomp::Exception::RegisterSignalHandler();
+
+  std::vector<std::shared_ptr<replay::CaptureFile>> captures;
+
+  for (auto path : args) {
+    auto capture = std::make_shared<replay::CaptureFile>();
+
+    if (!capture->Load(path)) {
+      std::cerr << "Failed to load channel capture: " << path << std::endl;
+
+      return EXIT_FAILURE;
+    }
+
+    captures.push_back(capture);
+  }
+
+  int clientCount = (int)options.get("clients");
+  double speed = (double)options.get("speed");
+  double timeout = (double)options.get("timeout");
+
+  // Clients take turns replaying each capture.
+  std::vector<std::shared_ptr<replay::ReplayClient>> clients;
+
+  for (int i = 0; i < clientCount; i++) {
+    clients.push_back(std::make_shared<replay::ReplayClient>(
+        captures[(size_t)i % captures.size()],
+        libcomp::String("%1%2").Arg(options["username"]).Arg(i + 1),
+        options["password"], (uint8_t)(int)options.get("character")));
+  }
+
+  // Log everyone in first so the replay itself is all game traffic.
+  std::vector<std::thread> threads;
+  std::vector<char> loggedIn(clients.size(), 0);
+
+  for (size_t i = 0; i < clients.size(); i++) {
+    threads.push_back(std::thread([&, i]() {
+      loggedIn[i] = clients[i]->Login(
+          options["host"], (uint16_t)(int)options.get("port"),
+          (uint32_t)(int)options.get("version"), timeout);
+    }));
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  threads.clear();
+
+  std::vector<std::shared_ptr<replay::ReplayClient>> active;
+
+  for (size_t i = 0; i < clients.size(); i++) {
+    if (loggedIn[i]) {
+      active.push_back(clients[i]);
+    } else {
+      std::cerr << "Failed to log in: " << clients[i]->GetUsername()
+                << std::endl;
+    }
+  }
+
+  if (active.empty()) {
+    return EXIT_FAILURE;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (auto client : active) {
+    threads.push_back(
+        std::thread([client, speed]() { client->Replay(speed); }));
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  // Give the server time to answer the last commands.
+  double linger = (double)options.get("linger");
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds((int64_t)(linger * 1000.0)));
+
+  uint64_t sent = 0, skipped = 0, received = 0;
+  std::vector<uint64_t> latencies;
+
+  for (auto client : active) {
+    sent += client->GetCommandsSent();
+    skipped += client->GetCommandsSkipped();
+    received += client->GetPacketsReceived();
+
+    auto clientLatencies = client->GetLatencies();
+    latencies.insert(latencies.end(), clientLatencies.begin(),
+                     clientLatencies.end());
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  uint64_t total = 0, slow = 0;
+  for (auto latency : latencies) {
+    total += latency;
+
+    if (SLOW_RESPONSE < latency) {
+      slow++;
+    }
+  }
+
+  std::cout << "Clients:           " << active.size() << " of "
+            << clients.size() << " logged in" << std::endl;
+  std::cout << "Replay time:       " << elapsed << " ms" << std::endl;
+  std::cout << "Commands sent:     " << sent << " (" << skipped
+            << " login commands skipped)" << std::endl;
+  std::cout << "Packets received:  " << received << std::endl;
+  std::cout << "Responses:         " << latencies.size() << std::endl;
+
+  if (!latencies.empty()) {
+    std::cout << "Latency (us):      avg "
+              << (total / (uint64_t)latencies.size()) << ", p50 "
+              << Percentile(latencies, 50.0) << ", p95 "
+              << Percentile(latencies, 95.0) << ", p99 "
+              << Percentile(latencies, 99.0) << ", max " << latencies.back()
+              << std::endl;
+    std::cout << "Over one tick:     " << slow << std::endl;
+  }
+
+  std::cout << "Server tick overruns are reported by the channel as the "
+               "TickOverruns performance count."
+            << std::endl;
+
+  // Close every connection before the captures go away.
+  active.clear();
+  clients.clear();
+
+  return EXIT_SUCCESS;
+}